@@ -0,0 +1,190 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "AllocatorBenchmark.h"
+
+namespace
+{
+    // Small and deterministic, so every run churns the same way.
+    class XorShift
+    {
+    public:
+        explicit XorShift(UINT32 seed) : m_state(seed) {}
+
+        UINT32 Next(UINT32 range)
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state % range;
+        }
+
+    private:
+        UINT32 m_state;
+    };
+
+    const UINT64 HeapSize = 1024ull * 1024 * 1024;
+    const UINT LiveTarget = 160;        // Allocations live at once, on average.
+    const UINT MaxRunLength = 64;
+
+    struct LiveAllocation
+    {
+        UINT32 block;
+        UINT64 alignment;
+    };
+
+    // A mix of what placed resources look like, with the alignment each gets.
+    void NextRequest(XorShift* pRandom, UINT64* pSize, UINT64* pAlignment)
+    {
+        const UINT kind = pRandom->Next(100);
+        if (kind < 40)
+        {
+            // Buffers.
+            *pSize = 64 * 1024 + pRandom->Next(2 * 1024 * 1024);
+            *pAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+        else if (kind < 70)
+        {
+            // Small textures.
+            *pSize = 4 * 1024 * (1 + pRandom->Next(16));
+            *pAlignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+        else if (kind < 95)
+        {
+            // Textures.
+            *pSize = 256 * 1024 + pRandom->Next(16 * 1024 * 1024);
+            *pAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+        else
+        {
+            // MSAA targets.
+            *pSize = 4 * 1024 * 1024 + pRandom->Next(28 * 1024 * 1024);
+            *pAlignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+    }
+}
+
+AllocatorBenchmarkResult RunAllocatorBenchmark(UINT allocationCount)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    TlsfAllocator allocator(HeapSize);
+    XorShift random(0x12345678);
+    std::vector<LiveAllocation> live;
+    live.reserve(allocationCount);
+
+    AllocatorBenchmarkResult result = {};
+    UINT64 allocateTime = 0;
+    UINT64 freeTime = 0;
+    UINT allocated = 0;
+    UINT freed = 0;
+    UINT64 sizes[MaxRunLength];
+    UINT64 alignments[MaxRunLength];
+    UINT32 freedBlocks[MaxRunLength];
+    while (allocated < allocationCount)
+    {
+        // Runs of allocations outweigh runs of frees below the target and the
+        // other way around above it, so the live set hovers around it.
+        const UINT runLength = (std::min)(1 + random.Next(MaxRunLength), allocationCount - allocated);
+        const bool allocate = live.size() < LiveTarget ? random.Next(4) != 0 : random.Next(4) == 0;
+        LARGE_INTEGER start, end;
+        if (allocate)
+        {
+            // Requests are drawn up front so that only the allocator is timed.
+            for (UINT i = 0; i < runLength; i++)
+            {
+                NextRequest(&random, &sizes[i], &alignments[i]);
+            }
+
+            UINT32 blocks[MaxRunLength];
+            QueryPerformanceCounter(&start);
+            for (UINT i = 0; i < runLength; i++)
+            {
+                TlsfAllocator::Allocation allocation;
+                blocks[i] = allocator.Allocate(sizes[i], alignments[i], &allocation) ? allocation.block : TlsfAllocator::InvalidBlock;
+            }
+            QueryPerformanceCounter(&end);
+            allocateTime += end.QuadPart - start.QuadPart;
+            allocated += runLength;
+
+            for (UINT i = 0; i < runLength; i++)
+            {
+                if (blocks[i] != TlsfAllocator::InvalidBlock)
+                {
+                    live.push_back({ blocks[i], alignments[i] });
+                }
+                else
+                {
+                    result.failedAllocationCount++;
+                }
+            }
+        }
+        else
+        {
+            // Frees hit random allocations, not the most recent ones.
+            UINT freeCount = 0;
+            while (freeCount < runLength && !live.empty())
+            {
+                const UINT index = random.Next(static_cast<UINT32>(live.size()));
+                freedBlocks[freeCount++] = live[index].block;
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            QueryPerformanceCounter(&start);
+            for (UINT i = 0; i < freeCount; i++)
+            {
+                allocator.Free(freedBlocks[i]);
+            }
+            QueryPerformanceCounter(&end);
+            freeTime += end.QuadPart - start.QuadPart;
+            freed += freeCount;
+        }
+    }
+
+    const double nsPerTick = 1000000000.0 / frequency.QuadPart;
+    result.allocateNs = allocateTime * nsPerTick / (std::max)(allocated, 1u);
+    result.freeNs = freeTime * nsPerTick / (std::max)(freed, 1u);
+    result.churned = allocator.GetStatistics();
+
+    // Move every allocation that has a lower place to go, from the top down. The
+    // alignments are looked up once, outside the timed part.
+    std::vector<UINT64> blockAlignments;
+    for (const LiveAllocation& allocation : live)
+    {
+        if (blockAlignments.size() <= allocation.block)
+        {
+            blockAlignments.resize(allocation.block + 1);
+        }
+        blockAlignments[allocation.block] = allocation.alignment;
+    }
+
+    std::vector<TlsfAllocator::Allocation> candidates;
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+    allocator.GetAllocationsFromTop(&candidates);
+    for (const TlsfAllocator::Allocation& candidate : candidates)
+    {
+        TlsfAllocator::Allocation allocation;
+        if (allocator.Relocate(candidate.block, blockAlignments[candidate.block], &allocation))
+        {
+            allocator.Free(candidate.block);
+            result.defragmentationMoveCount++;
+        }
+    }
+    QueryPerformanceCounter(&end);
+    result.defragmentationMs = (end.QuadPart - start.QuadPart) * nsPerTick / 1000000.0;
+    result.defragmented = allocator.GetStatistics();
+    return result;
+}
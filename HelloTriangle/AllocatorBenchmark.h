@@ -0,0 +1,34 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include "TlsfAllocator.h"
+
+struct AllocatorBenchmarkResult
+{
+    double allocateNs;                  // Average time per allocation.
+    double freeNs;                      // Average time per free.
+    UINT failedAllocationCount;
+    TlsfAllocator::Statistics churned;  // After the churn.
+    UINT defragmentationMoveCount;
+    double defragmentationMs;           // Time to plan every move.
+    TlsfAllocator::Statistics defragmented;
+};
+
+// Churns a TlsfAllocator the size of a large heap with the given number of
+// allocations and as many frees, the way streaming placed resources would:
+// runs of allocations and runs of frees of random length, mostly 64KB aligned
+// buffers and textures, some small textures at 4KB and some MSAA targets at
+// 4MB. Then relocates allocations downward as far as they go, the way
+// defragmentation would. Pure CPU bookkeeping; no device is involved.
+AllocatorBenchmarkResult RunAllocatorBenchmark(UINT allocationCount);
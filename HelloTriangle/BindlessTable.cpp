@@ -0,0 +1,131 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "BindlessTable.h"
+
+BindlessTable::BindlessTable(ID3D12Device* pDevice, FenceTimeline* pTimeline, ID3D12DescriptorHeap* pHeap, UINT firstDescriptor, UINT capacity) :
+    m_device(pDevice),
+    m_pTimeline(pTimeline),
+    m_heap(pHeap),
+    m_capacity(capacity),
+    m_count(0)
+{
+    const D3D12_DESCRIPTOR_HEAP_DESC heapDesc = pHeap->GetDesc();
+    if (heapDesc.Type != D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || !(heapDesc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) ||
+        firstDescriptor + capacity > heapDesc.NumDescriptors)
+    {
+        OutputDebugStringW(L"Bindless table needs a range of a shader-visible CBV/SRV/UAV heap.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    m_descriptorSize = pDevice->GetDescriptorHandleIncrementSize(heapDesc.Type);
+    m_cpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(pHeap->GetCPUDescriptorHandleForHeapStart(), firstDescriptor, m_descriptorSize);
+    m_gpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(pHeap->GetGPUDescriptorHandleForHeapStart(), firstDescriptor, m_descriptorSize);
+}
+
+BindlessTable::~BindlessTable()
+{
+}
+
+// Recycled slots first, then the ones never handed out, so the used part of
+// the table stays compact.
+UINT32 BindlessTable::AllocateSlot()
+{
+    if (m_freeSlots.empty() && m_generations.size() == m_capacity)
+    {
+        OutputDebugStringW(L"Bindless table is full.\n");
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    UINT32 index;
+    if (!m_freeSlots.empty())
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<UINT32>(m_generations.size());
+        m_generations.push_back(0);
+    }
+    m_count++;
+    return index;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE BindlessTable::GetCpuHandle(UINT32 index) const
+{
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuStart, index, m_descriptorSize);
+}
+
+_Use_decl_annotations_
+BindlessTable::Handle BindlessTable::CreateShaderResourceView(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc)
+{
+    const UINT32 index = AllocateSlot();
+    m_device->CreateShaderResourceView(pResource, pDesc, GetCpuHandle(index));
+    return GetHandle(index);
+}
+
+BindlessTable::Handle BindlessTable::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc)
+{
+    const UINT32 index = AllocateSlot();
+    m_device->CreateConstantBufferView(&desc, GetCpuHandle(index));
+    return GetHandle(index);
+}
+
+_Use_decl_annotations_
+BindlessTable::Handle BindlessTable::CreateUnorderedAccessView(ID3D12Resource* pResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* pDesc)
+{
+    const UINT32 index = AllocateSlot();
+    m_device->CreateUnorderedAccessView(pResource, nullptr, pDesc, GetCpuHandle(index));
+    return GetHandle(index);
+}
+
+BindlessTable::Handle BindlessTable::Copy(D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+    const UINT32 index = AllocateSlot();
+    m_device->CopyDescriptorsSimple(1, GetCpuHandle(index), source, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    return GetHandle(index);
+}
+
+void BindlessTable::Release(const Handle& handle)
+{
+    if (!IsValid(handle))
+    {
+        OutputDebugStringW(L"Releasing a stale bindless handle.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    // Timeline values only grow, so the pending slots stay sorted.
+    m_generations[handle.index]++;
+    m_pendingSlots.push_back({ m_pTimeline->GetNextValue(), handle.index });
+    m_count--;
+}
+
+void BindlessTable::Collect()
+{
+    while (!m_pendingSlots.empty() && m_pTimeline->IsCompleted(m_pendingSlots.front().fenceValue))
+    {
+        m_freeSlots.push_back(m_pendingSlots.front().index);
+        m_pendingSlots.pop_front();
+    }
+}
+
+UINT32 BindlessTable::GetIndex(const Handle& handle) const
+{
+    if (!IsValid(handle))
+    {
+        OutputDebugStringW(L"Stale bindless handle.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+    return handle.index;
+}
@@ -0,0 +1,94 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+
+// A bindless resource table: a range of the shader-visible CBV/SRV/UAV heap in
+// which every view the shaders read gets a slot of its own for as long as it
+// lives. Shaders declare the range as unbounded arrays and receive indices
+// into it as root constants, so draws never set up descriptor tables; the
+// table is bound once per command list.
+//
+// Views are referred to by generational handles. Releasing a view bumps its
+// slot's generation, so a handle kept past the release no longer validates,
+// even after the slot holds another view. The slot itself is reused only
+// once the timeline passes the work submitted so far, which may still index it.
+//
+// Not thread safe.
+class BindlessTable
+{
+public:
+    static const UINT32 InvalidIndex = UINT32_MAX;
+
+    struct Handle
+    {
+        UINT32 index = InvalidIndex;
+        UINT32 generation = 0;
+    };
+
+    BindlessTable(ID3D12Device* pDevice, FenceTimeline* pTimeline, ID3D12DescriptorHeap* pHeap, UINT firstDescriptor, UINT capacity);
+    ~BindlessTable();
+
+    // Writes the view straight into a free slot. Throws when the table is full.
+    Handle CreateShaderResourceView(ID3D12Resource* pResource, _In_opt_ const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc);
+    Handle CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc);
+    Handle CreateUnorderedAccessView(ID3D12Resource* pResource, _In_opt_ const D3D12_UNORDERED_ACCESS_VIEW_DESC* pDesc);
+
+    // Copies a view created in a staging heap into a free slot.
+    Handle Copy(D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+    void Release(const Handle& handle);
+
+    // Makes the slots whose last use has completed available again.
+    void Collect();
+
+    bool IsValid(const Handle& handle) const
+    {
+        return handle.index < m_generations.size() && m_generations[handle.index] == handle.generation;
+    }
+
+    // The index shaders use. Throws on a stale handle.
+    UINT32 GetIndex(const Handle& handle) const;
+
+    ID3D12DescriptorHeap* GetHeap() const               { return m_heap.Get(); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuStart() const     { return m_gpuStart; }
+    UINT GetCapacity() const                            { return m_capacity; }
+    UINT GetCount() const                               { return m_count; }
+
+private:
+    struct PendingSlot
+    {
+        UINT64 fenceValue;
+        UINT32 index;
+    };
+
+    UINT32 AllocateSlot();
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(UINT32 index) const;
+    Handle GetHandle(UINT32 index) const                { return { index, m_generations[index] }; }
+
+    ComPtr<ID3D12Device> m_device;
+    FenceTimeline* m_pTimeline;
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart;
+    UINT m_descriptorSize;
+    UINT m_capacity;
+    UINT m_count;
+    std::vector<UINT32> m_generations;      // Per slot handed out so far.
+    std::vector<UINT32> m_freeSlots;
+    std::deque<PendingSlot> m_pendingSlots;
+};
@@ -0,0 +1,120 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "BundleCache.h"
+
+size_t BundleCache::KeyHash::operator()(const StaticDrawKey& key) const
+{
+    const UINT64 values[] =
+    {
+        reinterpret_cast<UINT64>(key.pPipelineState),
+        reinterpret_cast<UINT64>(key.pRootSignature),
+        key.vertexBufferView.BufferLocation,
+        (UINT64(key.vertexBufferView.SizeInBytes) << 32) | key.vertexBufferView.StrideInBytes,
+        (UINT64(key.topology) << 32) | key.vertexCountPerInstance,
+        (UINT64(key.instanceCount) << 32) | key.drawCount
+    };
+
+    size_t hash = 0;
+    for (UINT64 value : values)
+    {
+        hash ^= std::hash<UINT64>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+bool BundleCache::KeyEqual::operator()(const StaticDrawKey& a, const StaticDrawKey& b) const
+{
+    return a.pPipelineState == b.pPipelineState && a.pRootSignature == b.pRootSignature && a.topology == b.topology &&
+        a.vertexBufferView.BufferLocation == b.vertexBufferView.BufferLocation &&
+        a.vertexBufferView.SizeInBytes == b.vertexBufferView.SizeInBytes &&
+        a.vertexBufferView.StrideInBytes == b.vertexBufferView.StrideInBytes &&
+        a.vertexCountPerInstance == b.vertexCountPerInstance && a.instanceCount == b.instanceCount && a.drawCount == b.drawCount;
+}
+
+BundleCache::BundleCache(ID3D12Device* pDevice, DeferredReleaseQueue* pDeferredReleases) :
+    m_device(pDevice),
+    m_pDeferredReleases(pDeferredReleases),
+    m_frameNumber(0),
+    m_recordCount(0)
+{
+}
+
+BundleCache::~BundleCache()
+{
+    Invalidate();
+}
+
+ID3D12GraphicsCommandList* BundleCache::GetBundle(const StaticDrawKey& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_bundles.find(key);
+    if (it == m_bundles.end())
+    {
+        Bundle bundle = {};
+        ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_BUNDLE, IID_PPV_ARGS(&bundle.allocator)));
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_BUNDLE, bundle.allocator.Get(), key.pPipelineState, IID_PPV_ARGS(&bundle.commandList)));
+        SetNameIndexed(bundle.commandList.Get(), L"StaticDrawBundle", static_cast<UINT>(m_recordCount));
+
+        // Bundles inherit nothing but the descriptor heaps, so the root
+        // signature has to be set even though it matches the caller's.
+        ID3D12GraphicsCommandList* pBundle = bundle.commandList.Get();
+        pBundle->SetGraphicsRootSignature(key.pRootSignature);
+        pBundle->IASetPrimitiveTopology(key.topology);
+        pBundle->IASetVertexBuffers(0, 1, &key.vertexBufferView);
+        for (UINT i = 0; i < key.drawCount; i++)
+        {
+            pBundle->DrawInstanced(key.vertexCountPerInstance, key.instanceCount, 0, 0);
+        }
+        ThrowIfFailed(pBundle->Close());
+
+        m_recordCount++;
+        it = m_bundles.emplace(key, bundle).first;
+    }
+
+    it->second.lastUsedFrame = m_frameNumber;
+    return it->second.commandList.Get();
+}
+
+void BundleCache::EndFrame()
+{
+    for (auto it = m_bundles.begin(); it != m_bundles.end();)
+    {
+        if (m_frameNumber - it->second.lastUsedFrame >= MaxUnusedFrames)
+        {
+            Release(it->second);
+            it = m_bundles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    m_frameNumber++;
+}
+
+void BundleCache::Invalidate()
+{
+    for (auto& entry : m_bundles)
+    {
+        Release(entry.second);
+    }
+    m_bundles.clear();
+}
+
+// Frames that executed the bundle may still be in flight.
+void BundleCache::Release(Bundle& bundle)
+{
+    m_pDeferredReleases->Release(bundle.commandList.Detach());
+    m_pDeferredReleases->Release(bundle.allocator.Detach());
+}
@@ -0,0 +1,86 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+
+// Everything that goes into a static draw sequence: the bundle sets the root
+// signature, topology and vertex buffer, then issues drawCount identical draws.
+// The pipeline state is the bundle's initial state.
+struct StaticDrawKey
+{
+    ID3D12PipelineState* pPipelineState;
+    ID3D12RootSignature* pRootSignature;
+    D3D12_PRIMITIVE_TOPOLOGY topology;
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+    UINT vertexCountPerInstance;
+    UINT instanceCount;
+    UINT drawCount;
+};
+
+// Records static draw sequences into bundles once and hands them out for
+// ExecuteBundle for as long as their key is in use. A changed input is a new key,
+// so stale bundles are never replayed; they are dropped once they have not been
+// used for a while, after the GPU is done with them.
+//
+// GetBundle() is thread safe; EndFrame() and Invalidate() must not be called
+// while other threads are recording.
+class BundleCache
+{
+public:
+    static const UINT MaxUnusedFrames = 60;
+
+    BundleCache(ID3D12Device* pDevice, DeferredReleaseQueue* pDeferredReleases);
+    ~BundleCache();
+
+    // Returns the bundle for the key, recording it first if there is none.
+    ID3D12GraphicsCommandList* GetBundle(const StaticDrawKey& key);
+
+    // Drops the bundles that have gone unused for MaxUnusedFrames frames.
+    void EndFrame();
+
+    // Drops every bundle, e.g. when the objects the keys point to are recreated
+    // at the same addresses.
+    void Invalidate();
+
+    size_t GetBundleCount() const       { return m_bundles.size(); }
+    UINT64 GetRecordCount() const       { return m_recordCount; }
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const StaticDrawKey& key) const;
+    };
+    struct KeyEqual
+    {
+        bool operator()(const StaticDrawKey& a, const StaticDrawKey& b) const;
+    };
+
+    struct Bundle
+    {
+        ComPtr<ID3D12CommandAllocator> allocator;   // Bundles are never re-recorded, so each keeps its own.
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        UINT64 lastUsedFrame;
+    };
+
+    void Release(Bundle& bundle);
+
+    ComPtr<ID3D12Device> m_device;
+    DeferredReleaseQueue* m_pDeferredReleases;
+    std::mutex m_mutex;
+    std::unordered_map<StaticDrawKey, Bundle, KeyHash, KeyEqual> m_bundles;
+    UINT64 m_frameNumber;
+    UINT64 m_recordCount;
+};
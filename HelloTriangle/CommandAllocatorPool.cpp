@@ -0,0 +1,108 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "CommandAllocatorPool.h"
+
+CommandAllocatorPool::CommandAllocatorPool(ID3D12Device* pDevice, FenceTimeline* pTimeline) :
+    m_device(pDevice),
+    m_pTimeline(pTimeline),
+    m_frameNumber(0),
+    m_allocatorCount(0)
+{
+    for (auto& threadSubPools : m_subPools)
+    {
+        for (SubPool& subPool : threadSubPools)
+        {
+            memset(subPool.usage, 0, sizeof(subPool.usage));
+            subPool.peakUsage = 0;
+        }
+    }
+}
+
+CommandAllocatorPool::~CommandAllocatorPool()
+{
+    // Allocators may only be destroyed once the GPU is done with them; the owner
+    // is expected to have waited for the timeline to go idle.
+}
+
+ID3D12CommandAllocator* CommandAllocatorPool::Acquire(UINT threadIndex, D3D12_COMMAND_LIST_TYPE type)
+{
+    assert(threadIndex < MaxThreadCount && type < ListTypeCount);
+    SubPool& subPool = m_subPools[threadIndex][type];
+
+    ComPtr<ID3D12CommandAllocator> allocator;
+    if (!subPool.retired.empty() && m_pTimeline->IsCompleted(subPool.retired.front().fenceValue))
+    {
+        // Command list allocators can only be reset when the associated 
+        // command lists have finished execution on the GPU.
+        allocator = std::move(subPool.retired.front().allocator);
+        subPool.retired.pop_front();
+        ThrowIfFailed(allocator->Reset());
+    }
+    else
+    {
+        ThrowIfFailed(m_device->CreateCommandAllocator(type, IID_PPV_ARGS(&allocator)));
+        m_allocatorCount++;
+    }
+
+    subPool.acquired.push_back(allocator);
+    return allocator.Get();
+}
+
+void CommandAllocatorPool::EndFrame(UINT64 fenceValue)
+{
+    const UINT slot = m_frameNumber % UsageWindow;
+    for (auto& threadSubPools : m_subPools)
+    {
+        for (SubPool& subPool : threadSubPools)
+        {
+            const UINT used = static_cast<UINT>(subPool.acquired.size());
+            for (auto& allocator : subPool.acquired)
+            {
+                subPool.retired.push_back({ fenceValue, std::move(allocator) });
+            }
+            subPool.acquired.clear();
+
+            // Track the peak demand over the window. Recomputing only when the
+            // evicted sample was the peak keeps this O(1) in the common case.
+            const UINT evicted = subPool.usage[slot];
+            subPool.usage[slot] = used;
+            if (used >= subPool.peakUsage)
+            {
+                subPool.peakUsage = used;
+            }
+            else if (evicted == subPool.peakUsage)
+            {
+                subPool.peakUsage = *std::max_element(subPool.usage, subPool.usage + UsageWindow);
+            }
+
+            // Allocators that are already idle beyond what a frame needs only hold
+            // on to command memory; release them.
+            UINT idle = 0;
+            for (const RetiredAllocator& retired : subPool.retired)
+            {
+                if (!m_pTimeline->IsCompleted(retired.fenceValue))
+                {
+                    break;
+                }
+                idle++;
+            }
+            while (idle > subPool.peakUsage)
+            {
+                subPool.retired.pop_front();
+                m_allocatorCount--;
+                idle--;
+            }
+        }
+    }
+    m_frameNumber++;
+}
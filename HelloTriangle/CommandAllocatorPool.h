@@ -0,0 +1,69 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+
+// Hands out command allocators per recording thread and command list type. An
+// allocator acquired during a frame is tagged with the fence value that ends the
+// frame and is only reset and handed out again once that value has completed.
+//
+// Each recording thread owns the sub-pools for its thread index, so Acquire()
+// takes no locks. EndFrame() must be called while no thread is recording.
+//
+// D3D12 does not report how much memory an allocator holds, so the pool adapts
+// to the frame's command memory in units of allocators: it tracks how many each
+// sub-pool needed per frame over a rolling window and frees idle allocators
+// beyond that peak, while growing on demand.
+class CommandAllocatorPool
+{
+public:
+    static const UINT MaxThreadCount = 16;
+    static const UINT ListTypeCount = D3D12_COMMAND_LIST_TYPE_COPY + 1;
+    static const UINT UsageWindow = 64;
+
+    CommandAllocatorPool(ID3D12Device* pDevice, FenceTimeline* pTimeline);
+    ~CommandAllocatorPool();
+
+    // Returns a reset allocator the GPU is no longer using.
+    ID3D12CommandAllocator* Acquire(UINT threadIndex, D3D12_COMMAND_LIST_TYPE type);
+
+    // Tags every allocator acquired since the previous call with the fence value
+    // that retires them, and trims idle allocators.
+    void EndFrame(UINT64 fenceValue);
+
+    UINT GetAllocatorCount() const          { return m_allocatorCount; }
+
+private:
+    struct RetiredAllocator
+    {
+        UINT64 fenceValue;
+        ComPtr<ID3D12CommandAllocator> allocator;
+    };
+
+    struct SubPool
+    {
+        std::vector<ComPtr<ID3D12CommandAllocator>> acquired;
+        std::deque<RetiredAllocator> retired;
+        UINT usage[UsageWindow];
+        UINT peakUsage;
+    };
+
+    ComPtr<ID3D12Device> m_device;
+    FenceTimeline* m_pTimeline;
+    SubPool m_subPools[MaxThreadCount][ListTypeCount];
+    UINT m_frameNumber;
+    std::atomic<UINT> m_allocatorCount;
+};
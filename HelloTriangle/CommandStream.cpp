@@ -0,0 +1,633 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "CommandStream.h"
+
+namespace
+{
+    // A texture copy location is the resource, the location type, then either
+    // the subresource or the placed footprint (offset, format, width, height,
+    // depth, row pitch); all fields are always present.
+    #define TEXTURE_COPY_LOCATION "ouuuuuuuu"
+
+    const CommandStreamOpInfo OpInfos[] =
+    {
+        { "ExecuteCommandLists",                "n[l]" },
+        { "Signal",                             "ou" },
+        { "Wait",                               "ou" },
+        { "Present",                            "uuu" },
+
+        { "Reset",                              "o" },
+        { "ClearState",                         "o" },
+        { "DrawInstanced",                      "uuuu" },
+        { "DrawIndexedInstanced",               "uuuiu" },
+        { "Dispatch",                           "uuu" },
+        { "CopyBufferRegion",                   "ououu" },
+        { "CopyTextureRegion",                  TEXTURE_COPY_LOCATION "uuu" TEXTURE_COPY_LOCATION "n[uuuuuu]" },
+        { "CopyResource",                       "oo" },
+        { "ResolveSubresource",                 "ououu" },
+        { "IASetPrimitiveTopology",             "u" },
+        { "RSSetViewports",                     "n[ffffff]" },
+        { "RSSetScissorRects",                  "n[iiii]" },
+        { "OMSetBlendFactor",                   "ffff" },
+        { "OMSetStencilRef",                    "u" },
+        { "SetPipelineState",                   "o" },
+        { "ResourceBarrier",                    "n[uuoouss]" },
+        { "ExecuteBundle",                      "o" },
+        { "SetDescriptorHeaps",                 "n[o]" },
+        { "SetComputeRootSignature",            "o" },
+        { "SetGraphicsRootSignature",           "o" },
+        { "SetComputeRootDescriptorTable",      "ug" },
+        { "SetGraphicsRootDescriptorTable",     "ug" },
+        { "SetComputeRoot32BitConstants",       "uun[u]" },
+        { "SetGraphicsRoot32BitConstants",      "uun[u]" },
+        { "SetComputeRootConstantBufferView",   "ua" },
+        { "SetGraphicsRootConstantBufferView",  "ua" },
+        { "SetComputeRootShaderResourceView",   "ua" },
+        { "SetGraphicsRootShaderResourceView",  "ua" },
+        { "SetComputeRootUnorderedAccessView",  "ua" },
+        { "SetGraphicsRootUnorderedAccessView", "ua" },
+        { "IASetIndexBuffer",                   "n[auu]" },
+        { "IASetVertexBuffers",                 "un[auu]" },
+        { "OMSetRenderTargets",                 "uun[c]n[c]" },
+        { "ClearDepthStencilView",              "cufun[iiii]" },
+        { "ClearRenderTargetView",              "cffffn[iiii]" },
+        { "DiscardResource",                    "on[n[iiii]uu]" },
+        { "BeginQuery",                         "ouu" },
+        { "EndQuery",                           "ouu" },
+        { "ResolveQueryData",                   "ouuuou" },
+        { "SetMarker",                          "ub" },
+        { "BeginEvent",                         "ub" },
+        { "EndEvent",                           "" },
+        { "ExecuteIndirect",                    "ououou" },
+
+        { "Unsupported",                        "b" },
+    };
+    static_assert(_countof(OpInfos) == static_cast<size_t>(CommandStreamOp::Count), "Every op needs an info entry.");
+
+    #undef TEXTURE_COPY_LOCATION
+
+    void ThrowInvalidStream()
+    {
+        throw HrException(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+    }
+
+    void AppendFormat(std::string& out, const char* pFormat, ...)
+    {
+        char buffer[128];
+        va_list args;
+        va_start(args, pFormat);
+        const int length = vsnprintf(buffer, sizeof(buffer), pFormat, args);
+        va_end(args);
+        if (length > 0)
+        {
+            out.append(buffer, (std::min)(static_cast<size_t>(length), sizeof(buffer) - 1));
+        }
+    }
+
+    void AppendIndexed(std::string& out, UINT64 index, UINT64 offset, const char* pOffsetFormat)
+    {
+        if (index == 0)
+        {
+            AppendFormat(out, offset ? "0x%llx" : "null", offset);
+        }
+        else
+        {
+            AppendFormat(out, "#%llu", index);
+            AppendFormat(out, pOffsetFormat, offset);
+        }
+    }
+
+    void AppendStates(std::string& out, UINT64 states)
+    {
+        static const struct { D3D12_RESOURCE_STATES state; const char* name; } StateNames[] =
+        {
+            { D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, "VERTEX_AND_CONSTANT_BUFFER" },
+            { D3D12_RESOURCE_STATE_INDEX_BUFFER, "INDEX_BUFFER" },
+            { D3D12_RESOURCE_STATE_RENDER_TARGET, "RENDER_TARGET" },
+            { D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "UNORDERED_ACCESS" },
+            { D3D12_RESOURCE_STATE_DEPTH_WRITE, "DEPTH_WRITE" },
+            { D3D12_RESOURCE_STATE_DEPTH_READ, "DEPTH_READ" },
+            { D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, "NON_PIXEL_SHADER_RESOURCE" },
+            { D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, "PIXEL_SHADER_RESOURCE" },
+            { D3D12_RESOURCE_STATE_STREAM_OUT, "STREAM_OUT" },
+            { D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, "INDIRECT_ARGUMENT" },
+            { D3D12_RESOURCE_STATE_COPY_DEST, "COPY_DEST" },
+            { D3D12_RESOURCE_STATE_COPY_SOURCE, "COPY_SOURCE" },
+            { D3D12_RESOURCE_STATE_RESOLVE_DEST, "RESOLVE_DEST" },
+            { D3D12_RESOURCE_STATE_RESOLVE_SOURCE, "RESOLVE_SOURCE" },
+        };
+
+        if (states == D3D12_RESOURCE_STATE_COMMON)
+        {
+            out += "COMMON";
+            return;
+        }
+
+        bool first = true;
+        for (const auto& entry : StateNames)
+        {
+            if (states & entry.state)
+            {
+                out += first ? "" : "|";
+                out += entry.name;
+                states &= ~static_cast<UINT64>(entry.state);
+                first = false;
+            }
+        }
+        if (states)
+        {
+            AppendFormat(out, first ? "0x%llx" : "|0x%llx", states);
+        }
+    }
+
+    void AppendBytes(std::string& out, const UINT8* pBytes, size_t size)
+    {
+        bool printable = true;
+        for (size_t i = 0; i < size; i++)
+        {
+            printable &= (pBytes[i] >= 0x20 && pBytes[i] < 0x7f) || (pBytes[i] == 0 && i == size - 1);
+        }
+
+        if (printable)
+        {
+            out += '"';
+            out.append(reinterpret_cast<const char*>(pBytes), size && !pBytes[size - 1] ? size - 1 : size);
+            out += '"';
+        }
+        else
+        {
+            out += '<';
+            for (size_t i = 0; i < size; i++)
+            {
+                AppendFormat(out, i ? " %02x" : "%02x", pBytes[i]);
+            }
+            out += '>';
+        }
+    }
+
+    // Returns the position after the ']' that closes the group starting at pFields.
+    const char* SkipGroup(const char* pFields)
+    {
+        int depth = 1;
+        for (; *pFields; pFields++)
+        {
+            depth += *pFields == '[' ? 1 : *pFields == ']' ? -1 : 0;
+            if (depth == 0)
+            {
+                return pFields + 1;
+            }
+        }
+        ThrowInvalidStream();
+        return pFields;
+    }
+
+    void DumpPackets(CommandStreamReader& reader, int indent, std::string& out);
+
+    // Formats the fields in [pFields, pEnd) onto the current line. Command list
+    // bodies are collected into 'bodies' so they can follow the line.
+    void DumpFields(const char* pFields, const char* pEnd, CommandStreamReader& reader, int indent, std::string& out, std::string& bodies, UINT& listCount)
+    {
+        bool first = true;
+        while (pFields < pEnd)
+        {
+            const char field = *pFields++;
+            if (field == ']')
+            {
+                continue;
+            }
+
+            out += first ? "" : ", ";
+            first = false;
+
+            switch (field)
+            {
+            case 'u':
+                AppendFormat(out, "%llu", reader.GetUInt());
+                break;
+
+            case 'i':
+                AppendFormat(out, "%lld", reader.GetInt());
+                break;
+
+            case 'f':
+                AppendFormat(out, "%g", reader.GetFloat());
+                break;
+
+            case 'o':
+                AppendIndexed(out, reader.GetUInt(), 0, "");
+                break;
+
+            case 's':
+                AppendStates(out, reader.GetUInt());
+                break;
+
+            case 'a':
+            {
+                const UINT64 index = reader.GetUInt();
+                AppendIndexed(out, index, reader.GetUInt(), "+%llu");
+                break;
+            }
+
+            case 'c':
+            case 'g':
+            {
+                const UINT64 index = reader.GetUInt();
+                AppendIndexed(out, index, reader.GetUInt(), "[%llu]");
+                break;
+            }
+
+            case 'b':
+            {
+                size_t size;
+                const UINT8* pBytes = reader.GetBytes(&size);
+                AppendBytes(out, pBytes, size);
+                break;
+            }
+
+            case 'l':
+            {
+                size_t size;
+                const UINT8* pBody = reader.GetBytes(&size);
+                AppendFormat(out, "list %u", listCount);
+                AppendFormat(bodies, "%*slist %u:\n", indent * 4 + 2, "", listCount++);
+                CommandStreamReader bodyReader(pBody, size);
+                DumpPackets(bodyReader, indent + 1, bodies);
+                break;
+            }
+
+            case 'n':
+            {
+                if (*pFields != '[')
+                {
+                    ThrowInvalidStream();
+                }
+                const char* pGroupEnd = SkipGroup(pFields + 1);
+                const bool singleField = pGroupEnd - pFields == 3;
+                const UINT64 count = reader.GetUInt();
+
+                out += '[';
+                for (UINT64 i = 0; i < count; i++)
+                {
+                    out += i ? (singleField ? ", " : ", (") : (singleField ? "" : "(");
+                    DumpFields(pFields + 1, pGroupEnd - 1, reader, indent, out, bodies, listCount);
+                    out += singleField ? "" : ")";
+                }
+                out += ']';
+                pFields = pGroupEnd;
+                break;
+            }
+
+            default:
+                ThrowInvalidStream();
+            }
+        }
+    }
+
+    void DumpPackets(CommandStreamReader& reader, int indent, std::string& out)
+    {
+        while (!reader.IsAtEnd())
+        {
+            const CommandStreamOpInfo& info = GetCommandStreamOpInfo(reader.GetOp());
+
+            out.append(indent * 4, ' ');
+            out += info.name;
+
+            std::string fields;
+            std::string bodies;
+            UINT listCount = 0;
+            DumpFields(info.fields, info.fields + strlen(info.fields), reader, indent, fields, bodies, listCount);
+            if (!fields.empty())
+            {
+                out += ' ';
+                out += fields;
+            }
+            out += '\n';
+            out += bodies;
+        }
+    }
+}
+
+const CommandStreamOpInfo& GetCommandStreamOpInfo(CommandStreamOp op)
+{
+    if (op >= CommandStreamOp::Count)
+    {
+        ThrowInvalidStream();
+    }
+    return OpInfos[static_cast<size_t>(op)];
+}
+
+CommandStreamObjects::CommandStreamObjects(ID3D12Device* pDevice) :
+    m_device(pDevice)
+{
+    // Index 0 is reserved for null.
+    m_objects.push_back({});
+}
+
+UINT CommandStreamObjects::Register(ID3D12Object* pObject)
+{
+    return AddObject(pObject, true);
+}
+
+UINT CommandStreamObjects::Register(ID3D12Resource* pResource)
+{
+    const UINT index = AddObject(pResource, true);
+
+    const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        const D3D12_GPU_VIRTUAL_ADDRESS address = pResource->GetGPUVirtualAddress();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_objects[index].gpuAddress = address;
+        m_addressRanges[address] = { address + desc.Width, index };
+    }
+    return index;
+}
+
+UINT CommandStreamObjects::Register(ID3D12DescriptorHeap* pHeap)
+{
+    const UINT index = AddObject(pHeap, true);
+
+    const D3D12_DESCRIPTOR_HEAP_DESC desc = pHeap->GetDesc();
+    const bool shaderVisible = (desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Object& object = m_objects[index];
+    object.cpuDescriptorStart = pHeap->GetCPUDescriptorHandleForHeapStart().ptr;
+    object.gpuDescriptorStart = shaderVisible ? pHeap->GetGPUDescriptorHandleForHeapStart().ptr : 0;
+    object.descriptorCount = desc.NumDescriptors;
+    object.descriptorIncrement = m_device->GetDescriptorHandleIncrementSize(desc.Type);
+    m_descriptorHeaps.push_back(index);
+    return index;
+}
+
+UINT CommandStreamObjects::GetIndex(ID3D12Object* pObject)
+{
+    return pObject ? AddObject(pObject, false) : 0;
+}
+
+void CommandStreamObjects::EncodeGpuAddress(D3D12_GPU_VIRTUAL_ADDRESS address, UINT* pIndex, UINT64* pOffset)
+{
+    *pIndex = 0;
+    *pOffset = address;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_addressRanges.upper_bound(address);
+    if (address && it != m_addressRanges.begin())
+    {
+        --it;
+        if (address < it->second.end)
+        {
+            *pIndex = it->second.index;
+            *pOffset = address - it->first;
+        }
+    }
+}
+
+void CommandStreamObjects::EncodeCpuDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE handle, UINT* pIndex, UINT64* pOffset)
+{
+    *pIndex = 0;
+    *pOffset = handle.ptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (UINT index : m_descriptorHeaps)
+    {
+        const Object& heap = m_objects[index];
+        if (handle.ptr >= heap.cpuDescriptorStart &&
+            handle.ptr < heap.cpuDescriptorStart + static_cast<SIZE_T>(heap.descriptorCount) * heap.descriptorIncrement)
+        {
+            *pIndex = index;
+            *pOffset = (handle.ptr - heap.cpuDescriptorStart) / heap.descriptorIncrement;
+            return;
+        }
+    }
+}
+
+void CommandStreamObjects::EncodeGpuDescriptor(D3D12_GPU_DESCRIPTOR_HANDLE handle, UINT* pIndex, UINT64* pOffset)
+{
+    *pIndex = 0;
+    *pOffset = handle.ptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (UINT index : m_descriptorHeaps)
+    {
+        const Object& heap = m_objects[index];
+        if (heap.gpuDescriptorStart && handle.ptr >= heap.gpuDescriptorStart &&
+            handle.ptr < heap.gpuDescriptorStart + static_cast<UINT64>(heap.descriptorCount) * heap.descriptorIncrement)
+        {
+            *pIndex = index;
+            *pOffset = (handle.ptr - heap.gpuDescriptorStart) / heap.descriptorIncrement;
+            return;
+        }
+    }
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS CommandStreamObjects::DecodeGpuAddress(UINT index, UINT64 offset) const
+{
+    return index ? GetRegisteredObject(index).gpuAddress + offset : offset;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE CommandStreamObjects::DecodeCpuDescriptor(UINT index, UINT64 offset) const
+{
+    if (!index)
+    {
+        return { static_cast<SIZE_T>(offset) };
+    }
+    const Object& heap = GetRegisteredObject(index);
+    return { heap.cpuDescriptorStart + static_cast<SIZE_T>(offset) * heap.descriptorIncrement };
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE CommandStreamObjects::DecodeGpuDescriptor(UINT index, UINT64 offset) const
+{
+    if (!index)
+    {
+        return { offset };
+    }
+    const Object& heap = GetRegisteredObject(index);
+    return { heap.gpuDescriptorStart + offset * heap.descriptorIncrement };
+}
+
+UINT CommandStreamObjects::AddObject(ID3D12Object* pObject, bool registered)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_indices.find(pObject);
+    if (it != m_indices.end())
+    {
+        m_objects[it->second].registered |= registered;
+        return it->second;
+    }
+
+    const UINT index = static_cast<UINT>(m_objects.size());
+    Object object = {};
+    object.object = pObject;
+    object.registered = registered;
+    m_objects.push_back(object);
+    m_indices.emplace(pObject, index);
+    return index;
+}
+
+// Registration has to be complete before decoding starts, so the table is read
+// without taking the lock.
+const CommandStreamObjects::Object& CommandStreamObjects::GetRegisteredObject(UINT index) const
+{
+    if (index == 0 || index >= m_objects.size() || !m_objects[index].registered)
+    {
+        ThrowInvalidStream();
+    }
+    return m_objects[index];
+}
+
+void CommandStreamWriter::PutUInt(UINT64 value)
+{
+    while (value >= 0x80)
+    {
+        m_data.push_back(static_cast<UINT8>(value | 0x80));
+        value >>= 7;
+    }
+    m_data.push_back(static_cast<UINT8>(value));
+}
+
+void CommandStreamWriter::PutInt(INT64 value)
+{
+    // Zigzag encoding keeps small negative values small.
+    PutUInt((static_cast<UINT64>(value) << 1) ^ static_cast<UINT64>(value >> 63));
+}
+
+void CommandStreamWriter::PutFloat(float value)
+{
+    const UINT8* pBytes = reinterpret_cast<const UINT8*>(&value);
+    m_data.insert(m_data.end(), pBytes, pBytes + sizeof(value));
+}
+
+void CommandStreamWriter::PutBytes(const void* pData, size_t size)
+{
+    PutUInt(size);
+    const UINT8* pBytes = static_cast<const UINT8*>(pData);
+    m_data.insert(m_data.end(), pBytes, pBytes + size);
+}
+
+CommandStreamOp CommandStreamReader::GetOp()
+{
+    if (m_pData == m_pEnd || *m_pData >= static_cast<UINT8>(CommandStreamOp::Count))
+    {
+        ThrowInvalidStream();
+    }
+    return static_cast<CommandStreamOp>(*m_pData++);
+}
+
+UINT64 CommandStreamReader::GetUInt()
+{
+    UINT64 value = 0;
+    for (UINT shift = 0; shift < 64; shift += 7)
+    {
+        if (m_pData == m_pEnd)
+        {
+            break;
+        }
+        const UINT8 byte = *m_pData++;
+        value |= static_cast<UINT64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+    ThrowInvalidStream();
+    return 0;
+}
+
+INT64 CommandStreamReader::GetInt()
+{
+    const UINT64 value = GetUInt();
+    return static_cast<INT64>(value >> 1) ^ -static_cast<INT64>(value & 1);
+}
+
+float CommandStreamReader::GetFloat()
+{
+    if (m_pEnd - m_pData < static_cast<ptrdiff_t>(sizeof(float)))
+    {
+        ThrowInvalidStream();
+    }
+    float value;
+    memcpy(&value, m_pData, sizeof(value));
+    m_pData += sizeof(value);
+    return value;
+}
+
+const UINT8* CommandStreamReader::GetBytes(size_t* pSize)
+{
+    const UINT64 size = GetUInt();
+    if (size > static_cast<UINT64>(m_pEnd - m_pData))
+    {
+        ThrowInvalidStream();
+    }
+    const UINT8* pBytes = m_pData;
+    m_pData += size;
+    *pSize = static_cast<size_t>(size);
+    return pBytes;
+}
+
+void SaveCommandStream(LPCWSTR filename, const std::vector<UINT8>& stream)
+{
+    using namespace Microsoft::WRL;
+
+    const CommandStreamHeader header = { CommandStreamHeader::Magic, CommandStreamHeader::CurrentVersion };
+    const std::string dump = DumpCommandStream(stream.data(), stream.size());
+
+    {
+        Wrappers::FileHandle file(CreateFile2(filename, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr));
+        if (file.Get() == INVALID_HANDLE_VALUE ||
+            !WriteFile(file.Get(), &header, sizeof(header), nullptr, nullptr) ||
+            !WriteFile(file.Get(), stream.data(), static_cast<DWORD>(stream.size()), nullptr, nullptr))
+        {
+            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+        }
+    }
+
+    const std::wstring dumpFilename = std::wstring(filename) + L".txt";
+    Wrappers::FileHandle file(CreateFile2(dumpFilename.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr));
+    if (file.Get() == INVALID_HANDLE_VALUE ||
+        !WriteFile(file.Get(), dump.data(), static_cast<DWORD>(dump.size()), nullptr, nullptr))
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+std::vector<UINT8> LoadCommandStream(LPCWSTR filename)
+{
+    byte* pData = nullptr;
+    UINT size = 0;
+    ReadDataFromFile(filename, &pData, &size);
+    std::unique_ptr<byte, decltype(&free)> data(pData, &free);
+
+    CommandStreamHeader header;
+    if (size < sizeof(header))
+    {
+        ThrowInvalidStream();
+    }
+    memcpy(&header, pData, sizeof(header));
+    if (header.magic != CommandStreamHeader::Magic || header.version != CommandStreamHeader::CurrentVersion)
+    {
+        ThrowInvalidStream();
+    }
+
+    return std::vector<UINT8>(pData + sizeof(header), pData + size);
+}
+
+std::string DumpCommandStream(const UINT8* pData, size_t size)
+{
+    std::string out;
+    CommandStreamReader reader(pData, size);
+    DumpPackets(reader, 0, out);
+    return out;
+}
@@ -0,0 +1,223 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "DXSampleHelper.h"
+
+// A command stream is a compact binary record of the calls made on command
+// lists and queues. Every packet is an opcode followed by its arguments, with
+// integers stored as variable length (LEB128) values. Objects, GPU virtual
+// addresses and descriptor handles are stored relative to a table of known
+// objects, so a stream is identical between runs and builds that do the same
+// work, and its text dump can be diffed to catch unexpected extra work.
+//
+// The layout of each packet's arguments is described by a field string, which
+// is what lets the text dump stay generic:
+//
+//     u   unsigned integer         i   signed integer          f   float
+//     o   object                   s   resource states
+//     a   GPU virtual address      c   CPU descriptor          g   GPU descriptor
+//     b   byte string              l   command list body (nested packets)
+//     n[...]  count followed by that many repetitions of the group
+
+enum class CommandStreamOp : UINT8
+{
+    // Queue packets.
+    ExecuteCommandLists,
+    Signal,
+    Wait,
+    Present,
+
+    // Command list packets.
+    Reset,
+    ClearState,
+    DrawInstanced,
+    DrawIndexedInstanced,
+    Dispatch,
+    CopyBufferRegion,
+    CopyTextureRegion,
+    CopyResource,
+    ResolveSubresource,
+    IASetPrimitiveTopology,
+    RSSetViewports,
+    RSSetScissorRects,
+    OMSetBlendFactor,
+    OMSetStencilRef,
+    SetPipelineState,
+    ResourceBarrier,
+    ExecuteBundle,
+    SetDescriptorHeaps,
+    SetComputeRootSignature,
+    SetGraphicsRootSignature,
+    SetComputeRootDescriptorTable,
+    SetGraphicsRootDescriptorTable,
+    SetComputeRoot32BitConstants,
+    SetGraphicsRoot32BitConstants,
+    SetComputeRootConstantBufferView,
+    SetGraphicsRootConstantBufferView,
+    SetComputeRootShaderResourceView,
+    SetGraphicsRootShaderResourceView,
+    SetComputeRootUnorderedAccessView,
+    SetGraphicsRootUnorderedAccessView,
+    IASetIndexBuffer,
+    IASetVertexBuffers,
+    OMSetRenderTargets,
+    ClearDepthStencilView,
+    ClearRenderTargetView,
+    DiscardResource,
+    BeginQuery,
+    EndQuery,
+    ResolveQueryData,
+    SetMarker,
+    BeginEvent,
+    EndEvent,
+    ExecuteIndirect,
+
+    // A call the stream has no encoding for; stores the function name.
+    Unsupported,
+
+    Count
+};
+
+struct CommandStreamOpInfo
+{
+    const char* name;
+    const char* fields;
+};
+
+const CommandStreamOpInfo& GetCommandStreamOpInfo(CommandStreamOp op);
+
+// The objects a stream refers to, by index. Objects registered in the same order
+// get the same indices, which is what makes a stream replayable in another run.
+// Index 0 stands for null, or for a raw address or handle that did not resolve.
+// Objects that are encountered without having been registered still get an index
+// so that the dump can tell them apart, but cannot be replayed.
+//
+// Thread safe.
+class CommandStreamObjects
+{
+public:
+    explicit CommandStreamObjects(ID3D12Device* pDevice);
+
+    // Buffers also make their GPU virtual address range resolvable, descriptor
+    // heaps their descriptor handles.
+    UINT Register(ID3D12Object* pObject);
+    UINT Register(ID3D12Resource* pResource);
+    UINT Register(ID3D12DescriptorHeap* pHeap);
+
+    // Encoding. Unknown objects are added as unregistered.
+    UINT GetIndex(ID3D12Object* pObject);
+    void EncodeGpuAddress(D3D12_GPU_VIRTUAL_ADDRESS address, UINT* pIndex, UINT64* pOffset);
+    void EncodeCpuDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE handle, UINT* pIndex, UINT64* pOffset);
+    void EncodeGpuDescriptor(D3D12_GPU_DESCRIPTOR_HANDLE handle, UINT* pIndex, UINT64* pOffset);
+
+    // Decoding, once registration is complete. Throws on indices that were not
+    // registered in this run.
+    template<class T>
+    T* Resolve(UINT index)
+    {
+        return static_cast<T*>(GetRegisteredObject(index).object.Get());
+    }
+    D3D12_GPU_VIRTUAL_ADDRESS DecodeGpuAddress(UINT index, UINT64 offset) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE DecodeCpuDescriptor(UINT index, UINT64 offset) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE DecodeGpuDescriptor(UINT index, UINT64 offset) const;
+
+private:
+    // Addresses and descriptor heap starts are cached so decoding stays cheap.
+    struct Object
+    {
+        ComPtr<ID3D12Object> object;
+        bool registered;
+        D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+        SIZE_T cpuDescriptorStart;
+        UINT64 gpuDescriptorStart;
+        UINT descriptorCount;
+        UINT descriptorIncrement;
+    };
+
+    struct AddressRange
+    {
+        UINT64 end;
+        UINT index;
+    };
+
+    UINT AddObject(ID3D12Object* pObject, bool registered);
+    const Object& GetRegisteredObject(UINT index) const;
+
+    ComPtr<ID3D12Device> m_device;
+    std::mutex m_mutex;
+    std::vector<Object> m_objects;
+    std::unordered_map<ID3D12Object*, UINT> m_indices;
+    std::map<UINT64, AddressRange> m_addressRanges;
+    std::vector<UINT> m_descriptorHeaps;
+};
+
+class CommandStreamWriter
+{
+public:
+    void PutOp(CommandStreamOp op)      { m_data.push_back(static_cast<UINT8>(op)); }
+    void PutUInt(UINT64 value);
+    void PutInt(INT64 value);
+    void PutFloat(float value);
+    void PutBytes(const void* pData, size_t size);
+
+    void Clear()                        { m_data.clear(); }
+    const std::vector<UINT8>& GetData() const { return m_data; }
+
+private:
+    std::vector<UINT8> m_data;
+};
+
+// Reads packets written by CommandStreamWriter. Reading past the end throws.
+class CommandStreamReader
+{
+public:
+    CommandStreamReader(const UINT8* pData, size_t size) : m_pData(pData), m_pEnd(pData + size) {}
+
+    bool IsAtEnd() const                { return m_pData == m_pEnd; }
+    const UINT8* GetPosition() const    { return m_pData; }
+
+    CommandStreamOp GetOp();
+    UINT64 GetUInt();
+    UINT GetUInt32()                    { return static_cast<UINT>(GetUInt()); }
+    INT64 GetInt();
+    float GetFloat();
+
+    // Returns a pointer into the stream and skips the bytes.
+    const UINT8* GetBytes(size_t* pSize);
+
+private:
+    const UINT8* m_pData;
+    const UINT8* m_pEnd;
+};
+
+// Stream files start with this header.
+struct CommandStreamHeader
+{
+    static const UINT32 Magic = 'S' << 24 | 'C' << 16 | '2' << 8 | 'D';
+    static const UINT32 CurrentVersion = 2;
+
+    UINT32 magic;
+    UINT32 version;
+};
+
+// Writes a stream to a file, and its text dump to the same path plus ".txt".
+void SaveCommandStream(LPCWSTR filename, const std::vector<UINT8>& stream);
+
+// Reads a stream file and returns the packets after the header.
+std::vector<UINT8> LoadCommandStream(LPCWSTR filename);
+
+// One line per packet, with command list bodies indented below their submission.
+std::string DumpCommandStream(const UINT8* pData, size_t size);
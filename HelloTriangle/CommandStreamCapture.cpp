@@ -0,0 +1,759 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "CommandStreamCapture.h"
+
+using Microsoft::WRL::ChainInterfaces;
+using Microsoft::WRL::ClassicCom;
+using Microsoft::WRL::Make;
+using Microsoft::WRL::RuntimeClass;
+using Microsoft::WRL::RuntimeClassFlags;
+
+namespace
+{
+    // Forwards ID3D12Object and ID3D12DeviceChild to the wrapped object.
+    template<class Chain, class Real>
+    class CapturingDeviceChild : public RuntimeClass<RuntimeClassFlags<ClassicCom>, Chain>
+    {
+    public:
+        CapturingDeviceChild(Real* pReal, CommandStreamCapture* pCapture) :
+            m_real(pReal),
+            m_pCapture(pCapture),
+            m_pObjects(pCapture->GetObjects())
+        {
+        }
+
+        Real* GetReal() const { return m_real.Get(); }
+
+        HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* pDataSize, void* pData) override { return m_real->GetPrivateData(guid, pDataSize, pData); }
+        HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT DataSize, const void* pData) override { return m_real->SetPrivateData(guid, DataSize, pData); }
+        HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* pData) override { return m_real->SetPrivateDataInterface(guid, pData); }
+        HRESULT STDMETHODCALLTYPE SetName(LPCWSTR Name) override { return m_real->SetName(Name); }
+        HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override { return m_real->GetDevice(riid, ppvDevice); }
+
+    protected:
+        ComPtr<Real> m_real;
+        CommandStreamCapture* m_pCapture;
+        CommandStreamObjects* m_pObjects;
+    };
+
+    class CapturingCommandList : public CapturingDeviceChild<ChainInterfaces<ID3D12GraphicsCommandList, ID3D12CommandList, ID3D12DeviceChild, ID3D12Object>, ID3D12GraphicsCommandList>
+    {
+    public:
+        CapturingCommandList(ID3D12GraphicsCommandList* pReal, CommandStreamCapture* pCapture) :
+            CapturingDeviceChild(pReal, pCapture)
+        {
+        }
+
+        // The packets recorded since the last Reset.
+        const std::vector<UINT8>& GetBody() const { return m_writer.GetData(); }
+
+        D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return m_real->GetType(); }
+        HRESULT STDMETHODCALLTYPE Close() override { return m_real->Close(); }
+
+        // The allocator is not recorded; replay supplies its own.
+        HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState) override
+        {
+            m_writer.Clear();
+            m_writer.PutOp(CommandStreamOp::Reset);
+            PutObject(pInitialState);
+            return m_real->Reset(pAllocator, pInitialState);
+        }
+
+        void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* pPipelineState) override
+        {
+            m_writer.PutOp(CommandStreamOp::ClearState);
+            PutObject(pPipelineState);
+            m_real->ClearState(pPipelineState);
+        }
+
+        void STDMETHODCALLTYPE DrawInstanced(UINT VertexCountPerInstance, UINT InstanceCount, UINT StartVertexLocation, UINT StartInstanceLocation) override
+        {
+            m_writer.PutOp(CommandStreamOp::DrawInstanced);
+            m_writer.PutUInt(VertexCountPerInstance);
+            m_writer.PutUInt(InstanceCount);
+            m_writer.PutUInt(StartVertexLocation);
+            m_writer.PutUInt(StartInstanceLocation);
+            m_real->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
+        }
+
+        void STDMETHODCALLTYPE DrawIndexedInstanced(UINT IndexCountPerInstance, UINT InstanceCount, UINT StartIndexLocation, INT BaseVertexLocation, UINT StartInstanceLocation) override
+        {
+            m_writer.PutOp(CommandStreamOp::DrawIndexedInstanced);
+            m_writer.PutUInt(IndexCountPerInstance);
+            m_writer.PutUInt(InstanceCount);
+            m_writer.PutUInt(StartIndexLocation);
+            m_writer.PutInt(BaseVertexLocation);
+            m_writer.PutUInt(StartInstanceLocation);
+            m_real->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+        }
+
+        void STDMETHODCALLTYPE Dispatch(UINT ThreadGroupCountX, UINT ThreadGroupCountY, UINT ThreadGroupCountZ) override
+        {
+            m_writer.PutOp(CommandStreamOp::Dispatch);
+            m_writer.PutUInt(ThreadGroupCountX);
+            m_writer.PutUInt(ThreadGroupCountY);
+            m_writer.PutUInt(ThreadGroupCountZ);
+            m_real->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+        }
+
+        void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource* pDstBuffer, UINT64 DstOffset, ID3D12Resource* pSrcBuffer, UINT64 SrcOffset, UINT64 NumBytes) override
+        {
+            m_writer.PutOp(CommandStreamOp::CopyBufferRegion);
+            PutObject(pDstBuffer);
+            m_writer.PutUInt(DstOffset);
+            PutObject(pSrcBuffer);
+            m_writer.PutUInt(SrcOffset);
+            m_writer.PutUInt(NumBytes);
+            m_real->CopyBufferRegion(pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
+        }
+
+        void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION* pDst, UINT DstX, UINT DstY, UINT DstZ, const D3D12_TEXTURE_COPY_LOCATION* pSrc, const D3D12_BOX* pSrcBox) override
+        {
+            m_writer.PutOp(CommandStreamOp::CopyTextureRegion);
+            PutTextureCopyLocation(*pDst);
+            m_writer.PutUInt(DstX);
+            m_writer.PutUInt(DstY);
+            m_writer.PutUInt(DstZ);
+            PutTextureCopyLocation(*pSrc);
+            m_writer.PutUInt(pSrcBox ? 1 : 0);
+            if (pSrcBox)
+            {
+                m_writer.PutUInt(pSrcBox->left);
+                m_writer.PutUInt(pSrcBox->top);
+                m_writer.PutUInt(pSrcBox->front);
+                m_writer.PutUInt(pSrcBox->right);
+                m_writer.PutUInt(pSrcBox->bottom);
+                m_writer.PutUInt(pSrcBox->back);
+            }
+            m_real->CopyTextureRegion(pDst, DstX, DstY, DstZ, pSrc, pSrcBox);
+        }
+
+        void STDMETHODCALLTYPE CopyResource(ID3D12Resource* pDstResource, ID3D12Resource* pSrcResource) override
+        {
+            m_writer.PutOp(CommandStreamOp::CopyResource);
+            PutObject(pDstResource);
+            PutObject(pSrcResource);
+            m_real->CopyResource(pDstResource, pSrcResource);
+        }
+
+        void STDMETHODCALLTYPE CopyTiles(ID3D12Resource* pTiledResource, const D3D12_TILED_RESOURCE_COORDINATE* pTileRegionStartCoordinate, const D3D12_TILE_REGION_SIZE* pTileRegionSize, ID3D12Resource* pBuffer, UINT64 BufferStartOffsetInBytes, D3D12_TILE_COPY_FLAGS Flags) override
+        {
+            PutUnsupported(__FUNCTION__);
+            m_real->CopyTiles(pTiledResource, pTileRegionStartCoordinate, pTileRegionSize, pBuffer, BufferStartOffsetInBytes, Flags);
+        }
+
+        void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource* pDstResource, UINT DstSubresource, ID3D12Resource* pSrcResource, UINT SrcSubresource, DXGI_FORMAT Format) override
+        {
+            m_writer.PutOp(CommandStreamOp::ResolveSubresource);
+            PutObject(pDstResource);
+            m_writer.PutUInt(DstSubresource);
+            PutObject(pSrcResource);
+            m_writer.PutUInt(SrcSubresource);
+            m_writer.PutUInt(Format);
+            m_real->ResolveSubresource(pDstResource, DstSubresource, pSrcResource, SrcSubresource, Format);
+        }
+
+        void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY PrimitiveTopology) override
+        {
+            m_writer.PutOp(CommandStreamOp::IASetPrimitiveTopology);
+            m_writer.PutUInt(PrimitiveTopology);
+            m_real->IASetPrimitiveTopology(PrimitiveTopology);
+        }
+
+        void STDMETHODCALLTYPE RSSetViewports(UINT NumViewports, const D3D12_VIEWPORT* pViewports) override
+        {
+            m_writer.PutOp(CommandStreamOp::RSSetViewports);
+            m_writer.PutUInt(NumViewports);
+            for (UINT i = 0; i < NumViewports; i++)
+            {
+                m_writer.PutFloat(pViewports[i].TopLeftX);
+                m_writer.PutFloat(pViewports[i].TopLeftY);
+                m_writer.PutFloat(pViewports[i].Width);
+                m_writer.PutFloat(pViewports[i].Height);
+                m_writer.PutFloat(pViewports[i].MinDepth);
+                m_writer.PutFloat(pViewports[i].MaxDepth);
+            }
+            m_real->RSSetViewports(NumViewports, pViewports);
+        }
+
+        void STDMETHODCALLTYPE RSSetScissorRects(UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            m_writer.PutOp(CommandStreamOp::RSSetScissorRects);
+            PutRects(NumRects, pRects);
+            m_real->RSSetScissorRects(NumRects, pRects);
+        }
+
+        void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT BlendFactor[4]) override
+        {
+            static const FLOAT DefaultBlendFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            const FLOAT* pBlendFactor = BlendFactor ? BlendFactor : DefaultBlendFactor;
+
+            m_writer.PutOp(CommandStreamOp::OMSetBlendFactor);
+            for (UINT i = 0; i < 4; i++)
+            {
+                m_writer.PutFloat(pBlendFactor[i]);
+            }
+            m_real->OMSetBlendFactor(BlendFactor);
+        }
+
+        void STDMETHODCALLTYPE OMSetStencilRef(UINT StencilRef) override
+        {
+            m_writer.PutOp(CommandStreamOp::OMSetStencilRef);
+            m_writer.PutUInt(StencilRef);
+            m_real->OMSetStencilRef(StencilRef);
+        }
+
+        void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* pPipelineState) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetPipelineState);
+            PutObject(pPipelineState);
+            m_real->SetPipelineState(pPipelineState);
+        }
+
+        void STDMETHODCALLTYPE ResourceBarrier(UINT NumBarriers, const D3D12_RESOURCE_BARRIER* pBarriers) override
+        {
+            m_writer.PutOp(CommandStreamOp::ResourceBarrier);
+            m_writer.PutUInt(NumBarriers);
+            for (UINT i = 0; i < NumBarriers; i++)
+            {
+                const D3D12_RESOURCE_BARRIER& barrier = pBarriers[i];
+                m_writer.PutUInt(barrier.Type);
+                m_writer.PutUInt(barrier.Flags);
+                switch (barrier.Type)
+                {
+                case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+                    PutObject(barrier.Transition.pResource);
+                    PutObject(nullptr);
+                    m_writer.PutUInt(barrier.Transition.Subresource);
+                    m_writer.PutUInt(barrier.Transition.StateBefore);
+                    m_writer.PutUInt(barrier.Transition.StateAfter);
+                    break;
+
+                case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+                    PutObject(barrier.Aliasing.pResourceBefore);
+                    PutObject(barrier.Aliasing.pResourceAfter);
+                    m_writer.PutUInt(0);
+                    m_writer.PutUInt(0);
+                    m_writer.PutUInt(0);
+                    break;
+
+                default:
+                    PutObject(barrier.UAV.pResource);
+                    PutObject(nullptr);
+                    m_writer.PutUInt(0);
+                    m_writer.PutUInt(0);
+                    m_writer.PutUInt(0);
+                    break;
+                }
+            }
+            m_real->ResourceBarrier(NumBarriers, pBarriers);
+        }
+
+        void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override
+        {
+            m_writer.PutOp(CommandStreamOp::ExecuteBundle);
+            PutObject(pCommandList);
+            m_real->ExecuteBundle(pCommandList);
+        }
+
+        void STDMETHODCALLTYPE SetDescriptorHeaps(UINT NumDescriptorHeaps, ID3D12DescriptorHeap* const* ppDescriptorHeaps) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetDescriptorHeaps);
+            m_writer.PutUInt(NumDescriptorHeaps);
+            for (UINT i = 0; i < NumDescriptorHeaps; i++)
+            {
+                PutObject(ppDescriptorHeaps[i]);
+            }
+            m_real->SetDescriptorHeaps(NumDescriptorHeaps, ppDescriptorHeaps);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* pRootSignature) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetComputeRootSignature);
+            PutObject(pRootSignature);
+            m_real->SetComputeRootSignature(pRootSignature);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* pRootSignature) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetGraphicsRootSignature);
+            PutObject(pRootSignature);
+            m_real->SetGraphicsRootSignature(pRootSignature);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetComputeRootDescriptorTable);
+            m_writer.PutUInt(RootParameterIndex);
+            PutGpuDescriptor(BaseDescriptor);
+            m_real->SetComputeRootDescriptorTable(RootParameterIndex, BaseDescriptor);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT RootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE BaseDescriptor) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetGraphicsRootDescriptorTable);
+            m_writer.PutUInt(RootParameterIndex);
+            PutGpuDescriptor(BaseDescriptor);
+            m_real->SetGraphicsRootDescriptorTable(RootParameterIndex, BaseDescriptor);
+        }
+
+        // Single constants are stored as a run of one.
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override
+        {
+            PutRootConstants(CommandStreamOp::SetComputeRoot32BitConstants, RootParameterIndex, 1, &SrcData, DestOffsetIn32BitValues);
+            m_real->SetComputeRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT RootParameterIndex, UINT SrcData, UINT DestOffsetIn32BitValues) override
+        {
+            PutRootConstants(CommandStreamOp::SetGraphicsRoot32BitConstants, RootParameterIndex, 1, &SrcData, DestOffsetIn32BitValues);
+            m_real->SetGraphicsRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT RootParameterIndex, UINT Num32BitValuesToSet, const void* pSrcData, UINT DestOffsetIn32BitValues) override
+        {
+            PutRootConstants(CommandStreamOp::SetComputeRoot32BitConstants, RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+            m_real->SetComputeRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT RootParameterIndex, UINT Num32BitValuesToSet, const void* pSrcData, UINT DestOffsetIn32BitValues) override
+        {
+            PutRootConstants(CommandStreamOp::SetGraphicsRoot32BitConstants, RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+            m_real->SetGraphicsRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetComputeRootConstantBufferView, RootParameterIndex, BufferLocation);
+            m_real->SetComputeRootConstantBufferView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetGraphicsRootConstantBufferView, RootParameterIndex, BufferLocation);
+            m_real->SetGraphicsRootConstantBufferView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetComputeRootShaderResourceView, RootParameterIndex, BufferLocation);
+            m_real->SetComputeRootShaderResourceView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetGraphicsRootShaderResourceView, RootParameterIndex, BufferLocation);
+            m_real->SetGraphicsRootShaderResourceView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetComputeRootUnorderedAccessView, RootParameterIndex, BufferLocation);
+            m_real->SetComputeRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT RootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS BufferLocation) override
+        {
+            PutRootView(CommandStreamOp::SetGraphicsRootUnorderedAccessView, RootParameterIndex, BufferLocation);
+            m_real->SetGraphicsRootUnorderedAccessView(RootParameterIndex, BufferLocation);
+        }
+
+        void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* pView) override
+        {
+            m_writer.PutOp(CommandStreamOp::IASetIndexBuffer);
+            m_writer.PutUInt(pView ? 1 : 0);
+            if (pView)
+            {
+                PutGpuAddress(pView->BufferLocation);
+                m_writer.PutUInt(pView->SizeInBytes);
+                m_writer.PutUInt(pView->Format);
+            }
+            m_real->IASetIndexBuffer(pView);
+        }
+
+        // Unbinding (null views) is recorded as an empty set of views.
+        void STDMETHODCALLTYPE IASetVertexBuffers(UINT StartSlot, UINT NumViews, const D3D12_VERTEX_BUFFER_VIEW* pViews) override
+        {
+            m_writer.PutOp(CommandStreamOp::IASetVertexBuffers);
+            m_writer.PutUInt(StartSlot);
+            m_writer.PutUInt(pViews ? NumViews : 0);
+            for (UINT i = 0; pViews && i < NumViews; i++)
+            {
+                PutGpuAddress(pViews[i].BufferLocation);
+                m_writer.PutUInt(pViews[i].SizeInBytes);
+                m_writer.PutUInt(pViews[i].StrideInBytes);
+            }
+            m_real->IASetVertexBuffers(StartSlot, NumViews, pViews);
+        }
+
+        void STDMETHODCALLTYPE SOSetTargets(UINT StartSlot, UINT NumViews, const D3D12_STREAM_OUTPUT_BUFFER_VIEW* pViews) override
+        {
+            PutUnsupported(__FUNCTION__);
+            m_real->SOSetTargets(StartSlot, NumViews, pViews);
+        }
+
+        // A single handle to a descriptor range is stored as just that handle.
+        void STDMETHODCALLTYPE OMSetRenderTargets(UINT NumRenderTargetDescriptors, const D3D12_CPU_DESCRIPTOR_HANDLE* pRenderTargetDescriptors, BOOL RTsSingleHandleToDescriptorRange, const D3D12_CPU_DESCRIPTOR_HANDLE* pDepthStencilDescriptor) override
+        {
+            const UINT handleCount = !pRenderTargetDescriptors ? 0 : RTsSingleHandleToDescriptorRange ? (std::min)(NumRenderTargetDescriptors, 1u) : NumRenderTargetDescriptors;
+
+            m_writer.PutOp(CommandStreamOp::OMSetRenderTargets);
+            m_writer.PutUInt(NumRenderTargetDescriptors);
+            m_writer.PutUInt(RTsSingleHandleToDescriptorRange ? 1 : 0);
+            m_writer.PutUInt(handleCount);
+            for (UINT i = 0; i < handleCount; i++)
+            {
+                PutCpuDescriptor(pRenderTargetDescriptors[i]);
+            }
+            m_writer.PutUInt(pDepthStencilDescriptor ? 1 : 0);
+            if (pDepthStencilDescriptor)
+            {
+                PutCpuDescriptor(*pDepthStencilDescriptor);
+            }
+            m_real->OMSetRenderTargets(NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange, pDepthStencilDescriptor);
+        }
+
+        void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView, D3D12_CLEAR_FLAGS ClearFlags, FLOAT Depth, UINT8 Stencil, UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            m_writer.PutOp(CommandStreamOp::ClearDepthStencilView);
+            PutCpuDescriptor(DepthStencilView);
+            m_writer.PutUInt(ClearFlags);
+            m_writer.PutFloat(Depth);
+            m_writer.PutUInt(Stencil);
+            PutRects(NumRects, pRects);
+            m_real->ClearDepthStencilView(DepthStencilView, ClearFlags, Depth, Stencil, NumRects, pRects);
+        }
+
+        void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView, const FLOAT ColorRGBA[4], UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            m_writer.PutOp(CommandStreamOp::ClearRenderTargetView);
+            PutCpuDescriptor(RenderTargetView);
+            for (UINT i = 0; i < 4; i++)
+            {
+                m_writer.PutFloat(ColorRGBA[i]);
+            }
+            PutRects(NumRects, pRects);
+            m_real->ClearRenderTargetView(RenderTargetView, ColorRGBA, NumRects, pRects);
+        }
+
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap, D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle, ID3D12Resource* pResource, const UINT Values[4], UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            PutUnsupported(__FUNCTION__);
+            m_real->ClearUnorderedAccessViewUint(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values, NumRects, pRects);
+        }
+
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE ViewGPUHandleInCurrentHeap, D3D12_CPU_DESCRIPTOR_HANDLE ViewCPUHandle, ID3D12Resource* pResource, const FLOAT Values[4], UINT NumRects, const D3D12_RECT* pRects) override
+        {
+            PutUnsupported(__FUNCTION__);
+            m_real->ClearUnorderedAccessViewFloat(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResource, Values, NumRects, pRects);
+        }
+
+        void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* pResource, const D3D12_DISCARD_REGION* pRegion) override
+        {
+            m_writer.PutOp(CommandStreamOp::DiscardResource);
+            PutObject(pResource);
+            m_writer.PutUInt(pRegion ? 1 : 0);
+            if (pRegion)
+            {
+                PutRects(pRegion->NumRects, pRegion->pRects);
+                m_writer.PutUInt(pRegion->FirstSubresource);
+                m_writer.PutUInt(pRegion->NumSubresources);
+            }
+            m_real->DiscardResource(pResource, pRegion);
+        }
+
+        void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+        {
+            m_writer.PutOp(CommandStreamOp::BeginQuery);
+            PutObject(pQueryHeap);
+            m_writer.PutUInt(Type);
+            m_writer.PutUInt(Index);
+            m_real->BeginQuery(pQueryHeap, Type, Index);
+        }
+
+        void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT Index) override
+        {
+            m_writer.PutOp(CommandStreamOp::EndQuery);
+            PutObject(pQueryHeap);
+            m_writer.PutUInt(Type);
+            m_writer.PutUInt(Index);
+            m_real->EndQuery(pQueryHeap, Type, Index);
+        }
+
+        void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap* pQueryHeap, D3D12_QUERY_TYPE Type, UINT StartIndex, UINT NumQueries, ID3D12Resource* pDestinationBuffer, UINT64 AlignedDestinationBufferOffset) override
+        {
+            m_writer.PutOp(CommandStreamOp::ResolveQueryData);
+            PutObject(pQueryHeap);
+            m_writer.PutUInt(Type);
+            m_writer.PutUInt(StartIndex);
+            m_writer.PutUInt(NumQueries);
+            PutObject(pDestinationBuffer);
+            m_writer.PutUInt(AlignedDestinationBufferOffset);
+            m_real->ResolveQueryData(pQueryHeap, Type, StartIndex, NumQueries, pDestinationBuffer, AlignedDestinationBufferOffset);
+        }
+
+        void STDMETHODCALLTYPE SetPredication(ID3D12Resource* pBuffer, UINT64 AlignedBufferOffset, D3D12_PREDICATION_OP Operation) override
+        {
+            PutUnsupported(__FUNCTION__);
+            m_real->SetPredication(pBuffer, AlignedBufferOffset, Operation);
+        }
+
+        void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override
+        {
+            m_writer.PutOp(CommandStreamOp::SetMarker);
+            m_writer.PutUInt(Metadata);
+            m_writer.PutBytes(pData, Size);
+            m_real->SetMarker(Metadata, pData, Size);
+        }
+
+        void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override
+        {
+            m_writer.PutOp(CommandStreamOp::BeginEvent);
+            m_writer.PutUInt(Metadata);
+            m_writer.PutBytes(pData, Size);
+            m_real->BeginEvent(Metadata, pData, Size);
+        }
+
+        void STDMETHODCALLTYPE EndEvent() override
+        {
+            m_writer.PutOp(CommandStreamOp::EndEvent);
+            m_real->EndEvent();
+        }
+
+        void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature* pCommandSignature, UINT MaxCommandCount, ID3D12Resource* pArgumentBuffer, UINT64 ArgumentBufferOffset, ID3D12Resource* pCountBuffer, UINT64 CountBufferOffset) override
+        {
+            m_writer.PutOp(CommandStreamOp::ExecuteIndirect);
+            PutObject(pCommandSignature);
+            m_writer.PutUInt(MaxCommandCount);
+            PutObject(pArgumentBuffer);
+            m_writer.PutUInt(ArgumentBufferOffset);
+            PutObject(pCountBuffer);
+            m_writer.PutUInt(CountBufferOffset);
+            m_real->ExecuteIndirect(pCommandSignature, MaxCommandCount, pArgumentBuffer, ArgumentBufferOffset, pCountBuffer, CountBufferOffset);
+        }
+
+    private:
+        void PutObject(ID3D12Object* pObject)
+        {
+            m_writer.PutUInt(m_pObjects->GetIndex(pObject));
+        }
+
+        void PutGpuAddress(D3D12_GPU_VIRTUAL_ADDRESS address)
+        {
+            UINT index;
+            UINT64 offset;
+            m_pObjects->EncodeGpuAddress(address, &index, &offset);
+            m_writer.PutUInt(index);
+            m_writer.PutUInt(offset);
+        }
+
+        void PutCpuDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE handle)
+        {
+            UINT index;
+            UINT64 offset;
+            m_pObjects->EncodeCpuDescriptor(handle, &index, &offset);
+            m_writer.PutUInt(index);
+            m_writer.PutUInt(offset);
+        }
+
+        void PutGpuDescriptor(D3D12_GPU_DESCRIPTOR_HANDLE handle)
+        {
+            UINT index;
+            UINT64 offset;
+            m_pObjects->EncodeGpuDescriptor(handle, &index, &offset);
+            m_writer.PutUInt(index);
+            m_writer.PutUInt(offset);
+        }
+
+        void PutRects(UINT numRects, const D3D12_RECT* pRects)
+        {
+            m_writer.PutUInt(pRects ? numRects : 0);
+            for (UINT i = 0; pRects && i < numRects; i++)
+            {
+                m_writer.PutInt(pRects[i].left);
+                m_writer.PutInt(pRects[i].top);
+                m_writer.PutInt(pRects[i].right);
+                m_writer.PutInt(pRects[i].bottom);
+            }
+        }
+
+        // See the CopyTextureRegion field string: both location variants store
+        // every field.
+        void PutTextureCopyLocation(const D3D12_TEXTURE_COPY_LOCATION& location)
+        {
+            PutObject(location.pResource);
+            m_writer.PutUInt(location.Type);
+            if (location.Type == D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX)
+            {
+                m_writer.PutUInt(location.SubresourceIndex);
+                for (UINT i = 0; i < 6; i++)
+                {
+                    m_writer.PutUInt(0);
+                }
+            }
+            else
+            {
+                const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = location.PlacedFootprint;
+                m_writer.PutUInt(0);
+                m_writer.PutUInt(footprint.Offset);
+                m_writer.PutUInt(footprint.Footprint.Format);
+                m_writer.PutUInt(footprint.Footprint.Width);
+                m_writer.PutUInt(footprint.Footprint.Height);
+                m_writer.PutUInt(footprint.Footprint.Depth);
+                m_writer.PutUInt(footprint.Footprint.RowPitch);
+            }
+        }
+
+        void PutRootConstants(CommandStreamOp op, UINT rootParameterIndex, UINT count, const void* pData, UINT destOffset)
+        {
+            m_writer.PutOp(op);
+            m_writer.PutUInt(rootParameterIndex);
+            m_writer.PutUInt(destOffset);
+            m_writer.PutUInt(count);
+            for (UINT i = 0; i < count; i++)
+            {
+                m_writer.PutUInt(static_cast<const UINT*>(pData)[i]);
+            }
+        }
+
+        void PutRootView(CommandStreamOp op, UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+        {
+            m_writer.PutOp(op);
+            m_writer.PutUInt(rootParameterIndex);
+            PutGpuAddress(address);
+        }
+
+        void PutUnsupported(const char* pFunctionName)
+        {
+            m_writer.PutOp(CommandStreamOp::Unsupported);
+            m_writer.PutBytes(pFunctionName, strlen(pFunctionName));
+        }
+
+        CommandStreamWriter m_writer;
+    };
+
+    class CapturingCommandQueue : public CapturingDeviceChild<ChainInterfaces<ID3D12CommandQueue, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>, ID3D12CommandQueue>
+    {
+    public:
+        CapturingCommandQueue(ID3D12CommandQueue* pReal, CommandStreamCapture* pCapture) :
+            CapturingDeviceChild(pReal, pCapture)
+        {
+        }
+
+        // Tile mappings are not command list work and are not captured.
+        void STDMETHODCALLTYPE UpdateTileMappings(ID3D12Resource* pResource, UINT NumResourceRegions, const D3D12_TILED_RESOURCE_COORDINATE* pResourceRegionStartCoordinates, const D3D12_TILE_REGION_SIZE* pResourceRegionSizes, ID3D12Heap* pHeap, UINT NumRanges, const D3D12_TILE_RANGE_FLAGS* pRangeFlags, const UINT* pHeapRangeStartOffsets, const UINT* pRangeTileCounts, D3D12_TILE_MAPPING_FLAGS Flags) override
+        {
+            m_real->UpdateTileMappings(pResource, NumResourceRegions, pResourceRegionStartCoordinates, pResourceRegionSizes, pHeap, NumRanges, pRangeFlags, pHeapRangeStartOffsets, pRangeTileCounts, Flags);
+        }
+
+        void STDMETHODCALLTYPE CopyTileMappings(ID3D12Resource* pDstResource, const D3D12_TILED_RESOURCE_COORDINATE* pDstRegionStartCoordinate, ID3D12Resource* pSrcResource, const D3D12_TILED_RESOURCE_COORDINATE* pSrcRegionStartCoordinate, const D3D12_TILE_REGION_SIZE* pRegionSize, D3D12_TILE_MAPPING_FLAGS Flags) override
+        {
+            m_real->CopyTileMappings(pDstResource, pDstRegionStartCoordinate, pSrcResource, pSrcRegionStartCoordinate, pRegionSize, Flags);
+        }
+
+        void STDMETHODCALLTYPE ExecuteCommandLists(UINT NumCommandLists, ID3D12CommandList* const* ppCommandLists) override
+        {
+            m_pCapture->RecordExecuteCommandLists(NumCommandLists, ppCommandLists);
+
+            // The runtime only accepts its own command lists.
+            ID3D12CommandList* realCommandLists[64];
+            UINT submitted = 0;
+            while (submitted < NumCommandLists)
+            {
+                const UINT count = (std::min)(NumCommandLists - submitted, static_cast<UINT>(_countof(realCommandLists)));
+                for (UINT i = 0; i < count; i++)
+                {
+                    realCommandLists[i] = static_cast<CapturingCommandList*>(ppCommandLists[submitted + i])->GetReal();
+                }
+                m_real->ExecuteCommandLists(count, realCommandLists);
+                submitted += count;
+            }
+        }
+
+        void STDMETHODCALLTYPE SetMarker(UINT Metadata, const void* pData, UINT Size) override { m_real->SetMarker(Metadata, pData, Size); }
+        void STDMETHODCALLTYPE BeginEvent(UINT Metadata, const void* pData, UINT Size) override { m_real->BeginEvent(Metadata, pData, Size); }
+        void STDMETHODCALLTYPE EndEvent() override { m_real->EndEvent(); }
+
+        HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence* pFence, UINT64 Value) override
+        {
+            m_pCapture->RecordFenceOp(CommandStreamOp::Signal, pFence, Value);
+            return m_real->Signal(pFence, Value);
+        }
+
+        HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence* pFence, UINT64 Value) override
+        {
+            m_pCapture->RecordFenceOp(CommandStreamOp::Wait, pFence, Value);
+            return m_real->Wait(pFence, Value);
+        }
+
+        HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64* pFrequency) override { return m_real->GetTimestampFrequency(pFrequency); }
+        HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64* pGpuTimestamp, UINT64* pCpuTimestamp) override { return m_real->GetClockCalibration(pGpuTimestamp, pCpuTimestamp); }
+        D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override { return m_real->GetDesc(); }
+    };
+}
+
+CommandStreamCapture::CommandStreamCapture(CommandStreamObjects* pObjects) :
+    m_pObjects(pObjects)
+{
+}
+
+void CommandStreamCapture::Wrap(ComPtr<ID3D12GraphicsCommandList>& commandList)
+{
+    ComPtr<ID3D12GraphicsCommandList> wrapper = Make<CapturingCommandList>(commandList.Get(), this);
+    if (!wrapper)
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    commandList = wrapper;
+}
+
+void CommandStreamCapture::Wrap(ComPtr<ID3D12CommandQueue>& commandQueue)
+{
+    ComPtr<ID3D12CommandQueue> wrapper = Make<CapturingCommandQueue>(commandQueue.Get(), this);
+    if (!wrapper)
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    commandQueue = wrapper;
+}
+
+void CommandStreamCapture::RecordPresent(UINT backBufferIndex, UINT syncInterval, UINT flags)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stream.PutOp(CommandStreamOp::Present);
+    m_stream.PutUInt(backBufferIndex);
+    m_stream.PutUInt(syncInterval);
+    m_stream.PutUInt(flags);
+}
+
+void CommandStreamCapture::RecordExecuteCommandLists(UINT numCommandLists, ID3D12CommandList* const* ppCommandLists)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stream.PutOp(CommandStreamOp::ExecuteCommandLists);
+    m_stream.PutUInt(numCommandLists);
+    for (UINT i = 0; i < numCommandLists; i++)
+    {
+        const std::vector<UINT8>& body = static_cast<CapturingCommandList*>(ppCommandLists[i])->GetBody();
+        m_stream.PutBytes(body.data(), body.size());
+    }
+}
+
+void CommandStreamCapture::RecordFenceOp(CommandStreamOp op, ID3D12Fence* pFence, UINT64 value)
+{
+    const UINT fenceIndex = m_pObjects->GetIndex(pFence);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stream.PutOp(op);
+    m_stream.PutUInt(fenceIndex);
+    m_stream.PutUInt(value);
+}
@@ -0,0 +1,48 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "CommandStream.h"
+
+// Records everything submitted to a queue into a command stream.
+//
+// Command lists and queues are replaced in place by wrappers that forward every
+// call to the real object and encode it on the way through. Each command list
+// encodes into its own buffer, so lists can be recorded on any thread without
+// contention; ExecuteCommandLists copies the bodies of the submitted lists into
+// the queue's stream. Every list submitted to a wrapped queue, and no bundle
+// passed to ExecuteBundle, must be wrapped.
+class CommandStreamCapture
+{
+public:
+    explicit CommandStreamCapture(CommandStreamObjects* pObjects);
+
+    void Wrap(ComPtr<ID3D12GraphicsCommandList>& commandList);
+    void Wrap(ComPtr<ID3D12CommandQueue>& commandQueue);
+
+    // Presents go through the swap chain rather than the queue; call this after each
+    // with the index of the back buffer the frame rendered to.
+    void RecordPresent(UINT backBufferIndex, UINT syncInterval, UINT flags);
+
+    size_t GetSize() const                  { return m_stream.GetData().size(); }
+    void Save(LPCWSTR filename) const       { SaveCommandStream(filename, m_stream.GetData()); }
+
+    // Used by the wrappers.
+    CommandStreamObjects* GetObjects() const { return m_pObjects; }
+    void RecordExecuteCommandLists(UINT numCommandLists, ID3D12CommandList* const* ppCommandLists);
+    void RecordFenceOp(CommandStreamOp op, ID3D12Fence* pFence, UINT64 value);
+
+private:
+    CommandStreamObjects* m_pObjects;
+    std::mutex m_mutex;
+    CommandStreamWriter m_stream;
+};
@@ -0,0 +1,623 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "CommandStreamReplayer.h"
+
+CommandStreamReplayer::CommandStreamReplayer(ID3D12Device* pDevice, CommandStreamObjects* pObjects, CommandAllocatorPool* pAllocatorPool, std::vector<UINT8> stream) :
+    m_device(pDevice),
+    m_pObjects(pObjects),
+    m_pAllocatorPool(pAllocatorPool),
+    m_stream(std::move(stream)),
+    m_position(SIZE_MAX),
+    m_frameCount(0)
+{
+}
+
+void CommandStreamReplayer::ReplayFrame(ID3D12CommandQueue* pQueue, UINT backBufferIndex)
+{
+    // Lists are recorded one after another, so they can all share one allocator.
+    ID3D12CommandAllocator* pAllocator = m_pAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+    bool restarted = false;
+    for (;;)
+    {
+        if (m_position == SIZE_MAX || m_position == m_stream.size())
+        {
+            // A stream without a single Present would loop forever.
+            if (restarted || m_stream.empty())
+            {
+                return;
+            }
+            m_position = FindFrame(backBufferIndex);
+            restarted = true;
+        }
+
+        CommandStreamReader reader(m_stream.data() + m_position, m_stream.size() - m_position);
+        const CommandStreamOp op = reader.GetOp();
+        switch (op)
+        {
+        case CommandStreamOp::ExecuteCommandLists:
+        {
+            const UINT count = reader.GetUInt32();
+            m_submission.clear();
+            for (UINT i = 0; i < count; i++)
+            {
+                size_t size;
+                const UINT8* pBody = reader.GetBytes(&size);
+                ID3D12GraphicsCommandList* pCommandList = GetCommandList(i);
+                ReplayCommandList(pCommandList, pAllocator, pBody, size);
+                m_submission.push_back(pCommandList);
+            }
+            pQueue->ExecuteCommandLists(count, m_submission.data());
+            break;
+        }
+
+        case CommandStreamOp::Signal:
+        case CommandStreamOp::Wait:
+            reader.GetUInt();
+            reader.GetUInt();
+            break;
+
+        case CommandStreamOp::Present:
+            reader.GetUInt();
+            reader.GetUInt();
+            reader.GetUInt();
+            m_position = reader.GetPosition() - m_stream.data();
+            m_frameCount++;
+            return;
+
+        default:
+            throw HrException(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+        m_position = reader.GetPosition() - m_stream.data();
+    }
+}
+
+// Returns the offset of the first frame whose Present names the given back
+// buffer, or of the first frame if none does.
+size_t CommandStreamReplayer::FindFrame(UINT backBufferIndex) const
+{
+    CommandStreamReader reader(m_stream.data(), m_stream.size());
+    size_t frameStart = 0;
+    while (!reader.IsAtEnd())
+    {
+        switch (reader.GetOp())
+        {
+        case CommandStreamOp::ExecuteCommandLists:
+        {
+            const UINT count = reader.GetUInt32();
+            for (UINT i = 0; i < count; i++)
+            {
+                size_t size;
+                reader.GetBytes(&size);
+            }
+            break;
+        }
+
+        case CommandStreamOp::Signal:
+        case CommandStreamOp::Wait:
+            reader.GetUInt();
+            reader.GetUInt();
+            break;
+
+        case CommandStreamOp::Present:
+            if (reader.GetUInt32() == backBufferIndex)
+            {
+                return frameStart;
+            }
+            reader.GetUInt();
+            reader.GetUInt();
+            frameStart = reader.GetPosition() - m_stream.data();
+            break;
+
+        default:
+            throw HrException(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+    }
+    return 0;
+}
+
+// Replay lists are created on first use and reused by position in the submission.
+ID3D12GraphicsCommandList* CommandStreamReplayer::GetCommandList(UINT index)
+{
+    while (m_commandLists.size() <= index)
+    {
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        ID3D12CommandAllocator* pAllocator = m_pAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, pAllocator, nullptr, IID_PPV_ARGS(&commandList)));
+        ThrowIfFailed(commandList->Close());
+        SetNameIndexed(commandList.Get(), L"ReplayCommandList", static_cast<UINT>(m_commandLists.size()));
+        m_commandLists.push_back(commandList);
+    }
+    return m_commandLists[index].Get();
+}
+
+void CommandStreamReplayer::ReplayCommandList(ID3D12GraphicsCommandList* pCommandList, ID3D12CommandAllocator* pAllocator, const UINT8* pBody, size_t size)
+{
+    CommandStreamReader reader(pBody, size);
+    if (reader.GetOp() != CommandStreamOp::Reset)
+    {
+        throw HrException(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+    }
+    ThrowIfFailed(pCommandList->Reset(pAllocator, ReadObject<ID3D12PipelineState>(reader)));
+
+    while (!reader.IsAtEnd())
+    {
+        const CommandStreamOp op = reader.GetOp();
+        switch (op)
+        {
+        case CommandStreamOp::ClearState:
+            pCommandList->ClearState(ReadObject<ID3D12PipelineState>(reader));
+            break;
+
+        case CommandStreamOp::DrawInstanced:
+        {
+            const UINT vertexCount = reader.GetUInt32();
+            const UINT instanceCount = reader.GetUInt32();
+            const UINT startVertex = reader.GetUInt32();
+            const UINT startInstance = reader.GetUInt32();
+            pCommandList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+            break;
+        }
+
+        case CommandStreamOp::DrawIndexedInstanced:
+        {
+            const UINT indexCount = reader.GetUInt32();
+            const UINT instanceCount = reader.GetUInt32();
+            const UINT startIndex = reader.GetUInt32();
+            const INT baseVertex = static_cast<INT>(reader.GetInt());
+            const UINT startInstance = reader.GetUInt32();
+            pCommandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+            break;
+        }
+
+        case CommandStreamOp::Dispatch:
+        {
+            const UINT x = reader.GetUInt32();
+            const UINT y = reader.GetUInt32();
+            const UINT z = reader.GetUInt32();
+            pCommandList->Dispatch(x, y, z);
+            break;
+        }
+
+        case CommandStreamOp::CopyBufferRegion:
+        {
+            ID3D12Resource* pDst = ReadObject<ID3D12Resource>(reader);
+            const UINT64 dstOffset = reader.GetUInt();
+            ID3D12Resource* pSrc = ReadObject<ID3D12Resource>(reader);
+            const UINT64 srcOffset = reader.GetUInt();
+            const UINT64 numBytes = reader.GetUInt();
+            pCommandList->CopyBufferRegion(pDst, dstOffset, pSrc, srcOffset, numBytes);
+            break;
+        }
+
+        case CommandStreamOp::CopyTextureRegion:
+        {
+            const D3D12_TEXTURE_COPY_LOCATION dst = ReadTextureCopyLocation(reader);
+            const UINT x = reader.GetUInt32();
+            const UINT y = reader.GetUInt32();
+            const UINT z = reader.GetUInt32();
+            const D3D12_TEXTURE_COPY_LOCATION src = ReadTextureCopyLocation(reader);
+            D3D12_BOX box = {};
+            const bool hasBox = reader.GetUInt() != 0;
+            if (hasBox)
+            {
+                box.left = reader.GetUInt32();
+                box.top = reader.GetUInt32();
+                box.front = reader.GetUInt32();
+                box.right = reader.GetUInt32();
+                box.bottom = reader.GetUInt32();
+                box.back = reader.GetUInt32();
+            }
+            pCommandList->CopyTextureRegion(&dst, x, y, z, &src, hasBox ? &box : nullptr);
+            break;
+        }
+
+        case CommandStreamOp::CopyResource:
+        {
+            ID3D12Resource* pDst = ReadObject<ID3D12Resource>(reader);
+            ID3D12Resource* pSrc = ReadObject<ID3D12Resource>(reader);
+            pCommandList->CopyResource(pDst, pSrc);
+            break;
+        }
+
+        case CommandStreamOp::ResolveSubresource:
+        {
+            ID3D12Resource* pDst = ReadObject<ID3D12Resource>(reader);
+            const UINT dstSubresource = reader.GetUInt32();
+            ID3D12Resource* pSrc = ReadObject<ID3D12Resource>(reader);
+            const UINT srcSubresource = reader.GetUInt32();
+            const DXGI_FORMAT format = static_cast<DXGI_FORMAT>(reader.GetUInt());
+            pCommandList->ResolveSubresource(pDst, dstSubresource, pSrc, srcSubresource, format);
+            break;
+        }
+
+        case CommandStreamOp::IASetPrimitiveTopology:
+            pCommandList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(reader.GetUInt()));
+            break;
+
+        case CommandStreamOp::RSSetViewports:
+        {
+            m_viewports.resize(reader.GetUInt32());
+            for (D3D12_VIEWPORT& viewport : m_viewports)
+            {
+                viewport.TopLeftX = reader.GetFloat();
+                viewport.TopLeftY = reader.GetFloat();
+                viewport.Width = reader.GetFloat();
+                viewport.Height = reader.GetFloat();
+                viewport.MinDepth = reader.GetFloat();
+                viewport.MaxDepth = reader.GetFloat();
+            }
+            pCommandList->RSSetViewports(static_cast<UINT>(m_viewports.size()), m_viewports.data());
+            break;
+        }
+
+        case CommandStreamOp::RSSetScissorRects:
+        {
+            UINT count;
+            const D3D12_RECT* pRects = ReadRects(reader, &count);
+            pCommandList->RSSetScissorRects(count, pRects);
+            break;
+        }
+
+        case CommandStreamOp::OMSetBlendFactor:
+        {
+            FLOAT blendFactor[4];
+            for (FLOAT& value : blendFactor)
+            {
+                value = reader.GetFloat();
+            }
+            pCommandList->OMSetBlendFactor(blendFactor);
+            break;
+        }
+
+        case CommandStreamOp::OMSetStencilRef:
+            pCommandList->OMSetStencilRef(reader.GetUInt32());
+            break;
+
+        case CommandStreamOp::SetPipelineState:
+            pCommandList->SetPipelineState(ReadObject<ID3D12PipelineState>(reader));
+            break;
+
+        case CommandStreamOp::ResourceBarrier:
+        {
+            m_barriers.resize(reader.GetUInt32());
+            for (D3D12_RESOURCE_BARRIER& barrier : m_barriers)
+            {
+                barrier.Type = static_cast<D3D12_RESOURCE_BARRIER_TYPE>(reader.GetUInt());
+                barrier.Flags = static_cast<D3D12_RESOURCE_BARRIER_FLAGS>(reader.GetUInt());
+                ID3D12Resource* pFirst = ReadObject<ID3D12Resource>(reader);
+                ID3D12Resource* pSecond = ReadObject<ID3D12Resource>(reader);
+                const UINT subresource = reader.GetUInt32();
+                const D3D12_RESOURCE_STATES before = static_cast<D3D12_RESOURCE_STATES>(reader.GetUInt());
+                const D3D12_RESOURCE_STATES after = static_cast<D3D12_RESOURCE_STATES>(reader.GetUInt());
+                switch (barrier.Type)
+                {
+                case D3D12_RESOURCE_BARRIER_TYPE_TRANSITION:
+                    barrier.Transition = { pFirst, subresource, before, after };
+                    break;
+
+                case D3D12_RESOURCE_BARRIER_TYPE_ALIASING:
+                    barrier.Aliasing = { pFirst, pSecond };
+                    break;
+
+                default:
+                    barrier.UAV = { pFirst };
+                    break;
+                }
+            }
+            pCommandList->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+            break;
+        }
+
+        case CommandStreamOp::ExecuteBundle:
+            pCommandList->ExecuteBundle(ReadObject<ID3D12GraphicsCommandList>(reader));
+            break;
+
+        case CommandStreamOp::SetDescriptorHeaps:
+        {
+            m_descriptorHeaps.resize(reader.GetUInt32());
+            for (ID3D12DescriptorHeap*& pHeap : m_descriptorHeaps)
+            {
+                pHeap = ReadObject<ID3D12DescriptorHeap>(reader);
+            }
+            pCommandList->SetDescriptorHeaps(static_cast<UINT>(m_descriptorHeaps.size()), m_descriptorHeaps.data());
+            break;
+        }
+
+        case CommandStreamOp::SetComputeRootSignature:
+            pCommandList->SetComputeRootSignature(ReadObject<ID3D12RootSignature>(reader));
+            break;
+
+        case CommandStreamOp::SetGraphicsRootSignature:
+            pCommandList->SetGraphicsRootSignature(ReadObject<ID3D12RootSignature>(reader));
+            break;
+
+        case CommandStreamOp::SetComputeRootDescriptorTable:
+        case CommandStreamOp::SetGraphicsRootDescriptorTable:
+        {
+            const UINT rootParameterIndex = reader.GetUInt32();
+            const D3D12_GPU_DESCRIPTOR_HANDLE handle = ReadGpuDescriptor(reader);
+            if (op == CommandStreamOp::SetComputeRootDescriptorTable)
+            {
+                pCommandList->SetComputeRootDescriptorTable(rootParameterIndex, handle);
+            }
+            else
+            {
+                pCommandList->SetGraphicsRootDescriptorTable(rootParameterIndex, handle);
+            }
+            break;
+        }
+
+        case CommandStreamOp::SetComputeRoot32BitConstants:
+        case CommandStreamOp::SetGraphicsRoot32BitConstants:
+        {
+            const UINT rootParameterIndex = reader.GetUInt32();
+            const UINT destOffset = reader.GetUInt32();
+            m_constants.resize(reader.GetUInt32());
+            for (UINT& value : m_constants)
+            {
+                value = reader.GetUInt32();
+            }
+            if (op == CommandStreamOp::SetComputeRoot32BitConstants)
+            {
+                pCommandList->SetComputeRoot32BitConstants(rootParameterIndex, static_cast<UINT>(m_constants.size()), m_constants.data(), destOffset);
+            }
+            else
+            {
+                pCommandList->SetGraphicsRoot32BitConstants(rootParameterIndex, static_cast<UINT>(m_constants.size()), m_constants.data(), destOffset);
+            }
+            break;
+        }
+
+        case CommandStreamOp::SetComputeRootConstantBufferView:
+        case CommandStreamOp::SetGraphicsRootConstantBufferView:
+        case CommandStreamOp::SetComputeRootShaderResourceView:
+        case CommandStreamOp::SetGraphicsRootShaderResourceView:
+        case CommandStreamOp::SetComputeRootUnorderedAccessView:
+        case CommandStreamOp::SetGraphicsRootUnorderedAccessView:
+        {
+            const UINT rootParameterIndex = reader.GetUInt32();
+            const D3D12_GPU_VIRTUAL_ADDRESS address = ReadGpuAddress(reader);
+            switch (op)
+            {
+            case CommandStreamOp::SetComputeRootConstantBufferView:     pCommandList->SetComputeRootConstantBufferView(rootParameterIndex, address); break;
+            case CommandStreamOp::SetGraphicsRootConstantBufferView:    pCommandList->SetGraphicsRootConstantBufferView(rootParameterIndex, address); break;
+            case CommandStreamOp::SetComputeRootShaderResourceView:     pCommandList->SetComputeRootShaderResourceView(rootParameterIndex, address); break;
+            case CommandStreamOp::SetGraphicsRootShaderResourceView:    pCommandList->SetGraphicsRootShaderResourceView(rootParameterIndex, address); break;
+            case CommandStreamOp::SetComputeRootUnorderedAccessView:    pCommandList->SetComputeRootUnorderedAccessView(rootParameterIndex, address); break;
+            default:                                                    pCommandList->SetGraphicsRootUnorderedAccessView(rootParameterIndex, address); break;
+            }
+            break;
+        }
+
+        case CommandStreamOp::IASetIndexBuffer:
+        {
+            D3D12_INDEX_BUFFER_VIEW view = {};
+            const bool hasView = reader.GetUInt() != 0;
+            if (hasView)
+            {
+                view.BufferLocation = ReadGpuAddress(reader);
+                view.SizeInBytes = reader.GetUInt32();
+                view.Format = static_cast<DXGI_FORMAT>(reader.GetUInt());
+            }
+            pCommandList->IASetIndexBuffer(hasView ? &view : nullptr);
+            break;
+        }
+
+        case CommandStreamOp::IASetVertexBuffers:
+        {
+            const UINT startSlot = reader.GetUInt32();
+            m_vertexBufferViews.resize(reader.GetUInt32());
+            for (D3D12_VERTEX_BUFFER_VIEW& view : m_vertexBufferViews)
+            {
+                view.BufferLocation = ReadGpuAddress(reader);
+                view.SizeInBytes = reader.GetUInt32();
+                view.StrideInBytes = reader.GetUInt32();
+            }
+            pCommandList->IASetVertexBuffers(startSlot, static_cast<UINT>(m_vertexBufferViews.size()), m_vertexBufferViews.empty() ? nullptr : m_vertexBufferViews.data());
+            break;
+        }
+
+        case CommandStreamOp::OMSetRenderTargets:
+        {
+            const UINT numRenderTargets = reader.GetUInt32();
+            const BOOL singleHandle = reader.GetUInt() != 0;
+            m_renderTargetDescriptors.resize(reader.GetUInt32());
+            for (D3D12_CPU_DESCRIPTOR_HANDLE& handle : m_renderTargetDescriptors)
+            {
+                handle = ReadCpuDescriptor(reader);
+            }
+            D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = {};
+            const bool hasDepthStencil = reader.GetUInt() != 0;
+            if (hasDepthStencil)
+            {
+                depthStencil = ReadCpuDescriptor(reader);
+            }
+            pCommandList->OMSetRenderTargets(
+                numRenderTargets,
+                m_renderTargetDescriptors.empty() ? nullptr : m_renderTargetDescriptors.data(),
+                singleHandle,
+                hasDepthStencil ? &depthStencil : nullptr);
+            break;
+        }
+
+        case CommandStreamOp::ClearDepthStencilView:
+        {
+            const D3D12_CPU_DESCRIPTOR_HANDLE handle = ReadCpuDescriptor(reader);
+            const D3D12_CLEAR_FLAGS flags = static_cast<D3D12_CLEAR_FLAGS>(reader.GetUInt());
+            const FLOAT depth = reader.GetFloat();
+            const UINT8 stencil = static_cast<UINT8>(reader.GetUInt());
+            UINT rectCount;
+            const D3D12_RECT* pRects = ReadRects(reader, &rectCount);
+            pCommandList->ClearDepthStencilView(handle, flags, depth, stencil, rectCount, pRects);
+            break;
+        }
+
+        case CommandStreamOp::ClearRenderTargetView:
+        {
+            const D3D12_CPU_DESCRIPTOR_HANDLE handle = ReadCpuDescriptor(reader);
+            FLOAT color[4];
+            for (FLOAT& value : color)
+            {
+                value = reader.GetFloat();
+            }
+            UINT rectCount;
+            const D3D12_RECT* pRects = ReadRects(reader, &rectCount);
+            pCommandList->ClearRenderTargetView(handle, color, rectCount, pRects);
+            break;
+        }
+
+        case CommandStreamOp::DiscardResource:
+        {
+            ID3D12Resource* pResource = ReadObject<ID3D12Resource>(reader);
+            D3D12_DISCARD_REGION region = {};
+            const bool hasRegion = reader.GetUInt() != 0;
+            if (hasRegion)
+            {
+                region.pRects = ReadRects(reader, &region.NumRects);
+                region.FirstSubresource = reader.GetUInt32();
+                region.NumSubresources = reader.GetUInt32();
+            }
+            pCommandList->DiscardResource(pResource, hasRegion ? &region : nullptr);
+            break;
+        }
+
+        case CommandStreamOp::BeginQuery:
+        case CommandStreamOp::EndQuery:
+        {
+            ID3D12QueryHeap* pQueryHeap = ReadObject<ID3D12QueryHeap>(reader);
+            const D3D12_QUERY_TYPE type = static_cast<D3D12_QUERY_TYPE>(reader.GetUInt());
+            const UINT index = reader.GetUInt32();
+            if (op == CommandStreamOp::BeginQuery)
+            {
+                pCommandList->BeginQuery(pQueryHeap, type, index);
+            }
+            else
+            {
+                pCommandList->EndQuery(pQueryHeap, type, index);
+            }
+            break;
+        }
+
+        case CommandStreamOp::ResolveQueryData:
+        {
+            ID3D12QueryHeap* pQueryHeap = ReadObject<ID3D12QueryHeap>(reader);
+            const D3D12_QUERY_TYPE type = static_cast<D3D12_QUERY_TYPE>(reader.GetUInt());
+            const UINT startIndex = reader.GetUInt32();
+            const UINT numQueries = reader.GetUInt32();
+            ID3D12Resource* pDestination = ReadObject<ID3D12Resource>(reader);
+            const UINT64 offset = reader.GetUInt();
+            pCommandList->ResolveQueryData(pQueryHeap, type, startIndex, numQueries, pDestination, offset);
+            break;
+        }
+
+        case CommandStreamOp::SetMarker:
+        case CommandStreamOp::BeginEvent:
+        {
+            const UINT metadata = reader.GetUInt32();
+            size_t size;
+            const UINT8* pData = reader.GetBytes(&size);
+            if (op == CommandStreamOp::SetMarker)
+            {
+                pCommandList->SetMarker(metadata, pData, static_cast<UINT>(size));
+            }
+            else
+            {
+                pCommandList->BeginEvent(metadata, pData, static_cast<UINT>(size));
+            }
+            break;
+        }
+
+        case CommandStreamOp::EndEvent:
+            pCommandList->EndEvent();
+            break;
+
+        case CommandStreamOp::ExecuteIndirect:
+        {
+            ID3D12CommandSignature* pSignature = ReadObject<ID3D12CommandSignature>(reader);
+            const UINT maxCommandCount = reader.GetUInt32();
+            ID3D12Resource* pArgumentBuffer = ReadObject<ID3D12Resource>(reader);
+            const UINT64 argumentOffset = reader.GetUInt();
+            ID3D12Resource* pCountBuffer = ReadObject<ID3D12Resource>(reader);
+            const UINT64 countOffset = reader.GetUInt();
+            pCommandList->ExecuteIndirect(pSignature, maxCommandCount, pArgumentBuffer, argumentOffset, pCountBuffer, countOffset);
+            break;
+        }
+
+        default:
+            // Unsupported calls, or a queue packet inside a list: the stream
+            // cannot be reproduced faithfully.
+            throw HrException(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+    }
+
+    ThrowIfFailed(pCommandList->Close());
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS CommandStreamReplayer::ReadGpuAddress(CommandStreamReader& reader)
+{
+    const UINT index = reader.GetUInt32();
+    return m_pObjects->DecodeGpuAddress(index, reader.GetUInt());
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE CommandStreamReplayer::ReadCpuDescriptor(CommandStreamReader& reader)
+{
+    const UINT index = reader.GetUInt32();
+    return m_pObjects->DecodeCpuDescriptor(index, reader.GetUInt());
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE CommandStreamReplayer::ReadGpuDescriptor(CommandStreamReader& reader)
+{
+    const UINT index = reader.GetUInt32();
+    return m_pObjects->DecodeGpuDescriptor(index, reader.GetUInt());
+}
+
+D3D12_TEXTURE_COPY_LOCATION CommandStreamReplayer::ReadTextureCopyLocation(CommandStreamReader& reader)
+{
+    D3D12_TEXTURE_COPY_LOCATION location = {};
+    location.pResource = ReadObject<ID3D12Resource>(reader);
+    location.Type = static_cast<D3D12_TEXTURE_COPY_TYPE>(reader.GetUInt());
+    const UINT subresource = reader.GetUInt32();
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    footprint.Offset = reader.GetUInt();
+    footprint.Footprint.Format = static_cast<DXGI_FORMAT>(reader.GetUInt());
+    footprint.Footprint.Width = reader.GetUInt32();
+    footprint.Footprint.Height = reader.GetUInt32();
+    footprint.Footprint.Depth = reader.GetUInt32();
+    footprint.Footprint.RowPitch = reader.GetUInt32();
+
+    if (location.Type == D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX)
+    {
+        location.SubresourceIndex = subresource;
+    }
+    else
+    {
+        location.PlacedFootprint = footprint;
+    }
+    return location;
+}
+
+const D3D12_RECT* CommandStreamReplayer::ReadRects(CommandStreamReader& reader, UINT* pCount)
+{
+    m_rects.resize(reader.GetUInt32());
+    for (D3D12_RECT& rect : m_rects)
+    {
+        rect.left = static_cast<LONG>(reader.GetInt());
+        rect.top = static_cast<LONG>(reader.GetInt());
+        rect.right = static_cast<LONG>(reader.GetInt());
+        rect.bottom = static_cast<LONG>(reader.GetInt());
+    }
+    *pCount = static_cast<UINT>(m_rects.size());
+    return m_rects.empty() ? nullptr : m_rects.data();
+}
@@ -0,0 +1,71 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "CommandStream.h"
+#include "CommandAllocatorPool.h"
+
+// Re-issues a captured command stream, one frame at a time, with nothing but the
+// recorded work on the CPU: no application logic and no recording callbacks.
+// Objects are looked up by index, so the objects the stream refers to must have
+// been registered in the same order as when it was captured.
+//
+// Fence signals and waits are not replayed; the caller fences each frame as it
+// normally would, and presents once ReplayFrame returns.
+class CommandStreamReplayer
+{
+public:
+    CommandStreamReplayer(ID3D12Device* pDevice, CommandStreamObjects* pObjects, CommandAllocatorPool* pAllocatorPool, std::vector<UINT8> stream);
+
+    // Submits the packets up to and including the next Present. Starts over
+    // once the end of the stream is reached, at the first frame that rendered
+    // to the given back buffer, since the captured lists hard-code their render
+    // target and the swap chain need not be where it was when capture started.
+    void ReplayFrame(ID3D12CommandQueue* pQueue, UINT backBufferIndex);
+
+    UINT64 GetFrameCount() const    { return m_frameCount; }
+
+private:
+    size_t FindFrame(UINT backBufferIndex) const;
+    ID3D12GraphicsCommandList* GetCommandList(UINT index);
+    void ReplayCommandList(ID3D12GraphicsCommandList* pCommandList, ID3D12CommandAllocator* pAllocator, const UINT8* pBody, size_t size);
+
+    template<class T>
+    T* ReadObject(CommandStreamReader& reader)
+    {
+        const UINT index = reader.GetUInt32();
+        return index ? m_pObjects->Resolve<T>(index) : nullptr;
+    }
+    D3D12_GPU_VIRTUAL_ADDRESS ReadGpuAddress(CommandStreamReader& reader);
+    D3D12_CPU_DESCRIPTOR_HANDLE ReadCpuDescriptor(CommandStreamReader& reader);
+    D3D12_GPU_DESCRIPTOR_HANDLE ReadGpuDescriptor(CommandStreamReader& reader);
+    D3D12_TEXTURE_COPY_LOCATION ReadTextureCopyLocation(CommandStreamReader& reader);
+    const D3D12_RECT* ReadRects(CommandStreamReader& reader, UINT* pCount);
+
+    ComPtr<ID3D12Device> m_device;
+    CommandStreamObjects* m_pObjects;
+    CommandAllocatorPool* m_pAllocatorPool;
+    std::vector<UINT8> m_stream;
+    size_t m_position;      // SIZE_MAX until the first frame is found.
+    UINT64 m_frameCount;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_commandLists;
+
+    // Scratch space for decoded arrays, kept to avoid allocating per call.
+    std::vector<ID3D12CommandList*> m_submission;
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+    std::vector<D3D12_VIEWPORT> m_viewports;
+    std::vector<D3D12_RECT> m_rects;
+    std::vector<D3D12_VERTEX_BUFFER_VIEW> m_vertexBufferViews;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_renderTargetDescriptors;
+    std::vector<ID3D12DescriptorHeap*> m_descriptorHeaps;
+    std::vector<UINT> m_constants;
+};
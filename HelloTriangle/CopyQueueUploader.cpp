@@ -0,0 +1,119 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "CopyQueueUploader.h"
+
+CopyQueueUploader::CopyQueueUploader(ID3D12Device* pDevice, PlacedResourceAllocator* pAllocator) :
+    m_device(pDevice),
+    m_pAllocator(pAllocator),
+    m_recording(false)
+{
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    ThrowIfFailed(pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue)));
+    NAME_D3D12_OBJECT(m_queue);
+
+    m_timeline = std::make_unique<FenceTimeline>(pDevice, m_queue.Get());
+    m_allocatorPool = std::make_unique<CommandAllocatorPool>(pDevice, m_timeline.get());
+    m_stagingReleases = std::make_unique<DeferredReleaseQueue>(m_timeline.get());
+
+    // Command lists are created in the recording state; the first upload resets it.
+    ThrowIfFailed(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_allocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_COPY), nullptr, IID_PPV_ARGS(&m_commandList)));
+    NAME_D3D12_OBJECT(m_commandList);
+    ThrowIfFailed(m_commandList->Close());
+}
+
+CopyQueueUploader::~CopyQueueUploader()
+{
+    // The staging buffers and allocators must outlive the copies reading them.
+    Flush();
+    m_timeline->WaitForIdle();
+    m_stagingReleases->Flush();
+}
+
+_Use_decl_annotations_
+void* CopyQueueUploader::CreateBuffer(UINT64 size, ComPtr<ID3D12Resource>* pBuffer, UINT64* pUploadValue)
+{
+    if (m_pAllocator)
+    {
+        m_pAllocator->CreateResource(CD3DX12_RESOURCE_DESC::Buffer(size), D3D12_RESOURCE_STATE_COMMON, nullptr, pBuffer);
+    }
+    else
+    {
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(size),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(pBuffer->ReleaseAndGetAddressOf())));
+    }
+
+    ComPtr<ID3D12Resource> stagingBuffer;
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&stagingBuffer)));
+    NAME_D3D12_OBJECT(stagingBuffer);
+
+    // The staging buffer stays mapped until it is released.
+    void* pData;
+    CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+    ThrowIfFailed(stagingBuffer->Map(0, &readRange, &pData));
+
+    if (!m_recording)
+    {
+        ThrowIfFailed(m_commandList->Reset(m_allocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_COPY), nullptr));
+        m_recording = true;
+    }
+    m_commandList->CopyBufferRegion(pBuffer->Get(), 0, stagingBuffer.Get(), 0, size);
+
+    // The copy is part of the next batch, which completes at the next value.
+    *pUploadValue = m_timeline->GetNextValue();
+    m_stagingReleases->Release(stagingBuffer.Detach());
+    return pData;
+}
+
+UINT64 CopyQueueUploader::CreateBuffer(const void* pData, UINT64 size, ComPtr<ID3D12Resource>* pBuffer)
+{
+    UINT64 uploadValue;
+    memcpy(CreateBuffer(size, pBuffer, &uploadValue), pData, static_cast<size_t>(size));
+    return uploadValue;
+}
+
+void CopyQueueUploader::Flush()
+{
+    if (m_recording)
+    {
+        ThrowIfFailed(m_commandList->Close());
+        ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
+        m_queue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+        m_allocatorPool->EndFrame(m_timeline->Signal());
+        m_recording = false;
+    }
+
+    m_stagingReleases->Collect();
+}
+
+void CopyQueueUploader::QueueWait(ID3D12CommandQueue* pQueue, UINT64 uploadValue)
+{
+    if (uploadValue > m_timeline->GetLastSignaledValue())
+    {
+        Flush();
+    }
+    m_timeline->QueueWait(pQueue, uploadValue);
+}
@@ -0,0 +1,65 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <memory>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+#include "CommandAllocatorPool.h"
+#include "PlacedResourceAllocator.h"
+
+// Puts static data into DEFAULT-heap buffers, which the GPU reads from its own
+// memory instead of across the bus. The data is staged in upload memory and
+// copied on a dedicated copy queue, so bulk uploads overlap rendering.
+//
+// Every upload returns a value of the copy queue's fence timeline; once it has
+// completed, the buffer holds its data. A queue that draws from the buffer
+// waits for that value on the GPU with QueueWait(), and only for the uploads it
+// actually uses. New buffers start in the COMMON state, which the copy queue
+// promotes to COPY_DEST and the consuming queue to whatever read state it uses.
+//
+// Uploads are batched until Flush(); QueueWait() flushes whatever it waits on.
+// With an allocator, the buffers are placed in its heaps and go back to it with
+// its Release(). Not thread safe.
+class CopyQueueUploader
+{
+public:
+    explicit CopyQueueUploader(ID3D12Device* pDevice, PlacedResourceAllocator* pAllocator = nullptr);
+    ~CopyQueueUploader();
+
+    // Creates the buffer and queues the copy of its contents. The returned staging
+    // memory has to be filled before the next Flush().
+    void* CreateBuffer(UINT64 size, ComPtr<ID3D12Resource>* pBuffer, _Out_ UINT64* pUploadValue);
+    UINT64 CreateBuffer(const void* pData, UINT64 size, ComPtr<ID3D12Resource>* pBuffer);
+
+    // Submits the queued copies.
+    void Flush();
+
+    // Makes the queue wait on the GPU until the upload has completed.
+    void QueueWait(ID3D12CommandQueue* pQueue, UINT64 uploadValue);
+
+    bool IsCompleted(UINT64 uploadValue)    { return m_timeline->IsCompleted(uploadValue); }
+
+    ID3D12CommandQueue* GetQueue() const    { return m_queue.Get(); }
+    ID3D12Fence* GetFence() const           { return m_timeline->GetFence(); }
+
+private:
+    ComPtr<ID3D12Device> m_device;
+    PlacedResourceAllocator* m_pAllocator;
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    std::unique_ptr<FenceTimeline> m_timeline;
+    std::unique_ptr<CommandAllocatorPool> m_allocatorPool;
+    std::unique_ptr<DeferredReleaseQueue> m_stagingReleases;
+    bool m_recording;
+};
@@ -0,0 +1,221 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "CpuProfiler.h"
+
+thread_local CpuProfiler::Track* CpuProfiler::s_pThreadTrack = nullptr;
+std::mutex CpuProfiler::s_trackMutex;
+std::unique_ptr<CpuProfiler::Track> CpuProfiler::s_tracks[CpuProfiler::MaxTracks];
+CpuProfiler::Track CpuProfiler::s_overflowTrack;
+std::atomic<UINT> CpuProfiler::s_trackCount(0);
+const char* CpuProfiler::s_zoneNames[CpuProfiler::MaxZones];
+std::atomic<UINT> CpuProfiler::s_zoneCount(0);
+
+UINT CpuProfiler::RegisterZone(const char* pName)
+{
+    UINT index = s_zoneCount.fetch_add(1);
+    if (index >= MaxZones)
+    {
+        // Out of slots; lump the remaining zones together.
+        assert(false);
+        index = MaxZones - 1;
+        pName = "(other)";
+    }
+    s_zoneNames[index] = pName;
+    return index;
+}
+
+void CpuProfiler::SetThreadName(const char* pName)
+{
+    Track* pTrack = s_pThreadTrack ? s_pThreadTrack : CreateThreadTrack();
+
+    std::lock_guard<std::mutex> lock(s_trackMutex);
+    strncpy_s(pTrack->name, pName, _TRUNCATE);
+}
+
+// Returns nullptr once MaxTracks tracks exist. The caller holds s_trackMutex.
+CpuProfiler::Track* CpuProfiler::AddTrack(const char* pName, const char* pCategory)
+{
+    const UINT index = s_trackCount.load(std::memory_order_relaxed);
+    if (index >= MaxTracks)
+    {
+        assert(false);
+        return nullptr;
+    }
+
+    s_tracks[index] = std::make_unique<Track>();
+    s_tracks[index]->writeIndex.store(0, std::memory_order_relaxed);
+    s_tracks[index]->pCategory = pCategory;
+    if (pName)
+    {
+        strncpy_s(s_tracks[index]->name, pName, _TRUNCATE);
+    }
+    else
+    {
+        sprintf_s(s_tracks[index]->name, "Thread %u", index);
+    }
+    s_trackCount.store(index + 1, std::memory_order_release);
+    return s_tracks[index].get();
+}
+
+// Called on a thread's first zone. Tracks stay around after their thread exits,
+// so its events can still be exported.
+CpuProfiler::Track* CpuProfiler::CreateThreadTrack()
+{
+    std::lock_guard<std::mutex> lock(s_trackMutex);
+
+    Track* pTrack = AddTrack(nullptr, "cpu");
+    s_pThreadTrack = pTrack ? pTrack : &s_overflowTrack;
+    return s_pThreadTrack;
+}
+
+// Returns MaxTracks when out of tracks, which RecordOnTrack sends to the
+// overflow track.
+UINT CpuProfiler::CreateTrack(const char* pName, const char* pCategory)
+{
+    std::lock_guard<std::mutex> lock(s_trackMutex);
+
+    return AddTrack(pName, pCategory) ? s_trackCount.load(std::memory_order_relaxed) - 1 : MaxTracks;
+}
+
+void CpuProfiler::RecordOnTrack(UINT track, UINT zone, UINT64 begin, UINT64 end)
+{
+    Write(track < MaxTracks ? s_tracks[track].get() : &s_overflowTrack, zone, begin, end);
+}
+
+// Appends the events still in the track's ring. The owning thread keeps writing
+// meanwhile, so whatever it may have overwritten during the copy is dropped.
+void CpuProfiler::CopyEvents(const Track& track, std::vector<ProfileEvent>* pEvents)
+{
+    const UINT64 end = track.writeIndex.load(std::memory_order_acquire);
+    const UINT64 begin = end > RingSize ? end - RingSize : 0;
+    const size_t first = pEvents->size();
+    for (UINT64 i = begin; i < end; i++)
+    {
+        pEvents->push_back(track.events[i & (RingSize - 1)]);
+    }
+
+    // The writer may already be filling the slot of event written - RingSize.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const UINT64 written = track.writeIndex.load(std::memory_order_relaxed);
+    const UINT64 firstIntact = written + 1 > RingSize ? written + 1 - RingSize : 0;
+    if (firstIntact > begin)
+    {
+        const size_t dropped = static_cast<size_t>((std::min)(firstIntact, end) - begin);
+        pEvents->erase(pEvents->begin() + first, pEvents->begin() + first + dropped);
+    }
+}
+
+void CpuProfiler::GetStatistics(UINT64 sinceTime, std::vector<ZoneStatistics>* pStatistics)
+{
+    std::vector<ProfileEvent> events;
+    const UINT trackCount = s_trackCount.load(std::memory_order_acquire);
+    for (UINT t = 0; t < trackCount; t++)
+    {
+        CopyEvents(*s_tracks[t], &events);
+    }
+
+    const UINT zoneCount = (std::min)(s_zoneCount.load(), MaxZones);
+    std::vector<std::vector<UINT64>> durations(zoneCount);
+    for (const ProfileEvent& event : events)
+    {
+        if (event.end >= sinceTime)
+        {
+            durations[event.zone].push_back(event.end - event.begin);
+        }
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const double msPerTick = 1000.0 / frequency.QuadPart;
+
+    pStatistics->clear();
+    for (UINT zone = 0; zone < zoneCount; zone++)
+    {
+        std::vector<UINT64>& zoneDurations = durations[zone];
+        if (zoneDurations.empty())
+        {
+            continue;
+        }
+        std::sort(zoneDurations.begin(), zoneDurations.end());
+
+        const size_t count = zoneDurations.size();
+        auto percentile = [&](double fraction)
+        {
+            return zoneDurations[(std::min)(count - 1, static_cast<size_t>(fraction * count))] * msPerTick;
+        };
+
+        UINT64 total = 0;
+        for (UINT64 duration : zoneDurations)
+        {
+            total += duration;
+        }
+
+        ZoneStatistics statistics = {};
+        statistics.pName = s_zoneNames[zone];
+        statistics.count = static_cast<UINT>(count);
+        statistics.averageMs = total * msPerTick / count;
+        statistics.p50Ms = percentile(0.5);
+        statistics.p90Ms = percentile(0.9);
+        statistics.p99Ms = percentile(0.99);
+        statistics.maxMs = zoneDurations.back() * msPerTick;
+        pStatistics->push_back(statistics);
+    }
+}
+
+// Every track becomes a thread of the trace and every event a complete ("X")
+// event. Timestamps stay in the QPC timebase, converted to microseconds.
+HRESULT CpuProfiler::ExportChromeTrace(LPCWSTR filename)
+{
+    using namespace Microsoft::WRL;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const double usPerTick = 1000000.0 / frequency.QuadPart;
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    std::vector<ProfileEvent> events;
+    char line[512];
+    {
+        std::lock_guard<std::mutex> lock(s_trackMutex);
+        const UINT trackCount = s_trackCount.load(std::memory_order_acquire);
+        for (UINT t = 0; t < trackCount; t++)
+        {
+            sprintf_s(line, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n", t, s_tracks[t]->name);
+            json += line;
+
+            events.clear();
+            CopyEvents(*s_tracks[t], &events);
+            for (const ProfileEvent& event : events)
+            {
+                sprintf_s(line, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+                    s_zoneNames[event.zone], s_tracks[t]->pCategory, t, event.begin * usPerTick, (event.end - event.begin) * usPerTick);
+                json += line;
+            }
+        }
+    }
+
+    // JSON does not allow a trailing comma after the last event.
+    if (json.back() == '\n' && json[json.size() - 2] == ',')
+    {
+        json.erase(json.size() - 2, 1);
+    }
+    json += "]}\n";
+
+    Wrappers::FileHandle file(CreateFile2(filename, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr));
+    if (file.Get() == INVALID_HANDLE_VALUE ||
+        !WriteFile(file.Get(), json.data(), static_cast<DWORD>(json.size()), nullptr, nullptr))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+    return S_OK;
+}
@@ -0,0 +1,168 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "DXSampleHelper.h"
+
+// Low-overhead CPU timing. A zone is a named scope; entering and leaving it costs
+// two QueryPerformanceCounter reads and a store into the calling thread's ring of
+// recent events, with no locks or allocations, so zones can stay enabled in
+// shipping builds:
+//
+//     void Renderer::Populate()
+//     {
+//         PROFILE_ZONE("Populate");
+//         ...
+//     }
+//
+// Every thread writes to its own track, a ring holding its last RingSize events.
+// Any thread may read the tracks at any time: statistics and trace exports copy
+// the rings and drop whatever the owning threads overwrote during the copy. Zone
+// names are registered once per call site and have to live as long as the
+// profiler, which string literals do.
+
+struct ProfileEvent
+{
+    UINT64 begin;       // QPC ticks.
+    UINT64 end;
+    UINT zone;
+};
+
+class CpuProfiler
+{
+public:
+    static const UINT MaxZones = 256;
+    static const UINT MaxTracks = 64;
+    static const UINT RingSize = 16 * 1024;     // Events per track; a power of two.
+
+    // Rolling statistics of one zone, in milliseconds.
+    struct ZoneStatistics
+    {
+        const char* pName;
+        UINT count;
+        double averageMs;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+    static UINT RegisterZone(const char* pName);
+
+    // Names the calling thread's track in trace exports.
+    static void SetThreadName(const char* pName);
+
+    static UINT64 Now();
+
+    // Records a completed zone on the calling thread's track.
+    static void Record(UINT zone, UINT64 begin, UINT64 end);
+
+    // Creates a track for events that were not timed on a CPU thread, such as GPU
+    // work converted to the QPC timebase. The category tags its events in trace
+    // exports. Only one thread at a time may record on the track.
+    static UINT CreateTrack(const char* pName, const char* pCategory);
+    static void RecordOnTrack(UINT track, UINT zone, UINT64 begin, UINT64 end);
+
+    // Computes the statistics of every zone that has events ending at or after
+    // sinceTime, in registration order.
+    static void GetStatistics(UINT64 sinceTime, std::vector<ZoneStatistics>* pStatistics);
+
+    // Writes the recent events of every track as a Chrome trace, the JSON format
+    // chrome://tracing and Perfetto open.
+    static HRESULT ExportChromeTrace(LPCWSTR filename);
+
+private:
+    struct Track
+    {
+        std::atomic<UINT64> writeIndex;
+        ProfileEvent events[RingSize];
+        char name[64];
+        const char* pCategory;
+    };
+
+    static Track* AddTrack(const char* pName, const char* pCategory);
+    static Track* CreateThreadTrack();
+    static void Write(Track* pTrack, UINT zone, UINT64 begin, UINT64 end);
+    static void CopyEvents(const Track& track, std::vector<ProfileEvent>* pEvents);
+
+    static thread_local Track* s_pThreadTrack;
+    static std::mutex s_trackMutex;                 // Guards track creation and names.
+    static std::unique_ptr<Track> s_tracks[MaxTracks];
+    static Track s_overflowTrack;                   // Shared by threads beyond MaxTracks and never read.
+    static std::atomic<UINT> s_trackCount;
+    static const char* s_zoneNames[MaxZones];
+    static std::atomic<UINT> s_zoneCount;
+};
+
+inline UINT64 CpuProfiler::Now()
+{
+    LARGE_INTEGER time;
+    QueryPerformanceCounter(&time);
+    return time.QuadPart;
+}
+
+inline void CpuProfiler::Record(UINT zone, UINT64 begin, UINT64 end)
+{
+    Track* pTrack = s_pThreadTrack;
+    if (pTrack == nullptr)
+    {
+        pTrack = CreateThreadTrack();
+    }
+    Write(pTrack, zone, begin, end);
+}
+
+inline void CpuProfiler::Write(Track* pTrack, UINT zone, UINT64 begin, UINT64 end)
+{
+    // Only one thread writes the track, so the index needs no read-modify-write;
+    // the release store publishes the event to readers.
+    const UINT64 index = pTrack->writeIndex.load(std::memory_order_relaxed);
+    ProfileEvent& event = pTrack->events[index & (RingSize - 1)];
+    event.begin = begin;
+    event.end = end;
+    event.zone = zone;
+    pTrack->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+// Times the enclosing scope as one zone.
+class CpuProfileScope
+{
+public:
+    explicit CpuProfileScope(UINT zone) :
+        m_zone(zone),
+        m_begin(CpuProfiler::Now())
+    {
+    }
+
+    ~CpuProfileScope()
+    {
+        CpuProfiler::Record(m_zone, m_begin, CpuProfiler::Now());
+    }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    UINT m_zone;
+    UINT64 m_begin;
+};
+
+#define PROFILE_ZONE_CONCAT_(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_(a, b)
+
+// Times the rest of the enclosing scope as a zone with the given name.
+#define PROFILE_ZONE(name) \
+    static const UINT PROFILE_ZONE_CONCAT(s_profileZone, __LINE__) = CpuProfiler::RegisterZone(name); \
+    CpuProfileScope PROFILE_ZONE_CONCAT(profileZoneScope, __LINE__)(PROFILE_ZONE_CONCAT(s_profileZone, __LINE__))
@@ -11,6 +11,9 @@
 
 #include "stdafx.h"
 #include "D3D12HelloTriangle.h"
+#include "RenderGraphBenchmark.h"
+#include "AllocatorBenchmark.h"
+#include "ResidencyBenchmark.h"
 
 #define USE_DXC
 
@@ -28,12 +31,47 @@ static IDxcCompiler *           s_dxcCompiler = nullptr;
 static IDxcLibrary *            s_dxcLibrary = nullptr;
 #endif
 
+const float D3D12HelloTriangle::ClearColor[4] = { 0.0f, 0.2f, 0.4f, 1.0f };
+
+// The names of the stress strategies on the command line and in reports, in
+// StressStrategy order.
+static const LPCWSTR StressStrategyNames[] = { L"perobject", L"instanced", L"indirect", L"merged", L"bindless" };
+static const LPCWSTR PresentModeNames[] = { L"vsync", L"uncapped", L"waitable", L"none" };
+
 D3D12HelloTriangle::D3D12HelloTriangle(UINT width, UINT height, std::wstring name) :
     DXSample(width, height, name),
+    m_pCurrentFrameResource(nullptr),
+    m_currentFrameResourceIndex(0),
+    m_framesInFlight(0),
+    m_requiredUploadValue(0),
+    m_waitedUploadValue(0),
     m_frameIndex(0),
+    m_timerFrequency(0),
+    m_statsStartTime(0),
+    m_statsWaitTime(0),
+    m_statsRecordTime(0),
+    m_statsSubmitTime(0),
+    m_statsGpuTime(0.0),
+    m_statsGpuFrameCount(0),
+    m_statsApiCallCount(0),
+    m_statsFrameCount(0),
+    m_statsWarmUp(false),
+    m_paceWaitTime(0),
+    m_overlapFrameCount(0),
+    m_overlapStalledFrameCount(0),
+    m_overlapStartTime(0),
+    m_overlapEndTime(0),
+    m_overlapStartGpuTicks(0),
+    m_currentStressStrategy(StressStrategyPerObject),
+    m_stressInstanceBufferView(),
+    m_stressMergedVertexBufferView(),
+    m_stressSweepLastObjectCount(0),
+    m_currentPresentMode(PresentModeVsync),
+    m_tearingSupported(false),
+    m_frameLatencyWaitableObject(nullptr),
+    m_bindlessSupported(false),
     m_viewport(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)),
-    m_scissorRect(0, 0, static_cast<LONG>(width), static_cast<LONG>(height)),
-    m_rtvDescriptorSize(0)
+    m_scissorRect(0, 0, static_cast<LONG>(width), static_cast<LONG>(height))
 {
 }
 
@@ -54,6 +92,39 @@ void D3D12HelloTriangle::OnInit()
 
     LoadPipeline();
     LoadAssets();
+
+    if (m_renderGraphBenchmarkPasses > 0)
+    {
+        BenchmarkRenderGraph();
+    }
+    if (m_bundleBenchmarkDraws > 0)
+    {
+        BenchmarkBundles();
+    }
+    if (m_zoneBenchmarkCount > 0)
+    {
+        BenchmarkZones();
+    }
+    if (m_uploadBenchmarkCount > 0)
+    {
+        BenchmarkUploads();
+    }
+    if (m_allocatorBenchmarkCount > 0)
+    {
+        BenchmarkAllocator();
+    }
+    if (m_descriptorBenchmarkCount > 0)
+    {
+        BenchmarkDescriptors();
+    }
+    if (m_bindlessBenchmarkCount > 0)
+    {
+        BenchmarkBindless();
+    }
+    if (m_residencyBenchmarkCount > 0)
+    {
+        BenchmarkResidency();
+    }
 }
 
 // Load the rendering pipeline dependencies.
@@ -78,11 +149,19 @@ void D3D12HelloTriangle::LoadPipeline()
 
     ComPtr<IDXGIFactory4> factory;
     ThrowIfFailed(CreateDXGIFactory2(dxgiFactoryFlags, IID_PPV_ARGS(&factory)));
+    ResolvePresentMode(factory.Get());
 
-    if (m_useWarpDevice)
+    // The adapter reports the video memory budget; the null device has none.
+    ComPtr<IDXGIAdapter3> adapter;
+    if (m_useNullDevice)
+    {
+        ThrowIfFailed(CreateNullDevice(m_nullGpuTimePerDraw, IID_PPV_ARGS(&m_device)));
+    }
+    else if (m_useWarpDevice)
     {
         ComPtr<IDXGIAdapter> warpAdapter;
         ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter)));
+        warpAdapter.As(&adapter);
 
         ThrowIfFailed(D3D12CreateDevice(
             warpAdapter.Get(),
@@ -94,6 +173,7 @@ void D3D12HelloTriangle::LoadPipeline()
     {
         ComPtr<IDXGIAdapter1> hardwareAdapter;
         GetHardwareAdapter(factory.Get(), &hardwareAdapter);
+        hardwareAdapter.As(&adapter);
 
         ThrowIfFailed(D3D12CreateDevice(
             hardwareAdapter.Get(),
@@ -109,58 +189,156 @@ void D3D12HelloTriangle::LoadPipeline()
 
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
 
-    // Describe and create the swap chain.
-    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.BufferCount = FrameCount;
-    swapChainDesc.Width = m_width;
-    swapChainDesc.Height = m_height;
-    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-    swapChainDesc.SampleDesc.Count = 1;
-
-    ComPtr<IDXGISwapChain1> swapChain;
-    ThrowIfFailed(factory->CreateSwapChainForHwnd(
-        m_commandQueue.Get(),        // Swap chain needs the queue so that it can force a flush on it.
-        Win32Application::GetHwnd(),
-        &swapChainDesc,
-        nullptr,
-        nullptr,
-        &swapChain
-        ));
+    // Streams refer to objects by index, so capture and replay share a table.
+    // The swap chain needs the runtime's own queue, not the capturing one.
+    ComPtr<ID3D12CommandQueue> swapChainQueue = m_commandQueue;
+    if (!m_capturePath.empty() || !m_replayPath.empty())
+    {
+        m_streamObjects = std::make_unique<CommandStreamObjects>(m_device.Get());
+    }
+    if (!m_capturePath.empty())
+    {
+        m_capture = std::make_unique<CommandStreamCapture>(m_streamObjects.get());
+        m_capture->Wrap(m_commandQueue);
+    }
+
+    // Create the queue's fence timeline and everything that recycles by it.
+    m_graphicsTimeline = std::make_unique<FenceTimeline>(m_device.Get(), m_commandQueue.Get());
+    m_deferredReleases = std::make_unique<DeferredReleaseQueue>(m_graphicsTimeline.get());
+    m_residencyManager = std::make_unique<ResidencyManager>(m_device.Get(), adapter.Get(), m_graphicsTimeline.get(),
+        m_residencyBudget > 0 ? UINT64(m_residencyBudget) * 1024 * 1024 : UINT64_MAX);
+    m_bufferAllocator = std::make_unique<PlacedResourceAllocator>(m_device.Get(), m_graphicsTimeline.get(), D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+        PlacedResourceAllocator::DefaultBlockSize, m_residencyManager.get());
+    m_copyUploader = std::make_unique<CopyQueueUploader>(m_device.Get(), m_bufferAllocator.get());
+    m_commandAllocatorPool = std::make_unique<CommandAllocatorPool>(m_device.Get(), m_graphicsTimeline.get());
+
+    // Describe and create the swap chain. Without presents, there is no use for
+    // one and the frames render into a ring of offscreen targets instead.
+    if (m_currentPresentMode != PresentModeNone)
+    {
+        DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+        swapChainDesc.BufferCount = FrameCount;
+        swapChainDesc.Width = m_width;
+        swapChainDesc.Height = m_height;
+        swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        swapChainDesc.SampleDesc.Count = 1;
+        if (m_tearingSupported)
+        {
+            swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        }
+        if (m_currentPresentMode == PresentModeWaitable)
+        {
+            swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        }
+
+        ComPtr<IDXGISwapChain1> swapChain;
+        if (m_useNullDevice)
+        {
+            // DXGI cannot present from a null device's queue.
+            ThrowIfFailed(CreateNullSwapChain(swapChainQueue.Get(), Win32Application::GetHwnd(), &swapChainDesc, &swapChain));
+        }
+        else
+        {
+            ThrowIfFailed(factory->CreateSwapChainForHwnd(
+                swapChainQueue.Get(),        // Swap chain needs the queue so that it can force a flush on it.
+                Win32Application::GetHwnd(),
+                &swapChainDesc,
+                nullptr,
+                nullptr,
+                &swapChain
+                ));
+        }
 
-    // This sample does not support fullscreen transitions.
-    ThrowIfFailed(factory->MakeWindowAssociation(Win32Application::GetHwnd(), DXGI_MWA_NO_ALT_ENTER));
+        // This sample does not support fullscreen transitions.
+        ThrowIfFailed(factory->MakeWindowAssociation(Win32Application::GetHwnd(), DXGI_MWA_NO_ALT_ENTER));
 
-    ThrowIfFailed(swapChain.As(&m_swapChain));
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+        ThrowIfFailed(swapChain.As(&m_swapChain));
+        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
 
-    // Create descriptor heaps.
+        // For the lowest latency, let a single frame queue up for presentation.
+        if (m_currentPresentMode == PresentModeWaitable)
+        {
+            ThrowIfFailed(m_swapChain->SetMaximumFrameLatency(1));
+            m_frameLatencyWaitableObject = m_swapChain->GetFrameLatencyWaitableObject();
+        }
+    }
+    else
     {
-        // Describe and create a render target view (RTV) descriptor heap.
-        D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-        rtvHeapDesc.NumDescriptors = FrameCount;
-        rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-        rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        ThrowIfFailed(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_rtvHeap)));
+        // The offscreen targets start out in the same state swap chain buffers
+        // do, so the frame's barriers work unchanged.
+        const CD3DX12_CLEAR_VALUE clearValue(DXGI_FORMAT_R8G8B8A8_UNORM, ClearColor);
+        for (UINT n = 0; n < FrameCount; n++)
+        {
+            ThrowIfFailed(m_device->CreateCommittedResource(
+                &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+                D3D12_HEAP_FLAG_NONE,
+                &CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, m_width, m_height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET),
+                D3D12_RESOURCE_STATE_PRESENT,
+                &clearValue,
+                IID_PPV_ARGS(&m_renderTargets[n])));
+            NAME_D3D12_OBJECT_INDEXED(m_renderTargets, n);
+        }
+        m_frameIndex = 0;
+    }
 
-        m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    // Create descriptor heaps: CPU-only heaps that views are created in, and a
+    // shader-visible one. Its first part is the bindless table, whose views stay
+    // put for as long as they live; descriptor tables rebuilt every frame come
+    // from the rest.
+    {
+        m_rtvHeap = std::make_unique<StagingDescriptorHeap>(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, RtvHeapCapacity);
+        m_viewHeap = std::make_unique<StagingDescriptorHeap>(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, ViewHeapCapacity);
+
+        D3D12_DESCRIPTOR_HEAP_DESC shaderVisibleHeapDesc = {};
+        shaderVisibleHeapDesc.NumDescriptors = BindlessTableCapacity + DescriptorRingFrameSize * MaxFramesInFlight;
+        shaderVisibleHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        shaderVisibleHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&shaderVisibleHeapDesc, IID_PPV_ARGS(&m_shaderVisibleHeap)));
+        NAME_D3D12_OBJECT(m_shaderVisibleHeap);
+
+        m_bindlessTable = std::make_unique<BindlessTable>(m_device.Get(), m_graphicsTimeline.get(), m_shaderVisibleHeap.Get(), 0, BindlessTableCapacity);
+        m_descriptorRing = std::make_unique<ShaderVisibleDescriptorRing>(m_device.Get(), m_shaderVisibleHeap.Get(), BindlessTableCapacity, DescriptorRingFrameSize * MaxFramesInFlight, MaxFramesInFlight);
+
+        // Tier 1 cannot bind an unbounded range of shader resource views.
+        D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+        ThrowIfFailed(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+        m_bindlessSupported = options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2;
     }
 
     // Create frame resources.
     {
-        CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
-
         // Create a RTV for each frame.
         for (UINT n = 0; n < FrameCount; n++)
         {
-            ThrowIfFailed(m_swapChain->GetBuffer(n, IID_PPV_ARGS(&m_renderTargets[n])));
-            m_device->CreateRenderTargetView(m_renderTargets[n].Get(), nullptr, rtvHandle);
-            rtvHandle.Offset(1, m_rtvDescriptorSize);
+            if (m_swapChain)
+            {
+                ThrowIfFailed(m_swapChain->GetBuffer(n, IID_PPV_ARGS(&m_renderTargets[n])));
+            }
+            m_rtvs[n] = m_rtvHeap->Allocate();
+            m_device->CreateRenderTargetView(m_renderTargets[n].Get(), nullptr, m_rtvs[n].cpuHandle);
         }
     }
 
-    ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocator)));
+    // Swap chain buffers and the offscreen targets both start out ready to present.
+    m_resourceStates = std::make_unique<ResourceStateRegistry>();
+    for (UINT n = 0; n < FrameCount; n++)
+    {
+        m_resourceStates->Register(m_renderTargets[n].Get(), D3D12_RESOURCE_STATE_PRESENT);
+    }
+
+    // Create the frame resources the CPU cycles through while the GPU catches up.
+    m_framesInFlight = (std::max)(1u, (std::min)(m_frameLatency, MaxFramesInFlight));
+    for (UINT n = 0; n < m_framesInFlight; n++)
+    {
+        m_frameResources[n] = std::make_unique<FrameResource>();
+    }
+
+    // Transient upload memory for all frames in flight.
+    m_uploadRing = std::make_unique<UploadRing>(m_device.Get(), m_graphicsTimeline.get(), UploadRingSize);
+    m_currentFrameResourceIndex = 0;
+    m_pCurrentFrameResource = m_frameResources[m_currentFrameResourceIndex].get();
 }
 
 #if defined(USE_DXC)
@@ -266,7 +444,87 @@ HRESULT DXCCompileFromFile( _In_ LPCWSTR pFileName, CONST D3D_SHADER_MACRO* pDef
     }
 }
 
+// Retrieves the reflection interface of a shader compiled by DXCCompileFromFile.
+HRESULT DXCReflectShader( _In_ ID3DBlob* pShader, _COM_Outptr_ ID3D12ShaderReflection** ppReflection )
+{
+    // DXIL containers store the shader program and its reflection data in the 'DXIL' part.
+    const UINT32 dxilPartKind = 'D' | ( 'X' << 8 ) | ( 'I' << 16 ) | ( 'L' << 24 );
+
+    ComPtr<IDxcContainerReflection> containerReflection;
+    ThrowIfFailed( s_dxcSupport.CreateInstance( CLSID_DxcContainerReflection, containerReflection.GetAddressOf( ) ) );
+    ThrowIfFailed( containerReflection->Load( reinterpret_cast<IDxcBlob*>( pShader ) ) );
+
+    UINT32 partIndex = 0;
+    ThrowIfFailed( containerReflection->FindFirstPartKind( dxilPartKind, &partIndex ) );
+    return containerReflection->GetPartReflection( partIndex, IID_PPV_ARGS( ppReflection ) );
+}
+
+#endif
+
+// Appends formatted text, truncated to a line's worth; for reports that are put
+// together piece by piece.
+static void AppendFormat(std::wstring& out, LPCWSTR pFormat, ...)
+{
+    WCHAR buffer[512];
+    va_list args;
+    va_start(args, pFormat);
+    const int length = _vsnwprintf_s(buffer, _countof(buffer), _TRUNCATE, pFormat, args);
+    va_end(args);
+    out.append(buffer, length >= 0 ? static_cast<size_t>(length) : wcslen(buffer));
+}
+
+// Compiles one of the shader file's entry points.
+static ComPtr<ID3DBlob> CompileShader(const std::wstring& path, LPCSTR entryPoint, LPCSTR target)
+{
+#if defined(_DEBUG)
+    // Enable better shader debugging with the graphics debugging tools.
+    UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    UINT compileFlags = 0;
+#endif
+
+    ComPtr<ID3DBlob> shader;
+#if defined(USE_DXC)
+    ThrowIfFailed( DXCCompileFromFile( path.c_str( ), nullptr, nullptr, entryPoint, target, compileFlags, 0, &shader, nullptr ) );
+#else
+    ThrowIfFailed(D3DCompileFromFile(path.c_str(), nullptr, nullptr, entryPoint, target, compileFlags, 0, &shader, nullptr));
+#endif
+    return shader;
+}
+
+// Vertex input layouts are derived from the vertex structs; make sure a layout
+// feeds everything the vertex shader expects.
+static void VerifyVertexShaderInput(ID3DBlob* pVertexShader, const D3D12_INPUT_LAYOUT_DESC& layout)
+{
+    ComPtr<ID3D12ShaderReflection> vertexShaderReflection;
+#if defined(USE_DXC)
+    ThrowIfFailed( DXCReflectShader( pVertexShader, &vertexShaderReflection ) );
+#else
+    ThrowIfFailed(D3DReflect(pVertexShader->GetBufferPointer(), pVertexShader->GetBufferSize(), IID_PPV_ARGS(&vertexShaderReflection)));
 #endif
+    VerifyInputSignature(vertexShaderReflection.Get(), layout);
+}
+
+// Describes the graphics pipeline state object (PSO) the sample draws with;
+// only the root signature, the shaders and their inputs vary.
+static D3D12_GRAPHICS_PIPELINE_STATE_DESC DescribePipelineState(ID3D12RootSignature* pRootSignature, const D3D12_INPUT_LAYOUT_DESC& inputLayout, ID3DBlob* pVertexShader, ID3DBlob* pPixelShader)
+{
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.InputLayout = inputLayout;
+    psoDesc.pRootSignature = pRootSignature;
+    psoDesc.VS = CD3DX12_SHADER_BYTECODE(pVertexShader);
+    psoDesc.PS = CD3DX12_SHADER_BYTECODE(pPixelShader);
+    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+    psoDesc.SampleDesc.Count = 1;
+    return psoDesc;
+}
 
 // Load the sample assets.
 void D3D12HelloTriangle::LoadAssets()
@@ -354,196 +612,1626 @@ void D3D12HelloTriangle::LoadAssets()
 
     // Create the pipeline state, which includes compiling and loading shaders.
     {
-        ComPtr<ID3DBlob> vertexShader;
-        ComPtr<ID3DBlob> pixelShader;
-
-#if defined(_DEBUG)
-        // Enable better shader debugging with the graphics debugging tools.
-        UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-        UINT compileFlags = 0;
-#endif
+        const ComPtr<ID3DBlob> vertexShader = CompileShader(GetAssetFullPath(L"shaders.hlsl"), "VSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> pixelShader = CompileShader(GetAssetFullPath(L"shaders.hlsl"), "PSMain", "ps_5_0");
+        VerifyVertexShaderInput(vertexShader.Get(), VertexLayout::Desc());
 
-#if defined(USE_DXC)
-        ThrowIfFailed( DXCCompileFromFile( GetAssetFullPath( L"shaders.hlsl" ).c_str( ), nullptr, nullptr, "VSMain", "vs_5_0", compileFlags, 0, &vertexShader, nullptr ) );
-        ThrowIfFailed( DXCCompileFromFile( GetAssetFullPath( L"shaders.hlsl" ).c_str( ), nullptr, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &pixelShader, nullptr ) );
-#else
-        ThrowIfFailed(D3DCompileFromFile(GetAssetFullPath(L"shaders.hlsl").c_str(), nullptr, nullptr, "VSMain", "vs_5_0", compileFlags, 0, &vertexShader, nullptr));
-        ThrowIfFailed(D3DCompileFromFile(GetAssetFullPath(L"shaders.hlsl").c_str(), nullptr, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &pixelShader, nullptr));
-#endif
-
-        // Define the vertex input layout.
-        D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
-        {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-        };
-
-        // Describe and create the graphics pipeline state object (PSO).
-        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-        psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
-        psoDesc.pRootSignature = m_rootSignature.Get();
-        psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.Get());
-        psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.Get());
-        psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-        psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-        psoDesc.DepthStencilState.DepthEnable = FALSE;
-        psoDesc.DepthStencilState.StencilEnable = FALSE;
-        psoDesc.SampleMask = UINT_MAX;
-        psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-        psoDesc.NumRenderTargets = 1;
-        psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-        psoDesc.SampleDesc.Count = 1;
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = DescribePipelineState(m_rootSignature.Get(), VertexLayout::Desc(), vertexShader.Get(), pixelShader.Get());
         ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
     }
 
     // Create the command list.
-    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocator.Get(), m_pipelineState.Get(), IID_PPV_ARGS(&m_commandList)));
+    ID3D12CommandAllocator* pCommandAllocator = m_commandAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, pCommandAllocator, m_pipelineState.Get(), IID_PPV_ARGS(&m_commandList)));
 
     // Command lists are created in the recording state, but there is nothing
     // to record yet. The main loop expects it to be closed, so close it now.
     ThrowIfFailed(m_commandList->Close());
 
+    // The scene's draws are recorded in parallel between the frame's first list,
+    // which prepares the back buffer, and its last, which transitions it for present.
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, pCommandAllocator, nullptr, IID_PPV_ARGS(&m_postCommandList)));
+    ThrowIfFailed(m_postCommandList->Close());
+
+    if (m_capture)
+    {
+        m_capture->Wrap(m_commandList);
+        m_capture->Wrap(m_postCommandList);
+    }
+
+    m_recorder = std::make_unique<ParallelCommandRecorder>(m_device.Get(), m_commandAllocatorPool.get(), m_recordingThreadCount, m_capture.get());
+
+    // The frame's first and last lists track the back buffer's state; the draw
+    // lists in between leave it alone.
+    m_commandListStates = std::make_unique<ResourceStateTracker>(m_resourceStates.get());
+    m_postCommandListStates = std::make_unique<ResourceStateTracker>(m_resourceStates.get());
+    m_submitter = std::make_unique<ResourceStateSubmitter>(m_device.Get(), m_commandAllocatorPool.get(), m_resourceStates.get(), m_capture.get());
+    m_renderGraph = std::make_unique<RenderGraph>(m_device.Get(), m_resourceStates.get(), m_deferredReleases.get());
+    m_gpuProfiler = std::make_unique<GpuProfiler>(m_device.Get(), m_commandQueue.Get(), m_framesInFlight, "GPU: direct queue");
+    if (m_collectPipelineStatistics)
+    {
+        m_pipelineStatistics = std::make_unique<PipelineStatisticsCollector>(m_device.Get(), m_framesInFlight);
+    }
+
+    // A captured stream refers to bundles it has no way to recreate, so
+    // capturing records the draws directly.
+    m_bundleCache = std::make_unique<BundleCache>(m_device.Get(), m_deferredReleases.get());
+    if (m_capture)
+    {
+        m_useBundles = false;
+    }
+
+    // A stream only refers to the upload ring, not to what was in it, so
+    // capturing draws the static vertex buffer. So does ExecuteIndirect, whose
+    // argument buffer sets it. Bundles bake the vertex buffer in.
+    if (m_capture || m_useIndirect)
+    {
+        m_useDynamicVertices = false;
+    }
+    if (m_useDynamicVertices)
+    {
+        m_useBundles = false;
+    }
+
     // Create the vertex buffer.
     {
-        // Define the geometry for a triangle.
-        Vertex triangleVertices[] =
+        // Define the geometry for a triangle. The stress scene places copies of it.
+        const Vertex triangleVertices[] =
         {
             { { 0.0f, 0.25f * m_aspectRatio, 0.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
             { { 0.25f, -0.25f * m_aspectRatio, 0.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
             { { -0.25f, -0.25f * m_aspectRatio, 0.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } }
         };
+        static_assert(sizeof(triangleVertices) == sizeof(m_triangleVertices), "The triangle has three vertices.");
+        memcpy(m_triangleVertices, triangleVertices, sizeof(triangleVertices));
 
         const UINT vertexBufferSize = sizeof(triangleVertices);
 
-        // Note: using upload heaps to transfer static data like vert buffers is not 
-        // recommended. Every time the GPU needs it, the upload heap will be marshalled 
-        // over. Please read up on Default Heap usage. An upload heap is used here for 
-        // code simplicity and because there are very few verts to actually transfer.
+        // The vertex buffer lives in a default heap, so the GPU reads it from its
+        // own memory rather than over the bus on every use. The copy queue
+        // fills it; the first frame waits for that.
+        m_requiredUploadValue = m_copyUploader->CreateBuffer(triangleVertices, vertexBufferSize, &m_vertexBuffer);
+        NAME_D3D12_OBJECT(m_vertexBuffer);
+
+        // Initialize the vertex buffer view.
+        m_vertexBufferView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
+        m_vertexBufferView.StrideInBytes = VertexLayout::Strides[0];
+        m_vertexBufferView.SizeInBytes = vertexBufferSize;
+    }
+
+    // With ExecuteIndirect, the draws come from an argument buffer holding one
+    // command per draw. The draws never change, so it is only written once.
+    if (m_useIndirect)
+    {
+        m_commandSignature = IndirectCommandSignature<IndirectDraw>::Create(m_device.Get());
+        NAME_D3D12_OBJECT(m_commandSignature);
+
+        const UINT argumentBufferSize = (std::max)(m_drawCount, 1u) * sizeof(IndirectDraw);
         ThrowIfFailed(m_device->CreateCommittedResource(
             &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
             D3D12_HEAP_FLAG_NONE,
-            &CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize),
+            &CD3DX12_RESOURCE_DESC::Buffer(argumentBufferSize),
             D3D12_RESOURCE_STATE_GENERIC_READ,
             nullptr,
-            IID_PPV_ARGS(&m_vertexBuffer)));
+            IID_PPV_ARGS(&m_indirectArgumentBuffer)));
+        NAME_D3D12_OBJECT(m_indirectArgumentBuffer);
 
-        // Copy the triangle data to the vertex buffer.
-        UINT8* pVertexDataBegin;
+        IndirectDraw* pCommands;
         CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
-        ThrowIfFailed(m_vertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
-        memcpy(pVertexDataBegin, triangleVertices, sizeof(triangleVertices));
-        m_vertexBuffer->Unmap(0, nullptr);
+        ThrowIfFailed(m_indirectArgumentBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pCommands)));
+        for (UINT i = 0; i < m_drawCount; i++)
+        {
+            pCommands[i].vertexBuffer = m_vertexBufferView;
+            pCommands[i].draw = { 3, 1, 0, 0 };
+        }
+        m_indirectArgumentBuffer->Unmap(0, nullptr);
 
-        // Initialize the vertex buffer view.
-        m_vertexBufferView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();
-        m_vertexBufferView.StrideInBytes = sizeof(Vertex);
-        m_vertexBufferView.SizeInBytes = vertexBufferSize;
+        // The argument buffer sets the vertex buffer itself.
+        m_useBundles = false;
     }
 
-    // Create synchronization objects and wait until assets have been uploaded to the GPU.
+    if (m_stressObjectCount > 0)
     {
-        ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
-        m_fenceValue = 1;
+        LoadStressScene();
+    }
 
-        // Create an event handle to use for frame synchronization.
-        m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        if (m_fenceEvent == nullptr)
-        {
-            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
-        }
+    // Register everything a frame refers to before the first submission, so
+    // the object indices in the stream only depend on this order.
+    if (m_streamObjects)
+    {
+        RegisterStreamObjects();
+    }
+    if (!m_replayPath.empty())
+    {
+        m_replayer = std::make_unique<CommandStreamReplayer>(m_device.Get(), m_streamObjects.get(), m_commandAllocatorPool.get(), LoadCommandStream(m_replayPath.c_str()));
+    }
 
+    // Wait until assets have been uploaded to the GPU.
+    {
         // Wait for the command list to execute; we are reusing the same command 
         // list in our main loop but for now, we just want to wait for setup to 
         // complete before continuing.
-        WaitForPreviousFrame();
+        WaitForGpu();
+        m_commandAllocatorPool->EndFrame(m_graphicsTimeline->GetLastSignaledValue());
+
+        // The static geometry only has to be there by the first frame; let the
+        // copy queue get going in the meantime.
+        m_copyUploader->Flush();
+    }
+
+    // The frame pacer never lets the GPU queue more frames than the frame
+    // resource ring can hold.
+    m_pacingClock = std::make_unique<QpcPacingClock>();
+    m_pacingFence = std::make_unique<TimelinePacingFence>(m_graphicsTimeline.get());
+    m_framePacer = std::make_unique<FramePacer>(m_pacingClock.get(), m_pacingFence.get(), m_targetFrameTime, (std::min)(m_maxQueuedFrames, m_framesInFlight - 1));
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_timerFrequency = frequency.QuadPart;
+
+    // Only count API calls made by the frame loop.
+    if (m_useNullDevice)
+    {
+        m_statsApiCallCount = NullApiCallCounter::GetTotal();
     }
 }
 
-// Update frame-based values.
-void D3D12HelloTriangle::OnUpdate()
+// Creates what the stress scene's strategies draw with. Every strategy gets its
+// own pipeline state, all but the bindless one with a root signature that holds
+// an object's placement in root constants; CreateStressBuffers() fills in the
+// objects.
+void D3D12HelloTriangle::LoadStressScene()
 {
+    static_assert(_countof(StressStrategyNames) == StressStrategyCount, "Every stress strategy needs a name.");
+
+    m_currentStressStrategy = StressStrategyCount;
+    for (UINT i = 0; i < StressStrategyCount; i++)
+    {
+        if (_wcsicmp(m_stressStrategy.c_str(), StressStrategyNames[i]) == 0)
+        {
+            m_currentStressStrategy = static_cast<StressStrategy>(i);
+        }
+    }
+    if (m_currentStressStrategy == StressStrategyCount)
+    {
+        OutputDebugStringW((L"Unknown stress strategy: " + m_stressStrategy + L"\n").c_str());
+        ThrowIfFailed(E_INVALIDARG);
+    }
+    if (m_currentStressStrategy == StressStrategyBindless && !m_bindlessSupported)
+    {
+        OutputDebugStringW(L"The bindless stress strategy needs resource binding tier 2.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    // Create a root signature with the object's placement as root constants.
+    {
+        CD3DX12_ROOT_PARAMETER rootParameters[1];
+        rootParameters[0].InitAsConstants(sizeof(XMFLOAT3) / sizeof(UINT), 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+
+        CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+        rootSignatureDesc.Init(_countof(rootParameters), rootParameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+        ComPtr<ID3DBlob> signature;
+        ComPtr<ID3DBlob> error;
+        ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error));
+        ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_stressRootSignature)));
+        NAME_D3D12_OBJECT(m_stressRootSignature);
+    }
+
+    // Create the pipeline states. Per-object and indirect draws place the shared
+    // triangle from the root constants, instanced draws from the instance stream,
+    // and the merged vertex buffer is already in place.
+    {
+        const std::wstring shaderPath = GetAssetFullPath(L"shaders.hlsl");
+        const ComPtr<ID3DBlob> vertexShader = CompileShader(shaderPath, "VSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> placedVertexShader = CompileShader(shaderPath, "StressVSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> instancedVertexShader = CompileShader(shaderPath, "StressInstancedVSMain", "vs_5_0");
+        const ComPtr<ID3DBlob> pixelShader = CompileShader(shaderPath, "PSMain", "ps_5_0");
+        VerifyVertexShaderInput(placedVertexShader.Get(), VertexLayout::Desc());
+        VerifyVertexShaderInput(instancedVertexShader.Get(), InstancedVertexLayout::Desc());
+
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDescs[StressStrategyBindless] =
+        {
+            DescribePipelineState(m_stressRootSignature.Get(), VertexLayout::Desc(), placedVertexShader.Get(), pixelShader.Get()),
+            DescribePipelineState(m_stressRootSignature.Get(), InstancedVertexLayout::Desc(), instancedVertexShader.Get(), pixelShader.Get()),
+            DescribePipelineState(m_stressRootSignature.Get(), VertexLayout::Desc(), placedVertexShader.Get(), pixelShader.Get()),
+            DescribePipelineState(m_stressRootSignature.Get(), VertexLayout::Desc(), vertexShader.Get(), pixelShader.Get())
+        };
+        for (UINT i = 0; i < _countof(psoDescs); i++)
+        {
+            ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDescs[i], IID_PPV_ARGS(&m_stressPipelineStates[i])));
+            NAME_D3D12_OBJECT_INDEXED(m_stressPipelineStates, i);
+        }
+    }
+
+    // Create the bindless strategy's root signature and pipeline state. The
+    // shader sees the whole bindless table as an unbounded array of buffers and
+    // gets the index of the placements, and the first object of the draw, as
+    // root constants; the table is bound once per command list.
+    if (m_bindlessSupported)
+    {
+        // The views in the table are created and released while the table is
+        // bound, so they cannot be static.
+        CD3DX12_DESCRIPTOR_RANGE1 ranges[1];
+        ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE);
+
+        CD3DX12_ROOT_PARAMETER1 rootParameters[2];
+        rootParameters[0].InitAsConstants(2, 1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+        rootParameters[1].InitAsDescriptorTable(_countof(ranges), ranges, D3D12_SHADER_VISIBILITY_VERTEX);
+
+        CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+        rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+        ComPtr<ID3DBlob> signature;
+        ComPtr<ID3DBlob> error;
+        ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_1, &signature, &error));
+        ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_bindlessRootSignature)));
+        NAME_D3D12_OBJECT(m_bindlessRootSignature);
+
+        const std::wstring shaderPath = GetAssetFullPath(L"shaders.hlsl");
+        const ComPtr<ID3DBlob> bindlessVertexShader = CompileShader(shaderPath, "StressBindlessVSMain", "vs_5_1");
+        const ComPtr<ID3DBlob> pixelShader = CompileShader(shaderPath, "PSMain", "ps_5_0");
+        VerifyVertexShaderInput(bindlessVertexShader.Get(), VertexLayout::Desc());
+
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = DescribePipelineState(m_bindlessRootSignature.Get(), VertexLayout::Desc(), bindlessVertexShader.Get(), pixelShader.Get());
+        ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_stressPipelineStates[StressStrategyBindless])));
+        NAME_D3D12_OBJECT_INDEXED(m_stressPipelineStates, StressStrategyBindless);
+    }
+
+    m_stressCommandSignature = IndirectCommandSignature<IndirectObjectDraw>::Create(m_device.Get(), m_stressRootSignature.Get());
+    NAME_D3D12_OBJECT(m_stressCommandSignature);
+
+    // A sweep works its way up to the requested object count, one strategy at a
+    // time. It changes the object count, which a capture cannot follow.
+    m_stressObjectCount = (std::min)(m_stressObjectCount, MaxStressObjectCount);
+    if (m_stressSweep && m_capture)
+    {
+        m_stressSweep = false;
+    }
+    if (m_stressSweep)
+    {
+        m_stressSweepLastObjectCount = m_stressObjectCount;
+        m_stressObjectCount = (std::min)(m_stressObjectCount, StressSweepFirstObjectCount);
+        m_currentStressStrategy = StressStrategyPerObject;
+    }
+
+    CreateStressBuffers();
 }
 
-// Render the scene.
-void D3D12HelloTriangle::OnRender()
+// Lays the stress scene's objects out in a grid that fills the viewport and
+// writes them into every strategy's buffer. Like the triangle's vertex buffer,
+// the per-object data is uploaded on the copy queue into placed buffers; the
+// buffers are only rewritten when the object count changes.
+void D3D12HelloTriangle::CreateStressBuffers()
 {
-    // Record all the commands we need to render the scene into the command list.
-    PopulateCommandList();
+    // Frames still in flight may be reading the previous buffers.
+    if (m_bindlessTable->IsValid(m_stressPlacementsView))
+    {
+        m_bindlessTable->Release(m_stressPlacementsView);
+    }
+    m_bufferAllocator->Release(m_stressInstanceBuffer.Detach());
+    m_deferredReleases->Release(m_stressArgumentBuffer.Detach());
+    m_bufferAllocator->Release(m_stressMergedVertexBuffer.Detach());
 
-    // Execute the command list.
-    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    auto createUploadBuffer = [this](UINT64 size, ComPtr<ID3D12Resource>* pBuffer)
+    {
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(size),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(pBuffer->ReleaseAndGetAddressOf())));
+
+        void* pData;
+        CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+        ThrowIfFailed((*pBuffer)->Map(0, &readRange, &pData));
+        return pData;
+    };
+
+    // Every object gets a cell of the grid and is scaled to fit it. At full scale
+    // the triangle is 0.5 wide and 0.5 * aspect ratio tall.
+    const UINT objectCount = m_stressObjectCount;
+    const UINT columns = static_cast<UINT>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+    const UINT rows = (objectCount + columns - 1) / columns;
+    const float cellWidth = 2.0f / columns;
+    const float cellHeight = 2.0f / rows;
+    const float scale = 0.9f * (std::min)(cellWidth / 0.5f, cellHeight / (0.5f * m_aspectRatio));
+
+    m_stressPlacements.resize(objectCount);
+    for (UINT i = 0; i < objectCount; i++)
+    {
+        m_stressPlacements[i].placement = XMFLOAT3(-1.0f + (i % columns + 0.5f) * cellWidth, 1.0f - (i / columns + 0.5f) * cellHeight, scale);
+    }
+
+    // The instance stream is the placements as they are. It and the merged
+    // vertex buffer go through the copy queue into default heaps; the frames
+    // drawing the new objects wait for them.
+    {
+        const UINT bufferSize = objectCount * sizeof(ObjectPlacement);
+        m_requiredUploadValue = m_copyUploader->CreateBuffer(m_stressPlacements.data(), bufferSize, &m_stressInstanceBuffer);
+        NAME_D3D12_OBJECT(m_stressInstanceBuffer);
+
+        m_stressInstanceBufferView.BufferLocation = m_stressInstanceBuffer->GetGPUVirtualAddress();
+        m_stressInstanceBufferView.StrideInBytes = InstancedVertexLayout::Strides[1];
+        m_stressInstanceBufferView.SizeInBytes = bufferSize;
+
+        // The bindless strategy reads the same placements as a structured buffer.
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.Buffer.NumElements = objectCount;
+        srvDesc.Buffer.StructureByteStride = sizeof(ObjectPlacement);
+        m_stressPlacementsView = m_bindlessTable->CreateShaderResourceView(m_stressInstanceBuffer.Get(), &srvDesc);
+    }
+
+    // Each indirect command sets the placement and draws the shared triangle.
+    {
+        IndirectObjectDraw* pCommands = static_cast<IndirectObjectDraw*>(createUploadBuffer(UINT64(objectCount) * sizeof(IndirectObjectDraw), &m_stressArgumentBuffer));
+        for (UINT i = 0; i < objectCount; i++)
+        {
+            pCommands[i].placement = m_stressPlacements[i].placement;
+            pCommands[i].draw = { 3, 1, 0, 0 };
+        }
+        m_stressArgumentBuffer->Unmap(0, nullptr);
+        NAME_D3D12_OBJECT(m_stressArgumentBuffer);
+    }
 
-    // Present the frame.
-    ThrowIfFailed(m_swapChain->Present(1, 0));
+    // The merged vertex buffer holds a copy of the triangle per object, already
+    // in place, so a single draw covers them all.
+    {
+        const UINT vertexCount = 3 * objectCount;
+        Vertex* pVertices = static_cast<Vertex*>(m_copyUploader->CreateBuffer(UINT64(vertexCount) * sizeof(Vertex), &m_stressMergedVertexBuffer, &m_requiredUploadValue));
+        for (UINT i = 0; i < objectCount; i++)
+        {
+            const XMFLOAT3& placement = m_stressPlacements[i].placement;
+            for (UINT v = 0; v < 3; v++)
+            {
+                Vertex vertex = m_triangleVertices[v];
+                vertex.position.x = vertex.position.x * placement.z + placement.x;
+                vertex.position.y = vertex.position.y * placement.z + placement.y;
+                pVertices[3 * i + v] = vertex;
+            }
+        }
+        NAME_D3D12_OBJECT(m_stressMergedVertexBuffer);
 
-    WaitForPreviousFrame();
+        m_stressMergedVertexBufferView.BufferLocation = m_stressMergedVertexBuffer->GetGPUVirtualAddress();
+        m_stressMergedVertexBufferView.StrideInBytes = VertexLayout::Strides[0];
+        m_stressMergedVertexBufferView.SizeInBytes = vertexCount * sizeof(Vertex);
+    }
 }
 
-void D3D12HelloTriangle::OnDestroy()
+// The objects a captured stream may refer to. Replaying a stream requires the
+// same registration order as capturing it, so new objects go at the end, and
+// objects whose number depends on the command line go last.
+void D3D12HelloTriangle::RegisterStreamObjects()
 {
-    // Ensure that the GPU is no longer referencing resources that are about to be
-    // cleaned up by the destructor.
-    WaitForPreviousFrame();
-
-    CloseHandle(m_fenceEvent);
+    m_streamObjects->Register(m_rtvHeap->GetHeap());
+    for (UINT n = 0; n < FrameCount; n++)
+    {
+        m_streamObjects->Register(m_renderTargets[n].Get());
+    }
+    m_streamObjects->Register(m_rootSignature.Get());
+    m_streamObjects->Register(m_pipelineState.Get());
+    m_streamObjects->Register(m_vertexBuffer.Get());
+    m_streamObjects->Register(m_graphicsTimeline->GetFence());
+    m_streamObjects->Register(m_uploadRing->GetBuffer());
+    m_streamObjects->Register(m_gpuProfiler->GetQueryHeap());
+    m_streamObjects->Register(m_gpuProfiler->GetReadbackBuffer());
+    m_streamObjects->Register(m_copyUploader->GetFence());
+    if (m_useIndirect)
+    {
+        m_streamObjects->Register(m_commandSignature.Get());
+        m_streamObjects->Register(m_indirectArgumentBuffer.Get());
+    }
+    if (m_stressObjectCount > 0)
+    {
+        m_streamObjects->Register(m_stressRootSignature.Get());
+        for (UINT i = 0; i < StressStrategyCount; i++)
+        {
+            if (m_stressPipelineStates[i])
+            {
+                m_streamObjects->Register(m_stressPipelineStates[i].Get());
+            }
+        }
+        m_streamObjects->Register(m_stressCommandSignature.Get());
+        m_streamObjects->Register(m_stressInstanceBuffer.Get());
+        m_streamObjects->Register(m_stressArgumentBuffer.Get());
+        m_streamObjects->Register(m_stressMergedVertexBuffer.Get());
+        if (m_bindlessSupported)
+        {
+            m_streamObjects->Register(m_bindlessRootSignature.Get());
+            m_streamObjects->Register(m_shaderVisibleHeap.Get());
+        }
+    }
+    if (m_pipelineStatistics)
+    {
+        m_streamObjects->Register(m_pipelineStatistics->GetPipelineQueryHeap());
+        m_streamObjects->Register(m_pipelineStatistics->GetOcclusionQueryHeap());
+        m_streamObjects->Register(m_pipelineStatistics->GetReadbackBuffer());
+    }
 }
 
-void D3D12HelloTriangle::PopulateCommandList()
+// Update frame-based values.
+void D3D12HelloTriangle::OnUpdate()
 {
-    // Command list allocators can only be reset when the associated 
-    // command lists have finished execution on the GPU; apps should use 
-    // fences to determine GPU execution progress.
-    ThrowIfFailed(m_commandAllocator->Reset());
+    PROFILE_ZONE("Pace");
 
-    // However, when ExecuteCommandList() is called on a particular command 
-    // list, that command list can then be reset at any time and must be before 
-    // re-recording.
-    ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
+    // A waitable swap chain signals once it can take another frame. Starting
+    // the frame only then keeps frames from piling up in the present queue.
+    if (m_frameLatencyWaitableObject)
+    {
+        PROFILE_ZONE("Swap chain wait");
+        WaitForSingleObjectEx(m_frameLatencyWaitableObject, 1000, TRUE);
+    }
 
-    // Set necessary state.
-    m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
-    m_commandList->RSSetViewports(1, &m_viewport);
-    m_commandList->RSSetScissorRects(1, &m_scissorRect);
+    // Hold the CPU back until the last moment that still keeps the GPU fed, so
+    // whatever input this frame samples is as fresh as possible.
+    LARGE_INTEGER paceStart, paceEnd;
+    QueryPerformanceCounter(&paceStart);
+    m_framePacer->BeginFrame();
+    QueryPerformanceCounter(&paceEnd);
+    m_paceWaitTime = paceEnd.QuadPart - paceStart.QuadPart;
+}
 
-    // Indicate that the back buffer will be used as a render target.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+// T exports a trace of the recent frames. S cycles through the stress strategies;
+// the up and down arrow keys double and halve the number of objects.
+void D3D12HelloTriangle::OnKeyDown(UINT8 key)
+{
+    if (key == 'T' && !m_tracePath.empty())
+    {
+        ExportTrace();
+        return;
+    }
 
-    CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_frameIndex, m_rtvDescriptorSize);
-    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+    if (m_stressObjectCount == 0 || m_stressSweep)
+    {
+        return;
+    }
 
-    // Record commands.
-    const float clearColor[] = { 0.0f, 0.2f, 0.4f, 1.0f };
-    m_commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-    m_commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    m_commandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
-    m_commandList->DrawInstanced(3, 1, 0, 0);
+    switch (key)
+    {
+    case 'S':
+    {
+        // Skips the strategies the device cannot draw with.
+        UINT strategy = (m_currentStressStrategy + 1) % StressStrategyCount;
+        while (!m_stressPipelineStates[strategy])
+        {
+            strategy = (strategy + 1) % StressStrategyCount;
+        }
+        SetStressConfiguration(static_cast<StressStrategy>(strategy), m_stressObjectCount);
+        break;
+    }
 
-    // Indicate that the back buffer will now be used to present.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    case VK_UP:
+        SetStressConfiguration(m_currentStressStrategy, (std::min)(m_stressObjectCount, MaxStressObjectCount / 2) * 2);
+        break;
 
-    ThrowIfFailed(m_commandList->Close());
+    case VK_DOWN:
+        SetStressConfiguration(m_currentStressStrategy, m_stressObjectCount / 2);
+        break;
+    }
 }
 
-void D3D12HelloTriangle::WaitForPreviousFrame()
+// Render the scene.
+void D3D12HelloTriangle::OnRender()
 {
-    // WAITING FOR THE FRAME TO COMPLETE BEFORE CONTINUING IS NOT BEST PRACTICE.
-    // This is code implemented as such for simplicity. The D3D12HelloFrameBuffering
-    // sample illustrates how to use fences for efficient resource usage and to
-    // maximize GPU utilization.
+    PROFILE_ZONE("Render");
 
-    // Signal and increment the fence value.
-    const UINT64 fence = m_fenceValue;
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), fence));
-    m_fenceValue++;
+    WaitForUploads();
 
-    // Wait until the previous frame is finished.
-    if (m_fence->GetCompletedValue() < fence)
+    // The buffers the frame draws from must be resident when it is submitted;
+    // heaps the recent frames did not use may be evicted to make room.
+    m_bufferAllocator->Use(m_vertexBuffer.Get());
+    if (m_stressObjectCount > 0)
     {
-        ThrowIfFailed(m_fence->SetEventOnCompletion(fence, m_fenceEvent));
-        WaitForSingleObject(m_fenceEvent, INFINITE);
+        m_bufferAllocator->Use(m_stressInstanceBuffer.Get());
+        m_bufferAllocator->Use(m_stressMergedVertexBuffer.Get());
     }
+    m_residencyManager->PrepareSubmission();
 
-    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    LARGE_INTEGER recordStart, recordEnd;
+    QueryPerformanceCounter(&recordStart);
+    if (m_replayer)
+    {
+        // Replay re-records and submits the captured frame's command lists.
+        PROFILE_ZONE("Replay");
+        m_replayer->ReplayFrame(m_commandQueue.Get(), m_frameIndex);
+        QueryPerformanceCounter(&recordEnd);
+    }
+    else
+    {
+        // Record all the commands we need to render the scene into the command lists.
+        PopulateCommandList();
+        QueryPerformanceCounter(&recordEnd);
+
+        // Execute the command lists, in order, with a single submission.
+        ID3D12CommandList* ppCommandLists[ParallelCommandRecorder::MaxThreadCount + 2];
+        ResourceStateTracker* ppTrackers[ParallelCommandRecorder::MaxThreadCount + 2] = {};
+        UINT commandListCount = 0;
+        ppTrackers[commandListCount] = m_commandListStates.get();
+        ppCommandLists[commandListCount++] = m_commandList.Get();
+        for (UINT i = 0; i < m_recorder->GetCommandListCount(); i++)
+        {
+            ppCommandLists[commandListCount++] = m_recorder->GetCommandLists()[i];
+        }
+        ppTrackers[commandListCount] = m_postCommandListStates.get();
+        ppCommandLists[commandListCount++] = m_postCommandList.Get();
+
+        LARGE_INTEGER submitStart, submitEnd;
+        QueryPerformanceCounter(&submitStart);
+        {
+            PROFILE_ZONE("Execute");
+            m_submitter->ExecuteCommandLists(m_commandQueue.Get(), commandListCount, ppCommandLists, ppTrackers);
+        }
+        QueryPerformanceCounter(&submitEnd);
+        m_statsSubmitTime += submitEnd.QuadPart - submitStart.QuadPart;
+    }
+    m_statsRecordTime += recordEnd.QuadPart - recordStart.QuadPart;
+
+    Present();
+    MoveToNextFrame();
+}
+
+// Picks the present mode named on the command line. Uncapped presents tear
+// where the factory reports support for it, so the frame rate is not limited
+// by composition either.
+void D3D12HelloTriangle::ResolvePresentMode(IDXGIFactory4* pFactory)
+{
+    static_assert(_countof(PresentModeNames) == PresentModeCount, "Every present mode needs a name.");
+
+    m_currentPresentMode = PresentModeCount;
+    for (UINT i = 0; i < PresentModeCount; i++)
+    {
+        if (_wcsicmp(m_presentMode.c_str(), PresentModeNames[i]) == 0)
+        {
+            m_currentPresentMode = static_cast<PresentMode>(i);
+        }
+    }
+    if (m_currentPresentMode == PresentModeCount)
+    {
+        OutputDebugStringW((L"Unknown present mode: " + m_presentMode + L"\n").c_str());
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    // Headless mode has no window to present to.
+    if (m_headless)
+    {
+        m_currentPresentMode = PresentModeNone;
+    }
+
+    if (m_currentPresentMode == PresentModeUncapped)
+    {
+        ComPtr<IDXGIFactory5> factory5;
+        BOOL allowTearing = FALSE;
+        if (SUCCEEDED(pFactory->QueryInterface(IID_PPV_ARGS(&factory5))) &&
+            SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+        {
+            m_tearingSupported = allowTearing != FALSE;
+        }
+    }
+}
+
+// Presents the frame, or just moves on to the next offscreen target.
+void D3D12HelloTriangle::Present()
+{
+    const UINT backBufferIndex = m_frameIndex;
+    const UINT syncInterval = m_currentPresentMode == PresentModeUncapped ? 0 : 1;
+    const UINT flags = m_currentPresentMode == PresentModeUncapped && m_tearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0;
+    if (m_swapChain)
+    {
+        PROFILE_ZONE("Present");
+        ThrowIfFailed(m_swapChain->Present(syncInterval, flags));
+    }
+    else
+    {
+        m_frameIndex = (m_frameIndex + 1) % FrameCount;
+    }
+
+    // Either way the stream gets a Present, which is what delimits its frames.
+    if (m_capture)
+    {
+        m_capture->RecordPresent(backBufferIndex, syncInterval, flags);
+    }
+}
+
+void D3D12HelloTriangle::OnDestroy()
+{
+    // These hand their GPU objects to the deferred release queue, tagged with the
+    // next timeline value; signal it so that the flushes below can wait for it.
+    m_renderGraph.reset();
+    m_bundleCache.reset();
+    m_graphicsTimeline->Signal();
+
+    // Ensure that the GPU is no longer referencing resources that are about to be
+    // cleaned up by the destructor. Every frame was fenced in MoveToNextFrame, so
+    // waiting for the last signaled value covers all submitted work.
+    m_graphicsTimeline->WaitForIdle();
+
+    if (m_capture)
+    {
+        m_capture->Save(m_capturePath.c_str());
+    }
+
+    if (m_headless && !m_readbackPath.empty())
+    {
+        ReadBackLastFrame();
+    }
+
+    if (!m_tracePath.empty())
+    {
+        ExportTrace();
+    }
+
+    m_deferredReleases->Flush();
+    m_bufferAllocator->Flush();
+
+    if (m_frameLatencyWaitableObject)
+    {
+        CloseHandle(m_frameLatencyWaitableObject);
+        m_frameLatencyWaitableObject = nullptr;
+    }
+
+    if (m_useNullDevice)
+    {
+        NullApiCallCounter::Report();
+    }
+
+    if (m_checkOverlap)
+    {
+        CheckOverlap();
+    }
+}
+
+void D3D12HelloTriangle::PopulateCommandList()
+{
+    PROFILE_ZONE("Populate");
+
+    // Command list allocators can only be reset when the associated command
+    // lists have finished execution on the GPU; the pool only hands out
+    // allocators whose last submission has completed.
+    ID3D12CommandAllocator* pCommandAllocator = m_commandAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+    // However, when ExecuteCommandList() is called on a particular command 
+    // list, that command list can then be reset at any time and must be before 
+    // re-recording.
+    ThrowIfFailed(m_commandList->Reset(pCommandAllocator, m_pipelineState.Get()));
+    m_commandListStates->Reset();
+    m_gpuProfiler->BeginFrame(m_commandList.Get(), m_currentFrameResourceIndex);
+    if (m_pipelineStatistics)
+    {
+        m_pipelineStatistics->BeginFrame(m_currentFrameResourceIndex);
+    }
+
+    // The frame resource's fence has passed, so the frame's share of the
+    // descriptor ring is free again.
+    m_descriptorRing->BeginFrame(m_currentFrameResourceIndex);
+
+    const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvs[m_frameIndex].cpuHandle;
+    m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+
+    // Declare the frame's passes; the graph works out the barriers, including
+    // the one that makes the back buffer a render target.
+    m_renderGraph->Reset();
+    const RenderGraphResource backBuffer = m_renderGraph->ImportResource(m_renderTargets[m_frameIndex].Get());
+    const UINT clearPass = m_renderGraph->AddPass(L"Clear",
+        [&rtvHandle](ID3D12GraphicsCommandList* pCommandList)
+        {
+            pCommandList->ClearRenderTargetView(rtvHandle, ClearColor, 0, nullptr);
+        });
+    m_renderGraph->Write(clearPass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    m_renderGraph->Compile();
+
+    // Record commands.
+    {
+        GPU_PROFILE_ZONE(m_gpuProfiler.get(), m_commandList.Get(), "GPU clear");
+        PipelineStatisticsScope pipelineStatistics(m_pipelineStatistics.get(), m_commandList.Get(), "Clear");
+        m_renderGraph->Execute(m_commandList.Get(), m_commandListStates.get());
+    }
+
+    m_commandListStates->Finish(m_commandList.Get());
+    ThrowIfFailed(m_commandList->Close());
+
+    // Record the draws across the worker threads. Every list has to set up the
+    // state the draws depend on itself; nothing carries over between lists.
+    if (m_stressObjectCount > 0)
+    {
+        RecordStressScene(rtvHandle);
+    }
+    else
+    {
+        // Dynamic vertices are copied into the upload ring anew every frame.
+        const D3D12_VERTEX_BUFFER_VIEW vertexBufferView = m_useDynamicVertices ?
+            m_uploadRing->AllocateVertexBuffer(m_triangleVertices, sizeof(m_triangleVertices), sizeof(Vertex)) :
+            m_vertexBufferView;
+
+        m_recorder->Record(m_pipelineState.Get(), m_drawCount,
+            [&](ID3D12GraphicsCommandList* pCommandList)
+            {
+                pCommandList->SetGraphicsRootSignature(m_rootSignature.Get());
+                pCommandList->RSSetViewports(1, &m_viewport);
+                pCommandList->RSSetScissorRects(1, &m_scissorRect);
+                pCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+                if (!m_useBundles)
+                {
+                    pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                    pCommandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+                }
+            },
+            [&](ID3D12GraphicsCommandList* pCommandList, UINT firstDraw, UINT drawCount)
+            {
+                GPU_PROFILE_ZONE(m_gpuProfiler.get(), pCommandList, "GPU draws");
+                PipelineStatisticsScope pipelineStatistics(m_pipelineStatistics.get(), pCommandList, "Draws");
+
+                // The list's draws are a contiguous range of the argument buffer, so
+                // one call issues them all, however many there are.
+                if (m_useIndirect)
+                {
+                    pCommandList->ExecuteIndirect(m_commandSignature.Get(), drawCount, m_indirectArgumentBuffer.Get(), UINT64(firstDraw) * sizeof(IndirectDraw), nullptr, 0);
+                    return;
+                }
+
+                // The draws never change, so with bundles they are only recorded
+                // once per distinct draw count and replayed from then on.
+                if (m_useBundles)
+                {
+                    pCommandList->ExecuteBundle(m_bundleCache->GetBundle(GetTriangleDrawKey(drawCount)));
+                    return;
+                }
+
+                for (UINT i = 0; i < drawCount; i++)
+                {
+                    pCommandList->DrawInstanced(3, 1, 0, 0);
+                }
+            });
+    }
+    m_bundleCache->EndFrame();
+
+    // Indicate that the back buffer will now be used to present.
+    // The draw lists do not change the back buffer's state, so the first list's
+    // final states are the right assumption.
+    ThrowIfFailed(m_postCommandList->Reset(pCommandAllocator, nullptr));
+    m_postCommandListStates->Reset(m_commandListStates.get());
+    m_postCommandListStates->Transition(m_renderTargets[m_frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT);
+
+    m_postCommandListStates->Finish(m_postCommandList.Get());
+    if (m_pipelineStatistics)
+    {
+        m_pipelineStatistics->EndFrame(m_postCommandList.Get());
+    }
+    m_gpuProfiler->EndFrame(m_postCommandList.Get());
+    ThrowIfFailed(m_postCommandList->Close());
+}
+
+// Records the stress scene's objects across the worker threads with the current
+// strategy. Each list gets a contiguous range of objects and draws it the same
+// way the whole scene would be drawn.
+void D3D12HelloTriangle::RecordStressScene(const D3D12_CPU_DESCRIPTOR_HANDLE& rtvHandle)
+{
+    const StressStrategy strategy = m_currentStressStrategy;
+    m_recorder->Record(m_stressPipelineStates[strategy].Get(), m_stressObjectCount,
+        [&](ID3D12GraphicsCommandList* pCommandList)
+        {
+            if (strategy == StressStrategyBindless)
+            {
+                // Bound once; the draws only pass indices into the table.
+                ID3D12DescriptorHeap* ppHeaps[] = { m_shaderVisibleHeap.Get() };
+                pCommandList->SetGraphicsRootSignature(m_bindlessRootSignature.Get());
+                pCommandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                pCommandList->SetGraphicsRootDescriptorTable(1, m_bindlessTable->GetGpuStart());
+            }
+            else
+            {
+                pCommandList->SetGraphicsRootSignature(m_stressRootSignature.Get());
+            }
+            pCommandList->RSSetViewports(1, &m_viewport);
+            pCommandList->RSSetScissorRects(1, &m_scissorRect);
+            pCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+            pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            if (strategy == StressStrategyInstanced)
+            {
+                const D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[] = { m_vertexBufferView, m_stressInstanceBufferView };
+                pCommandList->IASetVertexBuffers(0, _countof(vertexBufferViews), vertexBufferViews);
+            }
+            else if (strategy == StressStrategyMerged)
+            {
+                pCommandList->IASetVertexBuffers(0, 1, &m_stressMergedVertexBufferView);
+            }
+            else
+            {
+                pCommandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
+            }
+        },
+        [&](ID3D12GraphicsCommandList* pCommandList, UINT firstObject, UINT objectCount)
+        {
+            GPU_PROFILE_ZONE(m_gpuProfiler.get(), pCommandList, "GPU draws");
+            PipelineStatisticsScope pipelineStatistics(m_pipelineStatistics.get(), pCommandList, "Draws");
+
+            switch (strategy)
+            {
+            case StressStrategyPerObject:
+                for (UINT i = firstObject; i < firstObject + objectCount; i++)
+                {
+                    pCommandList->SetGraphicsRoot32BitConstants(0, sizeof(XMFLOAT3) / sizeof(UINT), &m_stressPlacements[i].placement, 0);
+                    pCommandList->DrawInstanced(3, 1, 0, 0);
+                }
+                break;
+
+            case StressStrategyInstanced:
+                pCommandList->DrawInstanced(3, objectCount, 0, firstObject);
+                break;
+
+            case StressStrategyIndirect:
+                pCommandList->ExecuteIndirect(m_stressCommandSignature.Get(), objectCount, m_stressArgumentBuffer.Get(), UINT64(firstObject) * sizeof(IndirectObjectDraw), nullptr, 0);
+                break;
+
+            case StressStrategyMerged:
+                pCommandList->DrawInstanced(3 * objectCount, 1, 3 * firstObject, 0);
+                break;
+
+            case StressStrategyBindless:
+            {
+                // SV_InstanceID does not include the start instance, so the
+                // first object goes along with the index.
+                const UINT constants[] = { m_bindlessTable->GetIndex(m_stressPlacementsView), firstObject };
+                pCommandList->SetGraphicsRoot32BitConstants(0, _countof(constants), constants, 0);
+                pCommandList->DrawInstanced(3, objectCount, 0, 0);
+                break;
+            }
+            }
+        });
+}
+
+// Switches the stress scene to another strategy or object count. The frames in
+// flight still belong to the previous configuration, so the next report is
+// skipped. A capture keeps the object count it started with, since the stream
+// refers to the buffers it registered.
+void D3D12HelloTriangle::SetStressConfiguration(StressStrategy strategy, UINT objectCount)
+{
+    objectCount = (std::max)(1u, (std::min)(objectCount, MaxStressObjectCount));
+    if (objectCount != m_stressObjectCount && !m_capture)
+    {
+        m_stressObjectCount = objectCount;
+        CreateStressBuffers();
+    }
+    m_currentStressStrategy = strategy;
+
+    ResetFrameStatistics();
+    m_statsWarmUp = true;
+}
+
+// Moves the sweep on to the next strategy, and once every strategy has been
+// measured at the current object count, to four times as many objects.
+void D3D12HelloTriangle::AdvanceStressSweep()
+{
+    if (m_currentStressStrategy + 1 < StressStrategyCount && m_stressPipelineStates[m_currentStressStrategy + 1])
+    {
+        SetStressConfiguration(static_cast<StressStrategy>(m_currentStressStrategy + 1), m_stressObjectCount);
+    }
+    else if (m_stressObjectCount < m_stressSweepLastObjectCount)
+    {
+        SetStressConfiguration(StressStrategyPerObject, (std::min)(m_stressObjectCount * 4, m_stressSweepLastObjectCount));
+    }
+    else
+    {
+        m_stressSweep = false;
+        SetCustomWindowText(L"stress sweep complete");
+    }
+}
+
+// Makes the graphics queue wait for the static geometry the frame draws from.
+// The wait happens on the GPU, and only when there is a newer upload to wait for.
+void D3D12HelloTriangle::WaitForUploads()
+{
+    if (m_requiredUploadValue > m_waitedUploadValue)
+    {
+        m_copyUploader->QueueWait(m_commandQueue.Get(), m_requiredUploadValue);
+        m_waitedUploadValue = m_requiredUploadValue;
+    }
+}
+
+// Wait for pending GPU work to complete.
+void D3D12HelloTriangle::WaitForGpu()
+{
+    m_graphicsTimeline->WaitForValue(m_graphicsTimeline->Signal());
+
+    if (m_swapChain)
+    {
+        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    }
+}
+
+// Copies the most recently rendered offscreen target back to the CPU and writes
+// it to the readback path. Expects the GPU to be idle.
+void D3D12HelloTriangle::ReadBackLastFrame()
+{
+    ID3D12Resource* pRenderTarget = m_renderTargets[(m_frameIndex + FrameCount - 1) % FrameCount].Get();
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+    UINT64 readbackBufferSize;
+    m_device->GetCopyableFootprints(&pRenderTarget->GetDesc(), 0, 1, 0, &footprint, nullptr, nullptr, &readbackBufferSize);
+
+    ComPtr<ID3D12Resource> readbackBuffer;
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(readbackBufferSize),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(&readbackBuffer)));
+
+    ID3D12CommandAllocator* pCommandAllocator = m_commandAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    ThrowIfFailed(m_commandList->Reset(pCommandAllocator, nullptr));
+    m_commandListStates->Reset();
+
+    m_commandListStates->Transition(pRenderTarget, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_commandListStates->FlushBarriers(m_commandList.Get());
+    m_commandList->CopyTextureRegion(
+        &CD3DX12_TEXTURE_COPY_LOCATION(readbackBuffer.Get(), footprint), 0, 0, 0,
+        &CD3DX12_TEXTURE_COPY_LOCATION(pRenderTarget, 0), nullptr);
+    m_commandListStates->Transition(pRenderTarget, D3D12_RESOURCE_STATE_PRESENT);
+    m_commandListStates->Finish(m_commandList.Get());
+    ThrowIfFailed(m_commandList->Close());
+
+    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
+    ResourceStateTracker* ppTrackers[] = { m_commandListStates.get() };
+    m_submitter->ExecuteCommandLists(m_commandQueue.Get(), _countof(ppCommandLists), ppCommandLists, ppTrackers);
+    WaitForGpu();
+    m_commandAllocatorPool->EndFrame(m_graphicsTimeline->GetLastSignaledValue());
+
+    UINT8* pPixels;
+    ThrowIfFailed(readbackBuffer->Map(0, &CD3DX12_RANGE(0, static_cast<SIZE_T>(readbackBufferSize)), reinterpret_cast<void**>(&pPixels)));
+    const HRESULT hr = WriteBitmapToFile(m_readbackPath.c_str(), footprint.Footprint.Width, footprint.Footprint.Height, pPixels + footprint.Offset, footprint.Footprint.RowPitch);
+    readbackBuffer->Unmap(0, &CD3DX12_RANGE(0, 0));
+    ThrowIfFailed(hr);
+}
+
+// Measures how long declaring and compiling a large synthetic render graph
+// takes on the CPU and reports the result along with what the compile did.
+void D3D12HelloTriangle::BenchmarkRenderGraph()
+{
+    RenderGraph graph(m_device.Get(), m_resourceStates.get(), m_deferredReleases.get());
+    const RenderGraphBenchmarkResult result = RunRenderGraphBenchmark(&graph, m_renderTargets[0].Get(), m_renderGraphBenchmarkPasses, BenchmarkIterations);
+    const RenderGraph::Statistics& stats = result.statistics;
+
+    WCHAR text[512];
+    swprintf_s(text, L"render graph of %u passes: declare %.3f ms, compile %.3f ms; %u culled, %u levels, %u transitions (%u split), %u aliasing barriers, %u transients aliased from %.1f MB into %.1f MB",
+        stats.passCount,
+        result.declareMs,
+        result.compileMs,
+        stats.culledPassCount,
+        stats.levelCount,
+        stats.transitionCount,
+        stats.splitTransitionCount,
+        stats.aliasingBarrierCount,
+        stats.transientCount,
+        stats.unaliasedMemorySize / (1024.0 * 1024.0),
+        stats.transientMemorySize / (1024.0 * 1024.0));
+    SetCustomWindowText(text);
+}
+
+// The state the triangle's draws need, which is all a bundle of them depends on.
+StaticDrawKey D3D12HelloTriangle::GetTriangleDrawKey(UINT drawCount) const
+{
+    StaticDrawKey key = {};
+    key.pPipelineState = m_pipelineState.Get();
+    key.pRootSignature = m_rootSignature.Get();
+    key.topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    key.vertexBufferView = m_vertexBufferView;
+    key.vertexCountPerInstance = 3;
+    key.instanceCount = 1;
+    key.drawCount = drawCount;
+    return key;
+}
+
+// Measures the CPU cost of recording the frame's draws into a command list
+// directly against replaying them from a bundle. Nothing is submitted.
+void D3D12HelloTriangle::BenchmarkBundles()
+{
+    ComPtr<ID3D12CommandAllocator> commandAllocator;
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator)));
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), m_pipelineState.Get(), IID_PPV_ARGS(&commandList)));
+    ThrowIfFailed(commandList->Close());
+
+    // Recording the bundle is a one-time cost and not part of the comparison.
+    ID3D12GraphicsCommandList* pBundle = m_bundleCache->GetBundle(GetTriangleDrawKey(m_bundleBenchmarkDraws));
+    const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_rtvs[0].cpuHandle;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    UINT64 directTime = 0;
+    UINT64 bundleTime = 0;
+    for (UINT i = 0; i < BenchmarkIterations; i++)
+    {
+        for (UINT useBundle = 0; useBundle < 2; useBundle++)
+        {
+            // Nothing was submitted, so the allocator can be reset right away.
+            ThrowIfFailed(commandAllocator->Reset());
+
+            LARGE_INTEGER start, end;
+            QueryPerformanceCounter(&start);
+            ThrowIfFailed(commandList->Reset(commandAllocator.Get(), m_pipelineState.Get()));
+            commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+            commandList->RSSetViewports(1, &m_viewport);
+            commandList->RSSetScissorRects(1, &m_scissorRect);
+            commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+            if (useBundle)
+            {
+                commandList->ExecuteBundle(pBundle);
+            }
+            else
+            {
+                commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                commandList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
+                for (UINT draw = 0; draw < m_bundleBenchmarkDraws; draw++)
+                {
+                    commandList->DrawInstanced(3, 1, 0, 0);
+                }
+            }
+            ThrowIfFailed(commandList->Close());
+            QueryPerformanceCounter(&end);
+
+            (useBundle ? bundleTime : directTime) += end.QuadPart - start.QuadPart;
+        }
+    }
+
+    const double directMs = 1000.0 * directTime / frequency.QuadPart / BenchmarkIterations;
+    const double bundleMs = 1000.0 * bundleTime / frequency.QuadPart / BenchmarkIterations;
+    WCHAR text[256];
+    swprintf_s(text, L"recording %u draws: direct %.3f ms, bundle %.3f ms (%.1fx)",
+        m_bundleBenchmarkDraws, directMs, bundleMs, directMs / (std::max)(bundleMs, 1e-6));
+    SetCustomWindowText(text);
+}
+
+// Measures what a zone costs by entering and leaving one over and over, so that
+// it is clear zones can stay in the frame loop.
+void D3D12HelloTriangle::BenchmarkZones()
+{
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    for (UINT i = 0; i < m_zoneBenchmarkCount; i++)
+    {
+        PROFILE_ZONE("Benchmark");
+    }
+    QueryPerformanceCounter(&end);
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u zones: %.1f ns per zone",
+        m_zoneBenchmarkCount, 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / m_zoneBenchmarkCount);
+    SetCustomWindowText(text);
+}
+
+// Compares carving uploads out of the ring against giving each upload its own
+// committed resource. The ring's bookkeeping runs on a simulated fence that lags
+// m_framesInFlight frames behind, with the ring sized to exactly fit that many
+// frames, so running out of room would be a bookkeeping bug.
+void D3D12HelloTriangle::BenchmarkUploads()
+{
+    const UINT64 frameSize = UINT64(m_uploadBenchmarkCount) * UploadBenchmarkSize;
+    UploadRingAllocator allocator(frameSize * m_framesInFlight);
+    std::vector<UINT8> ringMemory(static_cast<size_t>(allocator.GetSize()));
+    UINT8 data[UploadBenchmarkSize] = {};
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    UINT64 peakUsedSize = 0;
+    for (UINT64 frame = 1; frame <= BenchmarkIterations; frame++)
+    {
+        if (frame > m_framesInFlight)
+        {
+            allocator.Retire(frame - m_framesInFlight);
+        }
+        for (UINT i = 0; i < m_uploadBenchmarkCount; i++)
+        {
+            const UINT64 offset = allocator.Allocate(UploadBenchmarkSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+            if (offset == UploadRingAllocator::InvalidOffset)
+            {
+                OutputDebugStringW(L"Upload ring ran out of room.\n");
+                ThrowIfFailed(E_FAIL);
+            }
+            memcpy(ringMemory.data() + offset, data, UploadBenchmarkSize);
+        }
+        peakUsedSize = (std::max)(peakUsedSize, allocator.GetUsedSize());
+        allocator.EndFrame(frame);
+    }
+    QueryPerformanceCounter(&end);
+    const double ringNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (UINT64(m_uploadBenchmarkCount) * BenchmarkIterations);
+
+    // Committed resources are slow enough that fewer of them make the point.
+    const UINT committedCount = (std::min)(m_uploadBenchmarkCount, MaxCommittedUploadBenchmarkCount);
+    QueryPerformanceCounter(&start);
+    for (UINT i = 0; i < committedCount; i++)
+    {
+        ComPtr<ID3D12Resource> buffer;
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(UploadBenchmarkSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&buffer)));
+
+        UINT8* pDataBegin;
+        CD3DX12_RANGE readRange(0, 0);
+        ThrowIfFailed(buffer->Map(0, &readRange, reinterpret_cast<void**>(&pDataBegin)));
+        memcpy(pDataBegin, data, UploadBenchmarkSize);
+        buffer->Unmap(0, nullptr);
+    }
+    QueryPerformanceCounter(&end);
+    const double committedNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / committedCount;
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u uploads of %u bytes per frame: ring %.1f ns, committed resource %.1f ns per upload (%.0fx), ring peak %llu of %llu KB",
+        m_uploadBenchmarkCount, UploadBenchmarkSize, ringNs, committedNs, committedNs / (std::max)(ringNs, 1e-3),
+        peakUsedSize / 1024, allocator.GetSize() / 1024);
+    SetCustomWindowText(text);
+}
+
+// Measures the TLSF bookkeeping behind the placed resource allocator on a
+// simulated heap; see RunAllocatorBenchmark(). Also reports how the sample's own
+// buffer heaps are used.
+void D3D12HelloTriangle::BenchmarkAllocator()
+{
+    const AllocatorBenchmarkResult result = RunAllocatorBenchmark(m_allocatorBenchmarkCount);
+    const PlacedResourceAllocator::Statistics buffers = m_bufferAllocator->GetStatistics();
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u placements: allocate %.1f ns, free %.1f ns, %u failed, fragmentation %.0f%%, %u moves in %.2f ms to %.0f%%; buffer heaps %u, %llu of %llu KB",
+        m_allocatorBenchmarkCount, result.allocateNs, result.freeNs, result.failedAllocationCount, 100.0 * result.churned.fragmentation,
+        result.defragmentationMoveCount, result.defragmentationMs, 100.0 * result.defragmented.fragmentation,
+        buffers.heapCount, buffers.usedSize / 1024, buffers.reservedSize / 1024);
+    SetCustomWindowText(text);
+}
+
+// Builds descriptor tables the way a frame would: constant buffer views in the
+// staging heap, copied into the descriptor ring as tables of a few scattered
+// descriptors each. A single batched CopyDescriptors per frame is compared with
+// a CopyDescriptorsSimple per descriptor.
+void D3D12HelloTriangle::BenchmarkDescriptors()
+{
+    const UINT tableCount = (std::min)(m_descriptorBenchmarkCount, (std::min)(DescriptorRingFrameSize, ViewHeapCapacity - m_viewHeap->GetAllocatedCount()) / DescriptorBenchmarkTableSize);
+    const UINT sourceCount = tableCount * DescriptorBenchmarkTableSize;
+    const UINT threadCount = (std::max)(m_recordingThreadCount, 1u);
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+
+    // Every thread takes its share of the staging heap and gives it back, over
+    // and over. An index handed out twice would be a broken free list.
+    std::unique_ptr<std::atomic<bool>[]> taken = std::make_unique<std::atomic<bool>[]>(ViewHeapCapacity);
+    std::atomic<bool> duplicate(false);
+    auto churn = [&](UINT count)
+    {
+        std::vector<DescriptorHandle> handles(count);
+        for (UINT iteration = 0; iteration < BenchmarkIterations; iteration++)
+        {
+            for (DescriptorHandle& handle : handles)
+            {
+                handle = m_viewHeap->Allocate();
+                if (taken[handle.index].exchange(true, std::memory_order_relaxed))
+                {
+                    duplicate = true;
+                }
+            }
+            for (const DescriptorHandle& handle : handles)
+            {
+                taken[handle.index].store(false, std::memory_order_relaxed);
+                m_viewHeap->Free(handle);
+            }
+        }
+    };
+
+    QueryPerformanceCounter(&start);
+    std::vector<std::thread> threads;
+    for (UINT i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(churn, sourceCount / threadCount);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    QueryPerformanceCounter(&end);
+    if (duplicate)
+    {
+        OutputDebugStringW(L"Staging descriptor heap handed out a descriptor twice.\n");
+        ThrowIfFailed(E_FAIL);
+    }
+    const UINT churnCount = (std::max)(sourceCount / threadCount * threadCount, 1u);
+    const double stagingNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (UINT64(churnCount) * BenchmarkIterations);
+
+    // Tables read their views in a scattered order, as a real scene's would.
+    std::vector<DescriptorHandle> views(sourceCount);
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> sources(sourceCount);
+    const UINT64 constantsAddress = m_uploadRing->GetBuffer()->GetGPUVirtualAddress();
+    for (UINT i = 0; i < sourceCount; i++)
+    {
+        views[i] = m_viewHeap->Allocate();
+        D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
+        cbvDesc.BufferLocation = constantsAddress + (i % (UploadRingSize / D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT)) * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        cbvDesc.SizeInBytes = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        m_device->CreateConstantBufferView(&cbvDesc, views[i].cpuHandle);
+    }
+    for (UINT i = 0; i < sourceCount; i++)
+    {
+        sources[i] = views[(i * 7 + i / DescriptorBenchmarkTableSize) % sourceCount].cpuHandle;
+    }
+
+    DescriptorCopyBatch batch(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> tables(tableCount);
+    QueryPerformanceCounter(&start);
+    for (UINT iteration = 0; iteration < BenchmarkIterations; iteration++)
+    {
+        m_descriptorRing->BeginFrame(0);
+        for (UINT t = 0; t < tableCount; t++)
+        {
+            tables[t] = m_descriptorRing->CopyTable(&batch, &sources[t * DescriptorBenchmarkTableSize], DescriptorBenchmarkTableSize);
+        }
+        batch.Flush(m_device.Get());
+    }
+    QueryPerformanceCounter(&end);
+    const double batchedNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (UINT64((std::max)(tableCount, 1u)) * BenchmarkIterations);
+
+    // Null descriptor handles point at the descriptors' bytes, so the copies can
+    // be checked there; the GPU handles of the ring mirror its CPU handles.
+    bool verified = false;
+    if (m_useNullDevice)
+    {
+        const UINT descriptorSize = m_viewHeap->GetDescriptorSize();
+        const SIZE_T cpuStart = m_shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart().ptr;
+        const UINT64 gpuStart = m_shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart().ptr;
+        for (UINT i = 0; i < sourceCount; i++)
+        {
+            const UINT t = i / DescriptorBenchmarkTableSize;
+            const SIZE_T copy = cpuStart + static_cast<SIZE_T>(tables[t].ptr - gpuStart) + SIZE_T(i % DescriptorBenchmarkTableSize) * descriptorSize;
+            if (memcmp(reinterpret_cast<const void*>(copy), reinterpret_cast<const void*>(sources[i].ptr), descriptorSize) != 0)
+            {
+                OutputDebugStringW(L"Descriptor ring holds a descriptor other than its source.\n");
+                ThrowIfFailed(E_FAIL);
+            }
+        }
+        verified = true;
+    }
+
+    QueryPerformanceCounter(&start);
+    for (UINT iteration = 0; iteration < BenchmarkIterations; iteration++)
+    {
+        m_descriptorRing->BeginFrame(0);
+        for (UINT t = 0; t < tableCount; t++)
+        {
+            DescriptorTable table;
+            if (!m_descriptorRing->Allocate(DescriptorBenchmarkTableSize, &table))
+            {
+                ThrowIfFailed(E_OUTOFMEMORY);
+            }
+            for (UINT d = 0; d < DescriptorBenchmarkTableSize; d++)
+            {
+                m_device->CopyDescriptorsSimple(1, CD3DX12_CPU_DESCRIPTOR_HANDLE(table.cpuHandle, d, m_viewHeap->GetDescriptorSize()),
+                    sources[t * DescriptorBenchmarkTableSize + d], D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+            }
+        }
+    }
+    QueryPerformanceCounter(&end);
+    const double simpleNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (UINT64((std::max)(tableCount, 1u)) * BenchmarkIterations);
+
+    for (const DescriptorHandle& view : views)
+    {
+        m_viewHeap->Free(view);
+    }
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u tables of %u descriptors: staging allocate and free %.1f ns on %u threads, batched copy %.1f ns, simple copies %.1f ns per table%s",
+        tableCount, DescriptorBenchmarkTableSize, stagingNs, threadCount, batchedNs, simpleNs, verified ? L" (copies verified)" : L"");
+    SetCustomWindowText(text);
+}
+
+// Registers views of a buffer in the bindless table until the requested count
+// or the table is full, releases them and registers them again once the GPU has
+// passed the release. None of the first handles may validate afterwards, even
+// though their slots are taken again.
+void D3D12HelloTriangle::BenchmarkBindless()
+{
+    const UINT viewCount = (std::min)(m_bindlessBenchmarkCount, m_bindlessTable->GetCapacity() - m_bindlessTable->GetCount());
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.NumElements = static_cast<UINT>(m_vertexBufferView.SizeInBytes / sizeof(UINT));
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER start;
+    LARGE_INTEGER end;
+    QueryPerformanceFrequency(&frequency);
+
+    std::vector<BindlessTable::Handle> views(viewCount);
+    QueryPerformanceCounter(&start);
+    for (UINT i = 0; i < viewCount; i++)
+    {
+        views[i] = m_bindlessTable->CreateShaderResourceView(m_vertexBuffer.Get(), &srvDesc);
+    }
+    QueryPerformanceCounter(&end);
+    const double registerNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (std::max)(viewCount, 1u);
+
+    QueryPerformanceCounter(&start);
+    for (UINT i = 0; i < viewCount; i++)
+    {
+        m_bindlessTable->Release(views[i]);
+    }
+    QueryPerformanceCounter(&end);
+    const double releaseNs = 1e9 * (end.QuadPart - start.QuadPart) / frequency.QuadPart / (std::max)(viewCount, 1u);
+
+    // The slots come back once the GPU has passed the releases.
+    m_graphicsTimeline->WaitForValue(m_graphicsTimeline->Signal());
+    m_bindlessTable->Collect();
+
+    std::vector<BindlessTable::Handle> reusedViews(viewCount);
+    for (UINT i = 0; i < viewCount; i++)
+    {
+        reusedViews[i] = m_bindlessTable->CreateShaderResourceView(m_vertexBuffer.Get(), &srvDesc);
+    }
+    UINT staleCount = 0;
+    for (UINT i = 0; i < viewCount; i++)
+    {
+        staleCount += m_bindlessTable->IsValid(views[i]) ? 0 : 1;
+    }
+    for (const BindlessTable::Handle& view : reusedViews)
+    {
+        m_bindlessTable->Release(view);
+    }
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u bindless views: register %.1f ns, release %.1f ns; %u of %u stale handles rejected after reuse",
+        viewCount, registerNs, releaseNs, staleCount, viewCount);
+    SetCustomWindowText(text);
+
+    if (staleCount != viewCount)
+    {
+        OutputDebugStringW(L"Bindless table accepted a handle to a reused slot.\n");
+        ThrowIfFailed(E_FAIL);
+    }
+}
+
+// Plays a synthetic trace against the eviction policy; see RunResidencyBenchmark().
+void D3D12HelloTriangle::BenchmarkResidency()
+{
+    const ResidencyBenchmarkResult result = RunResidencyBenchmark(m_residencyBenchmarkCount);
+
+    WCHAR text[256];
+    swprintf_s(text, L"%u frames of residency: update %.1f ns, %.2f evictions and %.1f MB paged in per frame, %u frames over budget, %u violations",
+        m_residencyBenchmarkCount, result.updateNs, result.evictionsPerFrame, result.pagedInMBPerFrame, result.overBudgetFrameCount, result.violationCount);
+    SetCustomWindowText(text);
+
+    if (result.violationCount > 0)
+    {
+        OutputDebugStringW(L"Residency policy evicted a heap that was in use.\n");
+        ThrowIfFailed(E_FAIL);
+    }
+}
+
+// Writes the CPU profiler's zones to a Chrome trace file.
+void D3D12HelloTriangle::ExportTrace()
+{
+    ThrowIfFailed(CpuProfiler::ExportChromeTrace(m_tracePath.c_str()));
+}
+
+// Prepare to render the next frame.
+void D3D12HelloTriangle::MoveToNextFrame()
+{
+    // Schedule a Signal command in the queue that marks the end of the current frame.
+    m_pCurrentFrameResource->m_fenceValue = m_graphicsTimeline->Signal();
+    m_commandAllocatorPool->EndFrame(m_pCurrentFrameResource->m_fenceValue);
+    m_uploadRing->EndFrame(m_pCurrentFrameResource->m_fenceValue);
+    m_framePacer->OnPresent(m_pCurrentFrameResource->m_fenceValue);
+
+    // Advance the frame resource ring and update the back buffer index.
+    m_currentFrameResourceIndex = (m_currentFrameResourceIndex + 1) % m_framesInFlight;
+    m_pCurrentFrameResource = m_frameResources[m_currentFrameResourceIndex].get();
+    if (m_swapChain)
+    {
+        m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    }
+
+    // The CPU only has to wait when it has lapped the GPU, i.e. when the GPU
+    // has not yet finished the frame that last used this frame resource.
+    LARGE_INTEGER waitStart, waitEnd;
+    QueryPerformanceCounter(&waitStart);
+    {
+        PROFILE_ZONE("Fence wait");
+        m_graphicsTimeline->WaitForValue(m_pCurrentFrameResource->m_fenceValue);
+    }
+    QueryPerformanceCounter(&waitEnd);
+
+    // That frame's timestamps are in the readback buffer by now.
+    double gpuTime;
+    if (m_gpuProfiler->ReadFrame(m_currentFrameResourceIndex, &gpuTime))
+    {
+        m_statsGpuTime += gpuTime;
+        m_statsGpuFrameCount++;
+    }
+    if (m_pipelineStatistics)
+    {
+        m_pipelineStatistics->ReadFrame(m_currentFrameResourceIndex);
+    }
+
+    // Objects whose last use has retired can go now. Uploads queued during the
+    // frame start copying, and staging memory of finished copies is freed.
+    m_deferredReleases->Collect();
+    m_bufferAllocator->Collect();
+    m_bindlessTable->Collect();
+    m_copyUploader->Flush();
+
+    // Once the ring has filled, a frame that blocks on the GPU, in the pacer or
+    // on the frame resource, counts against the overlap check.
+    if (m_checkOverlap && m_useNullDevice)
+    {
+        if (m_overlapStartTime == 0)
+        {
+            // Until then, the count is of the frames that fill the ring.
+            if (++m_overlapFrameCount >= m_framesInFlight)
+            {
+                m_overlapFrameCount = 0;
+                m_overlapStartTime = waitEnd.QuadPart;
+                m_overlapStartGpuTicks = GetNullGpuBusyTicks();
+            }
+        }
+        else
+        {
+            const double blockedMs = 1000.0 * (m_paceWaitTime + waitEnd.QuadPart - waitStart.QuadPart) / m_timerFrequency;
+            m_overlapStalledFrameCount += blockedMs > OverlapStallThresholdMs ? 1 : 0;
+            m_overlapFrameCount++;
+            m_overlapEndTime = waitEnd.QuadPart;
+        }
+    }
+
+    UpdateFrameStatistics(waitEnd.QuadPart - waitStart.QuadPart);
+}
+
+// Fails the run unless the CPU kept running ahead of a GPU that is faster than
+// it. The conditions are checked too, so that a run that cannot tell passes
+// nothing.
+void D3D12HelloTriangle::CheckOverlap()
+{
+    if (!m_useNullDevice || m_nullGpuTimePerDraw <= 0.0f || m_framesInFlight < 2 || m_targetFrameTime > 0.0f || m_overlapFrameCount == 0)
+    {
+        OutputDebugStringW(L"The overlap check needs the null device, a GPU time per draw, at least two frames in flight, no target frame time and a frame limit.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    const double cpuFrameMs = 1000.0 * (m_overlapEndTime - m_overlapStartTime) / m_timerFrequency / m_overlapFrameCount;
+    const double gpuFrameMs = 1000.0 * (GetNullGpuBusyTicks() - m_overlapStartGpuTicks) / m_timerFrequency / m_overlapFrameCount;
+    if (gpuFrameMs >= cpuFrameMs)
+    {
+        OutputDebugStringW(L"The overlap check needs a simulated GPU faster than the CPU; lower the GPU time per draw.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    WCHAR text[256];
+    swprintf_s(text, L"overlap check: %u of %u frames blocked on the GPU, CPU %.3f ms/frame, simulated GPU %.3f ms/frame, %u frames in flight",
+        m_overlapStalledFrameCount, m_overlapFrameCount, cpuFrameMs, gpuFrameMs, m_framesInFlight);
+    SetCustomWindowText(text);
+
+    // Allow for the odd frame that the OS preempted.
+    if (m_overlapStalledFrameCount > m_overlapFrameCount / 100)
+    {
+        OutputDebugStringW(L"Overlap check failed: the CPU waited on a GPU that was faster than it.\n");
+        ThrowIfFailed(E_FAIL);
+    }
+}
+
+// Accumulates how long the CPU spent blocked on the GPU and periodically reports
+// it: the lower the wait share, the more CPU and GPU work overlaps.
+void D3D12HelloTriangle::UpdateFrameStatistics(UINT64 waitTime)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    if (m_statsFrameCount == 0)
+    {
+        m_statsStartTime = now.QuadPart;
+    }
+
+    m_statsWaitTime += waitTime;
+    m_statsFrameCount++;
+
+    const UINT64 elapsed = now.QuadPart - m_statsStartTime;
+    if (elapsed >= m_timerFrequency)
+    {
+        const FramePacer::Statistics pacing = m_framePacer->GetStatistics();
+        m_framePacer->ResetStatistics();
+
+        const UINT64 apiCallCount = m_useNullDevice ? NullApiCallCounter::GetTotal() : 0;
+        if (m_statsWarmUp)
+        {
+            m_statsWarmUp = false;
+            m_statsApiCallCount = apiCallCount;
+            ResetFrameStatistics();
+            return;
+        }
+
+        // The stress scene reports which strategy drew how many objects, so every
+        // report is one point of the scaling curve.
+        std::wstring text;
+        if (m_stressObjectCount > 0)
+        {
+            AppendFormat(text, L"%s, %u objects, ", StressStrategyNames[m_currentStressStrategy], m_stressObjectCount);
+        }
+        AppendFormat(text, L"present %s%s, %u frames in flight, %.2f ms/frame, CPU waiting on GPU %.0f%%, recording %u %s on %u threads %.3f ms, submit %.3f ms, GPU %.3f ms, latency %.2f ms",
+            PresentModeNames[m_currentPresentMode],
+            m_tearingSupported ? L" with tearing" : L"",
+            m_framesInFlight,
+            1000.0 * elapsed / m_timerFrequency / m_statsFrameCount,
+            100.0 * m_statsWaitTime / elapsed,
+            m_stressObjectCount > 0 ? m_stressObjectCount : m_drawCount,
+            m_stressObjectCount > 0 ? L"objects" : L"draws",
+            m_recorder->GetThreadCount(),
+            1000.0 * m_statsRecordTime / m_timerFrequency / m_statsFrameCount,
+            1000.0 * m_statsSubmitTime / m_timerFrequency / m_statsFrameCount,
+            m_statsGpuTime / (std::max)(m_statsGpuFrameCount, 1u),
+            pacing.averageLatencyMs);
+        if (m_useNullDevice)
+        {
+            AppendFormat(text, L", %.0f API calls/frame",
+                static_cast<double>(apiCallCount - m_statsApiCallCount) / m_statsFrameCount);
+            m_statsApiCallCount = apiCallCount;
+        }
+        const ResidencyManager::Statistics residency = m_residencyManager->GetStatistics();
+        if (m_residencyBudget > 0 || residency.policy.evictionCount > 0)
+        {
+            AppendFormat(text, L", resident %llu of %llu MB%s, %llu evictions",
+                residency.policy.residentSize / (1024 * 1024),
+                residency.budget / (1024 * 1024),
+                residency.overBudget ? L" (over budget)" : L"",
+                residency.policy.evictionCount);
+        }
+        if (m_pipelineStatistics)
+        {
+            const PipelineStatisticsCollector::Statistics& statistics = m_pipelineStatistics->GetStatistics();
+            const PipelineStatisticsCollector::PassStatistics& total = statistics.total;
+            const double frameCount = (std::max)(statistics.frameCount, 1u);
+            AppendFormat(text, L", per frame VS %.0f PS %.0f primitives %.0f clipped %.0f samples %.0f",
+                total.pipeline.VSInvocations / frameCount,
+                total.pipeline.PSInvocations / frameCount,
+                total.pipeline.IAPrimitives / frameCount,
+                total.pipeline.CPrimitives / frameCount,
+                total.samplesPassed / frameCount);
+        }
+        if (m_showZoneStatistics)
+        {
+            std::vector<CpuProfiler::ZoneStatistics> zones;
+            CpuProfiler::GetStatistics(m_statsStartTime, &zones);
+            for (const CpuProfiler::ZoneStatistics& zone : zones)
+            {
+                AppendFormat(text, L", %hs p50 %.3f p99 %.3f ms",
+                    zone.pName, zone.p50Ms, zone.p99Ms);
+            }
+        }
+        SetCustomWindowText(text.c_str());
+
+        ResetFrameStatistics();
+        if (m_stressSweep)
+        {
+            AdvanceStressSweep();
+        }
+    }
+}
+
+// Starts a new reporting period.
+void D3D12HelloTriangle::ResetFrameStatistics()
+{
+    m_statsWaitTime = 0;
+    m_statsRecordTime = 0;
+    m_statsSubmitTime = 0;
+    m_statsGpuTime = 0.0;
+    m_statsGpuFrameCount = 0;
+    m_statsFrameCount = 0;
+    if (m_pipelineStatistics)
+    {
+        m_pipelineStatistics->ResetStatistics();
+    }
 }
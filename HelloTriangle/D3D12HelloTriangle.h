@@ -12,6 +12,28 @@
 #pragma once
 
 #include "DXSample.h"
+#include "VertexFormat.h"
+#include "FrameResource.h"
+#include "UploadRing.h"
+#include "CopyQueueUploader.h"
+#include "ResidencyManager.h"
+#include "PlacedResourceAllocator.h"
+#include "DescriptorAllocator.h"
+#include "BindlessTable.h"
+#include "FenceTimeline.h"
+#include "FramePacingAdapters.h"
+#include "CommandAllocatorPool.h"
+#include "ParallelCommandRecorder.h"
+#include "NullDevice.h"
+#include "CommandStreamCapture.h"
+#include "CommandStreamReplayer.h"
+#include "ResourceStateTracker.h"
+#include "RenderGraph.h"
+#include "BundleCache.h"
+#include "IndirectCommand.h"
+#include "GpuProfiler.h"
+#include "PipelineStatistics.h"
+#include "CpuProfiler.h"
 
 using namespace DirectX;
 
@@ -31,42 +53,251 @@ public:
     virtual void OnUpdate();
     virtual void OnRender();
     virtual void OnDestroy();
+    virtual void OnKeyDown(UINT8 key);
 
 private:
     static const UINT FrameCount = 2;
+    static const UINT MaxFramesInFlight = 3;
+    static const UINT64 FrameUploadBufferSize = 64 * 1024;
+    static const UINT64 UploadRingSize = FrameUploadBufferSize * MaxFramesInFlight;
+    static const UINT UploadBenchmarkSize = 256;
+    static const UINT MaxCommittedUploadBenchmarkCount = 1024;
+    static const float ClearColor[4];
+    static const UINT BenchmarkIterations = 100;
+    static const UINT MaxStressObjectCount = 4 * 1024 * 1024;
+    static const UINT StressSweepFirstObjectCount = 1024;
+    static const UINT RtvHeapCapacity = 64;
+    static const UINT ViewHeapCapacity = 4096;
+    static const UINT DescriptorRingFrameSize = 4096;
+    static const UINT DescriptorBenchmarkTableSize = 4;
+    static const UINT BindlessTableCapacity = 256 * 1024;
+    static constexpr double OverlapStallThresholdMs = 0.1;
 
     struct Vertex
     {
         XMFLOAT3 position;
         XMFLOAT4 color;
+
+        static constexpr std::array<VertexAttribute, 2> Attributes()
+        {
+            return { {
+                VERTEX_ATTRIBUTE(Vertex, position, "POSITION", 0),
+                VERTEX_ATTRIBUTE(Vertex, color, "COLOR", 0)
+            } };
+        }
+    };
+
+    using VertexLayout = VertexInputLayout<Vertex>;
+
+    // How the stress scene submits its objects: one draw per object with its
+    // placement in root constants, one instanced draw reading the placements
+    // from a per-instance stream, one ExecuteIndirect over per-object commands,
+    // one draw of a vertex buffer holding every object already in place, or one
+    // instanced draw reading the placements from a buffer in the bindless table.
+    enum StressStrategy
+    {
+        StressStrategyPerObject,
+        StressStrategyInstanced,
+        StressStrategyIndirect,
+        StressStrategyMerged,
+        StressStrategyBindless,
+        StressStrategyCount
+    };
+
+    // How OnRender presents; see DXSample::m_presentMode.
+    enum PresentMode
+    {
+        PresentModeVsync,
+        PresentModeUncapped,
+        PresentModeWaitable,
+        PresentModeNone,
+        PresentModeCount
+    };
+
+    // Where one object of the stress scene goes.
+    struct ObjectPlacement
+    {
+        XMFLOAT3 placement;     // xy: offset, z: scale.
+
+        static constexpr std::array<VertexAttribute, 1> Attributes()
+        {
+            return { {
+                VERTEX_ATTRIBUTE(ObjectPlacement, placement, "PLACEMENT", 0)
+            } };
+        }
+    };
+
+    using InstancedVertexLayout = VertexInputLayout<Vertex, PerInstance<ObjectPlacement>>;
+
+    // One triangle draw, as ExecuteIndirect reads it from the argument buffer.
+    struct IndirectDraw
+    {
+        D3D12_VERTEX_BUFFER_VIEW vertexBuffer;
+        D3D12_DRAW_ARGUMENTS draw;
+
+        static std::array<IndirectArgument, 2> Arguments()
+        {
+            return { {
+                INDIRECT_VERTEX_BUFFER_VIEW(IndirectDraw, vertexBuffer, 0),
+                INDIRECT_DRAW(IndirectDraw, draw)
+            } };
+        }
+    };
+
+    // One object of the stress scene, as ExecuteIndirect reads it.
+    struct IndirectObjectDraw
+    {
+        XMFLOAT3 placement;
+        D3D12_DRAW_ARGUMENTS draw;
+
+        static std::array<IndirectArgument, 2> Arguments()
+        {
+            return { {
+                INDIRECT_ROOT_CONSTANTS(IndirectObjectDraw, placement, 0, 0),
+                INDIRECT_DRAW(IndirectObjectDraw, draw)
+            } };
+        }
     };
 
     // Pipeline objects.
     CD3DX12_VIEWPORT m_viewport;
     CD3DX12_RECT m_scissorRect;
     ComPtr<IDXGISwapChain3> m_swapChain;
+    PresentMode m_currentPresentMode;
+    bool m_tearingSupported;
+    HANDLE m_frameLatencyWaitableObject;                    // Only in waitable present mode.
     ComPtr<ID3D12Device> m_device;
-    ComPtr<ID3D12Resource> m_renderTargets[FrameCount];
-    ComPtr<ID3D12CommandAllocator> m_commandAllocator;
+    ComPtr<ID3D12Resource> m_renderTargets[FrameCount];     // Swap chain buffers, or offscreen targets in headless mode.
     ComPtr<ID3D12CommandQueue> m_commandQueue;
     ComPtr<ID3D12RootSignature> m_rootSignature;
-    ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+    std::unique_ptr<StagingDescriptorHeap> m_rtvHeap;
+    std::unique_ptr<StagingDescriptorHeap> m_viewHeap;
+    ComPtr<ID3D12DescriptorHeap> m_shaderVisibleHeap;
+    std::unique_ptr<ShaderVisibleDescriptorRing> m_descriptorRing;
+    std::unique_ptr<BindlessTable> m_bindlessTable;
+    bool m_bindlessSupported;
+    DescriptorHandle m_rtvs[FrameCount];
     ComPtr<ID3D12PipelineState> m_pipelineState;
     ComPtr<ID3D12GraphicsCommandList> m_commandList;
-    UINT m_rtvDescriptorSize;
+    ComPtr<ID3D12GraphicsCommandList> m_postCommandList;
+    std::unique_ptr<CommandAllocatorPool> m_commandAllocatorPool;
+    std::unique_ptr<ParallelCommandRecorder> m_recorder;
+    std::unique_ptr<ResourceStateRegistry> m_resourceStates;
+    std::unique_ptr<ResourceStateTracker> m_commandListStates;
+    std::unique_ptr<ResourceStateTracker> m_postCommandListStates;
+    std::unique_ptr<ResourceStateSubmitter> m_submitter;
+    std::unique_ptr<RenderGraph> m_renderGraph;
+    std::unique_ptr<BundleCache> m_bundleCache;
+    std::unique_ptr<GpuProfiler> m_gpuProfiler;
+    std::unique_ptr<PipelineStatisticsCollector> m_pipelineStatistics;     // Only with -pipelinestats.
+
+    // Places the DEFAULT-heap buffers in a few large heaps, which the residency
+    // manager keeps within the video memory budget. Declared before the
+    // resources so that they outlive them.
+    std::unique_ptr<ResidencyManager> m_residencyManager;
+    std::unique_ptr<PlacedResourceAllocator> m_bufferAllocator;
 
     // App resources.
+    Vertex m_triangleVertices[3];
     ComPtr<ID3D12Resource> m_vertexBuffer;
     D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
+    ComPtr<ID3D12CommandSignature> m_commandSignature;
+    ComPtr<ID3D12Resource> m_indirectArgumentBuffer;
+
+    // Stress scene resources. Every strategy has its own pipeline state; the
+    // buffers hold the objects and are rebuilt when the object count changes.
+    // The bindless strategy has a root signature of its own and no pipeline
+    // state where the binding tier cannot index unbounded arrays.
+    StressStrategy m_currentStressStrategy;
+    ComPtr<ID3D12RootSignature> m_stressRootSignature;
+    ComPtr<ID3D12RootSignature> m_bindlessRootSignature;
+    ComPtr<ID3D12PipelineState> m_stressPipelineStates[StressStrategyCount];
+    ComPtr<ID3D12CommandSignature> m_stressCommandSignature;
+    std::vector<ObjectPlacement> m_stressPlacements;
+    ComPtr<ID3D12Resource> m_stressInstanceBuffer;
+    ComPtr<ID3D12Resource> m_stressArgumentBuffer;
+    ComPtr<ID3D12Resource> m_stressMergedVertexBuffer;
+    D3D12_VERTEX_BUFFER_VIEW m_stressInstanceBufferView;
+    D3D12_VERTEX_BUFFER_VIEW m_stressMergedVertexBufferView;
+    BindlessTable::Handle m_stressPlacementsView;
+    UINT m_stressSweepLastObjectCount;
+
+    // Frame resources. The CPU records into m_pCurrentFrameResource while the GPU
+    // may still be working on up to m_framesInFlight - 1 earlier frames.
+    std::unique_ptr<FrameResource> m_frameResources[MaxFramesInFlight];
+    FrameResource* m_pCurrentFrameResource;
+    UINT m_currentFrameResourceIndex;
+    UINT m_framesInFlight;
+    std::unique_ptr<UploadRing> m_uploadRing;
+
+    // Static geometry lives in DEFAULT-heap buffers filled on the copy queue.
+    // The graphics queue waits for the latest upload the frames draw from.
+    std::unique_ptr<CopyQueueUploader> m_copyUploader;
+    UINT64 m_requiredUploadValue;
+    UINT64 m_waitedUploadValue;
 
     // Synchronization objects.
     UINT m_frameIndex;
-    HANDLE m_fenceEvent;
-    ComPtr<ID3D12Fence> m_fence;
-    UINT64 m_fenceValue;
+    std::unique_ptr<FenceTimeline> m_graphicsTimeline;
+    std::unique_ptr<DeferredReleaseQueue> m_deferredReleases;
+
+    // Frame pacing.
+    std::unique_ptr<QpcPacingClock> m_pacingClock;
+    std::unique_ptr<TimelinePacingFence> m_pacingFence;
+    std::unique_ptr<FramePacer> m_framePacer;
+
+    // Command stream capture and replay.
+    std::unique_ptr<CommandStreamObjects> m_streamObjects;
+    std::unique_ptr<CommandStreamCapture> m_capture;
+    std::unique_ptr<CommandStreamReplayer> m_replayer;
+
+    // CPU/GPU overlap statistics, reported in the window title.
+    UINT64 m_timerFrequency;
+    UINT64 m_statsStartTime;
+    UINT64 m_statsWaitTime;
+    UINT64 m_statsRecordTime;
+    UINT64 m_statsSubmitTime;
+    double m_statsGpuTime;
+    UINT m_statsGpuFrameCount;
+    UINT64 m_statsApiCallCount;
+    UINT m_statsFrameCount;
+    bool m_statsWarmUp;         // The next report still covers frames of an earlier configuration.
+
+    // Overlap check: frames after the ring filled up, those that blocked on the
+    // GPU, and the CPU and simulated GPU time they took.
+    UINT64 m_paceWaitTime;
+    UINT m_overlapFrameCount;
+    UINT m_overlapStalledFrameCount;
+    UINT64 m_overlapStartTime;
+    UINT64 m_overlapEndTime;
+    UINT64 m_overlapStartGpuTicks;
 
     void LoadPipeline();
+    void ResolvePresentMode(IDXGIFactory4* pFactory);
+    void Present();
     void LoadAssets();
+    void LoadStressScene();
+    void CreateStressBuffers();
+    void RegisterStreamObjects();
     void PopulateCommandList();
-    void WaitForPreviousFrame();
+    void RecordStressScene(const D3D12_CPU_DESCRIPTOR_HANDLE& rtvHandle);
+    void SetStressConfiguration(StressStrategy strategy, UINT objectCount);
+    void AdvanceStressSweep();
+    void WaitForUploads();
+    void MoveToNextFrame();
+    void WaitForGpu();
+    void ReadBackLastFrame();
+    void BenchmarkRenderGraph();
+    void BenchmarkBundles();
+    void BenchmarkZones();
+    void BenchmarkUploads();
+    void BenchmarkAllocator();
+    void BenchmarkDescriptors();
+    void BenchmarkBindless();
+    void BenchmarkResidency();
+    void ExportTrace();
+    StaticDrawKey GetTriangleDrawKey(UINT drawCount) const;
+    void UpdateFrameStatistics(UINT64 waitTime);
+    void ResetFrameStatistics();
+    void CheckOverlap();
 };
@@ -18,7 +18,35 @@ DXSample::DXSample(UINT width, UINT height, std::wstring name) :
     m_width(width),
     m_height(height),
     m_title(name),
-    m_useWarpDevice(false)
+    m_useWarpDevice(false),
+    m_useNullDevice(false),
+    m_nullGpuTimePerDraw(0.0f),
+    m_frameLatency(2),
+    m_targetFrameTime(0.0f),
+    m_maxQueuedFrames(1),
+    m_recordingThreadCount(1),
+    m_drawCount(1),
+    m_useBundles(false),
+    m_useIndirect(false),
+    m_headless(false),
+    m_frameLimit(0),
+    m_renderGraphBenchmarkPasses(0),
+    m_bundleBenchmarkDraws(0),
+    m_stressObjectCount(0),
+    m_stressStrategy(L"perobject"),
+    m_stressSweep(false),
+    m_showZoneStatistics(false),
+    m_zoneBenchmarkCount(0),
+    m_collectPipelineStatistics(false),
+    m_presentMode(L"vsync"),
+    m_useDynamicVertices(false),
+    m_uploadBenchmarkCount(0),
+    m_allocatorBenchmarkCount(0),
+    m_descriptorBenchmarkCount(0),
+    m_bindlessBenchmarkCount(0),
+    m_residencyBudget(0),
+    m_residencyBenchmarkCount(0),
+    m_checkOverlap(false)
 {
     WCHAR assetsPath[512];
     GetAssetsPath(assetsPath, _countof(assetsPath));
@@ -72,7 +100,16 @@ void DXSample::GetHardwareAdapter(IDXGIFactory2* pFactory, IDXGIAdapter1** ppAda
 void DXSample::SetCustomWindowText(LPCWSTR text)
 {
     std::wstring windowText = m_title + L": " + text;
-    SetWindowText(Win32Application::GetHwnd(), windowText.c_str());
+    if (m_headless)
+    {
+        // There is no window; report to the console and the debugger instead.
+        wprintf(L"%s\n", windowText.c_str());
+        OutputDebugStringW((windowText + L"\n").c_str());
+    }
+    else
+    {
+        SetWindowText(Win32Application::GetHwnd(), windowText.c_str());
+    }
 }
 
 // Helper function for parsing any supplied command line args.
@@ -87,5 +124,171 @@ void DXSample::ParseCommandLineArgs(WCHAR* argv[], int argc)
             m_useWarpDevice = true;
             m_title = m_title + L" (WARP)";
         }
+        else if (_wcsnicmp(argv[i], L"-nulldevice", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/nulldevice", wcslen(argv[i])) == 0)
+        {
+            m_useNullDevice = true;
+            m_title = m_title + L" (Null device)";
+        }
+        else if ((_wcsnicmp(argv[i], L"-nullgputime", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/nullgputime", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_nullGpuTimePerDraw = static_cast<float>(_wtof(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-latency", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/latency", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_frameLatency = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-targetframetime", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/targetframetime", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_targetFrameTime = static_cast<float>(_wtof(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-maxqueued", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/maxqueued", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_maxQueuedFrames = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-threads", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/threads", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_recordingThreadCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-draws", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/draws", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_drawCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if (_wcsnicmp(argv[i], L"-bundles", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/bundles", wcslen(argv[i])) == 0)
+        {
+            m_useBundles = true;
+            m_title = m_title + L" (Bundles)";
+        }
+        else if (_wcsnicmp(argv[i], L"-indirect", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/indirect", wcslen(argv[i])) == 0)
+        {
+            m_useIndirect = true;
+            m_title = m_title + L" (ExecuteIndirect)";
+        }
+        else if (_wcsnicmp(argv[i], L"-headless", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/headless", wcslen(argv[i])) == 0)
+        {
+            m_headless = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-frames", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/frames", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_frameLimit = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-readback", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/readback", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_readbackPath = argv[++i];
+        }
+        else if ((_wcsnicmp(argv[i], L"-capture", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/capture", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_capturePath = argv[++i];
+        }
+        else if ((_wcsnicmp(argv[i], L"-replay", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/replay", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_replayPath = argv[++i];
+            m_headless = true;
+            m_title = m_title + L" (Replay)";
+        }
+        else if ((_wcsnicmp(argv[i], L"-graphbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/graphbench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_renderGraphBenchmarkPasses = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-bundlebench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/bundlebench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_bundleBenchmarkDraws = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-stress", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/stress", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_stressObjectCount = static_cast<UINT>(_wtoi(argv[++i]));
+            m_title = m_title + L" (Stress)";
+        }
+        else if ((_wcsnicmp(argv[i], L"-strategy", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/strategy", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_stressStrategy = argv[++i];
+        }
+        else if (_wcsnicmp(argv[i], L"-stresssweep", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/stresssweep", wcslen(argv[i])) == 0)
+        {
+            m_stressSweep = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-trace", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/trace", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_tracePath = argv[++i];
+        }
+        else if (_wcsnicmp(argv[i], L"-zones", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/zones", wcslen(argv[i])) == 0)
+        {
+            m_showZoneStatistics = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-zonebench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/zonebench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_zoneBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if (_wcsnicmp(argv[i], L"-pipelinestats", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/pipelinestats", wcslen(argv[i])) == 0)
+        {
+            m_collectPipelineStatistics = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-present", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/present", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_presentMode = argv[++i];
+        }
+        else if (_wcsnicmp(argv[i], L"-dynamic", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/dynamic", wcslen(argv[i])) == 0)
+        {
+            m_useDynamicVertices = true;
+        }
+        else if ((_wcsnicmp(argv[i], L"-uploadbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/uploadbench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_uploadBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-allocbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/allocbench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_allocatorBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-descriptorbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/descriptorbench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_descriptorBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-bindlessbench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/bindlessbench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_bindlessBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-residencybudget", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/residencybudget", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_residencyBudget = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if ((_wcsnicmp(argv[i], L"-residencybench", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/residencybench", wcslen(argv[i])) == 0) && i + 1 < argc)
+        {
+            m_residencyBenchmarkCount = static_cast<UINT>(_wtoi(argv[++i]));
+        }
+        else if (_wcsnicmp(argv[i], L"-overlapcheck", wcslen(argv[i])) == 0 ||
+            _wcsnicmp(argv[i], L"/overlapcheck", wcslen(argv[i])) == 0)
+        {
+            m_checkOverlap = true;
+        }
     }
 }
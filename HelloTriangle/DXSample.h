@@ -33,6 +33,8 @@ public:
     UINT GetWidth() const           { return m_width; }
     UINT GetHeight() const          { return m_height; }
     const WCHAR* GetTitle() const   { return m_title.c_str(); }
+    bool IsHeadless() const         { return m_headless; }
+    UINT GetFrameLimit() const      { return m_frameLimit; }
 
     void ParseCommandLineArgs(_In_reads_(argc) WCHAR* argv[], int argc);
 
@@ -46,8 +48,115 @@ protected:
     UINT m_height;
     float m_aspectRatio;
 
-    // Adapter info.
+    // Adapter info. The null device does no GPU work and optionally simulates
+    // a GPU that takes the given time per draw.
     bool m_useWarpDevice;
+    bool m_useNullDevice;
+    float m_nullGpuTimePerDraw;
+
+    // Number of frames the CPU may record ahead of the GPU.
+    UINT m_frameLatency;
+
+    // Frame pacing: target frame time in milliseconds (0 for none) and the number
+    // of frames the GPU may still have queued when the CPU starts a new one.
+    float m_targetFrameTime;
+    UINT m_maxQueuedFrames;
+
+    // Command recording workload. With bundles, the draws are recorded into
+    // bundles once and each command list replays one; with ExecuteIndirect, each
+    // command list issues its draws from an argument buffer in a single call.
+    UINT m_recordingThreadCount;
+    UINT m_drawCount;
+    bool m_useBundles;
+    bool m_useIndirect;
+
+    // Headless mode renders into offscreen targets without a window or swap chain
+    // and writes the final image to the readback path, if any, on exit. A frame
+    // limit of 0 renders until the window is closed.
+    bool m_headless;
+    UINT m_frameLimit;
+    std::wstring m_readbackPath;
+
+    // Command stream capture and replay. Capturing writes every submitted command
+    // list to the capture path on exit, plus a text dump next to it; replaying
+    // re-issues a captured stream, in headless mode, instead of recording frames.
+    std::wstring m_capturePath;
+    std::wstring m_replayPath;
+
+    // Number of passes of the synthetic render graph whose compile time is
+    // measured at startup; 0 to skip the benchmark.
+    UINT m_renderGraphBenchmarkPasses;
+
+    // Number of draws whose direct and bundle recording costs are compared at
+    // startup; 0 to skip the benchmark.
+    UINT m_bundleBenchmarkDraws;
+
+    // Stress scene: the number of objects to draw instead of the triangle (0 for
+    // the regular scene) and how their draws are submitted: "perobject",
+    // "instanced", "indirect", "merged" or "bindless". A sweep measures every
+    // strategy at a growing object count, up to the given one.
+    UINT m_stressObjectCount;
+    std::wstring m_stressStrategy;
+    bool m_stressSweep;
+
+    // CPU and GPU profiling. Zones are always recorded, GPU regions on a track of
+    // their own; the trace path, if any, receives a Chrome trace of the recent
+    // zones on exit and whenever T is pressed, and
+    // zone statistics add each zone's percentiles to the frame report. The zone
+    // benchmark measures the cost of a zone at startup; 0 to skip it.
+    std::wstring m_tracePath;
+    bool m_showZoneStatistics;
+    UINT m_zoneBenchmarkCount;
+
+    // Counts shader invocations, primitives and samples per pass with pipeline
+    // statistics and occlusion queries, and adds the per-frame averages to the
+    // frame report.
+    bool m_collectPipelineStatistics;
+
+    // How frames reach the screen: vsync, uncapped (tearing where supported),
+    // waitable (the CPU waits on the swap chain before starting a frame) or none
+    // (frames render into offscreen targets and are never presented). Headless
+    // mode always uses none.
+    std::wstring m_presentMode;
+
+    // Transient uploads. With dynamic vertices, the triangle is copied into the
+    // upload ring every frame instead of drawn from its static vertex buffer;
+    // this turns off bundles and has no effect with ExecuteIndirect or while
+    // capturing. The upload benchmark compares ring allocations against a
+    // committed resource per upload at startup; 0 to skip it.
+    bool m_useDynamicVertices;
+    UINT m_uploadBenchmarkCount;
+
+    // Number of placements the placed resource allocator's bookkeeping is churned
+    // with at startup, measuring allocation, free and defragmentation; 0 to skip
+    // the benchmark.
+    UINT m_allocatorBenchmarkCount;
+
+    // Number of descriptor tables per frame the descriptor allocators build at
+    // startup, once from a single batched copy and once with a copy per
+    // descriptor; 0 to skip the benchmark. Staging allocations are hammered from
+    // every recording thread at once, and on the null device the copied
+    // descriptors are checked against their sources.
+    UINT m_descriptorBenchmarkCount;
+
+    // Number of views registered in, released from and registered again in the
+    // bindless table at startup, measuring both and checking that the released
+    // handles no longer validate; 0 to skip the benchmark.
+    UINT m_bindlessBenchmarkCount;
+
+    // Video memory budget in MB for the placed buffer heaps, as a cap on the one
+    // the OS grants; 0 for the OS's alone. The frame report then includes the
+    // resident size and evictions. The residency benchmark plays a simulated
+    // trace of the given number of frames against the eviction policy at
+    // startup and fails if it ever evicts a heap in use; 0 to skip it.
+    UINT m_residencyBudget;
+    UINT m_residencyBenchmarkCount;
+
+    // Checks on exit that the frame resource ring let the CPU run ahead of the
+    // GPU: with a simulated GPU that is faster than the CPU and at least two
+    // frames in flight, hardly any frame may have waited on the GPU. Needs the
+    // null device with a GPU time per draw; fails the run otherwise.
+    bool m_checkOverlap;
 
 private:
     // Root assets path.
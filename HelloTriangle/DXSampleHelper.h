@@ -105,6 +105,59 @@ inline HRESULT ReadDataFromFile(LPCWSTR filename, byte** data, UINT* size)
     return S_OK;
 }
 
+// Writes 8-bit RGBA pixels, as read back from a DXGI_FORMAT_R8G8B8A8_UNORM
+// texture, to a 32-bit top-down .bmp file.
+inline HRESULT WriteBitmapToFile(LPCWSTR filename, UINT width, UINT height, const void* pPixels, UINT rowPitch)
+{
+    using namespace Microsoft::WRL;
+
+    const UINT imageSize = width * height * 4;
+
+    BITMAPFILEHEADER fileHeader = {};
+    fileHeader.bfType = 0x4D42;     // 'BM'
+    fileHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+    fileHeader.bfSize = fileHeader.bfOffBits + imageSize;
+
+    BITMAPINFOHEADER infoHeader = {};
+    infoHeader.biSize = sizeof(BITMAPINFOHEADER);
+    infoHeader.biWidth = static_cast<LONG>(width);
+    infoHeader.biHeight = -static_cast<LONG>(height);   // Negative height means top-down rows.
+    infoHeader.biPlanes = 1;
+    infoHeader.biBitCount = 32;
+    infoHeader.biCompression = BI_RGB;
+    infoHeader.biSizeImage = imageSize;
+
+    // Bitmaps store BGRA and have no row padding.
+    std::vector<UINT8> image(imageSize);
+    for (UINT y = 0; y < height; y++)
+    {
+        const UINT8* pSource = static_cast<const UINT8*>(pPixels) + static_cast<size_t>(y) * rowPitch;
+        UINT8* pDest = image.data() + static_cast<size_t>(y) * width * 4;
+        for (UINT x = 0; x < width; x++, pSource += 4, pDest += 4)
+        {
+            pDest[0] = pSource[2];
+            pDest[1] = pSource[1];
+            pDest[2] = pSource[0];
+            pDest[3] = pSource[3];
+        }
+    }
+
+    Wrappers::FileHandle file(CreateFile2(filename, GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr));
+    if (file.Get() == INVALID_HANDLE_VALUE)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    if (!WriteFile(file.Get(), &fileHeader, sizeof(fileHeader), nullptr, nullptr) ||
+        !WriteFile(file.Get(), &infoHeader, sizeof(infoHeader), nullptr, nullptr) ||
+        !WriteFile(file.Get(), image.data(), imageSize, nullptr, nullptr))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    return S_OK;
+}
+
 // Assign a name to the object to aid with debugging.
 #if defined(_DEBUG) || defined(DBG)
 inline void SetName(ID3D12Object* pObject, LPCWSTR name)
@@ -0,0 +1,135 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "DescriptorAllocator.h"
+
+StagingDescriptorHeap::StagingDescriptorHeap(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity) :
+    m_freeList(capacity),
+    m_allocatedCount(0)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = capacity;
+    heapDesc.Type = type;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(pDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+    NAME_D3D12_OBJECT(m_heap);
+
+    m_start = m_heap->GetCPUDescriptorHandleForHeapStart();
+    m_descriptorSize = pDevice->GetDescriptorHandleIncrementSize(type);
+}
+
+DescriptorHandle StagingDescriptorHeap::Allocate()
+{
+    const UINT32 index = m_freeList.Pop();
+    if (index == DescriptorIndexFreeList::InvalidIndex)
+    {
+        OutputDebugStringW(L"Staging descriptor heap is full.\n");
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    m_allocatedCount.fetch_add(1, std::memory_order_relaxed);
+
+    DescriptorHandle handle;
+    handle.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_start, index, m_descriptorSize);
+    handle.index = index;
+    return handle;
+}
+
+void StagingDescriptorHeap::Free(const DescriptorHandle& handle)
+{
+    m_allocatedCount.fetch_sub(1, std::memory_order_relaxed);
+    m_freeList.Push(handle.index);
+}
+
+_Use_decl_annotations_
+void DescriptorCopyBatch::Add(D3D12_CPU_DESCRIPTOR_HANDLE destination, const D3D12_CPU_DESCRIPTOR_HANDLE* pSources, UINT count)
+{
+    m_destinationStarts.push_back(destination);
+    m_destinationSizes.push_back(count);
+    m_sourceStarts.insert(m_sourceStarts.end(), pSources, pSources + count);
+}
+
+void DescriptorCopyBatch::Flush(ID3D12Device* pDevice)
+{
+    if (m_sourceStarts.empty())
+    {
+        return;
+    }
+
+    if (m_sourceSizes.size() < m_sourceStarts.size())
+    {
+        m_sourceSizes.resize(m_sourceStarts.size(), 1);
+    }
+    pDevice->CopyDescriptors(
+        static_cast<UINT>(m_destinationStarts.size()), m_destinationStarts.data(), m_destinationSizes.data(),
+        static_cast<UINT>(m_sourceStarts.size()), m_sourceStarts.data(), m_sourceSizes.data(),
+        m_type);
+
+    m_destinationStarts.clear();
+    m_destinationSizes.clear();
+    m_sourceStarts.clear();
+}
+
+ShaderVisibleDescriptorRing::ShaderVisibleDescriptorRing(ID3D12Device* pDevice, ID3D12DescriptorHeap* pHeap, UINT firstDescriptor, UINT descriptorCount, UINT frameCount) :
+    m_heap(pHeap),
+    m_frameCapacity(descriptorCount / frameCount),
+    m_frameStart(0),
+    m_usedCount(0)
+{
+    const D3D12_DESCRIPTOR_HEAP_DESC heapDesc = pHeap->GetDesc();
+    if (!(heapDesc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) || firstDescriptor + descriptorCount > heapDesc.NumDescriptors)
+    {
+        OutputDebugStringW(L"Descriptor ring needs a range of a shader-visible heap.\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    m_descriptorSize = pDevice->GetDescriptorHandleIncrementSize(heapDesc.Type);
+    m_cpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(pHeap->GetCPUDescriptorHandleForHeapStart(), firstDescriptor, m_descriptorSize);
+    m_gpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(pHeap->GetGPUDescriptorHandleForHeapStart(), firstDescriptor, m_descriptorSize);
+}
+
+void ShaderVisibleDescriptorRing::BeginFrame(UINT frameIndex)
+{
+    m_frameStart = frameIndex * m_frameCapacity;
+    m_usedCount.store(0, std::memory_order_relaxed);
+}
+
+_Use_decl_annotations_
+bool ShaderVisibleDescriptorRing::Allocate(UINT count, DescriptorTable* pTable)
+{
+    *pTable = {};
+
+    // A failed allocation leaves the count past the capacity, so every later
+    // one fails too until the next frame.
+    const UINT offset = m_usedCount.fetch_add(count, std::memory_order_relaxed);
+    if (offset + count > m_frameCapacity || offset + count < offset)
+    {
+        return false;
+    }
+
+    pTable->cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cpuStart, m_frameStart + offset, m_descriptorSize);
+    pTable->gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_gpuStart, m_frameStart + offset, m_descriptorSize);
+    return true;
+}
+
+_Use_decl_annotations_
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorRing::CopyTable(DescriptorCopyBatch* pBatch, const D3D12_CPU_DESCRIPTOR_HANDLE* pSources, UINT count)
+{
+    DescriptorTable table;
+    if (!Allocate(count, &table))
+    {
+        OutputDebugStringW(L"Descriptor ring ran out of room for the frame.\n");
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+    pBatch->Add(table.cpuHandle, pSources, count);
+    return table.gpuHandle;
+}
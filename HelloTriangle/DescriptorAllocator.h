@@ -0,0 +1,128 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "DXSampleHelper.h"
+#include "DescriptorIndexFreeList.h"
+
+// Descriptor management in three parts:
+//
+// - StagingDescriptorHeap hands out single descriptors of a CPU-only heap, where
+//   RTVs and DSVs live and where CBVs, SRVs and UAVs are created before the
+//   shaders get to see them.
+// - ShaderVisibleDescriptorRing hands out the descriptor tables a frame binds,
+//   carved linearly out of that frame's share of a shader-visible heap.
+// - DescriptorCopyBatch gathers the copies from staging descriptors into the
+//   ring and issues them with a single CopyDescriptors call.
+//
+// Allocation is O(1) and lock-free in both heaps, so recording threads can share
+// them. Descriptors are consumed when commands are recorded (CPU handles) or
+// when the GPU executes them (shader-visible ones), which is why staging
+// descriptors may be freed right after recording while the ring recycles a
+// frame's share only once the GPU is done with the frame.
+
+struct DescriptorHandle
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle;
+    UINT32 index;
+};
+
+// A fixed-size CPU-only descriptor heap with a free list. Allocate() and Free()
+// may be called from any thread.
+class StagingDescriptorHeap
+{
+public:
+    StagingDescriptorHeap(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity);
+
+    // Throws when the heap is full.
+    DescriptorHandle Allocate();
+    void Free(const DescriptorHandle& handle);
+
+    ID3D12DescriptorHeap* GetHeap() const   { return m_heap.Get(); }
+    UINT GetDescriptorSize() const          { return m_descriptorSize; }
+    UINT GetAllocatedCount() const          { return m_allocatedCount.load(std::memory_order_relaxed); }
+
+private:
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_start;
+    UINT m_descriptorSize;
+    DescriptorIndexFreeList m_freeList;
+    std::atomic<UINT> m_allocatedCount;
+};
+
+// Descriptors of a shader-visible heap: the CPU handle to write them with and
+// the GPU handle to bind them with.
+struct DescriptorTable
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle;
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle;
+};
+
+// Copies descriptors from wherever they were created into consecutive
+// descriptors of another heap. The copies happen on the CPU timeline, so they
+// only have to be flushed before the command lists using them are executed.
+// One batch per recording thread; not thread safe.
+class DescriptorCopyBatch
+{
+public:
+    explicit DescriptorCopyBatch(D3D12_DESCRIPTOR_HEAP_TYPE type) : m_type(type) {}
+
+    void Add(D3D12_CPU_DESCRIPTOR_HANDLE destination, _In_reads_(count) const D3D12_CPU_DESCRIPTOR_HANDLE* pSources, UINT count);
+
+    // Issues every queued copy with one CopyDescriptors call.
+    void Flush(ID3D12Device* pDevice);
+
+    UINT GetPendingCount() const            { return static_cast<UINT>(m_sourceStarts.size()); }
+
+private:
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_destinationStarts;
+    std::vector<UINT> m_destinationSizes;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_sourceStarts;
+    std::vector<UINT> m_sourceSizes;        // All ones; every source is a descriptor of its own.
+};
+
+// Per-frame descriptor tables in a range of a shader-visible heap. Every frame
+// in flight owns an equal share of the range and allocates linearly from it;
+// BeginFrame() starts over once the GPU is done with the frame that last used
+// the share. Allocate() may be called from any thread.
+class ShaderVisibleDescriptorRing
+{
+public:
+    ShaderVisibleDescriptorRing(ID3D12Device* pDevice, ID3D12DescriptorHeap* pHeap, UINT firstDescriptor, UINT descriptorCount, UINT frameCount);
+
+    void BeginFrame(UINT frameIndex);
+
+    // Returns false when the frame's share is used up.
+    bool Allocate(UINT count, _Out_ DescriptorTable* pTable);
+
+    // Allocates a table and queues copying the sources into it. Throws when the
+    // frame's share is used up.
+    D3D12_GPU_DESCRIPTOR_HANDLE CopyTable(DescriptorCopyBatch* pBatch, _In_reads_(count) const D3D12_CPU_DESCRIPTOR_HANDLE* pSources, UINT count);
+
+    ID3D12DescriptorHeap* GetHeap() const   { return m_heap.Get(); }
+    UINT GetFrameCapacity() const           { return m_frameCapacity; }
+    UINT GetUsedCount() const               { return (std::min)(m_usedCount.load(std::memory_order_relaxed), m_frameCapacity); }
+
+private:
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart;
+    UINT m_descriptorSize;
+    UINT m_frameCapacity;
+    UINT m_frameStart;                  // First descriptor of the current frame's share, relative to the range.
+    std::atomic<UINT> m_usedCount;
+};
@@ -0,0 +1,76 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// A lock-free stack of free indices. The head carries a tag that changes with
+// every update, so that a thread holding a stale head cannot succeed in
+// swapping it after another thread popped and pushed the same index (ABA).
+// Tests/DescriptorIndexFreeListTests.cpp hammers it from several threads.
+class DescriptorIndexFreeList
+{
+public:
+    static const uint32_t InvalidIndex = UINT32_MAX;
+
+    explicit DescriptorIndexFreeList(uint32_t capacity) :
+        m_next(std::make_unique<std::atomic<uint32_t>[]>(capacity)),
+        m_head(Pack(0, capacity > 0 ? 0 : InvalidIndex))
+    {
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            m_next[i].store(i + 1 < capacity ? i + 1 : InvalidIndex, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns InvalidIndex when every index is taken.
+    uint32_t Pop()
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint32_t index = Index(head);
+            if (index == InvalidIndex)
+            {
+                return InvalidIndex;
+            }
+
+            // The next index may be stale if another thread pops concurrently; the
+            // tag makes the exchange fail in that case.
+            const uint32_t next = m_next[index].load(std::memory_order_relaxed);
+            if (m_head.compare_exchange_weak(head, Pack(Tag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return index;
+            }
+        }
+    }
+
+    void Push(uint32_t index)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        do
+        {
+            m_next[index].store(Index(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, Pack(Tag(head) + 1, index), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+private:
+    static uint64_t Pack(uint32_t tag, uint32_t index)    { return (uint64_t(tag) << 32) | index; }
+    static uint32_t Tag(uint64_t head)                  { return static_cast<uint32_t>(head >> 32); }
+    static uint32_t Index(uint64_t head)                { return static_cast<uint32_t>(head); }
+
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint64_t> m_head;     // Tag in the high half, index in the low half.
+};
@@ -0,0 +1,171 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "FenceTimeline.h"
+
+FenceTimeline::FenceTimeline(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue) :
+    m_queue(pQueue),
+    m_fenceEvent(nullptr),
+    m_nextValue(1),
+    m_completedValue(0)
+{
+    ThrowIfFailed(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+
+    // Create an event handle to use for waiting on the fence.
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr)
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+FenceTimeline::~FenceTimeline()
+{
+    CloseHandle(m_fenceEvent);
+}
+
+UINT64 FenceTimeline::Signal()
+{
+    const UINT64 value = m_nextValue;
+    ThrowIfFailed(m_queue->Signal(m_fence.Get(), value));
+    m_nextValue++;
+    return value;
+}
+
+bool FenceTimeline::IsCompleted(UINT64 value)
+{
+    if (value <= m_completedValue.load(std::memory_order_acquire))
+    {
+        return true;
+    }
+    return value <= GetCompletedValue();
+}
+
+UINT64 FenceTimeline::GetCompletedValue()
+{
+    // Other threads may refresh the cache concurrently; only ever move it forward.
+    const UINT64 completed = m_fence->GetCompletedValue();
+    UINT64 cached = m_completedValue.load(std::memory_order_acquire);
+    while (cached < completed && !m_completedValue.compare_exchange_weak(cached, completed, std::memory_order_acq_rel))
+    {
+    }
+    return (std::max)(cached, completed);
+}
+
+void FenceTimeline::WaitForValue(UINT64 value)
+{
+    if (!IsCompleted(value))
+    {
+        ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_fenceEvent));
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+        GetCompletedValue();
+    }
+}
+
+void FenceTimeline::QueueWait(ID3D12CommandQueue* pQueue, UINT64 value) const
+{
+    ThrowIfFailed(pQueue->Wait(m_fence.Get(), value));
+}
+
+_Use_decl_annotations_
+void FenceTimeline::WaitForAll(const WaitPoint* pWaitPoints, UINT count)
+{
+    HANDLE events[MAXIMUM_WAIT_OBJECTS];
+    UINT eventCount = 0;
+
+    for (UINT i = 0; i < count; i++)
+    {
+        FenceTimeline* pTimeline = pWaitPoints[i].pTimeline;
+        if (pTimeline->IsCompleted(pWaitPoints[i].value))
+        {
+            continue;
+        }
+
+        // Each timeline owns a single event, so a timeline listed more than once
+        // only needs to wait for its largest value.
+        UINT64 value = pWaitPoints[i].value;
+        bool alreadyQueued = false;
+        for (UINT j = 0; j < count; j++)
+        {
+            if (pWaitPoints[j].pTimeline == pTimeline && (pWaitPoints[j].value > value || (pWaitPoints[j].value == value && j < i)))
+            {
+                alreadyQueued = true;
+                break;
+            }
+        }
+        if (alreadyQueued)
+        {
+            continue;
+        }
+
+        if (eventCount == MAXIMUM_WAIT_OBJECTS)
+        {
+            WaitForMultipleObjects(eventCount, events, TRUE, INFINITE);
+            eventCount = 0;
+        }
+
+        ThrowIfFailed(pTimeline->m_fence->SetEventOnCompletion(value, pTimeline->m_fenceEvent));
+        events[eventCount++] = pTimeline->m_fenceEvent;
+    }
+
+    if (eventCount > 0)
+    {
+        WaitForMultipleObjects(eventCount, events, TRUE, INFINITE);
+    }
+
+    for (UINT i = 0; i < count; i++)
+    {
+        pWaitPoints[i].pTimeline->GetCompletedValue();
+    }
+}
+
+DeferredReleaseQueue::DeferredReleaseQueue(FenceTimeline* pTimeline) :
+    m_pTimeline(pTimeline),
+    m_pending(pTimeline)
+{
+}
+
+DeferredReleaseQueue::~DeferredReleaseQueue()
+{
+    // Dropping objects the GPU may still be using would be a bug in the owner.
+    assert(m_pending.IsEmpty());
+}
+
+void DeferredReleaseQueue::Release(IUnknown* pObject, UINT64 lastUseValue)
+{
+    if (pObject == nullptr)
+    {
+        return;
+    }
+
+    if (m_pTimeline->IsCompleted(lastUseValue))
+    {
+        pObject->Release();
+        return;
+    }
+
+    // Takes over the caller's reference.
+    ComPtr<IUnknown> object;
+    object.Attach(pObject);
+    m_pending.Push(lastUseValue, std::move(object));
+}
+
+// Dropping the queue's reference is all there is to retiring an object.
+void DeferredReleaseQueue::Collect()
+{
+    m_pending.Collect([](ComPtr<IUnknown>&) {});
+}
+
+void DeferredReleaseQueue::Flush()
+{
+    m_pending.Flush([](ComPtr<IUnknown>&) {});
+}
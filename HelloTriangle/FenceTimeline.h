@@ -0,0 +1,99 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include "DXSampleHelper.h"
+#include "RetireQueue.h"
+
+// A monotonically increasing fence timeline for a single command queue. Every
+// Signal() hands out the next value, so "has the GPU finished X" becomes a
+// comparison against the value that was current when X was submitted.
+//
+// Signal() must be called from the thread that submits to the queue; the
+// completion queries may be called from any thread.
+class FenceTimeline
+{
+public:
+    FenceTimeline(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue);
+    ~FenceTimeline();
+
+    // Enqueues a signal of the next value on the queue and returns that value.
+    UINT64 Signal();
+
+    // The value the next Signal() will use. Work submitted now completes at or
+    // before this value.
+    UINT64 GetNextValue() const         { return m_nextValue; }
+    UINT64 GetLastSignaledValue() const { return m_nextValue - 1; }
+
+    // Polls for completion. Only touches the fence when the cached completed
+    // value is behind the one asked for.
+    bool IsCompleted(UINT64 value);
+    UINT64 GetCompletedValue();
+
+    // Blocks the calling thread until the value has completed.
+    void WaitForValue(UINT64 value);
+
+    // Blocks until everything signaled so far has completed. Does not signal.
+    void WaitForIdle()                  { WaitForValue(GetLastSignaledValue()); }
+
+    // Makes another queue wait on the GPU for a value of this timeline.
+    void QueueWait(ID3D12CommandQueue* pQueue, UINT64 value) const;
+
+    ID3D12CommandQueue* GetQueue() const { return m_queue.Get(); }
+    ID3D12Fence* GetFence() const       { return m_fence.Get(); }
+
+    // A value on a timeline; used to wait on several timelines at once.
+    struct WaitPoint
+    {
+        FenceTimeline* pTimeline;
+        UINT64 value;
+    };
+
+    // Blocks until every wait point has completed, with a single OS wait.
+    static void WaitForAll(_In_reads_(count) const WaitPoint* pWaitPoints, UINT count);
+
+private:
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceEvent;
+    UINT64 m_nextValue;
+    std::atomic<UINT64> m_completedValue;
+};
+
+// Holds on to objects the GPU may still reference and releases them once the
+// timeline passes their last use, so freeing a resource never needs a GPU flush.
+class DeferredReleaseQueue
+{
+public:
+    explicit DeferredReleaseQueue(FenceTimeline* pTimeline);
+    ~DeferredReleaseQueue();
+
+    // Releases the object once the timeline reaches lastUseValue.
+    void Release(IUnknown* pObject, UINT64 lastUseValue);
+
+    // Releases the object once all work submitted so far has completed.
+    void Release(IUnknown* pObject)     { Release(pObject, m_pTimeline->GetNextValue()); }
+
+    // Drops every object whose last use has completed. Cheap when nothing retired.
+    void Collect();
+
+    // Waits for the last use of every object, signaling the timeline first if
+    // that has not been signaled yet, and drops everything; used at shutdown.
+    void Flush();
+
+    size_t GetPendingCount() const      { return m_pending.GetCount(); }
+
+private:
+    FenceTimeline* m_pTimeline;
+    RetireQueue<ComPtr<IUnknown>, FenceTimeline> m_pending;
+};
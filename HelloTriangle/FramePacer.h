@@ -0,0 +1,260 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+
+// Decides when the CPU should start working on the next frame.
+//
+// Starting as early as possible maximizes throughput but lets frames queue up
+// behind the GPU, and every queued frame is a frame of input latency. The pacer
+// instead lets at most maxQueuedFrames frames be outstanding on the GPU when a
+// frame starts, and then delays the start further so the frame's submission
+// lands just before the GPU runs out of queued work. The delay is predicted from
+// moving averages of the CPU and GPU frame times minus a safety margin; the
+// margin grows whenever a submission finds the GPU idle (starved) and slowly
+// shrinks otherwise. A target frame time additionally caps the frame rate.
+//
+// GPU frame times are sampled when the pacer actually blocked on a frame's
+// fence, because only then is the completion time known rather than an upper
+// bound. Frames that completed without a wait still give an upper bound, which
+// can only bring the estimate down; otherwise a GPU that got faster would keep
+// the CPU held back for its old frame time.
+//
+// The controller only talks to time and to the GPU through the Clock and Fence
+// interfaces; Tests/FramePacerTests.cpp drives it with simulated ones.
+class FramePacer
+{
+public:
+    class Clock
+    {
+    public:
+        virtual ~Clock() {}
+        virtual int64_t GetTicks() = 0;
+        virtual int64_t GetFrequency() = 0;
+        virtual void SleepUntil(int64_t ticks) = 0;
+    };
+
+    class Fence
+    {
+    public:
+        virtual ~Fence() {}
+        virtual uint64_t GetCompletedValue() = 0;
+        virtual void WaitForValue(uint64_t value) = 0;
+    };
+
+    struct Statistics
+    {
+        uint64_t frameCount;
+        double averageLatencyMs;        // CPU frame start to present.
+        double averageFrameIntervalMs;  // Frame start to frame start.
+        double averageSleepMs;          // Time BeginFrame held the CPU back.
+        double safetyMarginMs;
+        uint32_t starvedFrames;         // Held-back frames whose submission found the GPU idle.
+    };
+
+    // A targetFrameTimeMs of 0 paces to the GPU alone. maxQueuedFrames is the
+    // number of frames the GPU may still have outstanding when a frame starts;
+    // 0 fully serializes CPU and GPU.
+    FramePacer(Clock* pClock, Fence* pFence, double targetFrameTimeMs, uint32_t maxQueuedFrames) :
+        m_pClock(pClock),
+        m_pFence(pFence),
+        m_frequency(static_cast<double>(pClock->GetFrequency())),
+        m_targetFrameTicks(static_cast<int64_t>(targetFrameTimeMs * 0.001 * m_frequency)),
+        m_maxQueuedFrames(maxQueuedFrames),
+        m_frameStart(0),
+        m_previousFrameStart(-1),
+        m_lastCompletionTime(0),
+        m_delayedForLatency(false),
+        m_cpuFrameTicks(0.0),
+        m_gpuFrameTicks(0.0),
+        m_safetyMarginTicks(MinSafetyMarginMs * 0.001 * m_frequency),
+        m_stats()
+    {
+        ResetStatistics();
+    }
+
+    // Call before the CPU starts the frame, i.e. before sampling input. Blocks
+    // until the frame should start.
+    void BeginFrame()
+    {
+        int64_t now = m_pClock->GetTicks();
+        RetireCompletedFrames(now);
+
+        // Bound the number of frames still outstanding on the GPU.
+        while (m_pending.size() > m_maxQueuedFrames)
+        {
+            m_pFence->WaitForValue(m_pending.front().fenceValue);
+            now = m_pClock->GetTicks();
+            RetireFrame(now, true);
+        }
+
+        int64_t start = now;
+        int64_t latencyStart = now;
+        if (!m_pending.empty() && m_gpuFrameTicks > 0.0)
+        {
+            // The oldest outstanding frame started on the GPU when its predecessor
+            // completed, or when it was submitted if the GPU was idle by then. The
+            // GPU drains the queue about one GPU frame time per frame later; aim
+            // to submit right before that.
+            const double gpuStart = static_cast<double>((std::max)(m_lastCompletionTime, m_pending.front().presentTime));
+            const double gpuDrainTime = gpuStart + m_gpuFrameTicks * m_pending.size();
+            latencyStart = (std::max)(now, static_cast<int64_t>(gpuDrainTime - m_cpuFrameTicks - m_safetyMarginTicks));
+            start = latencyStart;
+        }
+        if (m_targetFrameTicks > 0 && m_previousFrameStart >= 0)
+        {
+            start = (std::max)(start, m_previousFrameStart + m_targetFrameTicks);
+        }
+
+        // Only a delay the latency prediction imposed can starve the GPU; a CPU
+        // that is simply too slow, or a frame rate cap, idles it by design.
+        m_delayedForLatency = latencyStart > now && latencyStart >= start;
+
+        if (start > now)
+        {
+            m_pClock->SleepUntil(start);
+            m_stats.sleepTicks += start - now;
+            now = m_pClock->GetTicks();
+        }
+
+        if (m_previousFrameStart >= 0)
+        {
+            m_stats.intervalTicks += now - m_previousFrameStart;
+            m_stats.intervalCount++;
+        }
+        m_frameStart = now;
+        m_previousFrameStart = now;
+    }
+
+    // Call right after the frame is presented, with the fence value that retires it.
+    void OnPresent(uint64_t fenceValue)
+    {
+        const int64_t now = m_pClock->GetTicks();
+        RetireCompletedFrames(now);
+
+        const int64_t cpuTicks = now - m_frameStart;
+        m_cpuFrameTicks = m_cpuFrameTicks > 0.0 ? Blend(m_cpuFrameTicks, static_cast<double>(cpuTicks)) : cpuTicks;
+        m_stats.latencyTicks += cpuTicks;
+        m_stats.frameCount++;
+
+        // If nothing is queued after the pacer held this frame back, the GPU has
+        // been waiting on it: back off. Otherwise creep the margin back towards
+        // its minimum.
+        const double minMargin = MinSafetyMarginMs * 0.001 * m_frequency;
+        if (m_pending.empty() && m_delayedForLatency)
+        {
+            m_safetyMarginTicks = (std::min)(m_safetyMarginTicks * 2.0 + minMargin, MaxSafetyMarginMs * 0.001 * m_frequency);
+            m_stats.starvedFrames++;
+        }
+        else
+        {
+            m_safetyMarginTicks = (std::max)(m_safetyMarginTicks * 0.98, minMargin);
+        }
+
+        m_pending.push_back({ fenceValue, now });
+    }
+
+    // Averages since the last ResetStatistics().
+    Statistics GetStatistics() const
+    {
+        const double toMs = 1000.0 / m_frequency;
+        const double frames = static_cast<double>((std::max)(m_stats.frameCount, uint64_t(1)));
+        Statistics stats = {};
+        stats.frameCount = m_stats.frameCount;
+        stats.averageLatencyMs = m_stats.latencyTicks * toMs / frames;
+        stats.averageFrameIntervalMs = m_stats.intervalCount ? m_stats.intervalTicks * toMs / m_stats.intervalCount : 0.0;
+        stats.averageSleepMs = m_stats.sleepTicks * toMs / frames;
+        stats.safetyMarginMs = m_safetyMarginTicks * toMs;
+        stats.starvedFrames = m_stats.starvedFrames;
+        return stats;
+    }
+
+    void ResetStatistics()
+    {
+        m_stats = {};
+    }
+
+private:
+    static constexpr double MinSafetyMarginMs = 0.25;
+    static constexpr double MaxSafetyMarginMs = 8.0;
+
+    struct PendingFrame
+    {
+        uint64_t fenceValue;
+        int64_t presentTime;
+    };
+
+    struct Accumulators
+    {
+        uint64_t frameCount;
+        int64_t latencyTicks;
+        int64_t intervalTicks;
+        uint64_t intervalCount;
+        int64_t sleepTicks;
+        uint32_t starvedFrames;
+    };
+
+    static double Blend(double average, double sample)
+    {
+        return average + (sample - average) * 0.125;
+    }
+
+    // Retires frames that completed without the pacer waiting for them. Their
+    // completion time is only known to be no later than now.
+    void RetireCompletedFrames(int64_t now)
+    {
+        const uint64_t completed = m_pFence->GetCompletedValue();
+        while (!m_pending.empty() && m_pending.front().fenceValue <= completed)
+        {
+            RetireFrame(now, false);
+        }
+    }
+
+    void RetireFrame(int64_t completionTime, bool exact)
+    {
+        const PendingFrame& frame = m_pending.front();
+        const int64_t busySince = (std::max)(frame.presentTime, m_lastCompletionTime);
+        const double gpuTicks = static_cast<double>(completionTime - busySince);
+        if (exact)
+        {
+            m_gpuFrameTicks = m_gpuFrameTicks > 0.0 ? Blend(m_gpuFrameTicks, gpuTicks) : gpuTicks;
+        }
+        else if (m_gpuFrameTicks > 0.0)
+        {
+            m_gpuFrameTicks = (std::min)(m_gpuFrameTicks, Blend(m_gpuFrameTicks, gpuTicks));
+        }
+        m_lastCompletionTime = completionTime;
+        m_pending.pop_front();
+    }
+
+    Clock* m_pClock;
+    Fence* m_pFence;
+    double m_frequency;
+    int64_t m_targetFrameTicks;
+    uint32_t m_maxQueuedFrames;
+
+    std::deque<PendingFrame> m_pending;
+    int64_t m_frameStart;
+    int64_t m_previousFrameStart;
+    int64_t m_lastCompletionTime;
+    bool m_delayedForLatency;
+
+    // Exponential moving averages, in ticks.
+    double m_cpuFrameTicks;
+    double m_gpuFrameTicks;
+    double m_safetyMarginTicks;
+
+    Accumulators m_stats;
+};
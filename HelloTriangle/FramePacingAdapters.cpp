@@ -0,0 +1,43 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "FramePacingAdapters.h"
+
+QpcPacingClock::QpcPacingClock()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_frequency = frequency.QuadPart;
+}
+
+int64_t QpcPacingClock::GetTicks()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+void QpcPacingClock::SleepUntil(int64_t ticks)
+{
+    // Leave a couple of milliseconds of slack for the scheduler.
+    const int64_t slack = m_frequency * 2 / 1000;
+    int64_t now = GetTicks();
+    if (ticks - now > slack)
+    {
+        Sleep(static_cast<DWORD>((ticks - now - slack) * 1000 / m_frequency));
+    }
+
+    while (GetTicks() < ticks)
+    {
+        YieldProcessor();
+    }
+}
@@ -0,0 +1,45 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "FramePacer.h"
+#include "FenceTimeline.h"
+
+// Drives the frame pacer from QueryPerformanceCounter.
+class QpcPacingClock : public FramePacer::Clock
+{
+public:
+    QpcPacingClock();
+
+    virtual int64_t GetTicks();
+    virtual int64_t GetFrequency()      { return m_frequency; }
+
+    // Sleeps for the coarse part of the interval and spins for the rest, since
+    // Sleep() is only accurate to the scheduler quantum.
+    virtual void SleepUntil(int64_t ticks);
+
+private:
+    int64_t m_frequency;
+};
+
+// Exposes a queue's fence timeline to the frame pacer.
+class TimelinePacingFence : public FramePacer::Fence
+{
+public:
+    explicit TimelinePacingFence(FenceTimeline* pTimeline) : m_pTimeline(pTimeline) {}
+
+    virtual uint64_t GetCompletedValue()        { return m_pTimeline->GetCompletedValue(); }
+    virtual void WaitForValue(uint64_t value)   { m_pTimeline->WaitForValue(value); }
+
+private:
+    FenceTimeline* m_pTimeline;
+};
@@ -0,0 +1,28 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include "DXSampleHelper.h"
+
+// Everything the CPU tracks for a single frame in flight. The CPU may only touch
+// a frame resource again once the GPU has passed m_fenceValue. Command allocators
+// come from the CommandAllocatorPool and transient upload memory from the
+// UploadRing, which track their fence values themselves.
+class FrameResource
+{
+public:
+    FrameResource();
+    ~FrameResource();
+
+    UINT64 m_fenceValue;
+};
@@ -0,0 +1,156 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "GpuProfiler.h"
+
+GpuProfiler::GpuProfiler(ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue, UINT frameCount, const char* pTrackName) :
+    m_pCommandQueue(pCommandQueue),
+    m_frameZone(CpuProfiler::RegisterZone("GPU frame")),
+    m_track(CpuProfiler::CreateTrack(pTrackName, "gpu")),
+    m_regionZones(frameCount * MaxRegionsPerFrame, 0),
+    m_regionCounts(frameCount, 0),
+    m_pending(frameCount, false),
+    m_currentFrameIndex(0),
+    m_regionCount(0),
+    m_timestampFrequency(0),
+    m_cpuFrequency(0),
+    m_gpuCalibration(0),
+    m_cpuCalibration(0),
+    m_framesSinceCalibration(0)
+{
+    // Each region takes two queries: its begin and its end timestamp.
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = 2 * frameCount * MaxRegionsPerFrame;
+    ThrowIfFailed(pDevice->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)));
+    NAME_D3D12_OBJECT(m_queryHeap);
+
+    ThrowIfFailed(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(queryHeapDesc.Count * sizeof(UINT64)),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(&m_readbackBuffer)));
+    NAME_D3D12_OBJECT(m_readbackBuffer);
+
+    // Timestamps count ticks of the queue's own clock.
+    ThrowIfFailed(pCommandQueue->GetTimestampFrequency(&m_timestampFrequency));
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_cpuFrequency = frequency.QuadPart;
+
+    Calibrate();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+}
+
+// Samples the queue's clock and QPC at the same moment. The two clocks drift
+// apart slowly, so this is repeated every CalibrationInterval frames.
+void GpuProfiler::Calibrate()
+{
+    ThrowIfFailed(m_pCommandQueue->GetClockCalibration(&m_gpuCalibration, &m_cpuCalibration));
+    m_framesSinceCalibration = 0;
+}
+
+UINT64 GpuProfiler::ToCpuTime(UINT64 gpuTime) const
+{
+    // Timestamps taken before the calibration give a negative offset.
+    const double ticks = static_cast<double>(static_cast<INT64>(gpuTime - m_gpuCalibration));
+    return m_cpuCalibration + static_cast<INT64>(ticks * m_cpuFrequency / m_timestampFrequency);
+}
+
+void GpuProfiler::BeginFrame(ID3D12GraphicsCommandList* pCommandList, UINT frameIndex)
+{
+    m_currentFrameIndex = frameIndex;
+    m_regionCount.store(0, std::memory_order_relaxed);
+    BeginRegion(pCommandList, m_frameZone);
+}
+
+UINT GpuProfiler::BeginRegion(ID3D12GraphicsCommandList* pCommandList, UINT zone)
+{
+    const UINT region = m_regionCount.fetch_add(1, std::memory_order_relaxed);
+    if (region >= MaxRegionsPerFrame)
+    {
+        return InvalidRegion;
+    }
+
+    const UINT firstRegion = m_currentFrameIndex * MaxRegionsPerFrame;
+    m_regionZones[firstRegion + region] = zone;
+    pCommandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * (firstRegion + region));
+    return region;
+}
+
+void GpuProfiler::EndRegion(ID3D12GraphicsCommandList* pCommandList, UINT region)
+{
+    if (region != InvalidRegion)
+    {
+        const UINT firstRegion = m_currentFrameIndex * MaxRegionsPerFrame;
+        pCommandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * (firstRegion + region) + 1);
+    }
+}
+
+void GpuProfiler::EndFrame(ID3D12GraphicsCommandList* pCommandList)
+{
+    // The frame is region 0.
+    EndRegion(pCommandList, 0);
+
+    const UINT regionCount = (std::min)(m_regionCount.load(std::memory_order_relaxed), MaxRegionsPerFrame);
+    const UINT firstQuery = 2 * m_currentFrameIndex * MaxRegionsPerFrame;
+    pCommandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, 2 * regionCount, m_readbackBuffer.Get(), firstQuery * sizeof(UINT64));
+    m_regionCounts[m_currentFrameIndex] = regionCount;
+    m_pending[m_currentFrameIndex] = true;
+}
+
+_Use_decl_annotations_
+bool GpuProfiler::ReadFrame(UINT frameIndex, double* pMilliseconds)
+{
+    *pMilliseconds = 0.0;
+    if (!m_pending[frameIndex])
+    {
+        return false;
+    }
+    m_pending[frameIndex] = false;
+
+    if (++m_framesSinceCalibration >= CalibrationInterval)
+    {
+        Calibrate();
+    }
+
+    const UINT firstRegion = frameIndex * MaxRegionsPerFrame;
+    const UINT regionCount = m_regionCounts[frameIndex];
+    const SIZE_T offset = 2 * firstRegion * sizeof(UINT64);
+    UINT8* pData;
+    ThrowIfFailed(m_readbackBuffer->Map(0, &CD3DX12_RANGE(offset, offset + 2 * regionCount * sizeof(UINT64)), reinterpret_cast<void**>(&pData)));
+    const UINT64* pTimestamps = reinterpret_cast<const UINT64*>(pData + offset);
+    for (UINT region = 0; region < regionCount; region++)
+    {
+        const UINT64 begin = pTimestamps[2 * region];
+        const UINT64 end = pTimestamps[2 * region + 1];
+
+        // Timestamps that never made it to the buffer read back as zeros.
+        if (begin == 0 || end < begin)
+        {
+            continue;
+        }
+        CpuProfiler::RecordOnTrack(m_track, m_regionZones[firstRegion + region], ToCpuTime(begin), ToCpuTime(end));
+        if (region == 0 && m_timestampFrequency > 0)
+        {
+            *pMilliseconds = 1000.0 * (end - begin) / m_timestampFrequency;
+        }
+    }
+    m_readbackBuffer->Unmap(0, &CD3DX12_RANGE(0, 0));
+    return true;
+}
@@ -0,0 +1,123 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "DXSampleHelper.h"
+#include "CpuProfiler.h"
+
+// Times regions of a queue's work with pairs of timestamp queries:
+//
+//     {
+//         GPU_PROFILE_ZONE(pProfiler, pCommandList, "Shadows");
+//         ...
+//     }
+//
+// Every frame resource has its own block of MaxRegionsPerFrame query pairs and
+// its own slot in the readback buffer, so a frame's timestamps are read once that
+// frame resource comes around again, after its fence has passed, and reading
+// them never stalls. The whole frame is always timed as the first region.
+//
+// Timestamps are converted to the QPC timebase with the queue's clock
+// calibration and recorded on a CpuProfiler track of their own, so GPU regions
+// show up in the same statistics and trace exports as the CPU zones, next to the
+// threads that recorded them. Zone names share the CpuProfiler registry.
+class GpuProfiler
+{
+public:
+    static const UINT MaxRegionsPerFrame = 64;
+    static const UINT InvalidRegion = UINT_MAX;
+
+    GpuProfiler(ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue, UINT frameCount, const char* pTrackName);
+    ~GpuProfiler();
+
+    // Starts timing the frame recorded into the given frame resource. The list
+    // has to be the first one the frame submits.
+    void BeginFrame(ID3D12GraphicsCommandList* pCommandList, UINT frameIndex);
+
+    // Timestamps the start of a region of the current frame. May be called from
+    // any thread recording the frame. Returns InvalidRegion once the frame is out
+    // of regions; the region is then not timed.
+    UINT BeginRegion(ID3D12GraphicsCommandList* pCommandList, UINT zone);
+    void EndRegion(ID3D12GraphicsCommandList* pCommandList, UINT region);
+
+    // Stops timing the frame and copies its timestamps to the frame resource's
+    // slot of the readback buffer. The list has to be the last one the frame
+    // submits, and every other region must have ended.
+    void EndFrame(ID3D12GraphicsCommandList* pCommandList);
+
+    // Records the regions of the frame last timed in the given frame resource and
+    // returns its GPU time, in milliseconds. Its fence must have passed. Returns
+    // false if the frame resource has not been timed since the last call.
+    bool ReadFrame(UINT frameIndex, _Out_ double* pMilliseconds);
+
+    ID3D12QueryHeap* GetQueryHeap() const       { return m_queryHeap.Get(); }
+    ID3D12Resource* GetReadbackBuffer() const   { return m_readbackBuffer.Get(); }
+
+private:
+    static const UINT CalibrationInterval = 256;    // Frames between clock calibrations.
+
+    void Calibrate();
+    UINT64 ToCpuTime(UINT64 gpuTime) const;
+
+    ID3D12CommandQueue* m_pCommandQueue;
+    ComPtr<ID3D12QueryHeap> m_queryHeap;
+    ComPtr<ID3D12Resource> m_readbackBuffer;
+    UINT m_frameZone;
+    UINT m_track;
+
+    // Per frame resource: the zone of every region, the number of regions and
+    // whether the slot holds timestamps that have not been read yet.
+    std::vector<UINT> m_regionZones;
+    std::vector<UINT> m_regionCounts;
+    std::vector<bool> m_pending;
+    UINT m_currentFrameIndex;
+    std::atomic<UINT> m_regionCount;
+
+    UINT64 m_timestampFrequency;
+    UINT64 m_cpuFrequency;
+    UINT64 m_gpuCalibration;
+    UINT64 m_cpuCalibration;
+    UINT m_framesSinceCalibration;
+};
+
+// Times the enclosing scope of a command list's recording as one region.
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler* pProfiler, ID3D12GraphicsCommandList* pCommandList, UINT zone) :
+        m_pProfiler(pProfiler),
+        m_pCommandList(pCommandList),
+        m_region(pProfiler->BeginRegion(pCommandList, zone))
+    {
+    }
+
+    ~GpuProfileScope()
+    {
+        m_pProfiler->EndRegion(m_pCommandList, m_region);
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler* m_pProfiler;
+    ID3D12GraphicsCommandList* m_pCommandList;
+    UINT m_region;
+};
+
+// Times the commands recorded into the list during the rest of the enclosing
+// scope as a region with the given name.
+#define GPU_PROFILE_ZONE(pProfiler, pCommandList, name) \
+    static const UINT PROFILE_ZONE_CONCAT(s_gpuProfileZone, __LINE__) = CpuProfiler::RegisterZone(name); \
+    GpuProfileScope PROFILE_ZONE_CONCAT(gpuProfileZoneScope, __LINE__)(pProfiler, pCommandList, PROFILE_ZONE_CONCAT(s_gpuProfileZone, __LINE__))
@@ -0,0 +1,82 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "IndirectCommand.h"
+
+static bool IsDrawArgument(D3D12_INDIRECT_ARGUMENT_TYPE type)
+{
+    return type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW || type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+}
+
+static bool IsRootArgument(D3D12_INDIRECT_ARGUMENT_TYPE type)
+{
+    return type == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT ||
+        type == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW ||
+        type == D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW ||
+        type == D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW;
+}
+
+_Use_decl_annotations_
+void CreateIndirectCommandSignature(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignature, const IndirectArgument* pArguments, UINT argumentCount, UINT byteStride, ID3D12CommandSignature** ppCommandSignature)
+{
+    *ppCommandSignature = nullptr;
+
+    if (argumentCount == 0)
+    {
+        OutputDebugStringA("Indirect command has no arguments\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    std::vector<D3D12_INDIRECT_ARGUMENT_DESC> argumentDescs(argumentCount);
+    bool hasRootArguments = false;
+    UINT expectedOffset = 0;
+    for (UINT i = 0; i < argumentCount; i++)
+    {
+        const IndirectArgument& argument = pArguments[i];
+        const std::string name = "Indirect command argument " + std::to_string(i);
+
+        // The GPU reads the arguments back to back, in order.
+        if (argument.offset != expectedOffset)
+        {
+            OutputDebugStringA((name + " is at offset " + std::to_string(argument.offset) + " instead of " + std::to_string(expectedOffset) + "; arguments must be in member order without padding\n").c_str());
+            ThrowIfFailed(E_INVALIDARG);
+        }
+        if (IsDrawArgument(argument.desc.Type) != (i == argumentCount - 1))
+        {
+            OutputDebugStringA((name + ": an indirect command has to end with its only draw\n").c_str());
+            ThrowIfFailed(E_INVALIDARG);
+        }
+
+        hasRootArguments |= IsRootArgument(argument.desc.Type);
+        expectedOffset += argument.size;
+        argumentDescs[i] = argument.desc;
+    }
+
+    if (expectedOffset > byteStride)
+    {
+        OutputDebugStringA("Indirect command arguments do not fit the byte stride\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+    if (hasRootArguments && pRootSignature == nullptr)
+    {
+        OutputDebugStringA("Indirect command sets root arguments but no root signature was given\n");
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    D3D12_COMMAND_SIGNATURE_DESC desc = {};
+    desc.ByteStride = byteStride;
+    desc.NumArgumentDescs = argumentCount;
+    desc.pArgumentDescs = argumentDescs.data();
+
+    // Signatures that leave the root arguments alone must not name a root signature.
+    ThrowIfFailed(pDevice->CreateCommandSignature(&desc, hasRootArguments ? pRootSignature : nullptr, IID_PPV_ARGS(ppCommandSignature)));
+}
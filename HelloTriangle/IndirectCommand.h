@@ -0,0 +1,153 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include "DXSampleHelper.h"
+
+// Command signatures for ExecuteIndirect are derived from annotated command
+// structs, the same way vertex input layouts are derived from vertex structs. A
+// command is any struct that exposes its arguments through a static Arguments()
+// function:
+//
+//     struct IndirectDraw
+//     {
+//         UINT objectIndex;
+//         D3D12_VERTEX_BUFFER_VIEW vertexBuffer;
+//         D3D12_DRAW_ARGUMENTS draw;
+//
+//         static std::array<IndirectArgument, 3> Arguments()
+//         {
+//             return { {
+//                 INDIRECT_ROOT_CONSTANTS(IndirectDraw, objectIndex, 0, 0),
+//                 INDIRECT_VERTEX_BUFFER_VIEW(IndirectDraw, vertexBuffer, 0),
+//                 INDIRECT_DRAW(IndirectDraw, draw)
+//             } };
+//         }
+//     };
+//
+// IndirectCommandSignature<IndirectDraw>::Create() then builds the signature with
+// the struct's size as the byte stride, so argument buffers are simply arrays of
+// the struct. Each macro only accepts members of the matching type; the order
+// and packing of the arguments are checked when the signature is created.
+
+struct IndirectArgument
+{
+    D3D12_INDIRECT_ARGUMENT_DESC desc;
+    UINT offset;
+    UINT size;
+};
+
+template<class T>
+IndirectArgument MakeIndirectArgument(D3D12_INDIRECT_ARGUMENT_TYPE type, UINT offset)
+{
+    IndirectArgument argument = {};
+    argument.desc.Type = type;
+    argument.offset = offset;
+    argument.size = static_cast<UINT>(sizeof(T));
+    return argument;
+}
+
+template<class T>
+IndirectArgument MakeIndirectDraw(UINT offset)
+{
+    static_assert(std::is_same<T, D3D12_DRAW_ARGUMENTS>::value, "Draw arguments must be a D3D12_DRAW_ARGUMENTS.");
+    return MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW, offset);
+}
+
+template<class T>
+IndirectArgument MakeIndirectDrawIndexed(UINT offset)
+{
+    static_assert(std::is_same<T, D3D12_DRAW_INDEXED_ARGUMENTS>::value, "Indexed draw arguments must be a D3D12_DRAW_INDEXED_ARGUMENTS.");
+    return MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, offset);
+}
+
+template<class T>
+IndirectArgument MakeIndirectVertexBufferView(UINT offset, UINT slot)
+{
+    static_assert(std::is_same<T, D3D12_VERTEX_BUFFER_VIEW>::value, "Vertex buffer arguments must be a D3D12_VERTEX_BUFFER_VIEW.");
+    IndirectArgument argument = MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW, offset);
+    argument.desc.VertexBuffer.Slot = slot;
+    return argument;
+}
+
+template<class T>
+IndirectArgument MakeIndirectIndexBufferView(UINT offset)
+{
+    static_assert(std::is_same<T, D3D12_INDEX_BUFFER_VIEW>::value, "Index buffer arguments must be a D3D12_INDEX_BUFFER_VIEW.");
+    return MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW, offset);
+}
+
+// Root constants may be any plain type made of 32-bit values: a UINT, an array
+// of them, a struct of floats and so on.
+template<class T>
+IndirectArgument MakeIndirectRootConstants(UINT offset, UINT rootParameterIndex, UINT destOffsetIn32BitValues)
+{
+    static_assert(std::is_trivially_copyable<T>::value && sizeof(T) % sizeof(UINT) == 0, "Root constants must be made of 32-bit values.");
+    IndirectArgument argument = MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT, offset);
+    argument.desc.Constant.RootParameterIndex = rootParameterIndex;
+    argument.desc.Constant.DestOffsetIn32BitValues = destOffsetIn32BitValues;
+    argument.desc.Constant.Num32BitValuesToSet = static_cast<UINT>(sizeof(T) / sizeof(UINT));
+    return argument;
+}
+
+template<class T>
+IndirectArgument MakeIndirectConstantBufferView(UINT offset, UINT rootParameterIndex)
+{
+    static_assert(std::is_same<T, D3D12_GPU_VIRTUAL_ADDRESS>::value, "Constant buffer view arguments must be a D3D12_GPU_VIRTUAL_ADDRESS.");
+    IndirectArgument argument = MakeIndirectArgument<T>(D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW, offset);
+    argument.desc.ConstantBufferView.RootParameterIndex = rootParameterIndex;
+    return argument;
+}
+
+// Describe a single member of a command; the type and the offset are taken from
+// the member itself so they can never drift from the struct.
+#define INDIRECT_DRAW(Command, member) \
+    MakeIndirectDraw<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)))
+#define INDIRECT_DRAW_INDEXED(Command, member) \
+    MakeIndirectDrawIndexed<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)))
+#define INDIRECT_VERTEX_BUFFER_VIEW(Command, member, slot) \
+    MakeIndirectVertexBufferView<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)), slot)
+#define INDIRECT_INDEX_BUFFER_VIEW(Command, member) \
+    MakeIndirectIndexBufferView<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)))
+#define INDIRECT_ROOT_CONSTANTS(Command, member, rootParameterIndex, destOffsetIn32BitValues) \
+    MakeIndirectRootConstants<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)), rootParameterIndex, destOffsetIn32BitValues)
+#define INDIRECT_CONSTANT_BUFFER_VIEW(Command, member, rootParameterIndex) \
+    MakeIndirectConstantBufferView<decltype(Command::member)>(static_cast<UINT>(offsetof(Command, member)), rootParameterIndex)
+
+// Creates a command signature from a command's arguments. The arguments have to
+// be listed in member order and packed without gaps, since that is how the GPU
+// reads them, and end with the draw. The root signature is only used when there
+// are root arguments, and is required then. Throws an HrException with
+// E_INVALIDARG (after logging the offending argument) otherwise.
+void CreateIndirectCommandSignature(
+    _In_ ID3D12Device* pDevice,
+    _In_opt_ ID3D12RootSignature* pRootSignature,
+    _In_reads_(argumentCount) const IndirectArgument* pArguments,
+    UINT argumentCount,
+    UINT byteStride,
+    _COM_Outptr_ ID3D12CommandSignature** ppCommandSignature);
+
+template<class Command>
+class IndirectCommandSignature
+{
+public:
+    static ComPtr<ID3D12CommandSignature> Create(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignature = nullptr)
+    {
+        const auto arguments = Command::Arguments();
+        ComPtr<ID3D12CommandSignature> commandSignature;
+        CreateIndirectCommandSignature(pDevice, pRootSignature, arguments.data(), static_cast<UINT>(arguments.size()), sizeof(Command), &commandSignature);
+        return commandSignature;
+    }
+};
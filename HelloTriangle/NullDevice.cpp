@@ -0,0 +1,1685 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "NullDevice.h"
+#include "FramePacingAdapters.h"
+#include "TlsfAllocator.h"
+
+#include <deque>
+#include <mutex>
+
+using Microsoft::WRL::ChainInterfaces;
+using Microsoft::WRL::ClassicCom;
+using Microsoft::WRL::Make;
+using Microsoft::WRL::RuntimeClass;
+using Microsoft::WRL::RuntimeClassFlags;
+
+std::atomic<UINT64> NullApiCallCounter::s_counts[NullApiCallCounter::MaxCallSites];
+const char* NullApiCallCounter::s_names[NullApiCallCounter::MaxCallSites];
+std::atomic<UINT> NullApiCallCounter::s_callSiteCount(0);
+
+static std::atomic<UINT64> s_nullGpuBusyTicks(0);
+
+UINT NullApiCallCounter::Register(const char* pName)
+{
+    UINT index = s_callSiteCount.fetch_add(1);
+    if (index >= MaxCallSites)
+    {
+        // Out of slots; lump the remaining entry points together.
+        assert(false);
+        index = MaxCallSites - 1;
+        pName = "(other)";
+    }
+    s_names[index] = pName;
+    return index;
+}
+
+UINT64 NullApiCallCounter::GetTotal()
+{
+    const UINT callSiteCount = (std::min)(s_callSiteCount.load(), MaxCallSites);
+    UINT64 total = 0;
+    for (UINT i = 0; i < callSiteCount; i++)
+    {
+        total += s_counts[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void NullApiCallCounter::Report()
+{
+    const UINT callSiteCount = (std::min)(s_callSiteCount.load(), MaxCallSites);
+    std::vector<UINT> order(callSiteCount);
+    for (UINT i = 0; i < callSiteCount; i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [](UINT a, UINT b) { return s_counts[a] > s_counts[b]; });
+
+    for (UINT index : order)
+    {
+        char line[256];
+        sprintf_s(line, "%14llu  %s\n", s_counts[index].load(), s_names[index]);
+        OutputDebugStringA(line);
+        printf("%s", line);
+    }
+}
+
+// Every descriptor takes this many bytes in a null descriptor heap.
+static const UINT NullDescriptorSize = 32;
+
+// What a null descriptor holds: enough to tell descriptors apart, so that
+// copies between heaps can be checked.
+enum NullDescriptorKind
+{
+    NullDescriptorConstantBufferView = 1,
+    NullDescriptorShaderResourceView,
+    NullDescriptorUnorderedAccessView,
+    NullDescriptorRenderTargetView,
+    NullDescriptorDepthStencilView,
+    NullDescriptorSampler
+};
+
+struct NullDescriptor
+{
+    UINT64 target;      // The resource or GPU virtual address viewed.
+    UINT32 kind;
+};
+
+static_assert(sizeof(NullDescriptor) <= NullDescriptorSize, "Null descriptors must fit their heap slots.");
+
+static void WriteNullDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE handle, UINT64 target, NullDescriptorKind kind)
+{
+    const NullDescriptor descriptor = { target, static_cast<UINT32>(kind) };
+    memcpy(reinterpret_cast<void*>(handle.ptr), &descriptor, sizeof(descriptor));
+}
+
+static bool IsCpuAccessible(const D3D12_HEAP_PROPERTIES& heapProperties)
+{
+    return heapProperties.Type == D3D12_HEAP_TYPE_UPLOAD ||
+        heapProperties.Type == D3D12_HEAP_TYPE_READBACK ||
+        (heapProperties.Type == D3D12_HEAP_TYPE_CUSTOM &&
+            (heapProperties.CPUPageProperty == D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE || heapProperties.CPUPageProperty == D3D12_CPU_PAGE_PROPERTY_WRITE_BACK));
+}
+
+// Bytes per texel for the formats samples commonly use; everything else is
+// treated as a 32-bit format.
+static UINT GetFormatElementSize(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 16;
+
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return 12;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+        return 8;
+
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_D16_UNORM:
+        return 2;
+
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_A8_UNORM:
+        return 1;
+
+    default:
+        return 4;
+    }
+}
+
+class NullDevice;
+
+// Implements ID3D12Object for all null objects. Private data and names are
+// accepted and dropped.
+template<class Chain>
+class NullObject : public RuntimeClass<RuntimeClassFlags<ClassicCom>, Chain>
+{
+public:
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID /*guid*/, UINT* pDataSize, void* /*pData*/) override
+    {
+        COUNT_NULL_API_CALL();
+        if (pDataSize)
+        {
+            *pDataSize = 0;
+        }
+        return DXGI_ERROR_NOT_FOUND;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID /*guid*/, UINT /*DataSize*/, const void* /*pData*/) override
+    {
+        COUNT_NULL_API_CALL();
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID /*guid*/, const IUnknown* /*pData*/) override
+    {
+        COUNT_NULL_API_CALL();
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR /*Name*/) override
+    {
+        COUNT_NULL_API_CALL();
+        return S_OK;
+    }
+};
+
+// Implements ID3D12DeviceChild; children keep their device alive.
+template<class Chain>
+class NullDeviceChild : public NullObject<Chain>
+{
+public:
+    NullDeviceChild(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        m_device(pDevice),
+        m_pNullDevice(pNullDevice)
+    {
+    }
+
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppvDevice) override
+    {
+        COUNT_NULL_API_CALL();
+        return m_device.CopyTo(riid, ppvDevice);
+    }
+
+protected:
+    ComPtr<ID3D12Device> m_device;
+    NullDevice* m_pNullDevice;
+};
+
+class NullDevice : public NullObject<ChainInterfaces<ID3D12Device, ID3D12Object>>
+{
+public:
+    explicit NullDevice(float gpuMicrosecondsPerDraw);
+
+    // Simulated GPU time.
+    QpcPacingClock* GetClock()                  { return &m_clock; }
+    double GetGpuTicksPerDraw() const           { return m_gpuTicksPerDraw; }
+
+    // Hands out address space for buffers and heaps; it is never backed.
+    D3D12_GPU_VIRTUAL_ADDRESS AllocateGpuVirtualAddress(UINT64 size);
+
+    UINT STDMETHODCALLTYPE GetNodeCount() override;
+    HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc, REFIID riid, void** ppCommandQueue) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE type, REFIID riid, void** ppCommandAllocator) override;
+    HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState) override;
+    HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* pDesc, REFIID riid, void** ppPipelineState) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandList(UINT nodeMask, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* pCommandAllocator, ID3D12PipelineState* pInitialState, REFIID riid, void** ppCommandList) override;
+    HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE Feature, void* pFeatureSupportData, UINT FeatureSupportDataSize) override;
+    HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc, REFIID riid, void** ppvHeap) override;
+    UINT STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapType) override;
+    HRESULT STDMETHODCALLTYPE CreateRootSignature(UINT nodeMask, const void* pBlobWithRootSignature, SIZE_T blobLengthInBytes, REFIID riid, void** ppvRootSignature) override;
+    void STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D12Resource* pResource, ID3D12Resource* pCounterResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource* pResource, const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource* pResource, const D3D12_DEPTH_STENCIL_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
+    void STDMETHODCALLTYPE CopyDescriptors(UINT NumDestDescriptorRanges, const D3D12_CPU_DESCRIPTOR_HANDLE* pDestDescriptorRangeStarts, const UINT* pDestDescriptorRangeSizes, UINT NumSrcDescriptorRanges, const D3D12_CPU_DESCRIPTOR_HANDLE* pSrcDescriptorRangeStarts, const UINT* pSrcDescriptorRangeSizes, D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapsType) override;
+    void STDMETHODCALLTYPE CopyDescriptorsSimple(UINT NumDescriptors, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptorRangeStart, D3D12_CPU_DESCRIPTOR_HANDLE SrcDescriptorRangeStart, D3D12_DESCRIPTOR_HEAP_TYPE DescriptorHeapsType) override;
+    D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo(UINT visibleMask, UINT numResourceDescs, const D3D12_RESOURCE_DESC* pResourceDescs) override;
+    D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT nodeMask, D3D12_HEAP_TYPE heapType) override;
+    HRESULT STDMETHODCALLTYPE CreateCommittedResource(const D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS HeapFlags, const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES InitialResourceState, const D3D12_CLEAR_VALUE* pOptimizedClearValue, REFIID riidResource, void** ppvResource) override;
+    HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap) override;
+    HRESULT STDMETHODCALLTYPE CreatePlacedResource(ID3D12Heap* pHeap, UINT64 HeapOffset, const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES InitialState, const D3D12_CLEAR_VALUE* pOptimizedClearValue, REFIID riid, void** ppvResource) override;
+    HRESULT STDMETHODCALLTYPE CreateReservedResource(const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES InitialState, const D3D12_CLEAR_VALUE* pOptimizedClearValue, REFIID riid, void** ppvResource) override;
+    HRESULT STDMETHODCALLTYPE CreateSharedHandle(ID3D12DeviceChild* pObject, const SECURITY_ATTRIBUTES* pAttributes, DWORD Access, LPCWSTR Name, HANDLE* pHandle) override;
+    HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE NTHandle, REFIID riid, void** ppvObj) override;
+    HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR Name, DWORD Access, HANDLE* pNTHandle) override;
+    HRESULT STDMETHODCALLTYPE MakeResident(UINT NumObjects, ID3D12Pageable* const* ppObjects) override;
+    HRESULT STDMETHODCALLTYPE Evict(UINT NumObjects, ID3D12Pageable* const* ppObjects) override;
+    HRESULT STDMETHODCALLTYPE CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS Flags, REFIID riid, void** ppFence) override;
+    HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override;
+    void STDMETHODCALLTYPE GetCopyableFootprints(const D3D12_RESOURCE_DESC* pResourceDesc, UINT FirstSubresource, UINT NumSubresources, UINT64 BaseOffset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts, UINT* pNumRows, UINT64* pRowSizeInBytes, UINT64* pTotalBytes) override;
+    HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap) override;
+    HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL Enable) override;
+    HRESULT STDMETHODCALLTYPE CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC* pDesc, ID3D12RootSignature* pRootSignature, REFIID riid, void** ppvCommandSignature) override;
+    void STDMETHODCALLTYPE GetResourceTiling(ID3D12Resource* pTiledResource, UINT* pNumTilesForEntireResource, D3D12_PACKED_MIP_INFO* pPackedMipDesc, D3D12_TILE_SHAPE* pStandardTileShapeForNonPackedMips, UINT* pNumSubresourceTilings, UINT FirstSubresourceTilingToGet, D3D12_SUBRESOURCE_TILING* pSubresourceTilingsForNonPackedMips) override;
+    LUID STDMETHODCALLTYPE GetAdapterLuid() override;
+
+private:
+    QpcPacingClock m_clock;
+    double m_gpuTicksPerDraw;
+    std::atomic<UINT64> m_nextGpuVirtualAddress;
+};
+
+// Returns a newly made object through an IID, following the D3D12 convention of
+// S_FALSE when the caller only asked whether creation would succeed.
+template<class T>
+static HRESULT ReturnObject(const ComPtr<T>& object, REFIID riid, void** ppObject)
+{
+    if (!object)
+    {
+        return E_OUTOFMEMORY;
+    }
+    if (ppObject == nullptr)
+    {
+        return S_FALSE;
+    }
+    return object.CopyTo(riid, ppObject);
+}
+
+class NullFence : public NullDeviceChild<ChainInterfaces<ID3D12Fence, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullFence(ID3D12Device* pDevice, NullDevice* pNullDevice, UINT64 initialValue) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_completedValue(initialValue),
+        m_pendingCount(0)
+    {
+    }
+
+    UINT64 STDMETHODCALLTYPE GetCompletedValue() override
+    {
+        COUNT_NULL_API_CALL();
+        if (m_pendingCount.load(std::memory_order_acquire) != 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            RetireSignals(m_pNullDevice->GetClock()->GetTicks());
+        }
+        return m_completedValue.load(std::memory_order_acquire);
+    }
+
+    // The event is set once the value completes on the simulated timeline. As
+    // nothing else can advance that timeline, a value that is still pending is
+    // waited out here rather than by a background thread.
+    HRESULT STDMETHODCALLTYPE SetEventOnCompletion(UINT64 Value, HANDLE hEvent) override
+    {
+        COUNT_NULL_API_CALL();
+        INT64 completionTicks = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            RetireSignals(m_pNullDevice->GetClock()->GetTicks());
+            if (m_completedValue < Value)
+            {
+                completionTicks = GetCompletionTicksLocked(Value);
+                if (completionTicks < 0)
+                {
+                    // Never signaled; like the real thing, the event stays unset.
+                    return S_OK;
+                }
+            }
+        }
+
+        if (completionTicks > 0)
+        {
+            m_pNullDevice->GetClock()->SleepUntil(completionTicks);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            RetireSignals(m_pNullDevice->GetClock()->GetTicks());
+        }
+
+        if (hEvent)
+        {
+            SetEvent(hEvent);
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Signal(UINT64 Value) override
+    {
+        COUNT_NULL_API_CALL();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_completedValue = Value;
+        return S_OK;
+    }
+
+    // Called by queues: the value completes once the simulated GPU clock reaches
+    // completionTicks.
+    void ScheduleSignal(UINT64 value, INT64 completionTicks)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (completionTicks <= m_pNullDevice->GetClock()->GetTicks() && m_pending.empty())
+        {
+            m_completedValue = value;
+            return;
+        }
+        m_pending.push_back({ value, completionTicks });
+        m_pendingCount = m_pending.size();
+    }
+
+    // When the value completes on the simulated timeline; 0 if it already has
+    // and -1 if it has not been signaled yet.
+    INT64 GetCompletionTicks(UINT64 value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_completedValue >= value ? 0 : GetCompletionTicksLocked(value);
+    }
+
+private:
+    struct PendingSignal
+    {
+        UINT64 value;
+        INT64 completionTicks;
+    };
+
+    void RetireSignals(INT64 now)
+    {
+        while (!m_pending.empty() && m_pending.front().completionTicks <= now)
+        {
+            m_completedValue = m_pending.front().value;
+            m_pending.pop_front();
+        }
+        m_pendingCount = m_pending.size();
+    }
+
+    INT64 GetCompletionTicksLocked(UINT64 value) const
+    {
+        for (const PendingSignal& signal : m_pending)
+        {
+            if (signal.value >= value)
+            {
+                return signal.completionTicks;
+            }
+        }
+        return -1;
+    }
+
+    std::mutex m_mutex;
+    std::atomic<UINT64> m_completedValue;
+    std::atomic<size_t> m_pendingCount;
+    std::deque<PendingSignal> m_pending;
+};
+
+class NullCommandAllocator : public NullDeviceChild<ChainInterfaces<ID3D12CommandAllocator, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullCommandAllocator(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        NullDeviceChild(pDevice, pNullDevice)
+    {
+    }
+
+    HRESULT STDMETHODCALLTYPE Reset() override
+    {
+        COUNT_NULL_API_CALL();
+        return S_OK;
+    }
+};
+
+class NullRootSignature : public NullDeviceChild<ChainInterfaces<ID3D12RootSignature, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullRootSignature(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        NullDeviceChild(pDevice, pNullDevice)
+    {
+    }
+};
+
+class NullPipelineState : public NullDeviceChild<ChainInterfaces<ID3D12PipelineState, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullPipelineState(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        NullDeviceChild(pDevice, pNullDevice)
+    {
+    }
+
+    HRESULT STDMETHODCALLTYPE GetCachedBlob(ID3DBlob** ppBlob) override
+    {
+        COUNT_NULL_API_CALL();
+        *ppBlob = nullptr;
+        return E_NOTIMPL;
+    }
+};
+
+class NullQueryHeap : public NullDeviceChild<ChainInterfaces<ID3D12QueryHeap, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullQueryHeap(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        NullDeviceChild(pDevice, pNullDevice)
+    {
+    }
+};
+
+class NullCommandSignature : public NullDeviceChild<ChainInterfaces<ID3D12CommandSignature, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullCommandSignature(ID3D12Device* pDevice, NullDevice* pNullDevice) :
+        NullDeviceChild(pDevice, pNullDevice)
+    {
+    }
+};
+
+class NullDescriptorHeap : public NullDeviceChild<ChainInterfaces<ID3D12DescriptorHeap, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullDescriptorHeap(ID3D12Device* pDevice, NullDevice* pNullDevice, const D3D12_DESCRIPTOR_HEAP_DESC& desc) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_desc(desc),
+        m_descriptors(static_cast<size_t>(desc.NumDescriptors) * NullDescriptorSize),
+        m_gpuBase(pNullDevice->AllocateGpuVirtualAddress(static_cast<UINT64>(desc.NumDescriptors) * NullDescriptorSize))
+    {
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GetDesc() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_desc;
+    }
+
+    // Descriptor handles point into real memory so that they are unique.
+    D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override
+    {
+        COUNT_NULL_API_CALL();
+        return { reinterpret_cast<SIZE_T>(m_descriptors.data()) };
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override
+    {
+        COUNT_NULL_API_CALL();
+        D3D12_GPU_DESCRIPTOR_HANDLE handle = {};
+        if (m_desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE)
+        {
+            handle.ptr = m_gpuBase;
+        }
+        return handle;
+    }
+
+private:
+    D3D12_DESCRIPTOR_HEAP_DESC m_desc;
+    std::vector<UINT8> m_descriptors;
+    UINT64 m_gpuBase;
+};
+
+class NullHeap : public NullDeviceChild<ChainInterfaces<ID3D12Heap, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullHeap(ID3D12Device* pDevice, NullDevice* pNullDevice, const D3D12_HEAP_DESC& desc) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_desc(desc),
+        m_gpuVirtualAddress(pNullDevice->AllocateGpuVirtualAddress(desc.SizeInBytes))
+    {
+        if (IsCpuAccessible(desc.Properties))
+        {
+            m_memory.resize(static_cast<size_t>(desc.SizeInBytes));
+        }
+    }
+
+    D3D12_HEAP_DESC STDMETHODCALLTYPE GetDesc() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_desc;
+    }
+
+    const D3D12_HEAP_DESC& GetHeapDesc() const      { return m_desc; }
+    UINT8* GetMemory()                              { return m_memory.empty() ? nullptr : m_memory.data(); }
+    D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const { return m_gpuVirtualAddress; }
+
+private:
+    D3D12_HEAP_DESC m_desc;
+    std::vector<UINT8> m_memory;
+    D3D12_GPU_VIRTUAL_ADDRESS m_gpuVirtualAddress;
+};
+
+class NullResource : public NullDeviceChild<ChainInterfaces<ID3D12Resource, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    // A committed or reserved resource. Committed buffers on CPU-visible heaps
+    // get their own system memory.
+    NullResource(ID3D12Device* pDevice, NullDevice* pNullDevice, const D3D12_RESOURCE_DESC& desc, const D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS heapFlags) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_desc(desc),
+        m_hasHeap(pHeapProperties != nullptr),
+        m_heapProperties(pHeapProperties ? *pHeapProperties : D3D12_HEAP_PROPERTIES{}),
+        m_heapFlags(heapFlags),
+        m_gpuVirtualAddress(0),
+        m_pData(nullptr)
+    {
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            m_gpuVirtualAddress = pNullDevice->AllocateGpuVirtualAddress(desc.Width);
+            if (pHeapProperties && IsCpuAccessible(*pHeapProperties))
+            {
+                m_memory.resize(static_cast<size_t>(desc.Width));
+                m_pData = m_memory.data();
+            }
+        }
+    }
+
+    // A placed resource shares the memory and address range of its heap.
+    NullResource(ID3D12Device* pDevice, NullDevice* pNullDevice, const D3D12_RESOURCE_DESC& desc, NullHeap* pHeap, UINT64 heapOffset) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_desc(desc),
+        m_heap(pHeap),
+        m_hasHeap(true),
+        m_heapProperties(pHeap->GetHeapDesc().Properties),
+        m_heapFlags(pHeap->GetHeapDesc().Flags),
+        m_gpuVirtualAddress(0),
+        m_pData(nullptr)
+    {
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            m_gpuVirtualAddress = pHeap->GetGpuVirtualAddress() + heapOffset;
+            if (pHeap->GetMemory())
+            {
+                m_pData = pHeap->GetMemory() + heapOffset;
+            }
+        }
+    }
+
+    HRESULT STDMETHODCALLTYPE Map(UINT /*Subresource*/, const D3D12_RANGE* /*pReadRange*/, void** ppData) override
+    {
+        COUNT_NULL_API_CALL();
+        if (m_pData == nullptr)
+        {
+            return E_INVALIDARG;
+        }
+        if (ppData)
+        {
+            *ppData = m_pData;
+        }
+        return S_OK;
+    }
+
+    void STDMETHODCALLTYPE Unmap(UINT /*Subresource*/, const D3D12_RANGE* /*pWrittenRange*/) override
+    {
+        COUNT_NULL_API_CALL();
+    }
+
+    D3D12_RESOURCE_DESC STDMETHODCALLTYPE GetDesc() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_desc;
+    }
+
+    D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GetGPUVirtualAddress() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_gpuVirtualAddress;
+    }
+
+    // Textures have no storage to write to or read from.
+    HRESULT STDMETHODCALLTYPE WriteToSubresource(UINT /*DstSubresource*/, const D3D12_BOX* /*pDstBox*/, const void* /*pSrcData*/, UINT /*SrcRowPitch*/, UINT /*SrcDepthPitch*/) override
+    {
+        COUNT_NULL_API_CALL();
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE ReadFromSubresource(void* /*pDstData*/, UINT /*DstRowPitch*/, UINT /*DstDepthPitch*/, UINT /*SrcSubresource*/, const D3D12_BOX* /*pSrcBox*/) override
+    {
+        COUNT_NULL_API_CALL();
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetHeapProperties(D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS* pHeapFlags) override
+    {
+        COUNT_NULL_API_CALL();
+        if (!m_hasHeap)
+        {
+            // Reserved resources have no heap.
+            return E_INVALIDARG;
+        }
+        if (pHeapProperties)
+        {
+            *pHeapProperties = m_heapProperties;
+        }
+        if (pHeapFlags)
+        {
+            *pHeapFlags = m_heapFlags;
+        }
+        return S_OK;
+    }
+
+private:
+    D3D12_RESOURCE_DESC m_desc;
+    ComPtr<ID3D12Heap> m_heap;
+    bool m_hasHeap;
+    D3D12_HEAP_PROPERTIES m_heapProperties;
+    D3D12_HEAP_FLAGS m_heapFlags;
+    D3D12_GPU_VIRTUAL_ADDRESS m_gpuVirtualAddress;
+    std::vector<UINT8> m_memory;
+    UINT8* m_pData;
+};
+
+// Records nothing but how much GPU work was submitted, which drives the
+// simulated timeline: every draw, dispatch and indirect command counts as one.
+class NullCommandList : public NullDeviceChild<ChainInterfaces<ID3D12GraphicsCommandList, ID3D12CommandList, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullCommandList(ID3D12Device* pDevice, NullDevice* pNullDevice, D3D12_COMMAND_LIST_TYPE type) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_type(type),
+        m_isOpen(true),
+        m_workCount(0)
+    {
+    }
+
+    UINT64 GetWorkCount() const     { return m_workCount; }
+
+    D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_type;
+    }
+
+    HRESULT STDMETHODCALLTYPE Close() override
+    {
+        COUNT_NULL_API_CALL();
+        if (!m_isOpen)
+        {
+            return E_FAIL;
+        }
+        m_isOpen = false;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* /*pInitialState*/) override
+    {
+        COUNT_NULL_API_CALL();
+        if (m_isOpen || pAllocator == nullptr)
+        {
+            return E_FAIL;
+        }
+        m_isOpen = true;
+        m_workCount = 0;
+        return S_OK;
+    }
+
+    void STDMETHODCALLTYPE ClearState(ID3D12PipelineState* /*pPipelineState*/) override { COUNT_NULL_API_CALL(); }
+
+    void STDMETHODCALLTYPE DrawInstanced(UINT /*VertexCountPerInstance*/, UINT /*InstanceCount*/, UINT /*StartVertexLocation*/, UINT /*StartInstanceLocation*/) override
+    {
+        COUNT_NULL_API_CALL();
+        m_workCount++;
+    }
+
+    void STDMETHODCALLTYPE DrawIndexedInstanced(UINT /*IndexCountPerInstance*/, UINT /*InstanceCount*/, UINT /*StartIndexLocation*/, INT /*BaseVertexLocation*/, UINT /*StartInstanceLocation*/) override
+    {
+        COUNT_NULL_API_CALL();
+        m_workCount++;
+    }
+
+    void STDMETHODCALLTYPE Dispatch(UINT /*ThreadGroupCountX*/, UINT /*ThreadGroupCountY*/, UINT /*ThreadGroupCountZ*/) override
+    {
+        COUNT_NULL_API_CALL();
+        m_workCount++;
+    }
+
+    void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource* /*pDstBuffer*/, UINT64 /*DstOffset*/, ID3D12Resource* /*pSrcBuffer*/, UINT64 /*SrcOffset*/, UINT64 /*NumBytes*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION* /*pDst*/, UINT /*DstX*/, UINT /*DstY*/, UINT /*DstZ*/, const D3D12_TEXTURE_COPY_LOCATION* /*pSrc*/, const D3D12_BOX* /*pSrcBox*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE CopyResource(ID3D12Resource* /*pDstResource*/, ID3D12Resource* /*pSrcResource*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE CopyTiles(ID3D12Resource* /*pTiledResource*/, const D3D12_TILED_RESOURCE_COORDINATE* /*pTileRegionStartCoordinate*/, const D3D12_TILE_REGION_SIZE* /*pTileRegionSize*/, ID3D12Resource* /*pBuffer*/, UINT64 /*BufferStartOffsetInBytes*/, D3D12_TILE_COPY_FLAGS /*Flags*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource* /*pDstResource*/, UINT /*DstSubresource*/, ID3D12Resource* /*pSrcResource*/, UINT /*SrcSubresource*/, DXGI_FORMAT /*Format*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY /*PrimitiveTopology*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE RSSetViewports(UINT /*NumViewports*/, const D3D12_VIEWPORT* /*pViewports*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE RSSetScissorRects(UINT /*NumRects*/, const D3D12_RECT* /*pRects*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT /*BlendFactor*/[4]) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE OMSetStencilRef(UINT /*StencilRef*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* /*pPipelineState*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ResourceBarrier(UINT /*NumBarriers*/, const D3D12_RESOURCE_BARRIER* /*pBarriers*/) override { COUNT_NULL_API_CALL(); }
+
+    void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList* pCommandList) override
+    {
+        COUNT_NULL_API_CALL();
+        m_workCount += static_cast<NullCommandList*>(pCommandList)->GetWorkCount();
+    }
+
+    void STDMETHODCALLTYPE SetDescriptorHeaps(UINT /*NumDescriptorHeaps*/, ID3D12DescriptorHeap* const* /*ppDescriptorHeaps*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature* /*pRootSignature*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* /*pRootSignature*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT /*RootParameterIndex*/, D3D12_GPU_DESCRIPTOR_HANDLE /*BaseDescriptor*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT /*RootParameterIndex*/, D3D12_GPU_DESCRIPTOR_HANDLE /*BaseDescriptor*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT /*RootParameterIndex*/, UINT /*SrcData*/, UINT /*DestOffsetIn32BitValues*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT /*RootParameterIndex*/, UINT /*SrcData*/, UINT /*DestOffsetIn32BitValues*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT /*RootParameterIndex*/, UINT /*Num32BitValuesToSet*/, const void* /*pSrcData*/, UINT /*DestOffsetIn32BitValues*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT /*RootParameterIndex*/, UINT /*Num32BitValuesToSet*/, const void* /*pSrcData*/, UINT /*DestOffsetIn32BitValues*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT /*RootParameterIndex*/, D3D12_GPU_VIRTUAL_ADDRESS /*BufferLocation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* /*pView*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE IASetVertexBuffers(UINT /*StartSlot*/, UINT /*NumViews*/, const D3D12_VERTEX_BUFFER_VIEW* /*pViews*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SOSetTargets(UINT /*StartSlot*/, UINT /*NumViews*/, const D3D12_STREAM_OUTPUT_BUFFER_VIEW* /*pViews*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE OMSetRenderTargets(UINT /*NumRenderTargetDescriptors*/, const D3D12_CPU_DESCRIPTOR_HANDLE* /*pRenderTargetDescriptors*/, BOOL /*RTsSingleHandleToDescriptorRange*/, const D3D12_CPU_DESCRIPTOR_HANDLE* /*pDepthStencilDescriptor*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE /*DepthStencilView*/, D3D12_CLEAR_FLAGS /*ClearFlags*/, FLOAT /*Depth*/, UINT8 /*Stencil*/, UINT /*NumRects*/, const D3D12_RECT* /*pRects*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE /*RenderTargetView*/, const FLOAT /*ColorRGBA*/[4], UINT /*NumRects*/, const D3D12_RECT* /*pRects*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE /*ViewGPUHandleInCurrentHeap*/, D3D12_CPU_DESCRIPTOR_HANDLE /*ViewCPUHandle*/, ID3D12Resource* /*pResource*/, const UINT /*Values*/[4], UINT /*NumRects*/, const D3D12_RECT* /*pRects*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE /*ViewGPUHandleInCurrentHeap*/, D3D12_CPU_DESCRIPTOR_HANDLE /*ViewCPUHandle*/, ID3D12Resource* /*pResource*/, const FLOAT /*Values*/[4], UINT /*NumRects*/, const D3D12_RECT* /*pRects*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE DiscardResource(ID3D12Resource* /*pResource*/, const D3D12_DISCARD_REGION* /*pRegion*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap* /*pQueryHeap*/, D3D12_QUERY_TYPE /*Type*/, UINT /*Index*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap* /*pQueryHeap*/, D3D12_QUERY_TYPE /*Type*/, UINT /*Index*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap* /*pQueryHeap*/, D3D12_QUERY_TYPE /*Type*/, UINT /*StartIndex*/, UINT /*NumQueries*/, ID3D12Resource* /*pDestinationBuffer*/, UINT64 /*AlignedDestinationBufferOffset*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetPredication(ID3D12Resource* /*pBuffer*/, UINT64 /*AlignedBufferOffset*/, D3D12_PREDICATION_OP /*Operation*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE SetMarker(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE BeginEvent(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE EndEvent() override { COUNT_NULL_API_CALL(); }
+
+    void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature* /*pCommandSignature*/, UINT MaxCommandCount, ID3D12Resource* /*pArgumentBuffer*/, UINT64 /*ArgumentBufferOffset*/, ID3D12Resource* /*pCountBuffer*/, UINT64 /*CountBufferOffset*/) override
+    {
+        COUNT_NULL_API_CALL();
+        m_workCount += MaxCommandCount;
+    }
+
+private:
+    D3D12_COMMAND_LIST_TYPE m_type;
+    bool m_isOpen;
+    UINT64 m_workCount;
+};
+
+// Runs a simulated GPU clock: each submission keeps the GPU busy for its work
+// count times the device's GPU time per draw, starting when the GPU gets to it.
+class NullCommandQueue : public NullDeviceChild<ChainInterfaces<ID3D12CommandQueue, ID3D12Pageable, ID3D12DeviceChild, ID3D12Object>>
+{
+public:
+    NullCommandQueue(ID3D12Device* pDevice, NullDevice* pNullDevice, const D3D12_COMMAND_QUEUE_DESC& desc) :
+        NullDeviceChild(pDevice, pNullDevice),
+        m_desc(desc),
+        m_gpuBusyUntil(0)
+    {
+    }
+
+    void STDMETHODCALLTYPE UpdateTileMappings(ID3D12Resource* /*pResource*/, UINT /*NumResourceRegions*/, const D3D12_TILED_RESOURCE_COORDINATE* /*pResourceRegionStartCoordinates*/, const D3D12_TILE_REGION_SIZE* /*pResourceRegionSizes*/, ID3D12Heap* /*pHeap*/, UINT /*NumRanges*/, const D3D12_TILE_RANGE_FLAGS* /*pRangeFlags*/, const UINT* /*pHeapRangeStartOffsets*/, const UINT* /*pRangeTileCounts*/, D3D12_TILE_MAPPING_FLAGS /*Flags*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE CopyTileMappings(ID3D12Resource* /*pDstResource*/, const D3D12_TILED_RESOURCE_COORDINATE* /*pDstRegionStartCoordinate*/, ID3D12Resource* /*pSrcResource*/, const D3D12_TILED_RESOURCE_COORDINATE* /*pSrcRegionStartCoordinate*/, const D3D12_TILE_REGION_SIZE* /*pRegionSize*/, D3D12_TILE_MAPPING_FLAGS /*Flags*/) override { COUNT_NULL_API_CALL(); }
+
+    void STDMETHODCALLTYPE ExecuteCommandLists(UINT NumCommandLists, ID3D12CommandList* const* ppCommandLists) override
+    {
+        COUNT_NULL_API_CALL();
+        const double ticksPerDraw = m_pNullDevice->GetGpuTicksPerDraw();
+        if (ticksPerDraw <= 0.0)
+        {
+            return;
+        }
+
+        UINT64 workCount = 0;
+        for (UINT i = 0; i < NumCommandLists; i++)
+        {
+            workCount += static_cast<NullCommandList*>(ppCommandLists[i])->GetWorkCount();
+        }
+
+        const INT64 busyTicks = static_cast<INT64>(workCount * ticksPerDraw);
+        s_nullGpuBusyTicks.fetch_add(busyTicks, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const INT64 start = (std::max)(m_gpuBusyUntil, m_pNullDevice->GetClock()->GetTicks());
+        m_gpuBusyUntil = start + busyTicks;
+    }
+
+    void STDMETHODCALLTYPE SetMarker(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE BeginEvent(UINT /*Metadata*/, const void* /*pData*/, UINT /*Size*/) override { COUNT_NULL_API_CALL(); }
+    void STDMETHODCALLTYPE EndEvent() override { COUNT_NULL_API_CALL(); }
+
+    HRESULT STDMETHODCALLTYPE Signal(ID3D12Fence* pFence, UINT64 Value) override
+    {
+        COUNT_NULL_API_CALL();
+        INT64 completionTicks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            completionTicks = m_gpuBusyUntil;
+        }
+        static_cast<NullFence*>(pFence)->ScheduleSignal(Value, completionTicks);
+        return S_OK;
+    }
+
+    // The GPU stalls until the fence value completes, if that is known yet.
+    HRESULT STDMETHODCALLTYPE Wait(ID3D12Fence* pFence, UINT64 Value) override
+    {
+        COUNT_NULL_API_CALL();
+        const INT64 completionTicks = static_cast<NullFence*>(pFence)->GetCompletionTicks(Value);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_gpuBusyUntil = (std::max)(m_gpuBusyUntil, completionTicks);
+        return S_OK;
+    }
+
+    // GPU timestamps are simulated GPU clock ticks, i.e. QPC ticks.
+    HRESULT STDMETHODCALLTYPE GetTimestampFrequency(UINT64* pFrequency) override
+    {
+        COUNT_NULL_API_CALL();
+        *pFrequency = static_cast<UINT64>(m_pNullDevice->GetClock()->GetFrequency());
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetClockCalibration(UINT64* pGpuTimestamp, UINT64* pCpuTimestamp) override
+    {
+        COUNT_NULL_API_CALL();
+        *pCpuTimestamp = static_cast<UINT64>(m_pNullDevice->GetClock()->GetTicks());
+        *pGpuTimestamp = *pCpuTimestamp;
+        return S_OK;
+    }
+
+    D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GetDesc() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_desc;
+    }
+
+private:
+    D3D12_COMMAND_QUEUE_DESC m_desc;
+    std::mutex m_mutex;
+    INT64 m_gpuBusyUntil;
+};
+
+// A flip model swap chain that cycles through its buffers on Present.
+class NullSwapChain : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ChainInterfaces<IDXGISwapChain3, IDXGISwapChain2, IDXGISwapChain1, IDXGISwapChain, IDXGIDeviceSubObject, IDXGIObject>>
+{
+public:
+    NullSwapChain(ID3D12CommandQueue* pQueue, HWND hwnd, const DXGI_SWAP_CHAIN_DESC1& desc) :
+        m_queue(pQueue),
+        m_hwnd(hwnd),
+        m_desc(desc),
+        m_currentBackBufferIndex(0),
+        m_presentCount(0),
+        m_maximumFrameLatency(3),
+        m_backgroundColor(),
+        m_rotation(DXGI_MODE_ROTATION_IDENTITY),
+        m_colorSpace(DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709),
+        m_matrixTransform()
+    {
+        ThrowIfFailed(pQueue->GetDevice(IID_PPV_ARGS(&m_device)));
+
+        // Presents never block, so the frame latency waitable object is always signaled.
+        m_frameLatencyWaitableObject = CreateEvent(nullptr, TRUE, TRUE, nullptr);
+        if (m_frameLatencyWaitableObject == nullptr)
+        {
+            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+        }
+
+        ThrowIfFailed(CreateBuffers());
+    }
+
+    ~NullSwapChain()
+    {
+        CloseHandle(m_frameLatencyWaitableObject);
+    }
+
+    // IDXGIObject
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID /*Name*/, UINT /*DataSize*/, const void* /*pData*/) override { COUNT_NULL_API_CALL(); return S_OK; }
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID /*Name*/, const IUnknown* /*pUnknown*/) override { COUNT_NULL_API_CALL(); return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID /*Name*/, UINT* pDataSize, void* /*pData*/) override
+    {
+        COUNT_NULL_API_CALL();
+        if (pDataSize)
+        {
+            *pDataSize = 0;
+        }
+        return DXGI_ERROR_NOT_FOUND;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetParent(REFIID /*riid*/, void** ppParent) override
+    {
+        COUNT_NULL_API_CALL();
+        *ppParent = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    // IDXGIDeviceSubObject. Like real D3D12 swap chains, the device is the queue.
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID riid, void** ppDevice) override
+    {
+        COUNT_NULL_API_CALL();
+        return m_queue.CopyTo(riid, ppDevice);
+    }
+
+    // IDXGISwapChain
+    HRESULT STDMETHODCALLTYPE Present(UINT /*SyncInterval*/, UINT Flags) override
+    {
+        COUNT_NULL_API_CALL();
+        if (Flags & DXGI_PRESENT_TEST)
+        {
+            return S_OK;
+        }
+        m_currentBackBufferIndex = (m_currentBackBufferIndex + 1) % m_desc.BufferCount;
+        m_presentCount++;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetBuffer(UINT Buffer, REFIID riid, void** ppSurface) override
+    {
+        COUNT_NULL_API_CALL();
+        if (Buffer >= m_buffers.size())
+        {
+            return DXGI_ERROR_INVALID_CALL;
+        }
+        return m_buffers[Buffer].CopyTo(riid, ppSurface);
+    }
+
+    HRESULT STDMETHODCALLTYPE SetFullscreenState(BOOL /*Fullscreen*/, IDXGIOutput* /*pTarget*/) override { COUNT_NULL_API_CALL(); return DXGI_ERROR_NOT_CURRENTLY_AVAILABLE; }
+
+    HRESULT STDMETHODCALLTYPE GetFullscreenState(BOOL* pFullscreen, IDXGIOutput** ppTarget) override
+    {
+        COUNT_NULL_API_CALL();
+        if (pFullscreen)
+        {
+            *pFullscreen = FALSE;
+        }
+        if (ppTarget)
+        {
+            *ppTarget = nullptr;
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetDesc(DXGI_SWAP_CHAIN_DESC* pDesc) override
+    {
+        COUNT_NULL_API_CALL();
+        *pDesc = {};
+        pDesc->BufferDesc.Width = m_desc.Width;
+        pDesc->BufferDesc.Height = m_desc.Height;
+        pDesc->BufferDesc.Format = m_desc.Format;
+        pDesc->SampleDesc = m_desc.SampleDesc;
+        pDesc->BufferUsage = m_desc.BufferUsage;
+        pDesc->BufferCount = m_desc.BufferCount;
+        pDesc->OutputWindow = m_hwnd;
+        pDesc->Windowed = TRUE;
+        pDesc->SwapEffect = m_desc.SwapEffect;
+        pDesc->Flags = m_desc.Flags;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE ResizeBuffers(UINT BufferCount, UINT Width, UINT Height, DXGI_FORMAT NewFormat, UINT SwapChainFlags) override
+    {
+        COUNT_NULL_API_CALL();
+        if (BufferCount != 0)
+        {
+            m_desc.BufferCount = BufferCount;
+        }
+        if (Width != 0)
+        {
+            m_desc.Width = Width;
+        }
+        if (Height != 0)
+        {
+            m_desc.Height = Height;
+        }
+        if (NewFormat != DXGI_FORMAT_UNKNOWN)
+        {
+            m_desc.Format = NewFormat;
+        }
+        m_desc.Flags = SwapChainFlags;
+        m_currentBackBufferIndex = 0;
+        return CreateBuffers();
+    }
+
+    HRESULT STDMETHODCALLTYPE ResizeTarget(const DXGI_MODE_DESC* /*pNewTargetParameters*/) override { COUNT_NULL_API_CALL(); return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE GetContainingOutput(IDXGIOutput** ppOutput) override
+    {
+        COUNT_NULL_API_CALL();
+        *ppOutput = nullptr;
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetFrameStatistics(DXGI_FRAME_STATISTICS* /*pStats*/) override { COUNT_NULL_API_CALL(); return DXGI_ERROR_FRAME_STATISTICS_DISJOINT; }
+
+    HRESULT STDMETHODCALLTYPE GetLastPresentCount(UINT* pLastPresentCount) override
+    {
+        COUNT_NULL_API_CALL();
+        *pLastPresentCount = m_presentCount;
+        return S_OK;
+    }
+
+    // IDXGISwapChain1
+    HRESULT STDMETHODCALLTYPE GetDesc1(DXGI_SWAP_CHAIN_DESC1* pDesc) override
+    {
+        COUNT_NULL_API_CALL();
+        *pDesc = m_desc;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetFullscreenDesc(DXGI_SWAP_CHAIN_FULLSCREEN_DESC* pDesc) override
+    {
+        COUNT_NULL_API_CALL();
+        *pDesc = {};
+        pDesc->Windowed = TRUE;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetHwnd(HWND* pHwnd) override
+    {
+        COUNT_NULL_API_CALL();
+        *pHwnd = m_hwnd;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetCoreWindow(REFIID /*refiid*/, void** ppUnk) override
+    {
+        COUNT_NULL_API_CALL();
+        *ppUnk = nullptr;
+        return DXGI_ERROR_INVALID_CALL;
+    }
+
+    HRESULT STDMETHODCALLTYPE Present1(UINT SyncInterval, UINT PresentFlags, const DXGI_PRESENT_PARAMETERS* /*pPresentParameters*/) override
+    {
+        return Present(SyncInterval, PresentFlags);
+    }
+
+    BOOL STDMETHODCALLTYPE IsTemporaryMonoSupported() override { COUNT_NULL_API_CALL(); return FALSE; }
+
+    HRESULT STDMETHODCALLTYPE GetRestrictToOutput(IDXGIOutput** ppRestrictToOutput) override
+    {
+        COUNT_NULL_API_CALL();
+        *ppRestrictToOutput = nullptr;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetBackgroundColor(const DXGI_RGBA* pColor) override
+    {
+        COUNT_NULL_API_CALL();
+        m_backgroundColor = *pColor;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetBackgroundColor(DXGI_RGBA* pColor) override
+    {
+        COUNT_NULL_API_CALL();
+        *pColor = m_backgroundColor;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetRotation(DXGI_MODE_ROTATION Rotation) override
+    {
+        COUNT_NULL_API_CALL();
+        m_rotation = Rotation;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetRotation(DXGI_MODE_ROTATION* pRotation) override
+    {
+        COUNT_NULL_API_CALL();
+        *pRotation = m_rotation;
+        return S_OK;
+    }
+
+    // IDXGISwapChain2
+    HRESULT STDMETHODCALLTYPE SetSourceSize(UINT /*Width*/, UINT /*Height*/) override { COUNT_NULL_API_CALL(); return S_OK; }
+
+    HRESULT STDMETHODCALLTYPE GetSourceSize(UINT* pWidth, UINT* pHeight) override
+    {
+        COUNT_NULL_API_CALL();
+        *pWidth = m_desc.Width;
+        *pHeight = m_desc.Height;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetMaximumFrameLatency(UINT MaxLatency) override
+    {
+        COUNT_NULL_API_CALL();
+        m_maximumFrameLatency = MaxLatency;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetMaximumFrameLatency(UINT* pMaxLatency) override
+    {
+        COUNT_NULL_API_CALL();
+        *pMaxLatency = m_maximumFrameLatency;
+        return S_OK;
+    }
+
+    HANDLE STDMETHODCALLTYPE GetFrameLatencyWaitableObject() override
+    {
+        COUNT_NULL_API_CALL();
+        HANDLE handle = nullptr;
+        DuplicateHandle(GetCurrentProcess(), m_frameLatencyWaitableObject, GetCurrentProcess(), &handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+        return handle;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetMatrixTransform(const DXGI_MATRIX_3X2_F* pMatrix) override
+    {
+        COUNT_NULL_API_CALL();
+        m_matrixTransform = *pMatrix;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetMatrixTransform(DXGI_MATRIX_3X2_F* pMatrix) override
+    {
+        COUNT_NULL_API_CALL();
+        *pMatrix = m_matrixTransform;
+        return S_OK;
+    }
+
+    // IDXGISwapChain3
+    UINT STDMETHODCALLTYPE GetCurrentBackBufferIndex() override
+    {
+        COUNT_NULL_API_CALL();
+        return m_currentBackBufferIndex;
+    }
+
+    HRESULT STDMETHODCALLTYPE CheckColorSpaceSupport(DXGI_COLOR_SPACE_TYPE ColorSpace, UINT* pColorSpaceSupport) override
+    {
+        COUNT_NULL_API_CALL();
+        *pColorSpaceSupport = ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709 ? DXGI_SWAP_CHAIN_COLOR_SPACE_SUPPORT_FLAG_PRESENT : 0;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SetColorSpace1(DXGI_COLOR_SPACE_TYPE ColorSpace) override
+    {
+        COUNT_NULL_API_CALL();
+        m_colorSpace = ColorSpace;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE ResizeBuffers1(UINT BufferCount, UINT Width, UINT Height, DXGI_FORMAT Format, UINT SwapChainFlags, const UINT* /*pCreationNodeMask*/, IUnknown* const* /*ppPresentQueue*/) override
+    {
+        return ResizeBuffers(BufferCount, Width, Height, Format, SwapChainFlags);
+    }
+
+private:
+    HRESULT CreateBuffers()
+    {
+        m_buffers.clear();
+        m_buffers.resize(m_desc.BufferCount);
+        for (UINT n = 0; n < m_desc.BufferCount; n++)
+        {
+            HRESULT hr = m_device->CreateCommittedResource(
+                &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+                D3D12_HEAP_FLAG_NONE,
+                &CD3DX12_RESOURCE_DESC::Tex2D(m_desc.Format, m_desc.Width, m_desc.Height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET),
+                D3D12_RESOURCE_STATE_PRESENT,
+                nullptr,
+                IID_PPV_ARGS(&m_buffers[n]));
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        return S_OK;
+    }
+
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12Device> m_device;
+    HWND m_hwnd;
+    DXGI_SWAP_CHAIN_DESC1 m_desc;
+    std::vector<ComPtr<ID3D12Resource>> m_buffers;
+    UINT m_currentBackBufferIndex;
+    UINT m_presentCount;
+    UINT m_maximumFrameLatency;
+    HANDLE m_frameLatencyWaitableObject;
+    DXGI_RGBA m_backgroundColor;
+    DXGI_MODE_ROTATION m_rotation;
+    DXGI_COLOR_SPACE_TYPE m_colorSpace;
+    DXGI_MATRIX_3X2_F m_matrixTransform;
+};
+
+NullDevice::NullDevice(float gpuMicrosecondsPerDraw) :
+    m_gpuTicksPerDraw(gpuMicrosecondsPerDraw * 1e-6 * m_clock.GetFrequency()),
+    m_nextGpuVirtualAddress(1ull << 32)
+{
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS NullDevice::AllocateGpuVirtualAddress(UINT64 size)
+{
+    return m_nextGpuVirtualAddress.fetch_add(AlignUp((std::max)(size, UINT64(1)), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT));
+}
+
+UINT NullDevice::GetNodeCount()
+{
+    COUNT_NULL_API_CALL();
+    return 1;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC* pDesc, REFIID riid, void** ppCommandQueue)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullCommandQueue>(this, this, *pDesc), riid, ppCommandQueue);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE /*type*/, REFIID riid, void** ppCommandAllocator)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullCommandAllocator>(this, this), riid, ppCommandAllocator);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* /*pDesc*/, REFIID riid, void** ppPipelineState)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullPipelineState>(this, this), riid, ppPipelineState);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC* /*pDesc*/, REFIID riid, void** ppPipelineState)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullPipelineState>(this, this), riid, ppPipelineState);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateCommandList(UINT /*nodeMask*/, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* pCommandAllocator, ID3D12PipelineState* /*pInitialState*/, REFIID riid, void** ppCommandList)
+{
+    COUNT_NULL_API_CALL();
+    if (pCommandAllocator == nullptr)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(Make<NullCommandList>(this, this, type), riid, ppCommandList);
+}
+
+// Reports a conservative feature set: feature level 11_0, resource binding tier
+// 2, so that bindless draws can be recorded, resource heap tier 1 and root
+// signature version 1.1.
+_Use_decl_annotations_
+HRESULT NullDevice::CheckFeatureSupport(D3D12_FEATURE Feature, void* pFeatureSupportData, UINT FeatureSupportDataSize)
+{
+    COUNT_NULL_API_CALL();
+    switch (Feature)
+    {
+    case D3D12_FEATURE_D3D12_OPTIONS:
+        if (FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_D3D12_OPTIONS))
+        {
+            return E_INVALIDARG;
+        }
+        *static_cast<D3D12_FEATURE_DATA_D3D12_OPTIONS*>(pFeatureSupportData) = {};
+        static_cast<D3D12_FEATURE_DATA_D3D12_OPTIONS*>(pFeatureSupportData)->ResourceBindingTier = D3D12_RESOURCE_BINDING_TIER_2;
+        static_cast<D3D12_FEATURE_DATA_D3D12_OPTIONS*>(pFeatureSupportData)->ResourceHeapTier = D3D12_RESOURCE_HEAP_TIER_1;
+        return S_OK;
+
+    case D3D12_FEATURE_ARCHITECTURE:
+        if (FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_ARCHITECTURE))
+        {
+            return E_INVALIDARG;
+        }
+        static_cast<D3D12_FEATURE_DATA_ARCHITECTURE*>(pFeatureSupportData)->TileBasedRenderer = FALSE;
+        static_cast<D3D12_FEATURE_DATA_ARCHITECTURE*>(pFeatureSupportData)->UMA = FALSE;
+        static_cast<D3D12_FEATURE_DATA_ARCHITECTURE*>(pFeatureSupportData)->CacheCoherentUMA = FALSE;
+        return S_OK;
+
+    case D3D12_FEATURE_FEATURE_LEVELS:
+    {
+        if (FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_FEATURE_LEVELS))
+        {
+            return E_INVALIDARG;
+        }
+        D3D12_FEATURE_DATA_FEATURE_LEVELS* pLevels = static_cast<D3D12_FEATURE_DATA_FEATURE_LEVELS*>(pFeatureSupportData);
+        pLevels->MaxSupportedFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+        for (UINT i = 0; i < pLevels->NumFeatureLevels; i++)
+        {
+            if (pLevels->pFeatureLevelsRequested[i] <= D3D_FEATURE_LEVEL_11_0)
+            {
+                pLevels->MaxSupportedFeatureLevel = (std::max)(pLevels->MaxSupportedFeatureLevel, pLevels->pFeatureLevelsRequested[i]);
+            }
+        }
+        return S_OK;
+    }
+
+    case D3D12_FEATURE_ROOT_SIGNATURE:
+    {
+        if (FeatureSupportDataSize != sizeof(D3D12_FEATURE_DATA_ROOT_SIGNATURE))
+        {
+            return E_INVALIDARG;
+        }
+        D3D12_FEATURE_DATA_ROOT_SIGNATURE* pRootSignature = static_cast<D3D12_FEATURE_DATA_ROOT_SIGNATURE*>(pFeatureSupportData);
+        pRootSignature->HighestVersion = (std::min)(pRootSignature->HighestVersion, D3D_ROOT_SIGNATURE_VERSION_1_1);
+        return S_OK;
+    }
+
+    default:
+        return E_INVALIDARG;
+    }
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc, REFIID riid, void** ppvHeap)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullDescriptorHeap>(this, this, *pDescriptorHeapDesc), riid, ppvHeap);
+}
+
+UINT NullDevice::GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapType*/)
+{
+    COUNT_NULL_API_CALL();
+    return NullDescriptorSize;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateRootSignature(UINT /*nodeMask*/, const void* pBlobWithRootSignature, SIZE_T blobLengthInBytes, REFIID riid, void** ppvRootSignature)
+{
+    COUNT_NULL_API_CALL();
+    if (pBlobWithRootSignature == nullptr || blobLengthInBytes == 0)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(Make<NullRootSignature>(this, this), riid, ppvRootSignature);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, pDesc ? pDesc->BufferLocation : 0, NullDescriptorConstantBufferView);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateShaderResourceView(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* /*pDesc*/, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, reinterpret_cast<UINT64>(pResource), NullDescriptorShaderResourceView);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateUnorderedAccessView(ID3D12Resource* pResource, ID3D12Resource* /*pCounterResource*/, const D3D12_UNORDERED_ACCESS_VIEW_DESC* /*pDesc*/, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, reinterpret_cast<UINT64>(pResource), NullDescriptorUnorderedAccessView);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateRenderTargetView(ID3D12Resource* pResource, const D3D12_RENDER_TARGET_VIEW_DESC* /*pDesc*/, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, reinterpret_cast<UINT64>(pResource), NullDescriptorRenderTargetView);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateDepthStencilView(ID3D12Resource* pResource, const D3D12_DEPTH_STENCIL_VIEW_DESC* /*pDesc*/, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, reinterpret_cast<UINT64>(pResource), NullDescriptorDepthStencilView);
+}
+
+_Use_decl_annotations_
+void NullDevice::CreateSampler(const D3D12_SAMPLER_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+{
+    COUNT_NULL_API_CALL();
+    WriteNullDescriptor(DestDescriptor, pDesc->Filter, NullDescriptorSampler);
+}
+
+_Use_decl_annotations_
+void NullDevice::CopyDescriptors(UINT NumDestDescriptorRanges, const D3D12_CPU_DESCRIPTOR_HANDLE* pDestDescriptorRangeStarts, const UINT* pDestDescriptorRangeSizes, UINT NumSrcDescriptorRanges, const D3D12_CPU_DESCRIPTOR_HANDLE* pSrcDescriptorRangeStarts, const UINT* pSrcDescriptorRangeSizes, D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapsType*/)
+{
+    COUNT_NULL_API_CALL();
+
+    // Both sides are walked descriptor by descriptor, each range after the
+    // other; a missing size array means ranges of one descriptor.
+    UINT destRange = 0, destIndex = 0;
+    UINT srcRange = 0, srcIndex = 0;
+    while (destRange < NumDestDescriptorRanges && srcRange < NumSrcDescriptorRanges)
+    {
+        const UINT destSize = pDestDescriptorRangeSizes ? pDestDescriptorRangeSizes[destRange] : 1;
+        const UINT srcSize = pSrcDescriptorRangeSizes ? pSrcDescriptorRangeSizes[srcRange] : 1;
+        if (destIndex == destSize)
+        {
+            destRange++;
+            destIndex = 0;
+            continue;
+        }
+        if (srcIndex == srcSize)
+        {
+            srcRange++;
+            srcIndex = 0;
+            continue;
+        }
+
+        memcpy(reinterpret_cast<void*>(pDestDescriptorRangeStarts[destRange].ptr + SIZE_T(destIndex) * NullDescriptorSize),
+            reinterpret_cast<const void*>(pSrcDescriptorRangeStarts[srcRange].ptr + SIZE_T(srcIndex) * NullDescriptorSize), NullDescriptorSize);
+        destIndex++;
+        srcIndex++;
+    }
+}
+
+_Use_decl_annotations_
+void NullDevice::CopyDescriptorsSimple(UINT NumDescriptors, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptorRangeStart, D3D12_CPU_DESCRIPTOR_HANDLE SrcDescriptorRangeStart, D3D12_DESCRIPTOR_HEAP_TYPE /*DescriptorHeapsType*/)
+{
+    COUNT_NULL_API_CALL();
+    memmove(reinterpret_cast<void*>(DestDescriptorRangeStart.ptr), reinterpret_cast<const void*>(SrcDescriptorRangeStart.ptr), SIZE_T(NumDescriptors) * NullDescriptorSize);
+}
+
+// Sizes resources like a typical driver: footprint size rounded up to the
+// placement alignment, with 4MB alignment for MSAA textures.
+_Use_decl_annotations_
+D3D12_RESOURCE_ALLOCATION_INFO NullDevice::GetResourceAllocationInfo(UINT /*visibleMask*/, UINT numResourceDescs, const D3D12_RESOURCE_DESC* pResourceDescs)
+{
+    COUNT_NULL_API_CALL();
+    D3D12_RESOURCE_ALLOCATION_INFO info = { 0, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+    for (UINT i = 0; i < numResourceDescs; i++)
+    {
+        const D3D12_RESOURCE_DESC& desc = pResourceDescs[i];
+        UINT64 alignment = desc.Alignment;
+        if (alignment == 0)
+        {
+            alignment = desc.SampleDesc.Count > 1 ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+
+        UINT64 size = desc.Width;
+        if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            const UINT16 arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+            const UINT subresourceCount = (std::max)(desc.MipLevels, UINT16(1)) * arraySize;
+            D3D12_RESOURCE_DESC footprintDesc = desc;
+            footprintDesc.MipLevels = (std::max)(desc.MipLevels, UINT16(1));
+            UINT64 footprintSize = 0;
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(subresourceCount);
+            GetCopyableFootprints(&footprintDesc, 0, subresourceCount, 0, layouts.data(), nullptr, nullptr, &footprintSize);
+            size = footprintSize * (std::max)(desc.SampleDesc.Count, 1u);
+        }
+
+        info.Alignment = (std::max)(info.Alignment, alignment);
+        info.SizeInBytes = AlignUp(info.SizeInBytes, alignment) + AlignUp(size, alignment);
+    }
+    return info;
+}
+
+D3D12_HEAP_PROPERTIES NullDevice::GetCustomHeapProperties(UINT /*nodeMask*/, D3D12_HEAP_TYPE heapType)
+{
+    COUNT_NULL_API_CALL();
+    D3D12_HEAP_PROPERTIES properties = {};
+    properties.Type = D3D12_HEAP_TYPE_CUSTOM;
+    properties.CPUPageProperty = heapType == D3D12_HEAP_TYPE_DEFAULT ? D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE :
+        heapType == D3D12_HEAP_TYPE_READBACK ? D3D12_CPU_PAGE_PROPERTY_WRITE_BACK : D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE;
+    properties.MemoryPoolPreference = heapType == D3D12_HEAP_TYPE_DEFAULT ? D3D12_MEMORY_POOL_L1 : D3D12_MEMORY_POOL_L0;
+    properties.CreationNodeMask = 1;
+    properties.VisibleNodeMask = 1;
+    return properties;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateCommittedResource(const D3D12_HEAP_PROPERTIES* pHeapProperties, D3D12_HEAP_FLAGS HeapFlags, const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES /*InitialResourceState*/, const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/, REFIID riidResource, void** ppvResource)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullResource>(this, this, *pDesc, pHeapProperties, HeapFlags), riidResource, ppvResource);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateHeap(const D3D12_HEAP_DESC* pDesc, REFIID riid, void** ppvHeap)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullHeap>(this, this, *pDesc), riid, ppvHeap);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreatePlacedResource(ID3D12Heap* pHeap, UINT64 HeapOffset, const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES /*InitialState*/, const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/, REFIID riid, void** ppvResource)
+{
+    COUNT_NULL_API_CALL();
+    NullHeap* pNullHeap = static_cast<NullHeap*>(pHeap);
+    const D3D12_RESOURCE_ALLOCATION_INFO info = GetResourceAllocationInfo(0, 1, pDesc);
+    if (HeapOffset % info.Alignment != 0 || HeapOffset + info.SizeInBytes > pNullHeap->GetHeapDesc().SizeInBytes)
+    {
+        return E_INVALIDARG;
+    }
+    return ReturnObject(Make<NullResource>(this, this, *pDesc, pNullHeap, HeapOffset), riid, ppvResource);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateReservedResource(const D3D12_RESOURCE_DESC* pDesc, D3D12_RESOURCE_STATES /*InitialState*/, const D3D12_CLEAR_VALUE* /*pOptimizedClearValue*/, REFIID riid, void** ppvResource)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullResource>(this, this, *pDesc, nullptr, D3D12_HEAP_FLAG_NONE), riid, ppvResource);
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateSharedHandle(ID3D12DeviceChild* /*pObject*/, const SECURITY_ATTRIBUTES* /*pAttributes*/, DWORD /*Access*/, LPCWSTR /*Name*/, HANDLE* /*pHandle*/)
+{
+    COUNT_NULL_API_CALL();
+    return E_NOTIMPL;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::OpenSharedHandle(HANDLE /*NTHandle*/, REFIID /*riid*/, void** /*ppvObj*/)
+{
+    COUNT_NULL_API_CALL();
+    return E_NOTIMPL;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::OpenSharedHandleByName(LPCWSTR /*Name*/, DWORD /*Access*/, HANDLE* /*pNTHandle*/)
+{
+    COUNT_NULL_API_CALL();
+    return E_NOTIMPL;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::MakeResident(UINT /*NumObjects*/, ID3D12Pageable* const* /*ppObjects*/)
+{
+    COUNT_NULL_API_CALL();
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::Evict(UINT /*NumObjects*/, ID3D12Pageable* const* /*ppObjects*/)
+{
+    COUNT_NULL_API_CALL();
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS /*Flags*/, REFIID riid, void** ppFence)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullFence>(this, this, InitialValue), riid, ppFence);
+}
+
+HRESULT NullDevice::GetDeviceRemovedReason()
+{
+    COUNT_NULL_API_CALL();
+    return S_OK;
+}
+
+// Lays subresources out back to back with the pitch and placement alignment
+// copies require. Block compressed and planar formats are not handled.
+_Use_decl_annotations_
+void NullDevice::GetCopyableFootprints(const D3D12_RESOURCE_DESC* pResourceDesc, UINT FirstSubresource, UINT NumSubresources, UINT64 BaseOffset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts, UINT* pNumRows, UINT64* pRowSizeInBytes, UINT64* pTotalBytes)
+{
+    COUNT_NULL_API_CALL();
+    const D3D12_RESOURCE_DESC& desc = *pResourceDesc;
+    const bool isBuffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+    const UINT mipLevels = (std::max)(desc.MipLevels, UINT16(1));
+    const UINT elementSize = isBuffer ? 1 : GetFormatElementSize(desc.Format);
+
+    UINT64 offset = BaseOffset;
+    UINT64 end = BaseOffset;
+    for (UINT i = 0; i < NumSubresources; i++)
+    {
+        const UINT mip = isBuffer ? 0 : (FirstSubresource + i) % mipLevels;
+        const UINT width = isBuffer ? static_cast<UINT>(desc.Width) : (std::max)(static_cast<UINT>(desc.Width >> mip), 1u);
+        const UINT height = isBuffer ? 1 : (std::max)(desc.Height >> mip, 1u);
+        const UINT depth = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? (std::max)(static_cast<UINT>(desc.DepthOrArraySize >> mip), 1u) : 1;
+        const UINT64 rowSize = static_cast<UINT64>(width) * elementSize;
+        const UINT rowPitch = static_cast<UINT>(AlignUp(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+
+        offset = AlignUp(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        if (pLayouts)
+        {
+            pLayouts[i].Offset = offset;
+            pLayouts[i].Footprint.Format = isBuffer ? DXGI_FORMAT_UNKNOWN : desc.Format;
+            pLayouts[i].Footprint.Width = width;
+            pLayouts[i].Footprint.Height = height;
+            pLayouts[i].Footprint.Depth = depth;
+            pLayouts[i].Footprint.RowPitch = rowPitch;
+        }
+        if (pNumRows)
+        {
+            pNumRows[i] = height;
+        }
+        if (pRowSizeInBytes)
+        {
+            pRowSizeInBytes[i] = rowSize;
+        }
+
+        // The last row only needs its actual size, not the full pitch.
+        end = offset + static_cast<UINT64>(rowPitch) * (height * depth - 1) + rowSize;
+        offset += static_cast<UINT64>(rowPitch) * height * depth;
+    }
+
+    if (pTotalBytes)
+    {
+        *pTotalBytes = end - BaseOffset;
+    }
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateQueryHeap(const D3D12_QUERY_HEAP_DESC* /*pDesc*/, REFIID riid, void** ppvHeap)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullQueryHeap>(this, this), riid, ppvHeap);
+}
+
+HRESULT NullDevice::SetStablePowerState(BOOL /*Enable*/)
+{
+    COUNT_NULL_API_CALL();
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT NullDevice::CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC* /*pDesc*/, ID3D12RootSignature* /*pRootSignature*/, REFIID riid, void** ppvCommandSignature)
+{
+    COUNT_NULL_API_CALL();
+    return ReturnObject(Make<NullCommandSignature>(this, this), riid, ppvCommandSignature);
+}
+
+_Use_decl_annotations_
+void NullDevice::GetResourceTiling(ID3D12Resource* /*pTiledResource*/, UINT* pNumTilesForEntireResource, D3D12_PACKED_MIP_INFO* pPackedMipDesc, D3D12_TILE_SHAPE* pStandardTileShapeForNonPackedMips, UINT* pNumSubresourceTilings, UINT /*FirstSubresourceTilingToGet*/, D3D12_SUBRESOURCE_TILING* /*pSubresourceTilingsForNonPackedMips*/)
+{
+    COUNT_NULL_API_CALL();
+    if (pNumTilesForEntireResource)
+    {
+        *pNumTilesForEntireResource = 0;
+    }
+    if (pPackedMipDesc)
+    {
+        *pPackedMipDesc = {};
+    }
+    if (pStandardTileShapeForNonPackedMips)
+    {
+        *pStandardTileShapeForNonPackedMips = {};
+    }
+    if (pNumSubresourceTilings)
+    {
+        *pNumSubresourceTilings = 0;
+    }
+}
+
+LUID NullDevice::GetAdapterLuid()
+{
+    COUNT_NULL_API_CALL();
+    return LUID{};
+}
+
+_Use_decl_annotations_
+HRESULT CreateNullDevice(float gpuMicrosecondsPerDraw, REFIID riid, void** ppDevice)
+{
+    return ReturnObject(Make<NullDevice>(gpuMicrosecondsPerDraw), riid, ppDevice);
+}
+
+UINT64 GetNullGpuBusyTicks()
+{
+    return s_nullGpuBusyTicks.load(std::memory_order_relaxed);
+}
+
+_Use_decl_annotations_
+HRESULT CreateNullSwapChain(ID3D12CommandQueue* pQueue, HWND hwnd, const DXGI_SWAP_CHAIN_DESC1* pDesc, IDXGISwapChain1** ppSwapChain)
+{
+    ComPtr<NullSwapChain> swapChain = Make<NullSwapChain>(pQueue, hwnd, *pDesc);
+    return ReturnObject(swapChain, IID_PPV_ARGS(ppSwapChain));
+}
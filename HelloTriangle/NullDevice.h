@@ -0,0 +1,76 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+#include "DXSampleHelper.h"
+
+// A D3D12 device that does no GPU work at all. Every interface the sample uses
+// (device, queue, command lists, allocators, fences, resources, descriptor heaps
+// and the swap chain) is implemented, accepts all calls and records nothing, so
+// the frame loop runs unchanged and what remains is the pure CPU cost of the
+// application and its API usage. Every call is counted per entry point.
+//
+// Fences complete as soon as they are signaled, unless a simulated GPU time per
+// draw is given: the queue then advances a simulated GPU clock by the work in
+// each submission and signals complete when that clock passes them.
+//
+// CPU-visible buffers (upload and readback heaps) are backed by system memory so
+// that mapping them works; everything else has a GPU virtual address but no
+// storage.
+
+// Process-wide counts of null device API calls, keyed by entry point.
+class NullApiCallCounter
+{
+public:
+    static const UINT MaxCallSites = 512;
+
+    // Registers an entry point once; the returned index is what Increment takes.
+    static UINT Register(const char* pName);
+
+    static void Increment(UINT index)
+    {
+        s_counts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Total number of calls made so far, over all entry points.
+    static UINT64 GetTotal();
+
+    // Writes the per entry point counts, highest first, to the debugger and stdout.
+    static void Report();
+
+private:
+    static std::atomic<UINT64> s_counts[MaxCallSites];
+    static const char* s_names[MaxCallSites];
+    static std::atomic<UINT> s_callSiteCount;
+};
+
+// Counts a call of the enclosing function.
+#define COUNT_NULL_API_CALL() \
+    static const UINT s_nullApiCallIndex = NullApiCallCounter::Register(__FUNCTION__); \
+    NullApiCallCounter::Increment(s_nullApiCallIndex)
+
+// Creates a null device. A gpuMicrosecondsPerDraw of 0 completes fences as soon
+// as they are signaled.
+HRESULT CreateNullDevice(float gpuMicrosecondsPerDraw, REFIID riid, _COM_Outptr_ void** ppDevice);
+
+// The simulated GPU time of everything submitted to null device queues so far,
+// in QPC ticks.
+UINT64 GetNullGpuBusyTicks();
+
+// Creates a swap chain for a command queue of a null device. The swap chain
+// never shows anything; the window handle is only reported back by GetHwnd.
+HRESULT CreateNullSwapChain(
+    _In_ ID3D12CommandQueue* pQueue,
+    HWND hwnd,
+    _In_ const DXGI_SWAP_CHAIN_DESC1* pDesc,
+    _COM_Outptr_ IDXGISwapChain1** ppSwapChain);
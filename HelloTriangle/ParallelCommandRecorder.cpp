@@ -0,0 +1,164 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "ParallelCommandRecorder.h"
+#include "CommandStreamCapture.h"
+#include "CpuProfiler.h"
+
+ParallelCommandRecorder::ParallelCommandRecorder(ID3D12Device* pDevice, CommandAllocatorPool* pAllocatorPool, UINT threadCount, CommandStreamCapture* pCapture) :
+    m_pAllocatorPool(pAllocatorPool),
+    m_threadCount((std::max)(1u, (std::min)(threadCount, MaxThreadCount))),
+    m_commandLists(),
+    m_exit(false),
+    m_pInitialState(nullptr),
+    m_pSetup(nullptr),
+    m_pDraw(nullptr)
+{
+    for (UINT i = 0; i < m_threadCount; i++)
+    {
+        Context& context = m_contexts[i];
+        context.firstDraw = 0;
+        context.drawCount = 0;
+        context.beginEvent = nullptr;
+        context.finishEvent = nullptr;
+
+        // No worker is running yet, so every sub-pool can be used from here.
+        ID3D12CommandAllocator* pAllocator = m_pAllocatorPool->Acquire(i, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        ThrowIfFailed(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, pAllocator, nullptr, IID_PPV_ARGS(&context.commandList)));
+        ThrowIfFailed(context.commandList->Close());
+        SetNameIndexed(context.commandList.Get(), L"ParallelCommandList", i);
+        if (pCapture)
+        {
+            pCapture->Wrap(context.commandList);
+        }
+
+        m_commandLists[i] = context.commandList.Get();
+
+        // The first range is always recorded by the thread calling Record().
+        if (i > 0)
+        {
+            context.beginEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            context.finishEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            if (context.beginEvent == nullptr || context.finishEvent == nullptr)
+            {
+                ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+            }
+            context.thread = std::thread(&ParallelCommandRecorder::WorkerThread, this, i);
+        }
+    }
+}
+
+ParallelCommandRecorder::~ParallelCommandRecorder()
+{
+    m_exit = true;
+    for (UINT i = 1; i < m_threadCount; i++)
+    {
+        Context& context = m_contexts[i];
+        if (context.thread.joinable())
+        {
+            SetEvent(context.beginEvent);
+            context.thread.join();
+        }
+        CloseHandle(context.beginEvent);
+        CloseHandle(context.finishEvent);
+    }
+}
+
+void ParallelCommandRecorder::Record(ID3D12PipelineState* pInitialState, UINT drawCount, const SetupCallback& setup, const DrawCallback& draw)
+{
+    m_pInitialState = pInitialState;
+    m_pSetup = &setup;
+    m_pDraw = &draw;
+
+    // Partition the draws into contiguous ranges so the lists execute in draw order.
+    const UINT drawsPerThread = drawCount / m_threadCount;
+    const UINT remainder = drawCount % m_threadCount;
+    UINT firstDraw = 0;
+    for (UINT i = 0; i < m_threadCount; i++)
+    {
+        m_contexts[i].firstDraw = firstDraw;
+        m_contexts[i].drawCount = drawsPerThread + (i < remainder ? 1 : 0);
+        firstDraw += m_contexts[i].drawCount;
+    }
+
+    HANDLE finishEvents[MaxThreadCount];
+    for (UINT i = 1; i < m_threadCount; i++)
+    {
+        finishEvents[i - 1] = m_contexts[i].finishEvent;
+        SetEvent(m_contexts[i].beginEvent);
+    }
+
+    RecordRange(0);
+
+    if (m_threadCount > 1)
+    {
+        WaitForMultipleObjects(m_threadCount - 1, finishEvents, TRUE, INFINITE);
+    }
+
+    // Surface the first failure on the calling thread.
+    for (UINT i = 0; i < m_threadCount; i++)
+    {
+        if (m_contexts[i].error)
+        {
+            std::exception_ptr error = m_contexts[i].error;
+            m_contexts[i].error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    m_pSetup = nullptr;
+    m_pDraw = nullptr;
+}
+
+void ParallelCommandRecorder::WorkerThread(UINT threadIndex)
+{
+    char threadName[32];
+    sprintf_s(threadName, "Recording thread %u", threadIndex);
+    CpuProfiler::SetThreadName(threadName);
+
+    Context& context = m_contexts[threadIndex];
+    for (;;)
+    {
+        WaitForSingleObject(context.beginEvent, INFINITE);
+        if (m_exit)
+        {
+            break;
+        }
+
+        RecordRange(threadIndex);
+        SetEvent(context.finishEvent);
+    }
+}
+
+void ParallelCommandRecorder::RecordRange(UINT threadIndex)
+{
+    PROFILE_ZONE("Record");
+
+    Context& context = m_contexts[threadIndex];
+    try
+    {
+        ID3D12CommandAllocator* pAllocator = m_pAllocatorPool->Acquire(threadIndex, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        ThrowIfFailed(context.commandList->Reset(pAllocator, m_pInitialState));
+
+        (*m_pSetup)(context.commandList.Get());
+        if (context.drawCount > 0)
+        {
+            (*m_pDraw)(context.commandList.Get(), context.firstDraw, context.drawCount);
+        }
+
+        ThrowIfFailed(context.commandList->Close());
+    }
+    catch (...)
+    {
+        context.error = std::current_exception();
+    }
+}
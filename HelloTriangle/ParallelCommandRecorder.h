@@ -0,0 +1,77 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <thread>
+#include "DXSampleHelper.h"
+#include "CommandAllocatorPool.h"
+
+class CommandStreamCapture;
+
+// Splits a frame's draws into contiguous ranges and records each range into its
+// own command list on its own thread. The calling thread records the first range
+// itself, so a single-threaded recorder costs no thread hand-off at all.
+//
+// Command lists do not inherit state from each other; the setup callback runs at
+// the start of every list to establish the root signature, viewport, render
+// targets and anything else the draws rely on.
+class ParallelCommandRecorder
+{
+public:
+    using SetupCallback = std::function<void(ID3D12GraphicsCommandList* pCommandList)>;
+    using DrawCallback = std::function<void(ID3D12GraphicsCommandList* pCommandList, UINT firstDraw, UINT drawCount)>;
+
+    static const UINT MaxThreadCount = CommandAllocatorPool::MaxThreadCount;
+
+    // Thread i records with allocators acquired from the pool's sub-pool i; the
+    // thread calling Record() is thread 0. With a capture, the command lists are
+    // wrapped so that everything they record is captured.
+    ParallelCommandRecorder(ID3D12Device* pDevice, CommandAllocatorPool* pAllocatorPool, UINT threadCount, CommandStreamCapture* pCapture = nullptr);
+    ~ParallelCommandRecorder();
+
+    // Records drawCount draws. Returns once every command list is closed.
+    void Record(ID3D12PipelineState* pInitialState, UINT drawCount, const SetupCallback& setup, const DrawCallback& draw);
+
+    // The recorded command lists, in draw order, ready for ExecuteCommandLists.
+    UINT GetCommandListCount() const                        { return m_threadCount; }
+    ID3D12CommandList* const* GetCommandLists() const       { return m_commandLists; }
+
+    UINT GetThreadCount() const                             { return m_threadCount; }
+
+private:
+    struct Context
+    {
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        UINT firstDraw;
+        UINT drawCount;
+        HANDLE beginEvent;
+        HANDLE finishEvent;
+        std::exception_ptr error;
+        std::thread thread;
+    };
+
+    void WorkerThread(UINT threadIndex);
+    void RecordRange(UINT threadIndex);
+
+    CommandAllocatorPool* m_pAllocatorPool;
+    UINT m_threadCount;
+    Context m_contexts[MaxThreadCount];
+    ID3D12CommandList* m_commandLists[MaxThreadCount];
+    bool m_exit;
+
+    // The job currently being recorded; only valid during Record().
+    ID3D12PipelineState* m_pInitialState;
+    const SetupCallback* m_pSetup;
+    const DrawCallback* m_pDraw;
+};
@@ -0,0 +1,157 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "PipelineStatistics.h"
+
+PipelineStatisticsCollector::PipelineStatisticsCollector(ID3D12Device* pDevice, UINT frameCount) :
+    m_passNames(frameCount * MaxPassesPerFrame, nullptr),
+    m_passCounts(frameCount, 0),
+    m_pending(frameCount, false),
+    m_currentFrameIndex(0),
+    m_passCount(0)
+{
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS;
+    queryHeapDesc.Count = frameCount * MaxPassesPerFrame;
+    ThrowIfFailed(pDevice->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_pipelineQueryHeap)));
+    NAME_D3D12_OBJECT(m_pipelineQueryHeap);
+
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_OCCLUSION;
+    ThrowIfFailed(pDevice->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_occlusionQueryHeap)));
+    NAME_D3D12_OBJECT(m_occlusionQueryHeap);
+
+    ThrowIfFailed(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(frameCount * FrameDataSize),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(&m_readbackBuffer)));
+    NAME_D3D12_OBJECT(m_readbackBuffer);
+
+    ResetStatistics();
+}
+
+PipelineStatisticsCollector::~PipelineStatisticsCollector()
+{
+}
+
+void PipelineStatisticsCollector::BeginFrame(UINT frameIndex)
+{
+    m_currentFrameIndex = frameIndex;
+    m_passCount.store(0, std::memory_order_relaxed);
+}
+
+UINT PipelineStatisticsCollector::BeginPass(ID3D12GraphicsCommandList* pCommandList, const char* pName)
+{
+    const UINT pass = m_passCount.fetch_add(1, std::memory_order_relaxed);
+    if (pass >= MaxPassesPerFrame)
+    {
+        return InvalidPass;
+    }
+
+    const UINT query = m_currentFrameIndex * MaxPassesPerFrame + pass;
+    m_passNames[query] = pName;
+    pCommandList->BeginQuery(m_pipelineQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, query);
+    pCommandList->BeginQuery(m_occlusionQueryHeap.Get(), D3D12_QUERY_TYPE_OCCLUSION, query);
+    return pass;
+}
+
+void PipelineStatisticsCollector::EndPass(ID3D12GraphicsCommandList* pCommandList, UINT pass)
+{
+    if (pass != InvalidPass)
+    {
+        const UINT query = m_currentFrameIndex * MaxPassesPerFrame + pass;
+        pCommandList->EndQuery(m_occlusionQueryHeap.Get(), D3D12_QUERY_TYPE_OCCLUSION, query);
+        pCommandList->EndQuery(m_pipelineQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, query);
+    }
+}
+
+void PipelineStatisticsCollector::EndFrame(ID3D12GraphicsCommandList* pCommandList)
+{
+    const UINT passCount = (std::min)(m_passCount.load(std::memory_order_relaxed), MaxPassesPerFrame);
+    if (passCount > 0)
+    {
+        const UINT firstQuery = m_currentFrameIndex * MaxPassesPerFrame;
+        const UINT64 offset = m_currentFrameIndex * FrameDataSize;
+        pCommandList->ResolveQueryData(m_pipelineQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, firstQuery, passCount, m_readbackBuffer.Get(), offset);
+        pCommandList->ResolveQueryData(m_occlusionQueryHeap.Get(), D3D12_QUERY_TYPE_OCCLUSION, firstQuery, passCount, m_readbackBuffer.Get(), offset + OcclusionDataOffset);
+    }
+    m_passCounts[m_currentFrameIndex] = passCount;
+    m_pending[m_currentFrameIndex] = true;
+}
+
+void PipelineStatisticsCollector::ReadFrame(UINT frameIndex)
+{
+    if (!m_pending[frameIndex])
+    {
+        return;
+    }
+    m_pending[frameIndex] = false;
+    m_statistics.frameCount++;
+
+    const UINT passCount = m_passCounts[frameIndex];
+    if (passCount == 0)
+    {
+        return;
+    }
+
+    const SIZE_T offset = frameIndex * FrameDataSize;
+    UINT8* pData;
+    ThrowIfFailed(m_readbackBuffer->Map(0, &CD3DX12_RANGE(offset, offset + FrameDataSize), reinterpret_cast<void**>(&pData)));
+    const D3D12_QUERY_DATA_PIPELINE_STATISTICS* pPipeline = reinterpret_cast<const D3D12_QUERY_DATA_PIPELINE_STATISTICS*>(pData + offset);
+    const UINT64* pSamplesPassed = reinterpret_cast<const UINT64*>(pData + offset + OcclusionDataOffset);
+    for (UINT pass = 0; pass < passCount; pass++)
+    {
+        const char* pName = m_passNames[frameIndex * MaxPassesPerFrame + pass];
+
+        // Passes are few, so a linear search by name beats a map.
+        auto it = std::find_if(m_statistics.passes.begin(), m_statistics.passes.end(),
+            [pName](const PassStatistics& passStatistics) { return strcmp(passStatistics.pName, pName) == 0; });
+        if (it == m_statistics.passes.end())
+        {
+            PassStatistics passStatistics = {};
+            passStatistics.pName = pName;
+            it = m_statistics.passes.insert(it, passStatistics);
+        }
+
+        Accumulate(&*it, pPipeline[pass], pSamplesPassed[pass]);
+        Accumulate(&m_statistics.total, pPipeline[pass], pSamplesPassed[pass]);
+    }
+    m_readbackBuffer->Unmap(0, &CD3DX12_RANGE(0, 0));
+}
+
+void PipelineStatisticsCollector::Accumulate(PassStatistics* pTotal, const D3D12_QUERY_DATA_PIPELINE_STATISTICS& pipeline, UINT64 samplesPassed)
+{
+    pTotal->count++;
+    pTotal->pipeline.IAVertices += pipeline.IAVertices;
+    pTotal->pipeline.IAPrimitives += pipeline.IAPrimitives;
+    pTotal->pipeline.VSInvocations += pipeline.VSInvocations;
+    pTotal->pipeline.GSInvocations += pipeline.GSInvocations;
+    pTotal->pipeline.GSPrimitives += pipeline.GSPrimitives;
+    pTotal->pipeline.CInvocations += pipeline.CInvocations;
+    pTotal->pipeline.CPrimitives += pipeline.CPrimitives;
+    pTotal->pipeline.PSInvocations += pipeline.PSInvocations;
+    pTotal->pipeline.HSInvocations += pipeline.HSInvocations;
+    pTotal->pipeline.DSInvocations += pipeline.DSInvocations;
+    pTotal->pipeline.CSInvocations += pipeline.CSInvocations;
+    pTotal->samplesPassed += samplesPassed;
+}
+
+void PipelineStatisticsCollector::ResetStatistics()
+{
+    m_statistics.frameCount = 0;
+    m_statistics.total = {};
+    m_statistics.total.pName = "Total";
+    m_statistics.passes.clear();
+}
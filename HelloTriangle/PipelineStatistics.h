@@ -0,0 +1,126 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "DXSampleHelper.h"
+
+// Counts what the GPU did in each pass of a frame: vertex and pixel shader
+// invocations, primitives assembled, primitives sent to and output by the
+// clipper, and samples that passed the depth and stencil tests. Shader
+// invocations against samples passed show overdraw and shader work growing
+// without an external profiler.
+//
+// Every pass is bracketed by a pipeline statistics query and an occlusion query.
+// Like the GPU profiler, each frame resource has its own block of queries and its
+// own slot in the readback buffer, read once its fence has passed. The counts
+// are summed per pass name and per frame until the statistics are reset.
+class PipelineStatisticsCollector
+{
+public:
+    static const UINT MaxPassesPerFrame = 64;
+    static const UINT InvalidPass = UINT_MAX;
+
+    struct PassStatistics
+    {
+        const char* pName;
+        UINT64 count;                                   // Instances of the pass, e.g. one per command list.
+        D3D12_QUERY_DATA_PIPELINE_STATISTICS pipeline;
+        UINT64 samplesPassed;
+    };
+
+    struct Statistics
+    {
+        UINT frameCount;
+        PassStatistics total;                           // All passes of all frames.
+        std::vector<PassStatistics> passes;             // Per pass name, in order of first use.
+    };
+
+    PipelineStatisticsCollector(ID3D12Device* pDevice, UINT frameCount);
+    ~PipelineStatisticsCollector();
+
+    void BeginFrame(UINT frameIndex);
+
+    // Starts counting a pass of the current frame. May be called from any thread
+    // recording the frame; the pass has to end in the same command list. The name
+    // has to outlive the collector. Returns InvalidPass once the frame is out of
+    // passes; the pass is then not counted.
+    UINT BeginPass(ID3D12GraphicsCommandList* pCommandList, const char* pName);
+    void EndPass(ID3D12GraphicsCommandList* pCommandList, UINT pass);
+
+    // Copies the frame's counts to the frame resource's slot of the readback
+    // buffer. The list has to be the last one the frame submits.
+    void EndFrame(ID3D12GraphicsCommandList* pCommandList);
+
+    // Adds the counts of the frame last collected in the given frame resource to
+    // the statistics. Its fence must have passed.
+    void ReadFrame(UINT frameIndex);
+
+    const Statistics& GetStatistics() const     { return m_statistics; }
+    void ResetStatistics();
+
+    ID3D12QueryHeap* GetPipelineQueryHeap() const   { return m_pipelineQueryHeap.Get(); }
+    ID3D12QueryHeap* GetOcclusionQueryHeap() const  { return m_occlusionQueryHeap.Get(); }
+    ID3D12Resource* GetReadbackBuffer() const       { return m_readbackBuffer.Get(); }
+
+private:
+    // A frame resource's slot of the readback buffer: the pipeline statistics of
+    // all its passes, followed by their occlusion counts.
+    static const UINT64 OcclusionDataOffset = MaxPassesPerFrame * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
+    static const UINT64 FrameDataSize = OcclusionDataOffset + MaxPassesPerFrame * sizeof(UINT64);
+
+    static void Accumulate(PassStatistics* pTotal, const D3D12_QUERY_DATA_PIPELINE_STATISTICS& pipeline, UINT64 samplesPassed);
+
+    ComPtr<ID3D12QueryHeap> m_pipelineQueryHeap;
+    ComPtr<ID3D12QueryHeap> m_occlusionQueryHeap;
+    ComPtr<ID3D12Resource> m_readbackBuffer;
+
+    // Per frame resource: the name of every pass, the number of passes and
+    // whether the slot holds counts that have not been read yet.
+    std::vector<const char*> m_passNames;
+    std::vector<UINT> m_passCounts;
+    std::vector<bool> m_pending;
+    UINT m_currentFrameIndex;
+    std::atomic<UINT> m_passCount;
+
+    Statistics m_statistics;
+};
+
+// Counts the commands recorded into the list during the enclosing scope as one pass.
+class PipelineStatisticsScope
+{
+public:
+    PipelineStatisticsScope(PipelineStatisticsCollector* pCollector, ID3D12GraphicsCommandList* pCommandList, const char* pName) :
+        m_pCollector(pCollector),
+        m_pCommandList(pCommandList),
+        m_pass(pCollector ? pCollector->BeginPass(pCommandList, pName) : PipelineStatisticsCollector::InvalidPass)
+    {
+    }
+
+    ~PipelineStatisticsScope()
+    {
+        if (m_pCollector)
+        {
+            m_pCollector->EndPass(m_pCommandList, m_pass);
+        }
+    }
+
+    PipelineStatisticsScope(const PipelineStatisticsScope&) = delete;
+    PipelineStatisticsScope& operator=(const PipelineStatisticsScope&) = delete;
+
+private:
+    PipelineStatisticsCollector* m_pCollector;
+    ID3D12GraphicsCommandList* m_pCommandList;
+    UINT m_pass;
+};
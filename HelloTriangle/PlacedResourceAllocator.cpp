@@ -0,0 +1,312 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "PlacedResourceAllocator.h"
+
+PlacedResourceAllocator::PlacedResourceAllocator(ID3D12Device* pDevice, FenceTimeline* pTimeline, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, UINT64 blockSize, ResidencyManager* pResidency) :
+    m_device(pDevice),
+    m_pTimeline(pTimeline),
+    m_heapType(heapType),
+    m_heapFlags(heapFlags),
+    m_blockSize(AlignUp(blockSize, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT)),
+    m_pResidency(pResidency),
+    m_pendingFrees(pTimeline)
+{
+}
+
+PlacedResourceAllocator::~PlacedResourceAllocator()
+{
+    // Freeing space the GPU may still be using would be a bug in the owner.
+    assert(m_pendingFrees.IsEmpty());
+
+    for (UINT i = 0; i < m_heaps.size(); i++)
+    {
+        if (m_heaps[i].heap)
+        {
+            DestroyHeap(i);
+        }
+    }
+}
+
+_Use_decl_annotations_
+void PlacedResourceAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* pClearValue, ComPtr<ID3D12Resource>* pResource)
+{
+    // Small textures may use the 4KB alignment; the device tells whether this
+    // one qualifies by answering with a larger alignment if it does not.
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && desc.Alignment == 0 && desc.SampleDesc.Count == 1 &&
+        (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0)
+    {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            placedDesc.Alignment = 0;
+        }
+    }
+    if (info.Alignment == 0 || placedDesc.Alignment == 0)
+    {
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+    if (info.SizeInBytes == UINT64_MAX)
+    {
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    // Anything aligned beyond 64KB needs a heap whose own placement is 4MB aligned.
+    const UINT64 heapAlignment = info.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT ?
+        D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    Placement placement = { UINT_MAX, TlsfAllocator::InvalidBlock, info.Alignment };
+    TlsfAllocator::Allocation allocation = {};
+    for (UINT i = 0; i < m_heaps.size() && placement.heap == UINT_MAX; i++)
+    {
+        if (m_heaps[i].heap && m_heaps[i].alignment >= heapAlignment &&
+            m_heaps[i].allocator->Allocate(info.SizeInBytes, info.Alignment, &allocation))
+        {
+            placement.heap = i;
+        }
+    }
+    if (placement.heap == UINT_MAX)
+    {
+        placement.heap = CreateHeap((std::max)(m_blockSize, AlignUp(info.SizeInBytes, heapAlignment)), heapAlignment);
+        if (!m_heaps[placement.heap].allocator->Allocate(info.SizeInBytes, info.Alignment, &allocation))
+        {
+            ThrowIfFailed(E_OUTOFMEMORY);
+        }
+    }
+    placement.block = allocation.block;
+
+    // The heap may have been evicted, and the resource is about to be written,
+    // possibly on another queue.
+    Heap& heap = m_heaps[placement.heap];
+    if (m_pResidency)
+    {
+        m_pResidency->EnsureResident(heap.heap.Get());
+    }
+    const HRESULT hr = m_device->CreatePlacedResource(heap.heap.Get(), allocation.offset, &placedDesc, initialState, pClearValue, IID_PPV_ARGS(pResource->ReleaseAndGetAddressOf()));
+    if (FAILED(hr))
+    {
+        heap.allocator->Free(allocation.block);
+        ThrowIfFailed(hr);
+    }
+
+    if (heap.resources.size() <= allocation.block)
+    {
+        heap.resources.resize(allocation.block + 1);
+    }
+    heap.resources[allocation.block] = pResource->Get();
+    m_placements[pResource->Get()] = placement;
+}
+
+// Reuses the slot of a destroyed heap, so placements keep their heap index.
+UINT PlacedResourceAllocator::CreateHeap(UINT64 size, UINT64 alignment)
+{
+    UINT index = 0;
+    while (index < m_heaps.size() && m_heaps[index].heap)
+    {
+        index++;
+    }
+    if (index == m_heaps.size())
+    {
+        m_heaps.emplace_back();
+    }
+
+    Heap& heap = m_heaps[index];
+    ThrowIfFailed(m_device->CreateHeap(&CD3DX12_HEAP_DESC(size, m_heapType, alignment, m_heapFlags), IID_PPV_ARGS(&heap.heap)));
+    SetNameIndexed(heap.heap.Get(), L"PlacedResourceHeap", index);
+    heap.allocator = std::make_unique<TlsfAllocator>(size);
+    heap.alignment = alignment;
+    heap.resources.clear();
+    if (m_pResidency)
+    {
+        m_pResidency->Register(heap.heap.Get(), size);
+    }
+    return index;
+}
+
+void PlacedResourceAllocator::DestroyHeap(UINT index)
+{
+    Heap& heap = m_heaps[index];
+    if (m_pResidency)
+    {
+        m_pResidency->Unregister(heap.heap.Get());
+    }
+    heap.heap.Reset();
+    heap.allocator.reset();
+}
+
+void PlacedResourceAllocator::Release(ID3D12Resource* pResource)
+{
+    if (pResource == nullptr)
+    {
+        return;
+    }
+
+    // Takes over the caller's reference.
+    PendingFree pending;
+    pending.resource.Attach(pResource);
+    pending.placement = { UINT_MAX, TlsfAllocator::InvalidBlock, 0 };
+
+    auto it = m_placements.find(pResource);
+    if (it != m_placements.end())
+    {
+        pending.placement = it->second;
+        m_heaps[it->second.heap].resources[it->second.block] = nullptr;
+        m_placements.erase(it);
+    }
+    m_pendingFrees.Push(m_pTimeline->GetNextValue(), std::move(pending));
+}
+
+void PlacedResourceAllocator::Use(ID3D12Resource* pResource)
+{
+    if (m_pResidency)
+    {
+        auto it = m_placements.find(pResource);
+        if (it != m_placements.end())
+        {
+            m_pResidency->Use(m_heaps[it->second.heap].heap.Get());
+        }
+    }
+}
+
+// The resource goes before the space it occupies.
+void PlacedResourceAllocator::Free(PendingFree& pending)
+{
+    pending.resource.Reset();
+    if (pending.placement.heap != UINT_MAX)
+    {
+        m_heaps[pending.placement.heap].allocator->Free(pending.placement.block);
+    }
+}
+
+void PlacedResourceAllocator::DestroyEmptyHeaps()
+{
+    for (UINT i = 1; i < m_heaps.size(); i++)
+    {
+        if (m_heaps[i].heap && m_heaps[i].allocator->IsEmpty())
+        {
+            DestroyHeap(i);
+        }
+    }
+}
+
+void PlacedResourceAllocator::Collect()
+{
+    if (m_pendingFrees.Collect([this](PendingFree& pending) { Free(pending); }) > 0)
+    {
+        DestroyEmptyHeaps();
+    }
+}
+
+void PlacedResourceAllocator::Flush()
+{
+    if (m_pendingFrees.Flush([this](PendingFree& pending) { Free(pending); }) > 0)
+    {
+        DestroyEmptyHeaps();
+    }
+}
+
+void PlacedResourceAllocator::Defragment(ID3D12GraphicsCommandList* pCommandList, UINT maxMoves, std::vector<Move>* pMoves)
+{
+    pMoves->clear();
+
+    // Buffers in other heap types cannot start out in COMMON.
+    if (m_heapType != D3D12_HEAP_TYPE_DEFAULT)
+    {
+        return;
+    }
+
+    for (UINT h = 0; h < m_heaps.size() && pMoves->size() < maxMoves; h++)
+    {
+        Heap& heap = m_heaps[h];
+        if (!heap.heap || heap.allocator->GetStatistics().fragmentation == 0.0)
+        {
+            continue;
+        }
+
+        heap.allocator->GetAllocationsFromTop(&m_defragmentationCandidates);
+        for (const TlsfAllocator::Allocation& candidate : m_defragmentationCandidates)
+        {
+            if (pMoves->size() >= maxMoves)
+            {
+                break;
+            }
+
+            // Released resources are only waiting for the GPU to let go of them.
+            ID3D12Resource* pSource = heap.resources[candidate.block];
+            if (pSource == nullptr)
+            {
+                continue;
+            }
+            const D3D12_RESOURCE_DESC desc = pSource->GetDesc();
+            if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER)
+            {
+                continue;
+            }
+
+            const Placement& source = m_placements[pSource];
+            TlsfAllocator::Allocation allocation;
+            if (!heap.allocator->Relocate(candidate.block, source.alignment, &allocation))
+            {
+                continue;
+            }
+
+            Move move;
+            move.pSource = pSource;
+            const HRESULT hr = m_device->CreatePlacedResource(heap.heap.Get(), allocation.offset, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&move.destination));
+            if (FAILED(hr))
+            {
+                heap.allocator->Free(allocation.block);
+                ThrowIfFailed(hr);
+            }
+            pCommandList->CopyBufferRegion(move.destination.Get(), 0, pSource, 0, desc.Width);
+            if (m_pResidency)
+            {
+                m_pResidency->Use(heap.heap.Get());
+            }
+
+            if (heap.resources.size() <= allocation.block)
+            {
+                heap.resources.resize(allocation.block + 1);
+            }
+            heap.resources[allocation.block] = move.destination.Get();
+            m_placements[move.destination.Get()] = { h, allocation.block, source.alignment };
+            pMoves->push_back(std::move(move));
+        }
+    }
+}
+
+PlacedResourceAllocator::Statistics PlacedResourceAllocator::GetStatistics() const
+{
+    Statistics statistics = {};
+    UINT64 freeSize = 0;
+    UINT64 largestFreeBlocks = 0;
+    for (const Heap& heap : m_heaps)
+    {
+        if (heap.heap)
+        {
+            const TlsfAllocator::Statistics heapStatistics = heap.allocator->GetStatistics();
+            statistics.heapCount++;
+            statistics.allocationCount += heapStatistics.allocationCount;
+            statistics.reservedSize += heapStatistics.size;
+            statistics.usedSize += heapStatistics.usedSize;
+            statistics.largestFreeBlock = (std::max)(statistics.largestFreeBlock, heapStatistics.largestFreeBlock);
+            freeSize += heapStatistics.freeSize;
+            largestFreeBlocks += heapStatistics.largestFreeBlock;
+        }
+    }
+    statistics.fragmentation = freeSize > 0 ? 1.0 - static_cast<double>(largestFreeBlocks) / freeSize : 0.0;
+    return statistics;
+}
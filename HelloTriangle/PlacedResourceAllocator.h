@@ -0,0 +1,131 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+#include "ResidencyManager.h"
+#include "RetireQueue.h"
+#include "TlsfAllocator.h"
+
+// Places resources in a few large ID3D12Heaps instead of giving each its own
+// committed allocation, which saves the per-allocation cost of the OS and the
+// driver and lets the app see and control how its memory is used. Space in the
+// heaps is handed out by a TlsfAllocator per heap.
+//
+// The allocator serves one heap type and one set of heap flags, so a tier 1
+// device needs one allocator per category of resource, like the render graph's
+// heaps. Resources get the placement alignment the device asks for: 4KB for
+// small textures that qualify, 64KB for everything else and 4MB for MSAA
+// targets, which only go into heaps that are themselves 4MB aligned. Resources
+// larger than the block size get a heap of their own.
+//
+// Release() frees a resource's space once the timeline passes everything
+// submitted so far, so it replaces a DeferredReleaseQueue for the resources it
+// created. With a ResidencyManager, the heaps are registered with it, and Use()
+// marks the heap of a resource the next submission reads. Not thread safe.
+class PlacedResourceAllocator
+{
+public:
+    static const UINT64 DefaultBlockSize = 64 * 1024 * 1024;
+
+    struct Statistics
+    {
+        UINT heapCount;
+        UINT allocationCount;
+        UINT64 reservedSize;        // Bytes in heaps.
+        UINT64 usedSize;            // Bytes in resources, with their alignment padding.
+        UINT64 largestFreeBlock;
+        double fragmentation;       // Share of the free space outside each heap's largest free block.
+    };
+
+    // A resource defragmentation placed at a lower offset. The copy of its
+    // contents is recorded; the owner switches to the destination and passes the
+    // source to Release().
+    struct Move
+    {
+        ID3D12Resource* pSource;
+        ComPtr<ID3D12Resource> destination;
+    };
+
+    PlacedResourceAllocator(ID3D12Device* pDevice, FenceTimeline* pTimeline, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, UINT64 blockSize = DefaultBlockSize, ResidencyManager* pResidency = nullptr);
+    ~PlacedResourceAllocator();
+
+    void CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, _In_opt_ const D3D12_CLEAR_VALUE* pClearValue, ComPtr<ID3D12Resource>* pResource);
+
+    // Takes over the caller's reference. Resources of other origins are only
+    // released, like DeferredReleaseQueue does.
+    void Release(ID3D12Resource* pResource);
+
+    // Tells the residency manager, if any, that the next submission uses the
+    // resource. Resources of other origins are ignored.
+    void Use(ID3D12Resource* pResource);
+
+    // Frees the space of every resource whose last use has completed, and the
+    // heaps that became empty, except for the first.
+    void Collect();
+
+    // Waits for the last use of every released resource, signaling the timeline
+    // first if that has not been signaled yet, and frees everything; used at
+    // shutdown.
+    void Flush();
+
+    // Moves up to maxMoves buffers of fragmented heaps down to lower offsets,
+    // starting with the highest, so that the free space gathers at the top.
+    // Only buffers move: they copy with CopyBufferRegion and promote from and
+    // decay to COMMON, so the copy needs no barriers as long as nothing writes
+    // the source in the same command list.
+    void Defragment(ID3D12GraphicsCommandList* pCommandList, UINT maxMoves, std::vector<Move>* pMoves);
+
+    Statistics GetStatistics() const;
+
+private:
+    struct Heap
+    {
+        ComPtr<ID3D12Heap> heap;            // Null for a slot of a destroyed heap.
+        std::unique_ptr<TlsfAllocator> allocator;
+        UINT64 alignment;
+        std::vector<ID3D12Resource*> resources;     // By block; null once released.
+    };
+
+    struct Placement
+    {
+        UINT heap;
+        UINT32 block;
+        UINT64 alignment;
+    };
+
+    struct PendingFree
+    {
+        ComPtr<ID3D12Resource> resource;
+        Placement placement;                // heap is UINT_MAX for a resource from elsewhere.
+    };
+
+    UINT CreateHeap(UINT64 size, UINT64 alignment);
+    void DestroyHeap(UINT index);
+    void Free(PendingFree& pending);
+    void DestroyEmptyHeaps();
+
+    ComPtr<ID3D12Device> m_device;
+    FenceTimeline* m_pTimeline;
+    D3D12_HEAP_TYPE m_heapType;
+    D3D12_HEAP_FLAGS m_heapFlags;
+    UINT64 m_blockSize;
+    ResidencyManager* m_pResidency;
+    std::vector<Heap> m_heaps;
+    std::unordered_map<ID3D12Resource*, Placement> m_placements;
+    RetireQueue<PendingFree, FenceTimeline> m_pendingFrees;
+    std::vector<TlsfAllocator::Allocation> m_defragmentationCandidates;
+};
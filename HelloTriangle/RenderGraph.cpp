@@ -0,0 +1,660 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "RenderGraph.h"
+#include "TlsfAllocator.h"
+
+static size_t HashCombine(size_t seed, UINT64 value)
+{
+    return seed ^ (std::hash<UINT64>()(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+size_t RenderGraph::DescHash::operator()(const D3D12_RESOURCE_DESC& desc) const
+{
+    size_t hash = HashCombine(0, desc.Dimension);
+    hash = HashCombine(hash, desc.Alignment);
+    hash = HashCombine(hash, desc.Width);
+    hash = HashCombine(hash, (UINT64(desc.Height) << 32) | (UINT64(desc.DepthOrArraySize) << 16) | desc.MipLevels);
+    hash = HashCombine(hash, (UINT64(desc.Format) << 32) | desc.Flags);
+    hash = HashCombine(hash, (UINT64(desc.SampleDesc.Count) << 32) | desc.SampleDesc.Quality);
+    return HashCombine(hash, desc.Layout);
+}
+
+bool RenderGraph::DescEqual::operator()(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b) const
+{
+    // Compared member by member; the struct has padding.
+    return a.Dimension == b.Dimension && a.Alignment == b.Alignment && a.Width == b.Width &&
+        a.Height == b.Height && a.DepthOrArraySize == b.DepthOrArraySize && a.MipLevels == b.MipLevels &&
+        a.Format == b.Format && a.SampleDesc.Count == b.SampleDesc.Count && a.SampleDesc.Quality == b.SampleDesc.Quality &&
+        a.Layout == b.Layout && a.Flags == b.Flags;
+}
+
+size_t RenderGraph::PlacedKeyHash::operator()(const PlacedKey& key) const
+{
+    size_t hash = HashCombine(DescHash()(key.desc), (UINT64(key.heapCategory) << 32) | key.heapGeneration);
+    return HashCombine(hash, key.heapOffset);
+}
+
+bool RenderGraph::PlacedKeyEqual::operator()(const PlacedKey& a, const PlacedKey& b) const
+{
+    return a.heapCategory == b.heapCategory && a.heapGeneration == b.heapGeneration && a.heapOffset == b.heapOffset && DescEqual()(a.desc, b.desc);
+}
+
+RenderGraph::RenderGraph(ID3D12Device* pDevice, ResourceStateRegistry* pRegistry, DeferredReleaseQueue* pDeferredReleases) :
+    m_device(pDevice),
+    m_pRegistry(pRegistry),
+    m_pDeferredReleases(pDeferredReleases),
+    m_heapSizes(),
+    m_heapAlignments(),
+    m_statistics(),
+    m_heapGeneration(),
+    m_frameNumber(0)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    // The GPU may still be using the transient memory.
+    for (auto& entry : m_placedResources)
+    {
+        m_pRegistry->Unregister(entry.second.resource.Get());
+        m_pDeferredReleases->Release(entry.second.resource.Detach());
+    }
+    for (UINT i = 0; i < HeapCategoryCount; i++)
+    {
+        if (m_heaps[i])
+        {
+            m_pDeferredReleases->Release(m_heaps[i].Detach());
+        }
+    }
+}
+
+void RenderGraph::Reset()
+{
+    m_resources.clear();
+    m_passes.clear();
+    m_accesses.clear();
+    m_statistics = {};
+}
+
+RenderGraphResource RenderGraph::ImportResource(ID3D12Resource* pResource)
+{
+    Resource resource = {};
+    resource.pImported = pResource;
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::CreateTransient(LPCWSTR name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pClearValue)
+{
+    Resource resource = {};
+    resource.name = name;
+    resource.desc = desc;
+    resource.hasClearValue = pClearValue != nullptr;
+    if (pClearValue)
+    {
+        resource.clearValue = *pClearValue;
+    }
+
+    // Graphs are mostly the same from frame to frame, so the driver only gets
+    // asked about each desc once.
+    auto it = m_allocationInfos.find(desc);
+    if (it == m_allocationInfos.end())
+    {
+        it = m_allocationInfos.emplace(desc, m_device->GetResourceAllocationInfo(0, 1, &desc)).first;
+    }
+    resource.allocationInfo = it->second;
+
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        resource.heapCategory = HeapCategoryBuffers;
+    }
+    else if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+    {
+        resource.heapCategory = HeapCategoryTargets;
+    }
+    else
+    {
+        resource.heapCategory = HeapCategoryTextures;
+    }
+
+    m_resources.push_back(resource);
+    return static_cast<RenderGraphResource>(m_resources.size() - 1);
+}
+
+UINT RenderGraph::AddPass(LPCWSTR name, ExecuteCallback execute)
+{
+    Pass pass = {};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return static_cast<UINT>(m_passes.size() - 1);
+}
+
+void RenderGraph::Read(UINT pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state)
+{
+    assert(pass < m_passes.size() && resource < m_resources.size());
+    m_accesses.push_back({ pass, resource, state, false });
+}
+
+void RenderGraph::Write(UINT pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state)
+{
+    assert(pass < m_passes.size() && resource < m_resources.size());
+    m_accesses.push_back({ pass, resource, state, true });
+}
+
+void RenderGraph::SetSideEffects(UINT pass)
+{
+    m_passes[pass].sideEffects = true;
+}
+
+void RenderGraph::Compile()
+{
+    const UINT passCount = static_cast<UINT>(m_passes.size());
+    m_statistics = {};
+    m_statistics.passCount = passCount;
+
+    // Group the accesses by pass, keeping their order within each pass.
+    m_passAccessStart.assign(passCount + 1, 0);
+    for (const Access& access : m_accesses)
+    {
+        m_passAccessStart[access.pass + 1]++;
+    }
+    for (UINT i = 0; i < passCount; i++)
+    {
+        m_passAccessStart[i + 1] += m_passAccessStart[i];
+    }
+    m_cursor.assign(m_passAccessStart.begin(), m_passAccessStart.end() - 1);
+    m_passAccesses.resize(m_accesses.size());
+    for (const Access& access : m_accesses)
+    {
+        m_passAccesses[m_cursor[access.pass]++] = access;
+    }
+
+    CullPasses();
+    SchedulePasses();
+    ComputeTransitions();
+    PlaceTransients();
+}
+
+// Walks the passes backwards, keeping those that write something that is still
+// needed afterwards. A kept pass in turn needs everything it reads.
+void RenderGraph::CullPasses()
+{
+    m_needed.assign(m_resources.size(), false);
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        m_needed[i] = m_resources[i].pImported != nullptr;
+    }
+
+    for (UINT p = static_cast<UINT>(m_passes.size()); p-- > 0;)
+    {
+        Pass& pass = m_passes[p];
+        bool live = pass.sideEffects;
+        for (UINT i = m_passAccessStart[p]; i < m_passAccessStart[p + 1] && !live; i++)
+        {
+            live = m_passAccesses[i].write && m_needed[m_passAccesses[i].resource];
+        }
+
+        pass.culled = !live;
+        if (!live)
+        {
+            m_statistics.culledPassCount++;
+            continue;
+        }
+
+        // Writes keep what was there before, so a resource that is needed
+        // stays needed up to its first write.
+        for (UINT i = m_passAccessStart[p]; i < m_passAccessStart[p + 1]; i++)
+        {
+            if (!m_passAccesses[i].write)
+            {
+                m_needed[m_passAccesses[i].resource] = true;
+            }
+        }
+    }
+}
+
+// Puts every pass in the earliest level after everything it depends on: reads
+// after the write before them, writes after the writes and reads before them.
+// Passes in the same level are independent, so their barriers can be batched.
+void RenderGraph::SchedulePasses()
+{
+    m_writeEnd.assign(m_resources.size(), 0);
+    m_readEnd.assign(m_resources.size(), 0);
+    UINT levelCount = 0;
+
+    for (UINT p = 0; p < m_passes.size(); p++)
+    {
+        Pass& pass = m_passes[p];
+        if (pass.culled)
+        {
+            continue;
+        }
+
+        UINT level = 0;
+        for (UINT i = m_passAccessStart[p]; i < m_passAccessStart[p + 1]; i++)
+        {
+            const Access& access = m_passAccesses[i];
+            level = (std::max)(level, m_writeEnd[access.resource]);
+            if (access.write)
+            {
+                level = (std::max)(level, m_readEnd[access.resource]);
+            }
+        }
+
+        for (UINT i = m_passAccessStart[p]; i < m_passAccessStart[p + 1]; i++)
+        {
+            const Access& access = m_passAccesses[i];
+            if (access.write)
+            {
+                m_writeEnd[access.resource] = level + 1;
+            }
+            else
+            {
+                m_readEnd[access.resource] = (std::max)(m_readEnd[access.resource], level + 1);
+            }
+        }
+
+        pass.level = level;
+        levelCount = (std::max)(levelCount, level + 1);
+    }
+    m_statistics.levelCount = levelCount;
+
+    // Sort the passes by level, keeping the declaration order within a level.
+    m_levelStart.assign(levelCount + 1, 0);
+    for (const Pass& pass : m_passes)
+    {
+        if (!pass.culled)
+        {
+            m_levelStart[pass.level + 1]++;
+        }
+    }
+    for (UINT i = 0; i < levelCount; i++)
+    {
+        m_levelStart[i + 1] += m_levelStart[i];
+    }
+    m_cursor.assign(m_levelStart.begin(), m_levelStart.end() - 1);
+    m_schedule.resize(m_levelStart[levelCount]);
+    for (UINT p = 0; p < m_passes.size(); p++)
+    {
+        if (!m_passes[p].culled)
+        {
+            m_schedule[m_cursor[m_passes[p].level]++] = p;
+        }
+    }
+}
+
+// Works out the state each resource needs per level. Reads within a level
+// combine their states. A state change that has a level without uses of the
+// resource before it is started as a split transition right after the last use.
+void RenderGraph::ComputeTransitions()
+{
+    const UINT levelCount = m_statistics.levelCount;
+    m_levelStamp.assign(m_resources.size(), NoLevel);
+    m_levelState.resize(m_resources.size());
+    m_levelWrite.resize(m_resources.size());
+    m_plannedState.resize(m_resources.size());
+    m_lastUseLevel.resize(m_resources.size());
+    for (Resource& resource : m_resources)
+    {
+        resource.firstLevel = NoLevel;
+    }
+
+    m_transitions.clear();
+    m_splitBegins.clear();
+    m_levelTransitionStart.resize(levelCount + 1);
+    for (UINT level = 0; level < levelCount; level++)
+    {
+        m_levelTransitionStart[level] = static_cast<UINT>(m_transitions.size());
+
+        m_touched.clear();
+        for (UINT s = m_levelStart[level]; s < m_levelStart[level + 1]; s++)
+        {
+            const UINT p = m_schedule[s];
+            for (UINT i = m_passAccessStart[p]; i < m_passAccessStart[p + 1]; i++)
+            {
+                const Access& access = m_passAccesses[i];
+                const RenderGraphResource r = access.resource;
+                if (m_levelStamp[r] != level)
+                {
+                    m_levelStamp[r] = level;
+                    m_levelState[r] = access.state;
+                    m_levelWrite[r] = access.write;
+                    m_touched.push_back(r);
+                }
+                else if (access.write)
+                {
+                    m_levelState[r] = access.state;
+                    m_levelWrite[r] = true;
+                }
+                else if (!m_levelWrite[r])
+                {
+                    m_levelState[r] |= access.state;
+                }
+            }
+        }
+
+        for (RenderGraphResource r : m_touched)
+        {
+            Resource& resource = m_resources[r];
+            const D3D12_RESOURCE_STATES state = m_levelState[r];
+            if (resource.firstLevel == NoLevel)
+            {
+                // The resource may be in any state when the graph starts; the
+                // state tracker skips the transition if it already is in this one.
+                resource.firstLevel = level;
+                resource.firstState = state;
+                m_transitions.push_back({ r, state, level });
+            }
+            else if (state != m_plannedState[r])
+            {
+                const UINT beginLevel = m_lastUseLevel[r] + 1;
+                m_transitions.push_back({ r, state, beginLevel });
+                if (beginLevel < level)
+                {
+                    m_splitBegins.push_back({ r, state, beginLevel });
+                }
+            }
+            m_plannedState[r] = state;
+            m_lastUseLevel[r] = level;
+            resource.lastLevel = level;
+        }
+    }
+    m_levelTransitionStart[levelCount] = static_cast<UINT>(m_transitions.size());
+    m_statistics.transitionCount = static_cast<UINT>(m_transitions.size());
+    m_statistics.splitTransitionCount = static_cast<UINT>(m_splitBegins.size());
+
+    // Group the split transitions by the level they begin in.
+    std::sort(m_splitBegins.begin(), m_splitBegins.end(),
+        [](const Transition& a, const Transition& b)
+        {
+            return a.beginLevel < b.beginLevel;
+        });
+    m_levelSplitBeginStart.assign(levelCount + 1, 0);
+    for (const Transition& begin : m_splitBegins)
+    {
+        m_levelSplitBeginStart[begin.beginLevel + 1]++;
+    }
+    for (UINT i = 0; i < levelCount; i++)
+    {
+        m_levelSplitBeginStart[i + 1] += m_levelSplitBeginStart[i];
+    }
+}
+
+// Places the transients used by the kept passes, largest first, at the lowest
+// offset in their heap that no transient with an overlapping lifetime uses.
+// Transients that share memory with another one need an aliasing barrier, and
+// render targets and depth buffers a discard, before their first use.
+void RenderGraph::PlaceTransients()
+{
+    m_placementOrder.clear();
+    for (RenderGraphResource r = 0; r < m_resources.size(); r++)
+    {
+        Resource& resource = m_resources[r];
+        if (!resource.pImported && resource.firstLevel != NoLevel)
+        {
+            m_placementOrder.push_back(r);
+            m_statistics.unaliasedMemorySize += AlignUp(resource.allocationInfo.SizeInBytes, resource.allocationInfo.Alignment);
+        }
+    }
+    m_statistics.transientCount = static_cast<UINT>(m_placementOrder.size());
+
+    std::sort(m_placementOrder.begin(), m_placementOrder.end(),
+        [this](RenderGraphResource a, RenderGraphResource b)
+        {
+            const Resource& resourceA = m_resources[a];
+            const Resource& resourceB = m_resources[b];
+            if (resourceA.heapCategory != resourceB.heapCategory)
+            {
+                return resourceA.heapCategory < resourceB.heapCategory;
+            }
+            if (resourceA.allocationInfo.SizeInBytes != resourceB.allocationInfo.SizeInBytes)
+            {
+                return resourceA.allocationInfo.SizeInBytes > resourceB.allocationInfo.SizeInBytes;
+            }
+            return a < b;
+        });
+
+    for (UINT i = 0; i < HeapCategoryCount; i++)
+    {
+        m_heapSizes[i] = 0;
+        m_heapAlignments[i] = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    }
+
+    m_placed.clear();
+    size_t categoryStart = 0;
+    for (RenderGraphResource r : m_placementOrder)
+    {
+        Resource& resource = m_resources[r];
+        const UINT64 size = resource.allocationInfo.SizeInBytes;
+        const UINT64 alignment = resource.allocationInfo.Alignment;
+        if (!m_placed.empty() && m_resources[m_placed.back()].heapCategory != resource.heapCategory)
+        {
+            categoryStart = m_placed.size();
+        }
+
+        // Collect the memory that is in use during this transient's lifetime.
+        m_occupied.clear();
+        for (size_t i = categoryStart; i < m_placed.size(); i++)
+        {
+            const Resource& other = m_resources[m_placed[i]];
+            if (other.firstLevel <= resource.lastLevel && resource.firstLevel <= other.lastLevel)
+            {
+                m_occupied.push_back({ other.heapOffset, other.heapOffset + other.allocationInfo.SizeInBytes });
+            }
+        }
+        std::sort(m_occupied.begin(), m_occupied.end());
+
+        // Take the first gap it fits in.
+        UINT64 offset = 0;
+        for (const auto& range : m_occupied)
+        {
+            if (AlignUp(offset, alignment) + size <= range.first)
+            {
+                break;
+            }
+            offset = (std::max)(offset, range.second);
+        }
+        offset = AlignUp(offset, alignment);
+
+        resource.heapOffset = offset;
+        resource.aliased = false;
+        m_heapSizes[resource.heapCategory] = (std::max)(m_heapSizes[resource.heapCategory], offset + size);
+        m_heapAlignments[resource.heapCategory] = (std::max)(m_heapAlignments[resource.heapCategory], alignment);
+        m_placed.push_back(r);
+    }
+
+    for (UINT i = 0; i < HeapCategoryCount; i++)
+    {
+        m_statistics.transientMemorySize += m_heapSizes[i];
+    }
+
+    // Find the transients that share memory. Transients that did not overlap
+    // in time overlap across frames, so both ends need the barrier.
+    m_aliasing.clear();
+    categoryStart = 0;
+    for (size_t i = 0; i < m_placed.size(); i++)
+    {
+        Resource& resource = m_resources[m_placed[i]];
+        if (m_resources[m_placed[categoryStart]].heapCategory != resource.heapCategory)
+        {
+            categoryStart = i;
+        }
+
+        RenderGraphResource before = NoResource;
+        UINT overlapCount = 0;
+        for (size_t j = categoryStart; j < m_placed.size() && m_resources[m_placed[j]].heapCategory == resource.heapCategory; j++)
+        {
+            const Resource& other = m_resources[m_placed[j]];
+            if (j != i &&
+                other.heapOffset < resource.heapOffset + resource.allocationInfo.SizeInBytes &&
+                resource.heapOffset < other.heapOffset + other.allocationInfo.SizeInBytes)
+            {
+                before = m_placed[j];
+                overlapCount++;
+            }
+        }
+
+        if (overlapCount > 0)
+        {
+            resource.aliased = true;
+            m_aliasing.push_back({ overlapCount == 1 ? before : NoResource, m_placed[i] });
+        }
+    }
+    m_statistics.aliasingBarrierCount = static_cast<UINT>(m_aliasing.size());
+
+    // Issue each aliasing barrier in the level of the transient's first use.
+    const UINT levelCount = m_statistics.levelCount;
+    std::sort(m_aliasing.begin(), m_aliasing.end(),
+        [this](const Aliasing& a, const Aliasing& b)
+        {
+            return m_resources[a.after].firstLevel < m_resources[b.after].firstLevel;
+        });
+    m_levelAliasingStart.assign(levelCount + 1, 0);
+    for (const Aliasing& aliasing : m_aliasing)
+    {
+        m_levelAliasingStart[m_resources[aliasing.after].firstLevel + 1]++;
+    }
+    for (UINT i = 0; i < levelCount; i++)
+    {
+        m_levelAliasingStart[i + 1] += m_levelAliasingStart[i];
+    }
+}
+
+void RenderGraph::Execute(ID3D12GraphicsCommandList* pCommandList, ResourceStateTracker* pTracker)
+{
+    RealizeTransients();
+
+    for (UINT level = 0; level < m_statistics.levelCount; level++)
+    {
+        // One batch of barriers per level.
+        for (UINT i = m_levelAliasingStart[level]; i < m_levelAliasingStart[level + 1]; i++)
+        {
+            const Aliasing& aliasing = m_aliasing[i];
+            pTracker->AliasingBarrier(aliasing.before != NoResource ? m_realized[aliasing.before] : nullptr, m_realized[aliasing.after]);
+        }
+        for (UINT i = m_levelTransitionStart[level]; i < m_levelTransitionStart[level + 1]; i++)
+        {
+            pTracker->Transition(m_realized[m_transitions[i].resource], m_transitions[i].state);
+        }
+        for (UINT i = m_levelSplitBeginStart[level]; i < m_levelSplitBeginStart[level + 1]; i++)
+        {
+            pTracker->BeginTransition(m_realized[m_splitBegins[i].resource], m_splitBegins[i].state);
+        }
+        pTracker->FlushBarriers(pCommandList);
+
+        // Aliased render targets and depth buffers have to be initialized
+        // before anything else touches them.
+        for (UINT i = m_levelAliasingStart[level]; i < m_levelAliasingStart[level + 1]; i++)
+        {
+            const Resource& resource = m_resources[m_aliasing[i].after];
+            if (resource.firstState == D3D12_RESOURCE_STATE_RENDER_TARGET || resource.firstState == D3D12_RESOURCE_STATE_DEPTH_WRITE)
+            {
+                pCommandList->DiscardResource(m_realized[m_aliasing[i].after], nullptr);
+            }
+        }
+
+        for (UINT s = m_levelStart[level]; s < m_levelStart[level + 1]; s++)
+        {
+            m_passes[m_schedule[s]].execute(pCommandList);
+        }
+    }
+}
+
+ID3D12Resource* RenderGraph::GetResource(RenderGraphResource resource) const
+{
+    return m_realized[resource];
+}
+
+// Makes sure the heaps are large enough for the compiled layout and looks up
+// the placed resource for every transient, creating those that are new.
+void RenderGraph::RealizeTransients()
+{
+    static const D3D12_HEAP_FLAGS heapFlags[HeapCategoryCount] =
+    {
+        D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES
+    };
+
+    m_frameNumber++;
+    for (UINT i = 0; i < HeapCategoryCount; i++)
+    {
+        if (m_heapSizes[i] == 0)
+        {
+            continue;
+        }
+
+        const D3D12_HEAP_DESC currentDesc = m_heaps[i] ? m_heaps[i]->GetDesc() : D3D12_HEAP_DESC();
+        if (currentDesc.SizeInBytes < m_heapSizes[i] || currentDesc.Alignment < m_heapAlignments[i])
+        {
+            if (m_heaps[i])
+            {
+                m_pDeferredReleases->Release(m_heaps[i].Detach());
+            }
+
+            const CD3DX12_HEAP_DESC heapDesc(AlignUp(m_heapSizes[i], m_heapAlignments[i]), D3D12_HEAP_TYPE_DEFAULT, m_heapAlignments[i], heapFlags[i]);
+            ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heaps[i])));
+            SetNameIndexed(m_heaps[i].Get(), L"RenderGraphHeap", i);
+
+            // Resources placed in the old heap are dropped below.
+            m_heapGeneration[i]++;
+        }
+    }
+
+    m_realized.resize(m_resources.size());
+    for (RenderGraphResource r = 0; r < m_resources.size(); r++)
+    {
+        const Resource& resource = m_resources[r];
+        m_realized[r] = resource.pImported ? resource.pImported :
+            resource.firstLevel != NoLevel ? GetPlacedResource(resource) : nullptr;
+    }
+
+    // Placed resources this graph no longer uses go once the GPU is done with them.
+    for (auto it = m_placedResources.begin(); it != m_placedResources.end();)
+    {
+        if (it->second.lastUsedFrame != m_frameNumber)
+        {
+            m_pRegistry->Unregister(it->second.resource.Get());
+            m_pDeferredReleases->Release(it->second.resource.Detach());
+            it = m_placedResources.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+ID3D12Resource* RenderGraph::GetPlacedResource(const Resource& resource)
+{
+    const PlacedKey key = { static_cast<UINT>(resource.heapCategory), m_heapGeneration[resource.heapCategory], resource.heapOffset, resource.desc };
+    auto it = m_placedResources.find(key);
+    if (it == m_placedResources.end())
+    {
+        // Created in the state of its first use, so the first frame needs no transition.
+        PlacedResource placed = {};
+        ThrowIfFailed(m_device->CreatePlacedResource(
+            m_heaps[resource.heapCategory].Get(),
+            resource.heapOffset,
+            &resource.desc,
+            resource.firstState,
+            resource.hasClearValue ? &resource.clearValue : nullptr,
+            IID_PPV_ARGS(&placed.resource)));
+        SetName(placed.resource.Get(), resource.name);
+        m_pRegistry->Register(placed.resource.Get(), resource.firstState);
+        it = m_placedResources.emplace(key, placed).first;
+    }
+    it->second.lastUsedFrame = m_frameNumber;
+    return it->second.resource.Get();
+}
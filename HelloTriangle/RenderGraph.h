@@ -0,0 +1,242 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+#include "ResourceStateTracker.h"
+
+// Refers to a resource declared in the current graph.
+typedef UINT RenderGraphResource;
+
+// A frame described as passes that declare which resources they read and write.
+// The graph is declared anew every frame and then:
+//
+//  - culls passes whose results nothing reads: passes are kept only if they
+//    have side effects or write something a kept pass or the outside world
+//    (an imported resource) reads later,
+//  - schedules the remaining passes into dependency levels, where the passes
+//    of a level do not depend on each other, so each level needs one batch of
+//    barriers,
+//  - works out the state every resource has to be in per level, starting
+//    split transitions as early as the previous use allows,
+//  - places transient resources into shared heaps, overlapping those whose
+//    lifetimes do not, and inserts the aliasing barriers that requires.
+//
+// Compile() is CPU work only. Execute() creates the heaps and placed resources
+// the layout needs, reusing them across frames while the layout stays the same,
+// and records the passes in schedule order.
+//
+// Writes keep the previous contents of a resource; a pass that writes a resource
+// depends on the pass that wrote it before. A pass either reads or writes a
+// given resource, and states cover whole resources.
+class RenderGraph
+{
+public:
+    typedef std::function<void(ID3D12GraphicsCommandList*)> ExecuteCallback;
+
+    struct Statistics
+    {
+        UINT passCount;
+        UINT culledPassCount;
+        UINT levelCount;
+        UINT transitionCount;
+        UINT splitTransitionCount;
+        UINT aliasingBarrierCount;
+        UINT transientCount;
+        UINT64 transientMemorySize;     // Heap memory the aliased layout needs.
+        UINT64 unaliasedMemorySize;     // Memory the transients would need without aliasing.
+    };
+
+    RenderGraph(ID3D12Device* pDevice, ResourceStateRegistry* pRegistry, DeferredReleaseQueue* pDeferredReleases);
+    ~RenderGraph();
+
+    // Starts declaring a new graph. Transient memory is kept for the next Execute().
+    void Reset();
+
+    // Resources from outside the graph. They are considered read after the
+    // graph has run, so the passes writing them are never culled.
+    RenderGraphResource ImportResource(ID3D12Resource* pResource);
+
+    // Resources that only live while the graph runs. Names must outlive the graph.
+    RenderGraphResource CreateTransient(LPCWSTR name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pClearValue = nullptr);
+
+    // Adds a pass; returns the index Read() and Write() refer to. Names must
+    // outlive the graph.
+    UINT AddPass(LPCWSTR name, ExecuteCallback execute);
+    void Read(UINT pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+    void Write(UINT pass, RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+
+    // Keeps a pass that has effects the graph cannot see, like UAV writes to
+    // resources it does not know about.
+    void SetSideEffects(UINT pass);
+
+    void Compile();
+
+    // Records the compiled graph. The tracker belongs to the command list and
+    // must have been reset; the caller finishes it as usual.
+    void Execute(ID3D12GraphicsCommandList* pCommandList, ResourceStateTracker* pTracker);
+
+    // Valid during Execute(), from within the passes.
+    ID3D12Resource* GetResource(RenderGraphResource resource) const;
+
+    const Statistics& GetStatistics() const     { return m_statistics; }
+
+private:
+    static const UINT NoLevel = UINT_MAX;
+    static const RenderGraphResource NoResource = UINT_MAX;
+
+    // Resources that may share a heap on every resource heap tier.
+    enum HeapCategory
+    {
+        HeapCategoryBuffers,
+        HeapCategoryTargets,            // Render target and depth stencil textures.
+        HeapCategoryTextures,
+        HeapCategoryCount
+    };
+
+    struct Resource
+    {
+        ID3D12Resource* pImported;
+        LPCWSTR name;
+        D3D12_RESOURCE_DESC desc;
+        D3D12_CLEAR_VALUE clearValue;
+        bool hasClearValue;
+        D3D12_RESOURCE_ALLOCATION_INFO allocationInfo;
+
+        // Filled in by Compile().
+        UINT firstLevel;
+        UINT lastLevel;
+        D3D12_RESOURCE_STATES firstState;
+        HeapCategory heapCategory;
+        UINT64 heapOffset;
+        bool aliased;
+    };
+
+    struct Pass
+    {
+        LPCWSTR name;
+        ExecuteCallback execute;
+        bool sideEffects;
+        bool culled;
+        UINT level;
+    };
+
+    struct Access
+    {
+        UINT pass;
+        RenderGraphResource resource;
+        D3D12_RESOURCE_STATES state;
+        bool write;
+    };
+
+    struct Transition
+    {
+        RenderGraphResource resource;
+        D3D12_RESOURCE_STATES state;
+        UINT beginLevel;                // Earlier than the level it is needed in for split transitions.
+    };
+
+    struct Aliasing
+    {
+        RenderGraphResource before;     // The resource last in the memory, if there is exactly one.
+        RenderGraphResource after;
+    };
+
+    struct DescHash
+    {
+        size_t operator()(const D3D12_RESOURCE_DESC& desc) const;
+    };
+    struct DescEqual
+    {
+        bool operator()(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b) const;
+    };
+
+    // Placed resources are reused while their heap, offset and desc stay the same.
+    struct PlacedKey
+    {
+        UINT heapCategory;
+        UINT heapGeneration;
+        UINT64 heapOffset;
+        D3D12_RESOURCE_DESC desc;
+    };
+    struct PlacedKeyHash
+    {
+        size_t operator()(const PlacedKey& key) const;
+    };
+    struct PlacedKeyEqual
+    {
+        bool operator()(const PlacedKey& a, const PlacedKey& b) const;
+    };
+    struct PlacedResource
+    {
+        ComPtr<ID3D12Resource> resource;
+        UINT64 lastUsedFrame;
+    };
+
+    void CullPasses();
+    void SchedulePasses();
+    void ComputeTransitions();
+    void PlaceTransients();
+    void RealizeTransients();
+    ID3D12Resource* GetPlacedResource(const Resource& resource);
+
+    ComPtr<ID3D12Device> m_device;
+    ResourceStateRegistry* m_pRegistry;
+    DeferredReleaseQueue* m_pDeferredReleases;
+
+    // The declared graph.
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    std::vector<Access> m_accesses;
+
+    // The compiled graph. Accesses are grouped by pass, passes by level, and
+    // transitions and aliasing barriers by the level they are issued in.
+    std::vector<UINT> m_passAccessStart;
+    std::vector<Access> m_passAccesses;
+    std::vector<UINT> m_schedule;
+    std::vector<UINT> m_levelStart;
+    std::vector<Transition> m_transitions;
+    std::vector<UINT> m_levelTransitionStart;
+    std::vector<Transition> m_splitBegins;
+    std::vector<UINT> m_levelSplitBeginStart;
+    std::vector<Aliasing> m_aliasing;
+    std::vector<UINT> m_levelAliasingStart;
+    UINT64 m_heapSizes[HeapCategoryCount];
+    UINT64 m_heapAlignments[HeapCategoryCount];
+    Statistics m_statistics;
+
+    // Scratch space, kept to avoid allocating per compile.
+    std::vector<UINT> m_cursor;
+    std::vector<bool> m_needed;
+    std::vector<UINT> m_writeEnd;       // First level a later access may be in.
+    std::vector<UINT> m_readEnd;        // First level a later write may be in.
+    std::vector<UINT> m_levelStamp;
+    std::vector<D3D12_RESOURCE_STATES> m_levelState;
+    std::vector<bool> m_levelWrite;
+    std::vector<D3D12_RESOURCE_STATES> m_plannedState;
+    std::vector<UINT> m_lastUseLevel;
+    std::vector<RenderGraphResource> m_touched;
+    std::vector<RenderGraphResource> m_placementOrder;
+    std::vector<RenderGraphResource> m_placed;
+    std::vector<std::pair<UINT64, UINT64>> m_occupied;
+
+    // Realized transient memory; persists across frames.
+    std::unordered_map<D3D12_RESOURCE_DESC, D3D12_RESOURCE_ALLOCATION_INFO, DescHash, DescEqual> m_allocationInfos;
+    ComPtr<ID3D12Heap> m_heaps[HeapCategoryCount];
+    UINT m_heapGeneration[HeapCategoryCount];
+    std::unordered_map<PlacedKey, PlacedResource, PlacedKeyHash, PlacedKeyEqual> m_placedResources;
+    std::vector<ID3D12Resource*> m_realized;
+    UINT64 m_frameNumber;
+};
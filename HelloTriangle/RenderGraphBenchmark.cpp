@@ -0,0 +1,117 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "RenderGraphBenchmark.h"
+
+namespace
+{
+    // Small and deterministic, so every iteration declares the same graph.
+    class XorShift
+    {
+    public:
+        explicit XorShift(UINT32 seed) : m_state(seed) {}
+
+        UINT32 Next(UINT32 range)
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state % range;
+        }
+
+    private:
+        UINT32 m_state;
+    };
+
+    const UINT ReadWindow = 16;         // Passes read what one of the last few passes rendered.
+    const UINT OutputInterval = 32;     // Every so many passes one composites into the output.
+    const UINT UnusedInterval = 10;     // Every so many passes one renders something nobody reads.
+
+    void DeclareSyntheticGraph(RenderGraph* pGraph, RenderGraphResource output, UINT passCount, std::vector<RenderGraphResource>* pTargets)
+    {
+        const D3D12_RESOURCE_DESC descs[] =
+        {
+            CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1920, 1080, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET),
+            CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R16G16B16A16_FLOAT, 960, 540, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET),
+            CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_FLOAT, 480, 270, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET),
+            CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, 1920, 1080, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+        };
+
+        XorShift random(0x12345678);
+        pTargets->clear();
+        for (UINT i = 0; i < passCount; i++)
+        {
+            const UINT descIndex = random.Next(_countof(descs));
+            const D3D12_RESOURCE_STATES writeState = descIndex == 3 ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET;
+            const RenderGraphResource target = pGraph->CreateTransient(L"SyntheticTarget", descs[descIndex]);
+
+            const UINT pass = pGraph->AddPass(L"SyntheticPass", [](ID3D12GraphicsCommandList*) {});
+            pGraph->Write(pass, target, writeState);
+
+            // Read up to three distinct recent targets, skipping the unused ones.
+            const UINT readCount = (std::min)(i, 1 + random.Next(3));
+            UINT lastRead = UINT_MAX;
+            for (UINT r = 0; r < readCount; r++)
+            {
+                const UINT source = i - 1 - random.Next((std::min)(i, ReadWindow));
+                if (source % UnusedInterval != UnusedInterval - 1 && source != lastRead)
+                {
+                    pGraph->Read(pass, (*pTargets)[source], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+                    lastRead = source;
+                }
+            }
+
+            if (i % OutputInterval == OutputInterval - 1 || i == passCount - 1)
+            {
+                pGraph->Write(pass, output, D3D12_RESOURCE_STATE_RENDER_TARGET);
+            }
+
+            pTargets->push_back(target);
+        }
+    }
+}
+
+RenderGraphBenchmarkResult RunRenderGraphBenchmark(RenderGraph* pGraph, ID3D12Resource* pOutput, UINT passCount, UINT iterationCount)
+{
+    std::vector<RenderGraphResource> targets;
+    targets.reserve(passCount);
+
+    // Warm up the graph's caches and scratch space, as the first frame would.
+    pGraph->Reset();
+    DeclareSyntheticGraph(pGraph, pGraph->ImportResource(pOutput), passCount, &targets);
+    pGraph->Compile();
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    UINT64 declareTime = 0;
+    UINT64 compileTime = 0;
+    for (UINT i = 0; i < iterationCount; i++)
+    {
+        LARGE_INTEGER start, declared, compiled;
+        QueryPerformanceCounter(&start);
+        pGraph->Reset();
+        DeclareSyntheticGraph(pGraph, pGraph->ImportResource(pOutput), passCount, &targets);
+        QueryPerformanceCounter(&declared);
+        pGraph->Compile();
+        QueryPerformanceCounter(&compiled);
+
+        declareTime += declared.QuadPart - start.QuadPart;
+        compileTime += compiled.QuadPart - declared.QuadPart;
+    }
+
+    RenderGraphBenchmarkResult result = {};
+    result.declareMs = 1000.0 * declareTime / frequency.QuadPart / (std::max)(iterationCount, 1u);
+    result.compileMs = 1000.0 * compileTime / frequency.QuadPart / (std::max)(iterationCount, 1u);
+    result.statistics = pGraph->GetStatistics();
+    return result;
+}
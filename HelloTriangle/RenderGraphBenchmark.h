@@ -0,0 +1,28 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include "RenderGraph.h"
+
+struct RenderGraphBenchmarkResult
+{
+    double declareMs;                   // Average time to declare the graph.
+    double compileMs;                   // Average time to compile it.
+    RenderGraph::Statistics statistics;
+};
+
+// Declares and compiles a synthetic graph of the given number of passes over and
+// over, the way a frame would, and reports the average CPU cost. The graph looks
+// like a deferred renderer's: every pass renders one transient, reads a few
+// recent ones, some write the output and some write something nobody reads.
+// Nothing is executed, so any device works, including the null device.
+RenderGraphBenchmarkResult RunRenderGraphBenchmark(RenderGraph* pGraph, ID3D12Resource* pOutput, UINT passCount, UINT iterationCount);
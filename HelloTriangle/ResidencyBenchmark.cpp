@@ -0,0 +1,135 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "ResidencyBenchmark.h"
+
+namespace
+{
+    // Small and deterministic, so every run plays the same trace.
+    class XorShift
+    {
+    public:
+        explicit XorShift(UINT32 seed) : m_state(seed) {}
+
+        UINT32 Next(UINT32 range)
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state % range;
+        }
+
+    private:
+        UINT32 m_state;
+    };
+
+    const UINT HeapCount = 96;
+    const UINT WindowSize = 20;         // Neighboring heaps in view.
+    const UINT RandomUseCount = 4;      // Heaps used from anywhere in the level.
+    const UINT FramesPerStep = 8;       // Frames before the window moves on by a heap.
+    const UINT StreamingInterval = 32;  // Frames between heaps being replaced.
+    const UINT GpuLatency = 2;          // Frames the GPU runs behind.
+    const UINT64 MB = 1024 * 1024;
+
+    UINT64 NextHeapSize(XorShift* pRandom)
+    {
+        return (16 + 4 * pRandom->Next(13)) * MB;
+    }
+}
+
+ResidencyBenchmarkResult RunResidencyBenchmark(UINT frameCount)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    ResidencyPolicy policy;
+    XorShift random(0x9e3779b9);
+
+    // Submission n signals fence value n + 1, and the GPU completes it
+    // GpuLatency frames later.
+    UINT64 totalSize = 0;
+    std::vector<UINT32> heaps(HeapCount);
+    for (UINT32& heap : heaps)
+    {
+        const UINT64 size = NextHeapSize(&random);
+        heap = policy.AddObject(size, 1);
+        totalSize += size;
+    }
+    const UINT64 normalBudget = totalSize / 2;
+    const UINT64 reducedBudget = totalSize / 3;
+
+    ResidencyBenchmarkResult result = {};
+    UINT64 updateTime = 0;
+    std::vector<UINT32> used;
+    std::vector<UINT32> makeResident;
+    std::vector<UINT32> evict;
+    for (UINT frame = 0; frame < frameCount; frame++)
+    {
+        const UINT64 fenceValue = frame + 1;
+        const UINT64 completedValue = fenceValue > GpuLatency ? fenceValue - GpuLatency : 0;
+        const bool reduced = frame >= frameCount / 2 && frame < frameCount / 2 + frameCount / 4;
+        const UINT64 budget = reduced ? reducedBudget : normalBudget;
+
+        // Streaming replaces a heap outside the window with a new one.
+        const UINT windowStart = (frame / FramesPerStep) % HeapCount;
+        if (frame % StreamingInterval == StreamingInterval - 1)
+        {
+            const UINT index = (windowStart + WindowSize + random.Next(HeapCount - WindowSize)) % HeapCount;
+            if (policy.GetLastUse(heaps[index]) <= completedValue)
+            {
+                policy.RemoveObject(heaps[index]);
+                heaps[index] = policy.AddObject(NextHeapSize(&random), fenceValue);
+            }
+        }
+
+        used.clear();
+        for (UINT i = 0; i < WindowSize; i++)
+        {
+            used.push_back(heaps[(windowStart + i) % HeapCount]);
+        }
+        for (UINT i = 0; i < RandomUseCount; i++)
+        {
+            used.push_back(heaps[random.Next(HeapCount)]);
+        }
+
+        LARGE_INTEGER start, end;
+        QueryPerformanceCounter(&start);
+        for (UINT32 heap : used)
+        {
+            policy.Use(heap, fenceValue);
+        }
+        const bool withinBudget = policy.Update(budget, completedValue, &makeResident, &evict);
+        QueryPerformanceCounter(&end);
+        updateTime += end.QuadPart - start.QuadPart;
+
+        if (!withinBudget)
+        {
+            result.overBudgetFrameCount++;
+        }
+        for (UINT32 heap : used)
+        {
+            result.violationCount += policy.IsResident(heap) ? 0 : 1;
+        }
+        for (UINT32 heap : evict)
+        {
+            result.violationCount += policy.GetLastUse(heap) > completedValue ? 1 : 0;
+        }
+    }
+
+    const double nsPerTick = 1000000000.0 / frequency.QuadPart;
+    result.final = policy.GetStatistics();
+    result.updateNs = updateTime * nsPerTick / (std::max)(frameCount, 1u);
+    result.evictionsPerFrame = static_cast<double>(result.final.evictionCount) / (std::max)(frameCount, 1u);
+    result.pagedInMBPerFrame = static_cast<double>(result.final.madeResidentBytes) / MB / (std::max)(frameCount, 1u);
+    return result;
+}
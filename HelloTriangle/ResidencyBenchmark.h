@@ -0,0 +1,35 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include "ResidencyPolicy.h"
+
+struct ResidencyBenchmarkResult
+{
+    double updateNs;                    // Average time per Update().
+    UINT overBudgetFrameCount;          // Frames whose resident heaps exceeded the budget.
+    UINT violationCount;                // Used heaps left evicted, or evicted heaps still in use.
+    double evictionsPerFrame;
+    double pagedInMBPerFrame;           // Made resident again, on average.
+    ResidencyPolicy::Statistics final;
+};
+
+// Plays a synthetic usage trace against a ResidencyPolicy under a simulated
+// budget: a level of heaps of 16 to 64MB that a camera moves through, each
+// frame using a window of neighboring heaps plus a few random ones, with the
+// GPU two frames behind. Heaps are streamed out and in now and then, and for a
+// quarter of the frames the budget drops, the way it does when another process
+// claims video memory. Every frame checks that the heaps it uses are resident
+// and that no heap the GPU may still be reading was evicted. Pure CPU
+// bookkeeping; no device is involved.
+ResidencyBenchmarkResult RunResidencyBenchmark(UINT frameCount);
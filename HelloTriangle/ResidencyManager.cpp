@@ -0,0 +1,129 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "ResidencyManager.h"
+
+_Use_decl_annotations_
+ResidencyManager::ResidencyManager(ID3D12Device* pDevice, IDXGIAdapter3* pAdapter, FenceTimeline* pTimeline, UINT64 budgetLimit) :
+    m_device(pDevice),
+    m_adapter(pAdapter),
+    m_pTimeline(pTimeline),
+    m_budgetLimit(budgetLimit),
+    m_budget(budgetLimit),
+    m_overBudget(false)
+{
+}
+
+ResidencyManager::~ResidencyManager()
+{
+    // The owners of the objects unregister them before destroying them.
+    assert(m_objectIds.empty());
+}
+
+void ResidencyManager::Register(ID3D12Pageable* pObject, UINT64 size)
+{
+    const UINT32 id = m_policy.AddObject(size, m_pTimeline->GetNextValue());
+    if (id >= m_objects.size())
+    {
+        m_objects.resize(id + 1);
+    }
+    m_objects[id] = pObject;
+    m_objectIds[pObject] = id;
+}
+
+void ResidencyManager::Unregister(ID3D12Pageable* pObject)
+{
+    auto it = m_objectIds.find(pObject);
+    if (it == m_objectIds.end())
+    {
+        return;
+    }
+    m_policy.RemoveObject(it->second);
+    m_objects[it->second] = nullptr;
+    m_objectIds.erase(it);
+}
+
+void ResidencyManager::Use(ID3D12Pageable* pObject)
+{
+    auto it = m_objectIds.find(pObject);
+    if (it != m_objectIds.end())
+    {
+        m_policy.Use(it->second, m_pTimeline->GetNextValue());
+    }
+}
+
+void ResidencyManager::EnsureResident(ID3D12Pageable* pObject)
+{
+    auto it = m_objectIds.find(pObject);
+    if (it == m_objectIds.end())
+    {
+        return;
+    }
+    m_policy.Use(it->second, m_pTimeline->GetNextValue());
+    if (!m_policy.IsResident(it->second))
+    {
+        PrepareSubmission();
+    }
+}
+
+// What the registered objects may use: the process's budget less its usage
+// outside of them.
+UINT64 ResidencyManager::QueryBudget()
+{
+    if (!m_adapter)
+    {
+        return m_budgetLimit;
+    }
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+    ThrowIfFailed(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info));
+    const UINT64 residentSize = m_policy.GetStatistics().residentSize;
+    const UINT64 otherUsage = info.CurrentUsage > residentSize ? info.CurrentUsage - residentSize : 0;
+    const UINT64 budget = info.Budget > otherUsage ? info.Budget - otherUsage : 0;
+    return (std::min)(budget, m_budgetLimit);
+}
+
+void ResidencyManager::PrepareSubmission()
+{
+    m_budget = QueryBudget();
+    m_overBudget = !m_policy.Update(m_budget, m_pTimeline->GetCompletedValue(), &m_makeResident, &m_evict);
+
+    // Evicting first lets the objects made resident take the memory it frees.
+    if (!m_evict.empty())
+    {
+        m_batch.clear();
+        for (UINT32 id : m_evict)
+        {
+            m_batch.push_back(m_objects[id]);
+        }
+        ThrowIfFailed(m_device->Evict(static_cast<UINT>(m_batch.size()), m_batch.data()));
+    }
+    if (!m_makeResident.empty())
+    {
+        m_batch.clear();
+        for (UINT32 id : m_makeResident)
+        {
+            m_batch.push_back(m_objects[id]);
+        }
+        ThrowIfFailed(m_device->MakeResident(static_cast<UINT>(m_batch.size()), m_batch.data()));
+    }
+}
+
+ResidencyManager::Statistics ResidencyManager::GetStatistics() const
+{
+    Statistics statistics = {};
+    statistics.policy = m_policy.GetStatistics();
+    statistics.budget = m_budget;
+    statistics.overBudget = m_overBudget;
+    return statistics;
+}
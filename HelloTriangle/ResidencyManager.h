@@ -0,0 +1,80 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <unordered_map>
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+#include "ResidencyPolicy.h"
+
+// Keeps the registered objects, such as the heaps of a PlacedResourceAllocator,
+// within the video memory budget the OS grants the process. Objects are marked
+// as used by the next submission on the timeline; before that submission,
+// PrepareSubmission() queries the budget, evicts the least recently used
+// objects the GPU is done with until the rest fits, and makes the evicted ones
+// the submission uses resident again, with one Evict() and one MakeResident()
+// call for the whole batch. The decisions are a ResidencyPolicy's.
+//
+// The budget is the local segment's budget from IDXGIAdapter3, less what the
+// process uses outside the registered objects, capped by the given budget if
+// any. Without an adapter, as on the null device, only the given budget
+// applies.
+//
+// Work on other queues that writes registered objects must be waited for by
+// the timeline's queue before its next submission completes. Not thread safe.
+class ResidencyManager
+{
+public:
+    struct Statistics
+    {
+        ResidencyPolicy::Statistics policy;
+        UINT64 budget;              // At the last PrepareSubmission().
+        bool overBudget;
+    };
+
+    ResidencyManager(ID3D12Device* pDevice, _In_opt_ IDXGIAdapter3* pAdapter, FenceTimeline* pTimeline, UINT64 budgetLimit = UINT64_MAX);
+    ~ResidencyManager();
+
+    // Registered objects count as resident and used by the next submission.
+    void Register(ID3D12Pageable* pObject, UINT64 size);
+    void Unregister(ID3D12Pageable* pObject);
+
+    // The next submission on the timeline uses the object.
+    void Use(ID3D12Pageable* pObject);
+
+    // Makes the object resident right away, for objects written before the next
+    // submission, such as by a copy queue.
+    void EnsureResident(ID3D12Pageable* pObject);
+
+    // Call before submitting work that uses the objects marked since the last
+    // call.
+    void PrepareSubmission();
+
+    Statistics GetStatistics() const;
+
+private:
+    UINT64 QueryBudget();
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<IDXGIAdapter3> m_adapter;
+    FenceTimeline* m_pTimeline;
+    UINT64 m_budgetLimit;
+    UINT64 m_budget;
+    bool m_overBudget;
+    ResidencyPolicy m_policy;
+    std::unordered_map<ID3D12Pageable*, UINT32> m_objectIds;
+    std::vector<ID3D12Pageable*> m_objects;     // By policy object.
+    std::vector<UINT32> m_makeResident;
+    std::vector<UINT32> m_evict;
+    std::vector<ID3D12Pageable*> m_batch;
+};
@@ -0,0 +1,258 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Least-recently-used residency decisions for a set of objects, such as heaps,
+// that compete for a video memory budget. Every object remembers the fence
+// value of the last submission that uses it. Before a submission, Update()
+// picks the evicted objects the submission uses, to be made resident, and
+// evicts the least recently used resident objects until the rest fits the
+// budget. Only objects whose last use has completed may be evicted; when those
+// do not free enough, the objects stay resident and the budget is exceeded
+// rather than evicting memory the GPU may still read.
+//
+// Resident objects are kept in a list by last use, so finding eviction
+// candidates is O(1) per candidate. Fence values passed to Use() must not
+// decrease.
+//
+// The policy only deals in sizes and fence values; ResidencyManager applies it
+// to ID3D12Pageables, and Tests/ResidencyPolicyTests.cpp to a simulated GPU.
+class ResidencyPolicy
+{
+public:
+    static const uint32_t InvalidObject = UINT32_MAX;
+
+    struct Statistics
+    {
+        uint64_t residentSize;
+        uint64_t evictedSize;
+        uint32_t residentCount;
+        uint32_t evictedCount;
+        uint64_t evictionCount;             // Since creation.
+        uint64_t makeResidentCount;
+        uint64_t evictedBytes;
+        uint64_t madeResidentBytes;
+    };
+
+    ResidencyPolicy() :
+        m_lruHead(InvalidObject),
+        m_lruTail(InvalidObject),
+        m_lastUse(0),
+        m_statistics()
+    {
+    }
+
+    // New objects are resident, as freshly created heaps are, and used by the
+    // submission with the given fence value.
+    uint32_t AddObject(uint64_t size, uint64_t fenceValue)
+    {
+        uint32_t object;
+        if (!m_freeObjects.empty())
+        {
+            object = m_freeObjects.back();
+            m_freeObjects.pop_back();
+        }
+        else
+        {
+            object = static_cast<uint32_t>(m_objects.size());
+            m_objects.emplace_back();
+        }
+
+        Object& entry = m_objects[object];
+        entry.size = size;
+        entry.lastUse = fenceValue;
+        entry.resident = true;
+        entry.pendingResident = false;
+        entry.alive = true;
+        PushBack(object);
+        m_statistics.residentSize += size;
+        m_statistics.residentCount++;
+        NoteUse(fenceValue);
+        return object;
+    }
+
+    void RemoveObject(uint32_t object)
+    {
+        Object& entry = m_objects[object];
+        assert(entry.alive);
+        if (entry.resident)
+        {
+            Unlink(object);
+            m_statistics.residentSize -= entry.size;
+            m_statistics.residentCount--;
+        }
+        else
+        {
+            m_statistics.evictedSize -= entry.size;
+            m_statistics.evictedCount--;
+            if (entry.pendingResident)
+            {
+                for (size_t i = 0; i < m_pendingResident.size(); i++)
+                {
+                    if (m_pendingResident[i] == object)
+                    {
+                        m_pendingResident.erase(m_pendingResident.begin() + i);
+                        break;
+                    }
+                }
+            }
+        }
+        entry.alive = false;
+        m_freeObjects.push_back(object);
+    }
+
+    // The submission with the given fence value uses the object.
+    void Use(uint32_t object, uint64_t fenceValue)
+    {
+        Object& entry = m_objects[object];
+        assert(entry.alive);
+        NoteUse(fenceValue);
+        entry.lastUse = fenceValue;
+        if (entry.resident)
+        {
+            Unlink(object);
+            PushBack(object);
+        }
+        else if (!entry.pendingResident)
+        {
+            entry.pendingResident = true;
+            m_pendingResident.push_back(object);
+        }
+    }
+
+    // Decides what changes before the next submission: the evicted objects it
+    // uses go to pMakeResident and the objects to evict, least recently used
+    // first, to pEvict. Evictions come first, so that the memory they free is
+    // there for the objects made resident. Returns false when the resident
+    // objects still exceed the budget.
+    bool Update(uint64_t budget, uint64_t completedFenceValue, std::vector<uint32_t>* pMakeResident, std::vector<uint32_t>* pEvict)
+    {
+        pMakeResident->clear();
+        pEvict->clear();
+
+        uint64_t incomingSize = 0;
+        for (uint32_t object : m_pendingResident)
+        {
+            incomingSize += m_objects[object].size;
+        }
+
+        // The list is in order of last use, so the first object still in use
+        // ends the search.
+        while (m_lruHead != InvalidObject && m_statistics.residentSize + incomingSize > budget &&
+            m_objects[m_lruHead].lastUse <= completedFenceValue)
+        {
+            const uint32_t object = m_lruHead;
+            Object& entry = m_objects[object];
+            Unlink(object);
+            entry.resident = false;
+            m_statistics.residentSize -= entry.size;
+            m_statistics.residentCount--;
+            m_statistics.evictedSize += entry.size;
+            m_statistics.evictedCount++;
+            m_statistics.evictionCount++;
+            m_statistics.evictedBytes += entry.size;
+            pEvict->push_back(object);
+        }
+
+        for (uint32_t object : m_pendingResident)
+        {
+            Object& entry = m_objects[object];
+            entry.resident = true;
+            entry.pendingResident = false;
+            PushBack(object);
+            m_statistics.evictedSize -= entry.size;
+            m_statistics.evictedCount--;
+            m_statistics.residentSize += entry.size;
+            m_statistics.residentCount++;
+            m_statistics.makeResidentCount++;
+            m_statistics.madeResidentBytes += entry.size;
+            pMakeResident->push_back(object);
+        }
+        m_pendingResident.clear();
+
+        return m_statistics.residentSize <= budget;
+    }
+
+    bool IsResident(uint32_t object) const          { return m_objects[object].resident; }
+    uint64_t GetLastUse(uint32_t object) const      { return m_objects[object].lastUse; }
+    uint64_t GetSize(uint32_t object) const         { return m_objects[object].size; }
+    const Statistics& GetStatistics() const         { return m_statistics; }
+
+private:
+    struct Object
+    {
+        uint64_t size;
+        uint64_t lastUse;
+        uint32_t previous;      // In the list of resident objects.
+        uint32_t next;
+        bool resident;
+        bool pendingResident;   // Evicted and used by the next submission.
+        bool alive;
+    };
+
+    void NoteUse(uint64_t fenceValue)
+    {
+        // Older uses would break the order of the list.
+        assert(fenceValue >= m_lastUse);
+        m_lastUse = fenceValue;
+    }
+
+    void PushBack(uint32_t object)
+    {
+        Object& entry = m_objects[object];
+        entry.previous = m_lruTail;
+        entry.next = InvalidObject;
+        if (m_lruTail != InvalidObject)
+        {
+            m_objects[m_lruTail].next = object;
+        }
+        else
+        {
+            m_lruHead = object;
+        }
+        m_lruTail = object;
+    }
+
+    void Unlink(uint32_t object)
+    {
+        Object& entry = m_objects[object];
+        if (entry.previous != InvalidObject)
+        {
+            m_objects[entry.previous].next = entry.next;
+        }
+        else
+        {
+            m_lruHead = entry.next;
+        }
+        if (entry.next != InvalidObject)
+        {
+            m_objects[entry.next].previous = entry.previous;
+        }
+        else
+        {
+            m_lruTail = entry.previous;
+        }
+    }
+
+    std::vector<Object> m_objects;
+    std::vector<uint32_t> m_freeObjects;
+    std::vector<uint32_t> m_pendingResident;
+    uint32_t m_lruHead;         // Least recently used.
+    uint32_t m_lruTail;
+    uint64_t m_lastUse;
+    Statistics m_statistics;
+};
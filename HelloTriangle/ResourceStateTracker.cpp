@@ -0,0 +1,254 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "ResourceStateTracker.h"
+#include "CommandStreamCapture.h"
+
+void ResourceStateRegistry::Register(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_states[pResource] = state;
+}
+
+void ResourceStateRegistry::Unregister(ID3D12Resource* pResource)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_states.erase(pResource);
+}
+
+bool ResourceStateRegistry::TryGetState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES* pState)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_states.find(pResource);
+    if (it == m_states.end())
+    {
+        return false;
+    }
+    *pState = it->second;
+    return true;
+}
+
+void ResourceStateRegistry::Resolve(const ResourceStateTracker& tracker, std::vector<D3D12_RESOURCE_BARRIER>* pBarriers)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const ResourceStateTracker::ResourceState& state : tracker.m_states)
+    {
+        auto it = m_states.find(state.pResource);
+        if (it != m_states.end())
+        {
+            if (it->second != state.initialState)
+            {
+                pBarriers->push_back(CD3DX12_RESOURCE_BARRIER::Transition(state.pResource, it->second, state.initialState));
+            }
+            it->second = state.currentState;
+        }
+        else
+        {
+            m_states.emplace(state.pResource, state.currentState);
+        }
+    }
+}
+
+ResourceStateTracker::ResourceStateTracker(ResourceStateRegistry* pRegistry) :
+    m_pRegistry(pRegistry),
+    m_pPredecessor(nullptr)
+{
+}
+
+void ResourceStateTracker::Reset(const ResourceStateTracker* pPredecessor)
+{
+    assert(m_pendingBarriers.empty());
+    m_pPredecessor = pPredecessor;
+    m_states.clear();
+    m_indices.clear();
+}
+
+void ResourceStateTracker::Transition(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+{
+    ResourceState* pState = FindOrAssume(pResource, state);
+    if (pState->splitInProgress)
+    {
+        // Ending into the state the split was going to anyway completes it;
+        // anything else needs a second transition after it.
+        EndSplitTransition(*pState);
+    }
+    if (pState->currentState != state)
+    {
+        m_pendingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pResource, pState->currentState, state));
+        pState->currentState = state;
+    }
+}
+
+void ResourceStateTracker::BeginTransition(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+{
+    D3D12_RESOURCE_STATES assumedState;
+    if (!Find(pResource) && !TryAssumeState(pResource, &assumedState))
+    {
+        // The split cannot start from an unknown state; the resource
+        // transitions on next use instead.
+        return;
+    }
+
+    ResourceState* pState = FindOrAssume(pResource, state);
+    if (pState->splitInProgress)
+    {
+        EndSplitTransition(*pState);
+    }
+    if (pState->currentState != state)
+    {
+        m_pendingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pResource, pState->currentState, state, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY));
+        pState->splitBeforeState = pState->currentState;
+        pState->currentState = state;
+        pState->splitInProgress = true;
+    }
+}
+
+void ResourceStateTracker::UAVBarrier(ID3D12Resource* pResource)
+{
+    m_pendingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(pResource));
+}
+
+void ResourceStateTracker::AliasingBarrier(ID3D12Resource* pResourceBefore, ID3D12Resource* pResourceAfter)
+{
+    m_pendingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(pResourceBefore, pResourceAfter));
+}
+
+void ResourceStateTracker::FlushBarriers(ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!m_pendingBarriers.empty())
+    {
+        pCommandList->ResourceBarrier(static_cast<UINT>(m_pendingBarriers.size()), m_pendingBarriers.data());
+        m_pendingBarriers.clear();
+    }
+}
+
+void ResourceStateTracker::Finish(ID3D12GraphicsCommandList* pCommandList)
+{
+    for (ResourceState& state : m_states)
+    {
+        if (state.splitInProgress)
+        {
+            EndSplitTransition(state);
+        }
+    }
+    FlushBarriers(pCommandList);
+}
+
+ResourceStateTracker::ResourceState* ResourceStateTracker::FindOrAssume(ID3D12Resource* pResource, D3D12_RESOURCE_STATES fallbackState)
+{
+    auto it = m_indices.find(pResource);
+    if (it != m_indices.end())
+    {
+        return &m_states[it->second];
+    }
+
+    // Without an assumption, expect the resource to already be in the state it
+    // is needed in; submission fixes it up if it is not.
+    D3D12_RESOURCE_STATES initialState;
+    if (!TryAssumeState(pResource, &initialState))
+    {
+        initialState = fallbackState;
+    }
+
+    m_indices.emplace(pResource, m_states.size());
+    m_states.push_back({ pResource, initialState, initialState, initialState, false });
+    return &m_states.back();
+}
+
+// Assumes the state the closest predecessor that used the resource leaves it
+// in, or else the state the registry holds.
+bool ResourceStateTracker::TryAssumeState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES* pState) const
+{
+    for (const ResourceStateTracker* pTracker = m_pPredecessor; pTracker; pTracker = pTracker->m_pPredecessor)
+    {
+        if (const ResourceState* pPrevious = pTracker->Find(pResource))
+        {
+            *pState = pPrevious->currentState;
+            return true;
+        }
+    }
+    return m_pRegistry->TryGetState(pResource, pState);
+}
+
+const ResourceStateTracker::ResourceState* ResourceStateTracker::Find(ID3D12Resource* pResource) const
+{
+    auto it = m_indices.find(pResource);
+    return it != m_indices.end() ? &m_states[it->second] : nullptr;
+}
+
+void ResourceStateTracker::EndSplitTransition(ResourceState& state)
+{
+    m_pendingBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(state.pResource, state.splitBeforeState, state.currentState, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY));
+    state.splitInProgress = false;
+}
+
+ResourceStateSubmitter::ResourceStateSubmitter(ID3D12Device* pDevice, CommandAllocatorPool* pAllocatorPool, ResourceStateRegistry* pRegistry, CommandStreamCapture* pCapture) :
+    m_device(pDevice),
+    m_pAllocatorPool(pAllocatorPool),
+    m_pRegistry(pRegistry),
+    m_pCapture(pCapture),
+    m_fixupListCount(0)
+{
+}
+
+void ResourceStateSubmitter::ExecuteCommandLists(ID3D12CommandQueue* pQueue, UINT numCommandLists, ID3D12CommandList* const* ppCommandLists, ResourceStateTracker* const* ppTrackers)
+{
+    m_submission.clear();
+    ID3D12CommandAllocator* pAllocator = nullptr;
+    UINT fixupCount = 0;
+
+    // Resolve in submission order, so each list is checked against the states
+    // the lists before it leave behind.
+    for (UINT i = 0; i < numCommandLists; i++)
+    {
+        if (ppTrackers[i])
+        {
+            m_barriers.clear();
+            m_pRegistry->Resolve(*ppTrackers[i], &m_barriers);
+            if (!m_barriers.empty())
+            {
+                if (!pAllocator)
+                {
+                    pAllocator = m_pAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+                }
+
+                ID3D12GraphicsCommandList* pFixupList = GetFixupList(fixupCount++);
+                ThrowIfFailed(pFixupList->Reset(pAllocator, nullptr));
+                pFixupList->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+                ThrowIfFailed(pFixupList->Close());
+                m_submission.push_back(pFixupList);
+            }
+        }
+        m_submission.push_back(ppCommandLists[i]);
+    }
+
+    m_fixupListCount += fixupCount;
+    pQueue->ExecuteCommandLists(static_cast<UINT>(m_submission.size()), m_submission.data());
+}
+
+ID3D12GraphicsCommandList* ResourceStateSubmitter::GetFixupList(UINT index)
+{
+    while (m_fixupLists.size() <= index)
+    {
+        ComPtr<ID3D12GraphicsCommandList> commandList;
+        ID3D12CommandAllocator* pAllocator = m_pAllocatorPool->Acquire(0, D3D12_COMMAND_LIST_TYPE_DIRECT);
+        ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, pAllocator, nullptr, IID_PPV_ARGS(&commandList)));
+        ThrowIfFailed(commandList->Close());
+        SetNameIndexed(commandList.Get(), L"BarrierFixupList", static_cast<UINT>(m_fixupLists.size()));
+        if (m_pCapture)
+        {
+            m_pCapture->Wrap(commandList);
+        }
+        m_fixupLists.push_back(commandList);
+    }
+    return m_fixupLists[index].Get();
+}
@@ -0,0 +1,138 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include "DXSampleHelper.h"
+#include "CommandAllocatorPool.h"
+
+class CommandStreamCapture;
+class ResourceStateTracker;
+
+// The state every registered resource is in once all submitted work has run.
+// Only the submission thread changes states, in submission order, through
+// Resolve(); recording threads may read them. States cover whole resources.
+//
+// Thread safe.
+class ResourceStateRegistry
+{
+public:
+    void Register(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
+    void Unregister(ID3D12Resource* pResource);
+
+    bool TryGetState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES* pState);
+
+    // Appends the barriers that bring the tracker's resources into the states
+    // its command list expects at its start, then commits the states the list
+    // leaves them in. Resources that were never registered are trusted to be
+    // in the expected state and are registered from then on.
+    void Resolve(const ResourceStateTracker& tracker, std::vector<D3D12_RESOURCE_BARRIER>* pBarriers);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_STATES> m_states;
+};
+
+// Tracks the states of the resources one command list uses and turns state
+// requirements into barriers. Transitions are queued and issued together by
+// FlushBarriers(), which belongs right before the next draw, clear or copy, so
+// that consecutive transitions cost one ResourceBarrier call.
+//
+// A command list does not know what state a resource will be in when it runs.
+// The first use of a resource therefore assumes a state: the one a predecessor
+// list leaves it in, or else the one the registry currently holds. At submission
+// the registry checks every assumption against the actual state and inserts a
+// barrier ahead of the list wherever one was wrong, so a good assumption costs
+// nothing and a bad one still renders correctly.
+class ResourceStateTracker
+{
+public:
+    explicit ResourceStateTracker(ResourceStateRegistry* pRegistry);
+
+    // Call whenever the command list is reset. The predecessor, if any, is the
+    // tracker of a list that was recorded before this one and runs before it.
+    void Reset(const ResourceStateTracker* pPredecessor = nullptr);
+
+    // Requires the resource to be in the given state from here on.
+    void Transition(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
+
+    // Starts a split transition into the given state, so the GPU can overlap it
+    // with the work recorded until the resource is next used or transitioned.
+    // Resources whose current state is unknown simply transition on next use.
+    void BeginTransition(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
+
+    void UAVBarrier(ID3D12Resource* pResource);
+    void AliasingBarrier(ID3D12Resource* pResourceBefore, ID3D12Resource* pResourceAfter);
+
+    // Issues the queued barriers as a single batch.
+    void FlushBarriers(ID3D12GraphicsCommandList* pCommandList);
+
+    // Ends any split transitions still in progress and flushes. Call before
+    // closing the command list.
+    void Finish(ID3D12GraphicsCommandList* pCommandList);
+
+private:
+    friend class ResourceStateRegistry;
+
+    struct ResourceState
+    {
+        ID3D12Resource* pResource;
+        D3D12_RESOURCE_STATES initialState;     // Expected at the start of the list.
+        D3D12_RESOURCE_STATES currentState;
+        D3D12_RESOURCE_STATES splitBeforeState; // Valid while a split transition is in progress.
+        bool splitInProgress;
+    };
+
+    // Returns the resource's entry, adding one on first use. A resource whose
+    // state cannot be assumed is expected in fallbackState.
+    ResourceState* FindOrAssume(ID3D12Resource* pResource, D3D12_RESOURCE_STATES fallbackState);
+    const ResourceState* Find(ID3D12Resource* pResource) const;
+    bool TryAssumeState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES* pState) const;
+    void EndSplitTransition(ResourceState& state);
+
+    ResourceStateRegistry* m_pRegistry;
+    const ResourceStateTracker* m_pPredecessor;
+
+    // Entries stay in order of first use so resolved barriers are deterministic.
+    std::vector<ResourceState> m_states;
+    std::unordered_map<ID3D12Resource*, size_t> m_indices;
+    std::vector<D3D12_RESOURCE_BARRIER> m_pendingBarriers;
+};
+
+// Submits tracked command lists. Wherever a list's assumed initial states turn
+// out to be wrong, a short fixup command list with the missing barriers is
+// inserted ahead of it in the same ExecuteCommandLists call.
+class ResourceStateSubmitter
+{
+public:
+    // With a capture, the fixup lists are wrapped so that they are captured too.
+    ResourceStateSubmitter(ID3D12Device* pDevice, CommandAllocatorPool* pAllocatorPool, ResourceStateRegistry* pRegistry, CommandStreamCapture* pCapture = nullptr);
+
+    // ppTrackers runs parallel to ppCommandLists; lists that track nothing pass null.
+    void ExecuteCommandLists(ID3D12CommandQueue* pQueue, UINT numCommandLists, ID3D12CommandList* const* ppCommandLists, ResourceStateTracker* const* ppTrackers);
+
+    // Number of fixup lists submitted so far; ideally stays at zero.
+    UINT64 GetFixupListCount() const        { return m_fixupListCount; }
+
+private:
+    ID3D12GraphicsCommandList* GetFixupList(UINT index);
+
+    ComPtr<ID3D12Device> m_device;
+    CommandAllocatorPool* m_pAllocatorPool;
+    ResourceStateRegistry* m_pRegistry;
+    CommandStreamCapture* m_pCapture;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_fixupLists;
+    std::vector<ID3D12CommandList*> m_submission;
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+    UINT64 m_fixupListCount;
+};
@@ -0,0 +1,92 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+// Items that have to outlive the GPU's use of them, each tagged with the fence
+// value of its last use and retired once the timeline passes that value.
+//
+// Items are usually tagged with the timeline's next value, which has not been
+// signaled yet, so Flush() signals it before waiting; otherwise a release
+// followed by a flush with no frame in between would wait forever.
+//
+// The timeline is anything with FenceTimeline's GetNextValue(), Signal(),
+// IsCompleted() and WaitForValue(); Tests/RetireQueueTests.cpp uses a
+// simulated one.
+template<class T, class Timeline>
+class RetireQueue
+{
+public:
+    explicit RetireQueue(Timeline* pTimeline) : m_pTimeline(pTimeline) {}
+
+    // Values are handed out in order, so the queue stays sorted as long as
+    // callers use the current timeline values; keep it sorted regardless.
+    void Push(uint64_t fenceValue, T item)
+    {
+        auto it = m_items.end();
+        while (it != m_items.begin() && (it - 1)->fenceValue > fenceValue)
+        {
+            --it;
+        }
+        m_items.insert(it, { fenceValue, std::move(item) });
+    }
+
+    // Hands every item whose last use has completed to retire(T&), oldest
+    // first, then drops it. Returns the number of items retired.
+    template<class Retire>
+    size_t Collect(Retire retire)
+    {
+        size_t count = 0;
+        while (!m_items.empty() && m_pTimeline->IsCompleted(m_items.front().fenceValue))
+        {
+            retire(m_items.front().item);
+            m_items.pop_front();
+            count++;
+        }
+        return count;
+    }
+
+    // Waits for the last use of every item and retires them all.
+    template<class Retire>
+    size_t Flush(Retire retire)
+    {
+        if (m_items.empty())
+        {
+            return 0;
+        }
+
+        const uint64_t lastValue = m_items.back().fenceValue;
+        while (lastValue >= m_pTimeline->GetNextValue())
+        {
+            m_pTimeline->Signal();
+        }
+        m_pTimeline->WaitForValue(lastValue);
+        return Collect(retire);
+    }
+
+    bool IsEmpty() const        { return m_items.empty(); }
+    size_t GetCount() const     { return m_items.size(); }
+
+private:
+    struct Item
+    {
+        uint64_t fenceValue;
+        T item;
+    };
+
+    Timeline* m_pTimeline;
+    std::deque<Item> m_items;
+};
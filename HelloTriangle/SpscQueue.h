@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <atomic>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Head and tail only ever grow; the capacity being a power of two lets
+// them wrap around the UINT range without breaking the full/empty tests.
+template<class T, UINT Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    SpscQueue() : m_head(0), m_tail(0) {}
+
+    // Producer only. Returns false when the queue is full.
+    bool Push(const T& item)
+    {
+        const UINT tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when the queue is empty.
+    bool Pop(T& item)
+    {
+        const UINT head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Keep the producer- and consumer-owned indices on separate cache lines.
+    alignas(64) std::atomic<UINT> m_head;
+    alignas(64) std::atomic<UINT> m_tail;
+    T m_items[Capacity];
+};
@@ -0,0 +1,116 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../DescriptorIndexFreeList.h"
+#include "TestCheck.h"
+
+namespace
+{
+    // Every index comes out once, and then the list is empty.
+    void TestPopAll()
+    {
+        DescriptorIndexFreeList freeList(64);
+        std::vector<bool> seen(64, false);
+        for (int i = 0; i < 64; i++)
+        {
+            const uint32_t index = freeList.Pop();
+            CHECK(index < 64 && !seen[index]);
+            seen[index] = true;
+        }
+        CHECK(freeList.Pop() == DescriptorIndexFreeList::InvalidIndex);
+
+        freeList.Push(17);
+        CHECK(freeList.Pop() == 17);
+        CHECK(freeList.Pop() == DescriptorIndexFreeList::InvalidIndex);
+
+        DescriptorIndexFreeList empty(0);
+        CHECK(empty.Pop() == DescriptorIndexFreeList::InvalidIndex);
+    }
+
+    // Recording threads allocate and free staging descriptors all at once. No
+    // index may ever be handed to two threads at a time, and none may be lost.
+    void TestConcurrent()
+    {
+        const uint32_t Capacity = 256;
+        const int ThreadCount = 8;
+        const int Iterations = 100000;
+
+        DescriptorIndexFreeList freeList(Capacity);
+        std::unique_ptr<std::atomic<bool>[]> taken(new std::atomic<bool>[Capacity]);
+        for (uint32_t i = 0; i < Capacity; i++)
+        {
+            taken[i] = false;
+        }
+        std::atomic<int> doubleTaken(0);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < ThreadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                std::vector<uint32_t> held;
+                for (int i = 0; i < Iterations; i++)
+                {
+                    // Hold a few indices at a time, so that pops and pushes of the
+                    // same indices interleave across threads.
+                    if (held.size() < static_cast<size_t>(1 + (i + t) % 4))
+                    {
+                        const uint32_t index = freeList.Pop();
+                        if (index != DescriptorIndexFreeList::InvalidIndex)
+                        {
+                            doubleTaken += taken[index].exchange(true) ? 1 : 0;
+                            held.push_back(index);
+                        }
+                    }
+                    else
+                    {
+                        taken[held.back()] = false;
+                        freeList.Push(held.back());
+                        held.pop_back();
+                    }
+                }
+                for (uint32_t index : held)
+                {
+                    taken[index] = false;
+                    freeList.Push(index);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        CHECK(doubleTaken == 0);
+
+        std::vector<bool> seen(Capacity, false);
+        for (uint32_t i = 0; i < Capacity; i++)
+        {
+            const uint32_t index = freeList.Pop();
+            CHECK(index < Capacity && !seen[index]);
+            seen[index] = true;
+        }
+        CHECK(freeList.Pop() == DescriptorIndexFreeList::InvalidIndex);
+    }
+}
+
+int main()
+{
+    TestPopAll();
+    TestConcurrent();
+    std::printf("DescriptorIndexFreeList tests passed\n");
+    return EXIT_SUCCESS;
+}
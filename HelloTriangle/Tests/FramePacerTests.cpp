@@ -0,0 +1,189 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <cstdint>
+#include <deque>
+#include "../FramePacer.h"
+#include "TestCheck.h"
+
+namespace
+{
+    const int64_t Frequency = 1000000;     // Microsecond ticks.
+
+    int64_t Ms(double ms)
+    {
+        return static_cast<int64_t>(ms * Frequency / 1000.0);
+    }
+
+    // Time only moves when the pacer sleeps or waits, or when the simulated
+    // CPU works on a frame.
+    class SimulatedClock : public FramePacer::Clock
+    {
+    public:
+        SimulatedClock() : m_now(0) {}
+
+        virtual int64_t GetTicks()                  { return m_now; }
+        virtual int64_t GetFrequency()              { return Frequency; }
+        virtual void SleepUntil(int64_t ticks)      { m_now = (std::max)(m_now, ticks); }
+
+        void Advance(int64_t ticks)                 { m_now += ticks; }
+
+    private:
+        int64_t m_now;
+    };
+
+    // A GPU that runs submissions in order, each for the GPU time given when it
+    // was submitted, starting once both it and the previous one are there.
+    class SimulatedFence : public FramePacer::Fence
+    {
+    public:
+        explicit SimulatedFence(SimulatedClock* pClock) : m_pClock(pClock), m_busyUntil(0) {}
+
+        void Submit(uint64_t fenceValue, int64_t gpuTicks)
+        {
+            m_busyUntil = (std::max)(m_busyUntil, m_pClock->GetTicks()) + gpuTicks;
+            m_completions.push_back({ fenceValue, m_busyUntil });
+        }
+
+        virtual uint64_t GetCompletedValue()
+        {
+            uint64_t completed = 0;
+            for (const Completion& completion : m_completions)
+            {
+                if (completion.time <= m_pClock->GetTicks())
+                {
+                    completed = completion.fenceValue;
+                }
+            }
+            return completed;
+        }
+
+        virtual void WaitForValue(uint64_t value)
+        {
+            for (const Completion& completion : m_completions)
+            {
+                if (completion.fenceValue >= value)
+                {
+                    m_pClock->SleepUntil(completion.time);
+                    return;
+                }
+            }
+        }
+
+    private:
+        struct Completion
+        {
+            uint64_t fenceValue;
+            int64_t time;
+        };
+
+        SimulatedClock* m_pClock;
+        int64_t m_busyUntil;
+        std::deque<Completion> m_completions;
+    };
+
+    struct Run
+    {
+        SimulatedClock clock;
+        SimulatedFence fence;
+        FramePacer pacer;
+        uint64_t fenceValue;
+
+        Run(double targetFrameTimeMs, uint32_t maxQueuedFrames) :
+            fence(&clock),
+            pacer(&clock, &fence, targetFrameTimeMs, maxQueuedFrames),
+            fenceValue(0)
+        {
+        }
+
+        // Runs the frames and returns the pacer's statistics over them.
+        FramePacer::Statistics Frames(uint32_t count, double cpuMs, double gpuMs)
+        {
+            pacer.ResetStatistics();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                pacer.BeginFrame();
+                clock.Advance(Ms(cpuMs));
+                fence.Submit(++fenceValue, Ms(gpuMs));
+                pacer.OnPresent(fenceValue);
+            }
+            return pacer.GetStatistics();
+        }
+    };
+
+    // A GPU-bound stream settles at the GPU's frame time, holding the CPU back
+    // instead of queueing frames.
+    void TestGpuBound()
+    {
+        Run run(0.0, 1);
+        run.Frames(200, 1.0, 10.0);
+        const FramePacer::Statistics stats = run.Frames(1000, 1.0, 10.0);
+        CHECK(stats.averageFrameIntervalMs > 9.9 && stats.averageFrameIntervalMs < 10.5);
+        CHECK(stats.averageSleepMs > 8.0);
+        CHECK(stats.starvedFrames < 20);
+    }
+
+    // A CPU-bound stream never sleeps.
+    void TestCpuBound()
+    {
+        Run run(0.0, 1);
+        run.Frames(200, 5.0, 1.0);
+        const FramePacer::Statistics stats = run.Frames(1000, 5.0, 1.0);
+        CHECK(stats.averageFrameIntervalMs > 4.99 && stats.averageFrameIntervalMs < 5.01);
+        CHECK(stats.averageSleepMs < 0.01);
+        CHECK(stats.starvedFrames == 0);
+    }
+
+    // The target frame time caps a fast stream.
+    void TestTargetFrameTime()
+    {
+        Run run(16.0, 1);
+        run.Frames(200, 1.0, 2.0);
+        const FramePacer::Statistics stats = run.Frames(1000, 1.0, 2.0);
+        CHECK(stats.averageFrameIntervalMs > 15.99 && stats.averageFrameIntervalMs < 16.01);
+    }
+
+    // Once the GPU gets faster, the pacer has to stop holding the CPU back for
+    // the old GPU time, although it no longer blocks on a fence to measure it.
+    void TestGpuSpeedsUp()
+    {
+        Run run(0.0, 1);
+        run.Frames(200, 1.0, 20.0);
+        run.Frames(200, 1.0, 2.0);
+        const FramePacer::Statistics stats = run.Frames(1600, 1.0, 2.0);
+        CHECK(stats.averageFrameIntervalMs < 2.2);
+        CHECK(stats.starvedFrames < 16);
+        CHECK(stats.safetyMarginMs < 1.0);
+    }
+
+    // And a GPU that gets slower is picked up from the fence waits.
+    void TestGpuSlowsDown()
+    {
+        Run run(0.0, 1);
+        run.Frames(200, 1.0, 2.0);
+        run.Frames(200, 1.0, 12.0);
+        const FramePacer::Statistics stats = run.Frames(1600, 1.0, 12.0);
+        CHECK(stats.averageFrameIntervalMs > 11.9 && stats.averageFrameIntervalMs < 12.5);
+        CHECK(stats.starvedFrames < 16);
+    }
+}
+
+int main()
+{
+    TestGpuBound();
+    TestCpuBound();
+    TestTargetFrameTime();
+    TestGpuSpeedsUp();
+    TestGpuSlowsDown();
+    std::printf("FramePacer tests passed\n");
+    return EXIT_SUCCESS;
+}
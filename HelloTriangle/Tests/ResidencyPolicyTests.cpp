@@ -0,0 +1,149 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../ResidencyPolicy.h"
+#include "TestCheck.h"
+
+namespace
+{
+    const uint64_t MB = 1024 * 1024;
+
+    // Objects stay resident while they fit the budget.
+    void TestUnderBudget()
+    {
+        ResidencyPolicy policy;
+        std::vector<uint32_t> makeResident, evict;
+        for (uint64_t fenceValue = 1; fenceValue <= 4; fenceValue++)
+        {
+            policy.AddObject(16 * MB, fenceValue);
+        }
+        CHECK(policy.Update(64 * MB, 4, &makeResident, &evict));
+        CHECK(makeResident.empty() && evict.empty());
+        CHECK(policy.GetStatistics().residentCount == 4);
+    }
+
+    // Over the budget, the least recently used objects go first, and an
+    // evicted object that is used again comes back.
+    void TestLeastRecentlyUsed()
+    {
+        ResidencyPolicy policy;
+        std::vector<uint32_t> makeResident, evict;
+        const uint32_t a = policy.AddObject(16 * MB, 1);
+        const uint32_t b = policy.AddObject(16 * MB, 2);
+        const uint32_t c = policy.AddObject(16 * MB, 3);
+        policy.Use(a, 4);
+
+        CHECK(policy.Update(32 * MB, 4, &makeResident, &evict));
+        CHECK(evict.size() == 1 && evict[0] == b);
+        CHECK(!policy.IsResident(b) && policy.IsResident(a) && policy.IsResident(c));
+
+        policy.Use(b, 5);
+        CHECK(policy.Update(32 * MB, 5, &makeResident, &evict));
+        CHECK(evict.size() == 1 && evict[0] == c);
+        CHECK(makeResident.size() == 1 && makeResident[0] == b);
+        CHECK(policy.GetStatistics().evictionCount == 2 && policy.GetStatistics().makeResidentCount == 1);
+    }
+
+    // Objects the GPU may still read stay resident, even over the budget.
+    void TestInUseNotEvicted()
+    {
+        ResidencyPolicy policy;
+        std::vector<uint32_t> makeResident, evict;
+        policy.AddObject(16 * MB, 1);
+        policy.AddObject(16 * MB, 2);
+        CHECK(!policy.Update(16 * MB, 0, &makeResident, &evict));
+        CHECK(evict.empty());
+        CHECK(policy.Update(16 * MB, 1, &makeResident, &evict));
+        CHECK(evict.size() == 1);
+    }
+
+    // A simulated GPU a few frames behind the CPU, drawing with a random set of
+    // heaps every frame against a budget that changes over time. Every heap a
+    // frame uses is resident when it is submitted, nothing the GPU may still
+    // read is ever evicted, and the budget holds whenever the completed frames
+    // leave enough to evict.
+    void TestSimulatedFrames()
+    {
+        const uint32_t HeapCount = 64;
+        const uint64_t FramesInFlight = 3;
+
+        ResidencyPolicy policy;
+        std::vector<uint32_t> heaps;
+        std::vector<uint32_t> makeResident, evict;
+        std::mt19937 random(1);
+        for (uint32_t i = 0; i < HeapCount; i++)
+        {
+            heaps.push_back(policy.AddObject((1 + random() % 8) * MB, 0));
+        }
+
+        uint64_t overBudgetFrames = 0;
+        for (uint64_t fenceValue = 1; fenceValue <= 5000; fenceValue++)
+        {
+            const uint64_t completedValue = fenceValue > FramesInFlight ? fenceValue - FramesInFlight : 0;
+            const uint64_t budget = (fenceValue / 500 % 2 ? 96 : 160) * MB;
+
+            std::vector<uint32_t> used;
+            for (uint32_t heap : heaps)
+            {
+                if (random() % 4 == 0)
+                {
+                    policy.Use(heap, fenceValue);
+                    used.push_back(heap);
+                }
+            }
+
+            const bool withinBudget = policy.Update(budget, completedValue, &makeResident, &evict);
+            overBudgetFrames += withinBudget ? 0 : 1;
+            for (uint32_t heap : used)
+            {
+                CHECK(policy.IsResident(heap));
+            }
+            for (uint32_t heap : evict)
+            {
+                CHECK(policy.GetLastUse(heap) <= completedValue);
+            }
+
+            // Over the budget, nothing resident may be left to evict.
+            uint64_t residentSize = 0;
+            for (uint32_t heap : heaps)
+            {
+                if (policy.IsResident(heap))
+                {
+                    residentSize += policy.GetSize(heap);
+                    CHECK(withinBudget || policy.GetLastUse(heap) > completedValue);
+                }
+            }
+            CHECK(residentSize == policy.GetStatistics().residentSize);
+            CHECK(withinBudget == (residentSize <= budget));
+        }
+        CHECK(overBudgetFrames > 0 && overBudgetFrames < 5000);
+
+        for (uint32_t heap : heaps)
+        {
+            policy.RemoveObject(heap);
+        }
+        CHECK(policy.GetStatistics().residentSize == 0 && policy.GetStatistics().evictedSize == 0);
+    }
+}
+
+int main()
+{
+    TestUnderBudget();
+    TestLeastRecentlyUsed();
+    TestInUseNotEvicted();
+    TestSimulatedFrames();
+    std::printf("ResidencyPolicy tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../RetireQueue.h"
+#include "../TlsfAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    // A queue's fence timeline on a GPU that finishes work only when told to,
+    // or when someone waits for it. Waiting for a value that was never signaled
+    // is what hangs on a real fence, so here it fails the test instead.
+    class SimulatedTimeline
+    {
+    public:
+        SimulatedTimeline() : m_nextValue(1), m_completedValue(0), m_signalCount(0) {}
+
+        uint64_t GetNextValue() const               { return m_nextValue; }
+        bool IsCompleted(uint64_t value) const      { return value <= m_completedValue; }
+
+        uint64_t Signal()
+        {
+            m_signalCount++;
+            return m_nextValue++;
+        }
+
+        void WaitForValue(uint64_t value)
+        {
+            CHECK(value < m_nextValue);
+            m_completedValue = value > m_completedValue ? value : m_completedValue;
+        }
+
+        void CompleteAll()                          { m_completedValue = m_nextValue - 1; }
+        uint32_t GetSignalCount() const             { return m_signalCount; }
+
+    private:
+        uint64_t m_nextValue;
+        uint64_t m_completedValue;
+        uint32_t m_signalCount;
+    };
+
+    typedef RetireQueue<std::shared_ptr<int>, SimulatedTimeline> Queue;
+
+    void Drop(std::shared_ptr<int>&) {}
+
+    // Items released since the last frame are tagged with a value that has
+    // not been signaled; flushing signals it rather than waiting forever.
+    void TestFlushWithoutFrame()
+    {
+        SimulatedTimeline timeline;
+        Queue queue(&timeline);
+        std::shared_ptr<int> object = std::make_shared<int>(0);
+        queue.Push(timeline.GetNextValue(), object);
+        CHECK(queue.Collect(Drop) == 0);
+
+        CHECK(queue.Flush(Drop) == 1);
+        CHECK(queue.IsEmpty() && object.use_count() == 1);
+        CHECK(timeline.GetSignalCount() == 1);
+    }
+
+    // Once the frame that used them has been signaled, flushing only waits.
+    void TestFlushAfterFrame()
+    {
+        SimulatedTimeline timeline;
+        Queue queue(&timeline);
+        queue.Push(timeline.GetNextValue(), std::make_shared<int>(0));
+        timeline.Signal();
+        CHECK(queue.Flush(Drop) == 1);
+        CHECK(timeline.GetSignalCount() == 1);
+        CHECK(queue.Flush(Drop) == 0);
+    }
+
+    // Items retire oldest first, and only once their value has completed,
+    // whatever order they were pushed in.
+    void TestCollectInOrder()
+    {
+        SimulatedTimeline timeline;
+        Queue queue(&timeline);
+        for (int i = 0; i < 3; i++)
+        {
+            timeline.Signal();
+        }
+        queue.Push(3, std::make_shared<int>(3));
+        queue.Push(1, std::make_shared<int>(1));
+        queue.Push(2, std::make_shared<int>(2));
+        queue.Push(4, std::make_shared<int>(4));
+
+        std::vector<int> retired;
+        auto record = [&](std::shared_ptr<int>& item) { retired.push_back(*item); };
+        CHECK(queue.Collect(record) == 0);
+        timeline.CompleteAll();
+        CHECK(queue.Collect(record) == 3);
+        CHECK(queue.GetCount() == 1);
+        CHECK(queue.Flush(record) == 1);
+        CHECK(retired == std::vector<int>({ 1, 2, 3, 4 }));
+    }
+
+    // PlacedResourceAllocator's pattern: a released resource's space goes back
+    // to its heap's allocator once the timeline passes it, and a shutdown flush
+    // right after the release still gets there.
+    void TestFreeSpaceWithoutFrame()
+    {
+        SimulatedTimeline timeline;
+        TlsfAllocator allocator(64 * 1024 * 1024);
+        RetireQueue<uint32_t, SimulatedTimeline> pendingFrees(&timeline);
+        auto free = [&](uint32_t& block) { allocator.Free(block); };
+
+        TlsfAllocator::Allocation first, second;
+        CHECK(allocator.Allocate(1024 * 1024, 65536, &first));
+        CHECK(allocator.Allocate(1024 * 1024, 65536, &second));
+        pendingFrees.Push(timeline.GetNextValue(), first.block);
+        timeline.Signal();
+        pendingFrees.Push(timeline.GetNextValue(), second.block);
+
+        timeline.CompleteAll();
+        CHECK(pendingFrees.Collect(free) == 1);
+        CHECK(!allocator.IsEmpty());
+        CHECK(pendingFrees.Flush(free) == 1);
+        CHECK(allocator.IsEmpty() && timeline.GetSignalCount() == 2);
+    }
+}
+
+int main()
+{
+    TestFlushWithoutFrame();
+    TestFlushAfterFrame();
+    TestCollectInOrder();
+    TestFreeSpaceWithoutFrame();
+    std::printf("RetireQueue tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// The portable tests run the platform-independent parts of the sample without
+// Windows or a GPU. A failed check prints where it failed and fails the test.
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
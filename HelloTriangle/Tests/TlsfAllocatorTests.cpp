@@ -0,0 +1,170 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "../TlsfAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    const uint64_t MB = 1024 * 1024;
+
+    // Checks the allocations against each other and against the statistics.
+    void CheckAllocations(const TlsfAllocator& allocator, const std::map<uint64_t, uint64_t>& allocations)
+    {
+        uint64_t usedSize = 0;
+        uint64_t end = 0;
+        for (const auto& allocation : allocations)
+        {
+            CHECK(allocation.first >= end);
+            end = allocation.first + allocation.second;
+            usedSize += allocation.second;
+        }
+        CHECK(end <= allocator.GetSize());
+
+        const TlsfAllocator::Statistics stats = allocator.GetStatistics();
+        CHECK(stats.usedSize == usedSize);
+        CHECK(stats.usedSize + stats.freeSize == stats.size);
+        CHECK(stats.allocationCount == allocations.size());
+        CHECK(stats.largestFreeBlock <= stats.freeSize);
+    }
+
+    // Sizes round up to the granularity and alignments are honored.
+    void TestAlignment()
+    {
+        TlsfAllocator allocator(4 * MB);
+        TlsfAllocator::Allocation a, b, c;
+        CHECK(allocator.Allocate(1, 1, &a));
+        CHECK(a.offset == 0 && a.size == TlsfAllocator::Granularity);
+        CHECK(allocator.Allocate(1000, 64 * 1024, &b));
+        CHECK(b.offset == 64 * 1024 && b.size == 1024);
+        CHECK(allocator.Allocate(MB, MB, &c));
+        CHECK(c.offset == MB);
+        CHECK(allocator.GetStatistics().freeBlockCount == 3);
+    }
+
+    // Freeing everything, in any order, merges the heap back into one block.
+    void TestMergeOnFree()
+    {
+        TlsfAllocator allocator(64 * MB);
+        std::vector<TlsfAllocator::Allocation> allocations(64);
+        for (TlsfAllocator::Allocation& allocation : allocations)
+        {
+            CHECK(allocator.Allocate(MB, TlsfAllocator::Granularity, &allocation));
+        }
+        TlsfAllocator::Allocation full;
+        CHECK(!allocator.Allocate(1, 1, &full));
+
+        for (size_t i = 0; i < allocations.size(); i += 2)
+        {
+            allocator.Free(allocations[i].block);
+        }
+        TlsfAllocator::Statistics stats = allocator.GetStatistics();
+        CHECK(stats.freeBlockCount == 32 && stats.largestFreeBlock == MB);
+
+        for (size_t i = 1; i < allocations.size(); i += 2)
+        {
+            allocator.Free(allocations[i].block);
+        }
+        stats = allocator.GetStatistics();
+        CHECK(allocator.IsEmpty());
+        CHECK(stats.freeBlockCount == 1 && stats.largestFreeBlock == 64 * MB);
+        CHECK(stats.fragmentation == 0.0);
+    }
+
+    // Size classes above 4 GB use the upper half of the bit scans.
+    void TestLargeHeap()
+    {
+        const uint64_t size = 1ull << 40;
+        TlsfAllocator allocator(size);
+        TlsfAllocator::Allocation small, large;
+        CHECK(allocator.Allocate(MB, TlsfAllocator::Granularity, &small));
+        CHECK(allocator.Allocate(size / 4, size / 4, &large));
+        CHECK(large.offset == size / 4);
+        CHECK(allocator.GetStatistics().largestFreeBlock == size / 2);
+        allocator.Free(large.block);
+        allocator.Free(small.block);
+        CHECK(allocator.GetStatistics().largestFreeBlock == size);
+    }
+
+    // Relocation only ever moves an allocation down.
+    void TestRelocate()
+    {
+        TlsfAllocator allocator(8 * MB);
+        TlsfAllocator::Allocation a, b, moved;
+        CHECK(allocator.Allocate(MB, TlsfAllocator::Granularity, &a));
+        CHECK(allocator.Allocate(MB, TlsfAllocator::Granularity, &b));
+        CHECK(!allocator.Relocate(b.block, TlsfAllocator::Granularity, &moved));
+        allocator.Free(a.block);
+        CHECK(allocator.Relocate(b.block, TlsfAllocator::Granularity, &moved));
+        CHECK(moved.offset == 0);
+        allocator.Free(b.block);
+        CHECK(allocator.GetStatistics().usedSize == MB);
+    }
+
+    // Random allocations and frees never overlap or lose track of memory.
+    void TestRandom()
+    {
+        TlsfAllocator allocator(256 * MB);
+        std::map<uint64_t, uint64_t> allocations;
+        std::map<uint64_t, uint32_t> blocks;
+        std::mt19937 random(1);
+        for (int i = 0; i < 20000; i++)
+        {
+            if (blocks.empty() || random() % 3 != 0)
+            {
+                const uint64_t size = 1 + random() % (4 * MB);
+                const uint64_t alignment = 1ull << (random() % 21);
+                TlsfAllocator::Allocation allocation;
+                if (allocator.Allocate(size, alignment, &allocation))
+                {
+                    CHECK(allocation.size >= size && allocation.offset % alignment == 0);
+                    allocations[allocation.offset] = allocation.size;
+                    blocks[allocation.offset] = allocation.block;
+                }
+            }
+            else
+            {
+                auto it = blocks.begin();
+                std::advance(it, random() % blocks.size());
+                allocator.Free(it->second);
+                allocations.erase(it->first);
+                blocks.erase(it);
+            }
+
+            if (i % 100 == 0)
+            {
+                CheckAllocations(allocator, allocations);
+            }
+        }
+
+        for (const auto& block : blocks)
+        {
+            allocator.Free(block.second);
+        }
+        CHECK(allocator.IsEmpty() && allocator.GetStatistics().freeBlockCount == 1);
+    }
+}
+
+int main()
+{
+    TestAlignment();
+    TestMergeOnFree();
+    TestLargeHeap();
+    TestRelocate();
+    TestRandom();
+    std::printf("TlsfAllocator tests passed\n");
+    return EXIT_SUCCESS;
+}
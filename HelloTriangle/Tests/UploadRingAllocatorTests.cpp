@@ -0,0 +1,127 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include "../UploadRingAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    const uint64_t KB = 1024;
+
+    // An allocation that does not fit before the end wraps to the start, and
+    // the bytes it skipped are only given back with its frame.
+    void TestWrap()
+    {
+        UploadRingAllocator ring(64 * KB);
+        CHECK(ring.Allocate(40 * KB, 256) == 0);
+        ring.EndFrame(1);
+        CHECK(ring.Allocate(16 * KB, 256) == 40 * KB);
+        ring.EndFrame(2);
+        CHECK(ring.Allocate(16 * KB, 256) == UploadRingAllocator::InvalidOffset);
+
+        ring.Retire(1);
+        CHECK(ring.Allocate(16 * KB, 256) == 0);
+        ring.EndFrame(3);
+        CHECK(ring.GetUsedSize() == 40 * KB);
+        CHECK(ring.GetOldestFenceValue() == 2);
+
+        ring.Retire(3);
+        CHECK(ring.GetUsedSize() == 0 && ring.GetPendingFrameCount() == 0);
+        CHECK(ring.GetOldestFenceValue() == 0);
+    }
+
+    // Frames without allocations do not hold up retirement.
+    void TestEmptyFrames()
+    {
+        UploadRingAllocator ring(64 * KB);
+        ring.EndFrame(1);
+        CHECK(ring.GetPendingFrameCount() == 0);
+        CHECK(ring.Allocate(1 * KB, 256) == 0);
+        ring.EndFrame(2);
+        ring.EndFrame(3);
+        CHECK(ring.GetPendingFrameCount() == 1 && ring.GetOldestFenceValue() == 2);
+    }
+
+    // A simulated GPU that completes a frame a random number of frames after
+    // it is submitted. The CPU waits on the oldest frame whenever the ring is
+    // full, the way UploadRing does, and no two live allocations ever overlap.
+    void TestSimulatedFrames()
+    {
+        const uint64_t Size = 256 * KB;
+
+        struct Live
+        {
+            uint64_t fenceValue;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        UploadRingAllocator ring(Size);
+        std::deque<Live> live;
+        std::mt19937 random(1);
+        uint64_t completedValue = 0;
+        uint64_t waitCount = 0;
+        for (uint64_t fenceValue = 1; fenceValue <= 5000; fenceValue++)
+        {
+            const uint32_t allocationCount = random() % 8;
+            for (uint32_t i = 0; i < allocationCount; i++)
+            {
+                const uint64_t size = 1 + random() % (32 * KB);
+                const uint64_t alignment = 1ull << (random() % 10);
+                uint64_t offset;
+                while ((offset = ring.Allocate(size, alignment)) == UploadRingAllocator::InvalidOffset)
+                {
+                    CHECK(ring.GetPendingFrameCount() > 0);
+                    completedValue = ring.GetOldestFenceValue();
+                    ring.Retire(completedValue);
+                    waitCount++;
+                }
+                CHECK(offset % alignment == 0 && offset + size <= Size);
+
+                while (!live.empty() && live.front().fenceValue <= completedValue)
+                {
+                    live.pop_front();
+                }
+                for (const Live& other : live)
+                {
+                    CHECK(offset + size <= other.offset || other.offset + other.size <= offset);
+                }
+                live.push_back({ fenceValue, offset, size });
+            }
+            ring.EndFrame(fenceValue);
+            CHECK(ring.GetUsedSize() <= Size);
+
+            if (random() % 3 == 0)
+            {
+                completedValue = (std::max)(completedValue, fenceValue - random() % 4);
+                ring.Retire(completedValue);
+            }
+        }
+        CHECK(waitCount > 0);
+
+        ring.Retire(UINT64_MAX);
+        CHECK(ring.GetUsedSize() == 0);
+    }
+}
+
+int main()
+{
+    TestWrap();
+    TestEmptyFrames();
+    TestSimulatedFrames();
+    std::printf("UploadRingAllocator tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,431 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Rounds a size or offset up to a multiple of a power-of-two alignment.
+inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Two-level segregated fit (TLSF) bookkeeping for a range of memory, such as a
+// heap that placed resources are carved out of. Allocation and free are O(1):
+// free blocks are kept in lists by size class, the first level a power of two
+// and the second level splitting it into SecondLevelCount linear steps, with a
+// bitmap per level to find the smallest non-empty class that fits. Freed blocks
+// merge with free neighbors right away, so no two free blocks are ever adjacent.
+//
+// Sizes are rounded up to Granularity. Alignments are powers of two; a block
+// found for an aligned request may leave a free gap before the allocation.
+//
+// The allocator only deals in offsets; PlacedResourceAllocator backs it with
+// ID3D12Heaps. The bit scans fall back to GCC/Clang builtins outside MSVC so
+// that Tests/TlsfAllocatorTests.cpp builds anywhere.
+class TlsfAllocator
+{
+public:
+    static const uint64_t Granularity = 256;
+    static const uint32_t InvalidBlock = UINT32_MAX;
+
+    struct Allocation
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t block;     // Identifies the allocation for Free().
+    };
+
+    struct Statistics
+    {
+        uint64_t size;
+        uint64_t usedSize;
+        uint64_t freeSize;
+        uint64_t largestFreeBlock;
+        uint32_t allocationCount;
+        uint32_t freeBlockCount;
+        double fragmentation;       // Share of the free memory outside the largest free block.
+    };
+
+    explicit TlsfAllocator(uint64_t size) :
+        m_size(size & ~(Granularity - 1)),
+        m_usedSize(0),
+        m_allocationCount(0),
+        m_freeBlockCount(0),
+        m_lastBlock(InvalidBlock),
+        m_firstLevelBitmap(0),
+        m_secondLevelBitmaps()
+    {
+        for (auto& lists : m_freeLists)
+        {
+            for (uint32_t& list : lists)
+            {
+                list = InvalidBlock;
+            }
+        }
+
+        if (m_size > 0)
+        {
+            m_lastBlock = NewBlock(0, m_size);
+            InsertFreeBlock(m_lastBlock);
+        }
+    }
+
+    // Returns false if no free block fits.
+    bool Allocate(uint64_t size, uint64_t alignment, Allocation* pAllocation)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+        size = AlignUp(size > 0 ? size : 1, Granularity);
+        alignment = alignment > Granularity ? alignment : Granularity;
+
+        // Any block of at least this size fits, wherever the alignment falls.
+        const uint32_t block = FindFreeBlock(size + alignment - Granularity);
+        if (block == InvalidBlock)
+        {
+            return false;
+        }
+        RemoveFreeBlock(block);
+
+        // Give back the gap in front of the aligned offset, then what is left over
+        // behind the allocation. The block's neighbors are in use, so neither
+        // piece has a free neighbor to merge with.
+        const uint64_t alignedOffset = AlignUp(m_blocks[block].offset, alignment);
+        const uint64_t padding = alignedOffset - m_blocks[block].offset;
+        if (padding > 0)
+        {
+            const uint32_t front = NewBlock(m_blocks[block].offset, padding);
+            LinkBefore(front, block);
+            m_blocks[block].offset = alignedOffset;
+            m_blocks[block].size -= padding;
+            InsertFreeBlock(front);
+        }
+        if (m_blocks[block].size > size)
+        {
+            const uint32_t back = NewBlock(alignedOffset + size, m_blocks[block].size - size);
+            LinkAfter(back, block);
+            m_blocks[block].size = size;
+            InsertFreeBlock(back);
+        }
+
+        m_blocks[block].free = false;
+        m_usedSize += size;
+        m_allocationCount++;
+
+        pAllocation->offset = alignedOffset;
+        pAllocation->size = size;
+        pAllocation->block = block;
+        return true;
+    }
+
+    void Free(uint32_t block)
+    {
+        assert(block < m_blocks.size() && !m_blocks[block].free);
+        m_usedSize -= m_blocks[block].size;
+        m_allocationCount--;
+
+        const uint32_t previous = m_blocks[block].previousPhysical;
+        if (previous != InvalidBlock && m_blocks[previous].free)
+        {
+            RemoveFreeBlock(previous);
+            m_blocks[previous].size += m_blocks[block].size;
+            Unlink(block);
+            block = previous;
+        }
+        const uint32_t next = m_blocks[block].nextPhysical;
+        if (next != InvalidBlock && m_blocks[next].free)
+        {
+            RemoveFreeBlock(next);
+            m_blocks[block].size += m_blocks[next].size;
+            Unlink(next);
+        }
+        InsertFreeBlock(block);
+    }
+
+    // Finds a new place for an allocation that starts below its current one, for
+    // defragmentation. The allocation keeps its place until it is freed, so its
+    // contents can be copied over first. Returns false if there is no such place.
+    bool Relocate(uint32_t block, uint64_t alignment, Allocation* pAllocation)
+    {
+        const uint64_t offset = m_blocks[block].offset;
+        if (!Allocate(m_blocks[block].size, alignment, pAllocation))
+        {
+            return false;
+        }
+        if (pAllocation->offset > offset)
+        {
+            Free(pAllocation->block);
+            return false;
+        }
+        return true;
+    }
+
+    // Allocations in descending order of offset, the order defragmentation
+    // moves them in.
+    void GetAllocationsFromTop(std::vector<Allocation>* pAllocations) const
+    {
+        pAllocations->clear();
+        for (uint32_t block = m_lastBlock; block != InvalidBlock; block = m_blocks[block].previousPhysical)
+        {
+            if (!m_blocks[block].free)
+            {
+                pAllocations->push_back({ m_blocks[block].offset, m_blocks[block].size, block });
+            }
+        }
+    }
+
+    Statistics GetStatistics() const
+    {
+        Statistics statistics = {};
+        statistics.size = m_size;
+        statistics.usedSize = m_usedSize;
+        statistics.freeSize = m_size - m_usedSize;
+        statistics.allocationCount = m_allocationCount;
+        statistics.freeBlockCount = m_freeBlockCount;
+
+        // The largest free block is in the highest non-empty size class.
+        if (m_firstLevelBitmap != 0)
+        {
+            const uint32_t firstLevel = Log2(m_firstLevelBitmap);
+            const uint32_t secondLevel = Log2(m_secondLevelBitmaps[firstLevel]);
+            for (uint32_t block = m_freeLists[firstLevel][secondLevel]; block != InvalidBlock; block = m_blocks[block].nextFree)
+            {
+                statistics.largestFreeBlock = (std::max)(statistics.largestFreeBlock, m_blocks[block].size);
+            }
+        }
+        statistics.fragmentation = statistics.freeSize > 0 ?
+            1.0 - static_cast<double>(statistics.largestFreeBlock) / statistics.freeSize : 0.0;
+        return statistics;
+    }
+
+    uint64_t GetSize() const        { return m_size; }
+    bool IsEmpty() const            { return m_allocationCount == 0; }
+
+private:
+    static const uint32_t SecondLevelBits = 4;
+    static const uint32_t SecondLevelCount = 1 << SecondLevelBits;
+    static const uint32_t FirstLevelCount = 64;
+
+    struct Block
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t previousPhysical;
+        uint32_t nextPhysical;
+        uint32_t previousFree;
+        uint32_t nextFree;
+        bool free;
+    };
+
+    static uint32_t Log2(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    static uint32_t LowestBit(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    // The size class of a size, in units of Granularity.
+    static void Mapping(uint64_t size, uint32_t* pFirstLevel, uint32_t* pSecondLevel)
+    {
+        const uint64_t units = size / Granularity;
+        if (units < SecondLevelCount)
+        {
+            *pFirstLevel = 0;
+            *pSecondLevel = static_cast<uint32_t>(units);
+        }
+        else
+        {
+            const uint32_t log = Log2(units);
+            *pFirstLevel = log - SecondLevelBits + 1;
+            *pSecondLevel = static_cast<uint32_t>(units >> (log - SecondLevelBits)) ^ SecondLevelCount;
+        }
+    }
+
+    // Rounds the size up to the next size class first, so that every block in
+    // the class found is large enough.
+    uint32_t FindFreeBlock(uint64_t size) const
+    {
+        const uint64_t units = size / Granularity;
+        if (units >= SecondLevelCount)
+        {
+            size += ((uint64_t(1) << (Log2(units) - SecondLevelBits)) - 1) * Granularity;
+        }
+
+        uint32_t firstLevel, secondLevel;
+        Mapping(size, &firstLevel, &secondLevel);
+        if (firstLevel >= FirstLevelCount)
+        {
+            return InvalidBlock;
+        }
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        if (secondLevelMap == 0)
+        {
+            const uint64_t firstLevelMap = firstLevel + 1 < FirstLevelCount ? m_firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+            if (firstLevelMap == 0)
+            {
+                return InvalidBlock;
+            }
+            firstLevel = LowestBit(firstLevelMap);
+            secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        }
+        return m_freeLists[firstLevel][LowestBit(secondLevelMap)];
+    }
+
+    void InsertFreeBlock(uint32_t block)
+    {
+        uint32_t firstLevel, secondLevel;
+        Mapping(m_blocks[block].size, &firstLevel, &secondLevel);
+
+        const uint32_t head = m_freeLists[firstLevel][secondLevel];
+        m_blocks[block].free = true;
+        m_blocks[block].previousFree = InvalidBlock;
+        m_blocks[block].nextFree = head;
+        if (head != InvalidBlock)
+        {
+            m_blocks[head].previousFree = block;
+        }
+        m_freeLists[firstLevel][secondLevel] = block;
+        m_firstLevelBitmap |= uint64_t(1) << firstLevel;
+        m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+        m_freeBlockCount++;
+    }
+
+    void RemoveFreeBlock(uint32_t block)
+    {
+        uint32_t firstLevel, secondLevel;
+        Mapping(m_blocks[block].size, &firstLevel, &secondLevel);
+
+        const Block& removed = m_blocks[block];
+        if (removed.previousFree != InvalidBlock)
+        {
+            m_blocks[removed.previousFree].nextFree = removed.nextFree;
+        }
+        else
+        {
+            m_freeLists[firstLevel][secondLevel] = removed.nextFree;
+        }
+        if (removed.nextFree != InvalidBlock)
+        {
+            m_blocks[removed.nextFree].previousFree = removed.previousFree;
+        }
+
+        if (m_freeLists[firstLevel][secondLevel] == InvalidBlock)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+            {
+                m_firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+            }
+        }
+        m_blocks[block].free = false;
+        m_freeBlockCount--;
+    }
+
+    // Block records are recycled, so allocations do not grow the vector once it
+    // has reached the peak block count.
+    uint32_t NewBlock(uint64_t offset, uint64_t size)
+    {
+        uint32_t block;
+        if (!m_unusedBlocks.empty())
+        {
+            block = m_unusedBlocks.back();
+            m_unusedBlocks.pop_back();
+        }
+        else
+        {
+            block = static_cast<uint32_t>(m_blocks.size());
+            m_blocks.emplace_back();
+        }
+        m_blocks[block] = { offset, size, InvalidBlock, InvalidBlock, InvalidBlock, InvalidBlock, false };
+        return block;
+    }
+
+    void LinkBefore(uint32_t block, uint32_t next)
+    {
+        const uint32_t previous = m_blocks[next].previousPhysical;
+        m_blocks[block].previousPhysical = previous;
+        m_blocks[block].nextPhysical = next;
+        m_blocks[next].previousPhysical = block;
+        if (previous != InvalidBlock)
+        {
+            m_blocks[previous].nextPhysical = block;
+        }
+    }
+
+    void LinkAfter(uint32_t block, uint32_t previous)
+    {
+        const uint32_t next = m_blocks[previous].nextPhysical;
+        m_blocks[block].previousPhysical = previous;
+        m_blocks[block].nextPhysical = next;
+        m_blocks[previous].nextPhysical = block;
+        if (next != InvalidBlock)
+        {
+            m_blocks[next].previousPhysical = block;
+        }
+        else
+        {
+            m_lastBlock = block;
+        }
+    }
+
+    void Unlink(uint32_t block)
+    {
+        const uint32_t previous = m_blocks[block].previousPhysical;
+        const uint32_t next = m_blocks[block].nextPhysical;
+        if (previous != InvalidBlock)
+        {
+            m_blocks[previous].nextPhysical = next;
+        }
+        if (next != InvalidBlock)
+        {
+            m_blocks[next].previousPhysical = previous;
+        }
+        else
+        {
+            m_lastBlock = previous;
+        }
+        m_unusedBlocks.push_back(block);
+    }
+
+    uint64_t m_size;
+    uint64_t m_usedSize;
+    uint32_t m_allocationCount;
+    uint32_t m_freeBlockCount;
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_unusedBlocks;
+    uint32_t m_lastBlock;               // Highest offset.
+    uint64_t m_firstLevelBitmap;
+    uint32_t m_secondLevelBitmaps[FirstLevelCount];
+    uint32_t m_freeLists[FirstLevelCount][SecondLevelCount];
+};
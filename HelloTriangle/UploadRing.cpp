@@ -0,0 +1,100 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#include "stdafx.h"
+#include "UploadRing.h"
+
+UploadRing::UploadRing(ID3D12Device* pDevice, FenceTimeline* pTimeline, UINT64 size) :
+    m_pTimeline(pTimeline),
+    m_pDataBegin(nullptr),
+    m_gpuAddress(0),
+    m_allocator(size)
+{
+    ThrowIfFailed(pDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(size),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_buffer)));
+    NAME_D3D12_OBJECT(m_buffer);
+
+    // Upload memory stays mapped for the lifetime of the ring; the fence
+    // protects it instead of Map/Unmap.
+    CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+    ThrowIfFailed(m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_pDataBegin)));
+    m_gpuAddress = m_buffer->GetGPUVirtualAddress();
+}
+
+UploadRing::~UploadRing()
+{
+    m_buffer->Unmap(0, nullptr);
+    m_pDataBegin = nullptr;
+}
+
+UploadAllocation UploadRing::Allocate(UINT64 size, UINT64 alignment)
+{
+    // Free whatever the GPU is done with before waiting on anything; when the
+    // ring is still full, wait for the oldest frame until the allocation fits.
+    m_allocator.Retire(m_pTimeline->GetCompletedValue());
+    UINT64 offset = m_allocator.Allocate(size, alignment);
+    while (offset == UploadRingAllocator::InvalidOffset)
+    {
+        const UINT64 fenceValue = m_allocator.GetOldestFenceValue();
+        if (fenceValue == 0)
+        {
+            // Only the current frame holds the ring; it is sized too small.
+            ThrowIfFailed(E_OUTOFMEMORY);
+        }
+        m_pTimeline->WaitForValue(fenceValue);
+        m_allocator.Retire(fenceValue);
+        offset = m_allocator.Allocate(size, alignment);
+    }
+
+    UploadAllocation allocation;
+    allocation.pCpuAddress = m_pDataBegin + offset;
+    allocation.gpuAddress = m_gpuAddress + offset;
+    allocation.pResource = m_buffer.Get();
+    allocation.offset = offset;
+    return allocation;
+}
+
+D3D12_VERTEX_BUFFER_VIEW UploadRing::AllocateVertexBuffer(const void* pData, UINT size, UINT stride)
+{
+    const UploadAllocation allocation = Allocate(size, 16);
+    memcpy(allocation.pCpuAddress, pData, size);
+
+    D3D12_VERTEX_BUFFER_VIEW view;
+    view.BufferLocation = allocation.gpuAddress;
+    view.SizeInBytes = size;
+    view.StrideInBytes = stride;
+    return view;
+}
+
+D3D12_INDEX_BUFFER_VIEW UploadRing::AllocateIndexBuffer(const void* pData, UINT size, DXGI_FORMAT format)
+{
+    const UploadAllocation allocation = Allocate(size, 16);
+    memcpy(allocation.pCpuAddress, pData, size);
+
+    D3D12_INDEX_BUFFER_VIEW view;
+    view.BufferLocation = allocation.gpuAddress;
+    view.SizeInBytes = size;
+    view.Format = format;
+    return view;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS UploadRing::AllocateConstants(const void* pData, UINT size)
+{
+    const UploadAllocation allocation = Allocate(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    memcpy(allocation.pCpuAddress, pData, size);
+    return allocation.gpuAddress;
+}
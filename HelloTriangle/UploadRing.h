@@ -0,0 +1,60 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include "DXSampleHelper.h"
+#include "FenceTimeline.h"
+#include "UploadRingAllocator.h"
+
+// A piece of the upload ring, valid until the frame it was allocated in has
+// completed on the GPU.
+struct UploadAllocation
+{
+    void* pCpuAddress;
+    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+    ID3D12Resource* pResource;
+    UINT64 offset;
+};
+
+// Transient CPU-written, GPU-read memory for vertex, index and constant data
+// that changes every frame. A single upload buffer stays mapped for the ring's
+// whole lifetime, so an allocation costs a pointer bump rather than a committed
+// resource and a Map/Unmap. A full ring waits for the oldest frame still using
+// it. The ring is not thread safe; allocate from the thread that submits.
+class UploadRing
+{
+public:
+    UploadRing(ID3D12Device* pDevice, FenceTimeline* pTimeline, UINT64 size);
+    ~UploadRing();
+
+    UploadAllocation Allocate(UINT64 size, UINT64 alignment);
+
+    // Copy data into the ring and return a view of it.
+    D3D12_VERTEX_BUFFER_VIEW AllocateVertexBuffer(const void* pData, UINT size, UINT stride);
+    D3D12_INDEX_BUFFER_VIEW AllocateIndexBuffer(const void* pData, UINT size, DXGI_FORMAT format);
+    D3D12_GPU_VIRTUAL_ADDRESS AllocateConstants(const void* pData, UINT size);
+
+    // Everything allocated since the last call is in use until the timeline
+    // passes fenceValue.
+    void EndFrame(UINT64 fenceValue)        { m_allocator.EndFrame(fenceValue); }
+
+    ID3D12Resource* GetBuffer() const       { return m_buffer.Get(); }
+    UINT64 GetUsedSize() const              { return m_allocator.GetUsedSize(); }
+
+private:
+    FenceTimeline* m_pTimeline;
+    ComPtr<ID3D12Resource> m_buffer;
+    UINT8* m_pDataBegin;
+    D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress;
+    UploadRingAllocator m_allocator;
+};
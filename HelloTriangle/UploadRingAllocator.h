@@ -0,0 +1,105 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+// The bookkeeping of a ring buffer that frames carve their transient data out
+// of. Allocations are a pointer bump at the head of the ring; every frame's
+// allocations are tagged with the fence value that frame signals, and the tail
+// only moves past them once that value has completed. An allocation that does
+// not fit before the end of the ring wraps to the start, and the skipped bytes
+// belong to the frame that skipped them.
+//
+// Offsets are tracked as running byte counts, so head - tail is always the
+// number of bytes in use. UploadRing backs the allocator with a persistently
+// mapped upload buffer.
+class UploadRingAllocator
+{
+public:
+    static const uint64_t InvalidOffset = UINT64_MAX;
+
+    // Every alignment asked for has to divide the size.
+    explicit UploadRingAllocator(uint64_t size) :
+        m_size(size),
+        m_head(0),
+        m_tail(0),
+        m_frameStart(0)
+    {
+    }
+
+    // Returns the allocation's offset in the ring, or InvalidOffset if the ring
+    // is too full; retiring frames may make room.
+    uint64_t Allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && m_size % alignment == 0);
+
+        const uint64_t headOffset = m_head % m_size;
+        uint64_t offset = (headOffset + (alignment - 1)) & ~(alignment - 1);
+        if (offset + size > m_size)
+        {
+            offset = 0;
+        }
+        const uint64_t start = m_head - headOffset + offset + (offset < headOffset ? m_size : 0);
+        if (start + size - m_tail > m_size)
+        {
+            return InvalidOffset;
+        }
+
+        m_head = start + size;
+        return offset;
+    }
+
+    // Tags everything allocated since the last call with the fence value that
+    // marks the end of its use.
+    void EndFrame(uint64_t fenceValue)
+    {
+        if (m_head != m_frameStart)
+        {
+            m_frames.push_back({ fenceValue, m_head });
+            m_frameStart = m_head;
+        }
+    }
+
+    // Frees the frames whose fence value has completed.
+    void Retire(uint64_t completedFenceValue)
+    {
+        while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+        {
+            m_tail = m_frames.front().end;
+            m_frames.pop_front();
+        }
+    }
+
+    // The fence value that frees the most memory next; 0 if no frame is pending.
+    uint64_t GetOldestFenceValue() const    { return m_frames.empty() ? 0 : m_frames.front().fenceValue; }
+
+    uint64_t GetSize() const                { return m_size; }
+    uint64_t GetUsedSize() const            { return m_head - m_tail; }
+    uint64_t GetPendingFrameCount() const   { return m_frames.size(); }
+
+private:
+    struct Frame
+    {
+        uint64_t fenceValue;
+        uint64_t end;       // Head of the ring when the frame ended.
+    };
+
+    uint64_t m_size;
+    uint64_t m_head;
+    uint64_t m_tail;
+    uint64_t m_frameStart;
+    std::deque<Frame> m_frames;
+};
@@ -0,0 +1,88 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+#include "DXSampleHelper.h"
+#include "VertexFormat.h"
+
+// Returns the register component type the input assembler produces for a format.
+static D3D_REGISTER_COMPONENT_TYPE GetFormatComponentType(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+        return D3D_REGISTER_COMPONENT_UINT32;
+
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+        return D3D_REGISTER_COMPONENT_SINT32;
+
+    default:
+        // Float, normalized and half formats are all read as floats.
+        return D3D_REGISTER_COMPONENT_FLOAT32;
+    }
+}
+
+_Use_decl_annotations_
+void VerifyInputSignature(ID3D12ShaderReflection* pShaderReflection, const D3D12_INPUT_LAYOUT_DESC& layout)
+{
+    D3D12_SHADER_DESC shaderDesc = {};
+    ThrowIfFailed(pShaderReflection->GetDesc(&shaderDesc));
+
+    for (UINT i = 0; i < shaderDesc.InputParameters; i++)
+    {
+        D3D12_SIGNATURE_PARAMETER_DESC parameter = {};
+        ThrowIfFailed(pShaderReflection->GetInputParameterDesc(i, &parameter));
+
+        // System values (SV_VertexID, SV_InstanceID, ...) are generated, not fetched.
+        if (parameter.SystemValueType != D3D_NAME_UNDEFINED)
+        {
+            continue;
+        }
+
+        const D3D12_INPUT_ELEMENT_DESC* pElement = nullptr;
+        for (UINT e = 0; e < layout.NumElements; e++)
+        {
+            const D3D12_INPUT_ELEMENT_DESC& element = layout.pInputElementDescs[e];
+            if (element.SemanticIndex == parameter.SemanticIndex && _stricmp(element.SemanticName, parameter.SemanticName) == 0)
+            {
+                pElement = &element;
+                break;
+            }
+        }
+
+        std::string semantic = std::string(parameter.SemanticName) + std::to_string(parameter.SemanticIndex);
+        if (pElement == nullptr)
+        {
+            OutputDebugStringA(("Vertex input layout does not provide shader input " + semantic + "\n").c_str());
+            ThrowIfFailed(E_INVALIDARG);
+        }
+
+        // Missing components are filled in by the input assembler, but the
+        // component type has to match what the shader declared.
+        if (GetFormatComponentType(pElement->Format) != parameter.ComponentType)
+        {
+            OutputDebugStringA(("Vertex input layout component type mismatch for shader input " + semantic + "\n").c_str());
+            ThrowIfFailed(E_INVALIDARG);
+        }
+    }
+}
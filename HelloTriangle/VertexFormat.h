@@ -0,0 +1,150 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <d3d12shader.h>
+
+// Vertex input layouts are derived at compile time from annotated vertex structs
+// instead of being maintained by hand next to them. A vertex stream is any struct
+// that exposes its attributes through a static constexpr Attributes() function:
+//
+//     struct Vertex
+//     {
+//         XMFLOAT3 position;
+//         XMFLOAT4 color;
+//
+//         static constexpr std::array<VertexAttribute, 2> Attributes()
+//         {
+//             return { {
+//                 VERTEX_ATTRIBUTE(Vertex, position, "POSITION", 0),
+//                 VERTEX_ATTRIBUTE(Vertex, color, "COLOR", 0)
+//             } };
+//         }
+//     };
+//
+// VertexInputLayout<Vertex> then describes an interleaved layout, while
+// VertexInputLayout<PositionStream, ColorStream> describes a split-stream (SoA)
+// layout with one input slot per stream.
+
+// Maps a C++ attribute type onto the format the input assembler reads it as.
+template<class T> struct VertexAttributeFormat;
+
+template<> struct VertexAttributeFormat<float>               { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32_FLOAT; };
+template<> struct VertexAttributeFormat<DirectX::XMFLOAT2>   { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32_FLOAT; };
+template<> struct VertexAttributeFormat<DirectX::XMFLOAT3>   { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32_FLOAT; };
+template<> struct VertexAttributeFormat<DirectX::XMFLOAT4>   { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32A32_FLOAT; };
+template<> struct VertexAttributeFormat<UINT>                { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32_UINT; };
+template<> struct VertexAttributeFormat<DirectX::XMUINT2>    { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32_UINT; };
+template<> struct VertexAttributeFormat<DirectX::XMUINT3>    { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32_UINT; };
+template<> struct VertexAttributeFormat<DirectX::XMUINT4>    { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32A32_UINT; };
+template<> struct VertexAttributeFormat<INT>                 { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32_SINT; };
+template<> struct VertexAttributeFormat<DirectX::XMINT2>     { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32_SINT; };
+template<> struct VertexAttributeFormat<DirectX::XMINT3>     { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32_SINT; };
+template<> struct VertexAttributeFormat<DirectX::XMINT4>     { static constexpr DXGI_FORMAT Value = DXGI_FORMAT_R32G32B32A32_SINT; };
+
+struct VertexAttribute
+{
+    LPCSTR semanticName;
+    UINT semanticIndex;
+    DXGI_FORMAT format;
+    UINT offset;
+};
+
+// Describes a single member of a vertex stream; the format and the offset are
+// taken from the member itself so they can never drift from the struct.
+#define VERTEX_ATTRIBUTE(Stream, member, semanticName, semanticIndex) \
+    VertexAttribute{ semanticName, semanticIndex, VertexAttributeFormat<decltype(Stream::member)>::Value, static_cast<UINT>(offsetof(Stream, member)) }
+
+// Marks a stream as per-instance data when used in a VertexInputLayout.
+template<class Stream, UINT StepRate = 1>
+struct PerInstance
+{
+};
+
+template<class Stream>
+struct VertexStreamTraits
+{
+    using Type = Stream;
+    static constexpr D3D12_INPUT_CLASSIFICATION Classification = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+    static constexpr UINT StepRate = 0;
+};
+
+template<class Stream, UINT Rate>
+struct VertexStreamTraits<PerInstance<Stream, Rate>>
+{
+    using Type = Stream;
+    static constexpr D3D12_INPUT_CLASSIFICATION Classification = D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA;
+    static constexpr UINT StepRate = Rate;
+};
+
+template<class... Streams>
+constexpr UINT VertexInputElementCount()
+{
+    return (static_cast<UINT>(VertexStreamTraits<Streams>::Type::Attributes().size()) + ... + 0);
+}
+
+template<class Stream, size_t N>
+constexpr void AppendVertexStream(std::array<D3D12_INPUT_ELEMENT_DESC, N>& elements, UINT& element, UINT& slot)
+{
+    using Traits = VertexStreamTraits<Stream>;
+    for (const VertexAttribute& attribute : Traits::Type::Attributes())
+    {
+        D3D12_INPUT_ELEMENT_DESC& desc = elements[element++];
+        desc.SemanticName = attribute.semanticName;
+        desc.SemanticIndex = attribute.semanticIndex;
+        desc.Format = attribute.format;
+        desc.InputSlot = slot;
+        desc.AlignedByteOffset = attribute.offset;
+        desc.InputSlotClass = Traits::Classification;
+        desc.InstanceDataStepRate = Traits::StepRate;
+    }
+    slot++;
+}
+
+template<class... Streams>
+constexpr std::array<D3D12_INPUT_ELEMENT_DESC, VertexInputElementCount<Streams...>()> BuildVertexInputElements()
+{
+    std::array<D3D12_INPUT_ELEMENT_DESC, VertexInputElementCount<Streams...>()> elements = {};
+    UINT element = 0;
+    UINT slot = 0;
+    (AppendVertexStream<Streams>(elements, element, slot), ...);
+    return elements;
+}
+
+template<class... Streams>
+class VertexInputLayout
+{
+public:
+    static constexpr UINT StreamCount = sizeof...(Streams);
+    static constexpr UINT ElementCount = VertexInputElementCount<Streams...>();
+
+    static_assert(StreamCount > 0, "A vertex input layout needs at least one stream.");
+    static_assert(StreamCount <= D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT, "Too many vertex streams.");
+    static_assert(ElementCount <= D3D12_IA_VERTEX_INPUT_STRUCTURE_ELEMENT_COUNT, "Too many vertex attributes.");
+
+    // Byte stride of each input slot, in slot order.
+    static constexpr std::array<UINT, StreamCount> Strides = { { static_cast<UINT>(sizeof(typename VertexStreamTraits<Streams>::Type))... } };
+
+    static constexpr std::array<D3D12_INPUT_ELEMENT_DESC, ElementCount> Elements = BuildVertexInputElements<Streams...>();
+
+    static D3D12_INPUT_LAYOUT_DESC Desc()
+    {
+        return { Elements.data(), ElementCount };
+    }
+};
+
+// Checks that every non system-value input of a vertex shader is fed by an element
+// of the layout with a matching semantic and component type. Throws an HrException
+// with E_INVALIDARG (after logging the offending semantic) on a mismatch.
+void VerifyInputSignature(_In_ ID3D12ShaderReflection* pShaderReflection, const D3D12_INPUT_LAYOUT_DESC& layout);
@@ -11,8 +11,13 @@
 
 #include "stdafx.h"
 #include "Win32Application.h"
+#include "CpuProfiler.h"
 
 HWND Win32Application::m_hwnd = nullptr;
+SpscQueue<Win32Application::WindowEvent, 256> Win32Application::m_windowEvents;
+std::atomic<bool> Win32Application::m_exitRenderThread(false);
+std::exception_ptr Win32Application::m_renderThreadError;
+HANDLE Win32Application::m_renderThread = nullptr;
 
 int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
 {
@@ -22,6 +27,11 @@ int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
     pSample->ParseCommandLineArgs(argv, argc);
     LocalFree(argv);
 
+    if (pSample->IsHeadless())
+    {
+        return RunHeadless(pSample);
+    }
+
     // Initialize the window class.
     WNDCLASSEX windowClass = { 0 };
     windowClass.cbSize = sizeof(WNDCLASSEX);
@@ -54,24 +64,126 @@ int Win32Application::Run(DXSample* pSample, HINSTANCE hInstance, int nCmdShow)
 
     ShowWindow(m_hwnd, nCmdShow);
 
-    // Main sample loop.
+    // Update and render run on their own thread from here on.
+    std::thread renderThread(RenderThread, pSample);
+    m_renderThread = renderThread.native_handle();
+
+    // Main message loop. Block until there is a message to handle, or until the
+    // render thread exits on its own after the frame limit or a failure.
     MSG msg = {};
     while (msg.message != WM_QUIT)
     {
+        const DWORD waitResult = MsgWaitForMultipleObjects(1, &m_renderThread, FALSE, INFINITE, QS_ALLINPUT);
+        if (waitResult == WAIT_OBJECT_0)
+        {
+            break;
+        }
+
         // Process any messages in the queue.
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        while (msg.message != WM_QUIT && PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
         {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
         }
     }
 
+    StopRenderThread();
+    renderThread.join();
+
     pSample->OnDestroy();
 
+    if (m_renderThreadError)
+    {
+        std::rethrow_exception(m_renderThreadError);
+    }
+
     // Return this part of the WM_QUIT message to Windows.
     return static_cast<char>(msg.wParam);
 }
 
+// Renders a fixed number of frames without creating a window.
+int Win32Application::RunHeadless(DXSample* pSample)
+{
+    // Print reports to the console of whoever launched us, if any.
+    if (AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        FILE* pConsole = nullptr;
+        freopen_s(&pConsole, "CONOUT$", "w", stdout);
+    }
+
+    pSample->OnInit();
+
+    const UINT frameCount = pSample->GetFrameLimit() ? pSample->GetFrameLimit() : DefaultHeadlessFrameCount;
+    for (UINT frame = 0; frame < frameCount; frame++)
+    {
+        pSample->OnUpdate();
+        pSample->OnRender();
+    }
+
+    pSample->OnDestroy();
+
+    return 0;
+}
+
+// Render thread loop: drains window events, then updates and renders a frame.
+void Win32Application::RenderThread(DXSample* pSample)
+{
+    CpuProfiler::SetThreadName("Render thread");
+
+    try
+    {
+        const UINT frameLimit = pSample->GetFrameLimit();
+        for (UINT frame = 0; !m_exitRenderThread && (frameLimit == 0 || frame < frameLimit); frame++)
+        {
+            WindowEvent event;
+            while (m_windowEvents.Pop(event))
+            {
+                switch (event.type)
+                {
+                case WindowEvent::KeyDown:
+                    pSample->OnKeyDown(event.key);
+                    break;
+
+                case WindowEvent::KeyUp:
+                    pSample->OnKeyUp(event.key);
+                    break;
+                }
+            }
+
+            pSample->OnUpdate();
+            pSample->OnRender();
+        }
+    }
+    catch (...)
+    {
+        // Rethrown on the window thread once the message loop has stopped.
+        m_renderThreadError = std::current_exception();
+    }
+}
+
+void Win32Application::PostWindowEvent(WindowEvent::Type type, UINT8 key)
+{
+    // The render thread drains the queue every frame; it can only be full if
+    // a frame takes very long, in which case holding up input is acceptable.
+    const WindowEvent event = { type, key };
+    while (!m_windowEvents.Push(event) && !m_exitRenderThread)
+    {
+        SwitchToThread();
+    }
+}
+
+// The render thread may be blocked sending a message to the window (e.g. from
+// SetWindowText), so keep dispatching sent messages while waiting for it.
+void Win32Application::StopRenderThread()
+{
+    m_exitRenderThread = true;
+    while (MsgWaitForMultipleObjects(1, &m_renderThread, FALSE, INFINITE, QS_SENDMESSAGE) != WAIT_OBJECT_0)
+    {
+        MSG msg;
+        PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+    }
+}
+
 // Main message handler for the sample.
 LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -90,23 +202,29 @@ LRESULT CALLBACK Win32Application::WindowProc(HWND hWnd, UINT message, WPARAM wP
     case WM_KEYDOWN:
         if (pSample)
         {
-            pSample->OnKeyDown(static_cast<UINT8>(wParam));
+            PostWindowEvent(WindowEvent::KeyDown, static_cast<UINT8>(wParam));
         }
         return 0;
 
     case WM_KEYUP:
         if (pSample)
         {
-            pSample->OnKeyUp(static_cast<UINT8>(wParam));
+            PostWindowEvent(WindowEvent::KeyUp, static_cast<UINT8>(wParam));
         }
         return 0;
 
     case WM_PAINT:
-        if (pSample)
+        // Frames are produced continuously by the render thread; just validate.
+        ValidateRect(hWnd, nullptr);
+        return 0;
+
+    case WM_CLOSE:
+        // Stop presenting before the window goes away.
+        if (m_renderThread)
         {
-            pSample->OnUpdate();
-            pSample->OnRender();
+            StopRenderThread();
         }
+        DestroyWindow(hWnd);
         return 0;
 
     case WM_DESTROY:
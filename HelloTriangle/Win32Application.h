@@ -11,10 +11,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <exception>
 #include "DXSample.h"
+#include "SpscQueue.h"
 
 class DXSample;
 
+// The window thread only pumps messages; update and render run on a dedicated
+// render thread. Window events reach the render thread through a lock-free
+// queue, so message handling never delays frame submission.
 class Win32Application
 {
 public:
@@ -25,5 +31,29 @@ protected:
     static LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 private:
+    struct WindowEvent
+    {
+        enum Type : UINT8
+        {
+            KeyDown,
+            KeyUp
+        };
+
+        Type type;
+        UINT8 key;
+    };
+
+    // Frames rendered in headless mode when no frame limit is given.
+    static const UINT DefaultHeadlessFrameCount = 1000;
+
+    static int RunHeadless(DXSample* pSample);
+    static void RenderThread(DXSample* pSample);
+    static void PostWindowEvent(WindowEvent::Type type, UINT8 key);
+    static void StopRenderThread();
+
     static HWND m_hwnd;
+    static SpscQueue<WindowEvent, 256> m_windowEvents;
+    static std::atomic<bool> m_exitRenderThread;
+    static std::exception_ptr m_renderThreadError;
+    static HANDLE m_renderThread;
 };
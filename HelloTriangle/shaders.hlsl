@@ -25,6 +25,50 @@ PSInput VSMain(float4 position : POSITION, float4 color : COLOR)
     return result;
 }
 
+// The stress scene draws many copies of the triangle, each scaled down and moved
+// into its own cell of a grid. The placement comes from root constants, or from
+// a per-instance vertex stream when the copies are drawn instanced.
+cbuffer ObjectConstants : register(b0)
+{
+    float3 objectPlacement;     // xy: offset, z: scale.
+};
+
+PSInput PlaceVertex(float4 position, float4 color, float3 placement)
+{
+    PSInput result;
+
+    result.position = float4(position.xy * placement.z + placement.xy, position.zw);
+    result.color = color;
+
+    return result;
+}
+
+PSInput StressVSMain(float4 position : POSITION, float4 color : COLOR)
+{
+    return PlaceVertex(position, color, objectPlacement);
+}
+
+PSInput StressInstancedVSMain(float4 position : POSITION, float4 color : COLOR, float3 placement : PLACEMENT)
+{
+    return PlaceVertex(position, color, placement);
+}
+
+// Bindless draws see every buffer of the bindless table and are told which one
+// holds the placements. The draw's first object comes along because
+// SV_InstanceID starts at 0 whatever the start instance.
+StructuredBuffer<float3> bindlessBuffers[] : register(t0, space1);
+
+cbuffer BindlessConstants : register(b1)
+{
+    uint placementBufferIndex;
+    uint firstObject;
+};
+
+PSInput StressBindlessVSMain(float4 position : POSITION, float4 color : COLOR, uint instance : SV_InstanceID)
+{
+    return PlaceVertex(position, color, bindlessBuffers[placementBufferIndex][firstObject + instance]);
+}
+
 /*
 float4 PSMain(PSInput input) : SV_TARGET
 {
@@ -22,11 +22,17 @@
 #include <windows.h>
 
 #include <d3d12.h>
-#include <dxgi1_4.h>
+#include <dxgi1_5.h>
 #include <D3Dcompiler.h>
 #include <DirectXMath.h>
 #include "d3dx12.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 #include <wrl.h>
 #include <shellapi.h>